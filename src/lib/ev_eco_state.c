@@ -0,0 +1,63 @@
+// Check if we're using a standard C compiler
+#ifndef PICO_C
+#include "ev_eco_state.h"
+#endif
+
+// Function to clear the readings, the car is not charging
+void initEvEcoState(struct EvEcoState* state) {
+    int loopIndex;
+
+    // Initialize the readings array
+    for (loopIndex = 0; loopIndex < SECONDS_IN_A_MINUTE; loopIndex++) {
+        state->solarPowerReadings[loopIndex] = 0.0;
+    }
+    state->solarPowerReadingsIndex = 0;
+    state->averagePower = 0.0;
+    state->highSOCPower = 0.0;
+    state->carCharging = 0;
+    state->ecoPower = 0.0;
+}
+
+// Function to take the readings of one second, 1 when the outputs were decided
+int updateEvEcoState(struct EvEcoState* state, float userConfigEcoPower, float currentSolarPowerProduction,
+                     float batterySoc, float userConfigSocTreshold) {
+    float sum = 0.0;
+    int loopIndex;
+
+    state->solarPowerReadings[state->solarPowerReadingsIndex] = currentSolarPowerProduction;
+    state->solarPowerReadingsIndex = (state->solarPowerReadingsIndex + 1) % SECONDS_IN_A_MINUTE;
+
+    if (state->solarPowerReadingsIndex != 0) {
+        return 0;
+    }
+
+    // Every minute
+    for (loopIndex = 0; loopIndex < SECONDS_IN_A_MINUTE; loopIndex++) {
+        sum += state->solarPowerReadings[loopIndex];
+    }
+    state->averagePower = sum / SECONDS_IN_A_MINUTE;
+
+    // Choose the higher of the two values as the power to charge the car in case SOC is above threshold
+    if (state->averagePower > userConfigEcoPower) {
+        state->highSOCPower = state->averagePower;
+    } else {
+        state->highSOCPower = userConfigEcoPower;
+    }
+
+    if (state->carCharging) {
+        // If car is already charging, use lower SOC threshold (threshold - SOC_HYSTERESIS_MARGIN)
+        if (batterySoc >= userConfigSocTreshold - SOC_HYSTERESIS_MARGIN) {
+            state->ecoPower = state->highSOCPower;
+        } else {
+            state->ecoPower = 0;
+            state->carCharging = 0;
+        }
+    } else {
+        // If car is not charging, use higher SOC threshold
+        if (batterySoc >= userConfigSocTreshold) {
+            state->ecoPower = state->highSOCPower;
+            state->carCharging = 1;
+        }
+    }
+    return 1;
+}
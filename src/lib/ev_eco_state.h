@@ -0,0 +1,29 @@
+#ifndef EV_ECO_STATE_H
+#define EV_ECO_STATE_H
+
+// Decision core of ev-eco-power-calculation: the ECO charging power from the
+// PV power averaged over a minute and the battery SOC. Everything the script
+// remembers between seconds is in one EvEcoState, so the fleet simulation can
+// keep a copy per household (see fleet_sim.h).
+
+#define SECONDS_IN_A_MINUTE 60
+#define SOC_HYSTERESIS_MARGIN 2.0 // Hysteresis margin for SOC to avoid frequent switching charging on/off
+
+struct EvEcoState {
+    float solarPowerReadings[SECONDS_IN_A_MINUTE];
+    int solarPowerReadingsIndex;
+    float averagePower;
+    float highSOCPower;                        // Power to charge the car when SOC is above threshold
+    int carCharging;                           // Flag to track if car charging is on
+    float ecoPower;
+};
+
+// Function to clear the readings, the car is not charging
+void initEvEcoState(struct EvEcoState* state);
+
+// Function to take the readings of one second. Every minute the ECO power and
+// car charging are decided again and 1 is returned, 0 otherwise.
+int updateEvEcoState(struct EvEcoState* state, float userConfigEcoPower, float currentSolarPowerProduction,
+                     float batterySoc, float userConfigSocTreshold);
+
+#endif // EV_ECO_STATE_H
@@ -0,0 +1,66 @@
+#include "ev_eco_state.h"
+#include <stdio.h>
+#include <assert.h>
+
+// Function to take a minute of constant readings, returns the updates
+int run_minute(struct EvEcoState* state, float ecoPower, float solarPower, float soc, float threshold) {
+    int updates = 0;
+    int i;
+
+    for (i = 0; i < SECONDS_IN_A_MINUTE; i++) {
+        updates += updateEvEcoState(state, ecoPower, solarPower, soc, threshold);
+    }
+    return updates;
+}
+
+void test_average() {
+    printf("Testing the minute average...\n");
+
+    struct EvEcoState state;
+    int i;
+
+    initEvEcoState(&state);
+    for (i = 0; i < SECONDS_IN_A_MINUTE - 1; i++) {
+        assert(updateEvEcoState(&state, 1.4, i < 30 ? 2 : 4, 90, 80) == 0);
+    }
+    assert(state.carCharging == 0 && state.ecoPower == 0);
+    assert(updateEvEcoState(&state, 1.4, 4, 90, 80) == 1);
+    assert(state.averagePower == 3);
+    assert(state.highSOCPower == 3);
+    assert(state.carCharging == 1 && state.ecoPower == 3);
+    printf("✓ Outputs are decided once a minute from the average PV power\n");
+
+    assert(run_minute(&state, 1.4, 0.5, 90, 80) == 1);
+    assert(state.ecoPower == 1.4f);
+    printf("✓ Below the user setting the car charges with it\n");
+}
+
+void test_hysteresis() {
+    printf("\nTesting the SOC hysteresis...\n");
+
+    struct EvEcoState state;
+
+    initEvEcoState(&state);
+    run_minute(&state, 1.4, 3, 79, 80);
+    assert(state.carCharging == 0 && state.ecoPower == 0);
+    run_minute(&state, 1.4, 3, 80, 80);
+    assert(state.carCharging == 1);
+
+    run_minute(&state, 1.4, 3, 78, 80);
+    assert(state.carCharging == 1 && state.ecoPower == 3);
+    run_minute(&state, 1.4, 3, 77.9, 80);
+    assert(state.carCharging == 0 && state.ecoPower == 0);
+    run_minute(&state, 1.4, 3, 79, 80);
+    assert(state.carCharging == 0);
+    printf("✓ Charging starts at the threshold and stops 2 %% below it\n");
+}
+
+int main() {
+    printf("Running ev_eco_state tests...\n\n");
+
+    test_average();
+    test_hysteresis();
+
+    printf("\nAll tests passed! ✓\n");
+    return 0;
+}
@@ -0,0 +1,170 @@
+#include "fleet_sim.h"
+
+char *fleet_parameters[FLEET_PARAMETERS] = {
+    "pv_scale", "capacity", "power", "load", "import_fee", "heater", "draw", "ev_power", "ev_soc_threshold"
+};
+
+// Series steps shared by the tasks of a round
+struct fleet_round {
+    struct fleet_config *config;
+    struct backtest_series *series;
+    struct fleet_household *households;
+    long count;
+    long first;                 // Series steps of the round
+    long last;
+    long substeps;              // Plant steps per series step
+    long control;               // Plant steps per controller run
+    double hours;               // Of a plant step
+};
+
+void fleet_config_init(struct fleet_config *config) {
+    plant_sim_config_init(&config->sim);
+    config->batch = 64;
+    config->round_seconds = 86400;
+    config->workers = work_pool_cores();
+}
+
+void fleet_household_init(struct fleet_household *household) {
+    plant_config_init(&household->plant);
+    backtest_settings_init(&household->settings);
+    household->pv_scale = 1;
+    household->ev_power = 1.4f;
+    household->ev_soc_threshold = 80;
+}
+
+int fleet_set_parameter(struct fleet_household *household, char *name, float value) {
+    int parameter = backtest_parameter(name);
+    struct plant_config *plant = &household->plant;
+
+    if (parameter >= 0) {
+        backtest_set_parameter(&household->settings, parameter, value);
+        return 0;
+    }
+    for (parameter = 0; parameter < FLEET_PARAMETERS; parameter++) {
+        if (strcmp(fleet_parameters[parameter], name) == 0) break;
+    }
+    switch (parameter) {
+    case 0: household->pv_scale = value; break;
+    case 1: plant->capacity_kwh = value; break;
+    case 2: plant->power_kw = value; break;
+    case 3: plant->load_kw = value; break;
+    case 4: plant->import_fee = value; break;
+    case 5: plant->heater_kw = value; break;
+    case 6: plant->draw_kw = value; break;
+    case 7: household->ev_power = value; break;
+    case 8: household->ev_soc_threshold = value; break;
+    default: return -1;
+    }
+    return 0;
+}
+
+// Function to advance one batch of households through the series steps of a round
+void fleet_run_batch(void *context, long task, int worker) {
+    struct fleet_round *round = context;
+    struct backtest_series *series = round->series;
+    struct plant_sim_config *sim = &round->config->sim;
+    long from = task * round->config->batch;
+    long till = from + round->config->batch;
+    struct fleet_household *household;
+    struct plant_controllers *controllers;
+    struct plant_state *plant;
+    double pv_tomorrow;
+    double load;
+    double house;
+    long tick;
+    long h;
+    long i;
+    long k;
+    int second;
+
+    (void)worker;
+    if (till > round->count) till = round->count;
+
+    for (i = round->first; i < round->last; i++) {
+        pv_tomorrow = series->pv_tomorrow != NULL ? series->pv_tomorrow[i] : 0;
+
+        for (h = from; h < till; h++) {
+            household = &round->households[h];
+            controllers = &household->controllers;
+            plant = &household->state;
+            load = series->load != NULL ? series->load[i] : household->plant.load_kw;
+
+            controllers->inverter.currentSpotPrice = series->price[i];
+            controllers->inverter.maxSpotPrice = series->max_price[i];
+            controllers->inverter.predictedPVToday = series->pv_today[i] * household->pv_scale;
+            controllers->inverter.hour = series->hour[i];
+            controllers->tank.spotPriceIsVeryLow = series->price[i] < sim->very_low_price;
+            controllers->tank.predictedPVToday = series->pv_today[i] * household->pv_scale;
+            controllers->tank.predictedPVTomorrow = pv_tomorrow * household->pv_scale;
+            controllers->tank.pvPowerNow = series->pv[i] * household->pv_scale;
+            controllers->tank.hour = series->hour[i];
+
+            tick = i * round->substeps;
+            for (k = 0; k < round->substeps; k++, tick++) {
+                // The outputs of the controllers hold until their next run
+                if (tick % round->control == 0) {
+                    plant_control(&household->plant, &household->settings, plant, controllers);
+                }
+                // The EV ring holds the readings of a minute of seconds
+                for (second = 0; second < sim->step_seconds; second++) {
+                    updateEvEcoState(&household->ev, household->ev_power, controllers->tank.pvPowerNow,
+                                     plant_soc(&household->plant, plant), household->ev_soc_threshold);
+                }
+
+                house = load + controllers->heating.heating * household->plant.heater_kw + household->ev.ecoPower;
+                plant_step_inverter(&household->plant, plant, &controllers->decision, controllers->tank.pvPowerNow,
+                                    house, series->price[i], round->hours);
+                plant_step_tank(&household->plant, plant, controllers->heating.heating, round->hours);
+                household->ev_kwh += household->ev.ecoPower * round->hours;
+            }
+        }
+    }
+}
+
+long fleet_simulate(struct fleet_config *config, struct backtest_series *series, struct fleet_household *households,
+                    long count, struct work_pool_stats *stats) {
+    struct plant_sim_config *sim = &config->sim;
+    struct work_pool_stats round_stats;
+    struct fleet_round round;
+    long round_steps;
+    long batches;
+    long h;
+    int w;
+
+    if (sim->step_seconds <= 0 || series->step_seconds % sim->step_seconds != 0 ||
+        sim->control_seconds < sim->step_seconds || sim->control_seconds % sim->step_seconds != 0 ||
+        config->batch <= 0) {
+        return -1;
+    }
+    round.config = config;
+    round.series = series;
+    round.households = households;
+    round.count = count;
+    round.substeps = series->step_seconds / sim->step_seconds;
+    round.control = sim->control_seconds / sim->step_seconds;
+    round.hours = sim->step_seconds / 3600.0;
+    round_steps = config->round_seconds / series->step_seconds;
+    if (round_steps < 1) round_steps = 1;
+    batches = (count + config->batch - 1) / config->batch;
+
+    for (h = 0; h < count; h++) {
+        plant_state_init(&households[h].plant, &households[h].state);
+        households[h].ev_kwh = 0;
+        plant_controllers_init(sim, &households[h].settings, &households[h].controllers);
+        initEvEcoState(&households[h].ev);
+    }
+    if (stats != NULL) memset(stats, 0, sizeof(*stats));
+
+    for (round.first = 0; round.first < series->steps; round.first = round.last) {
+        round.last = round.first + round_steps;
+        if (round.last > series->steps) round.last = series->steps;
+        if (work_pool_run(config->workers, batches, fleet_run_batch, &round, &round_stats) != 0) return -1;
+
+        if (stats != NULL) {
+            stats->workers = round_stats.workers;
+            stats->steals += round_stats.steals;
+            for (w = 0; w < round_stats.workers; w++) stats->tasks[w] += round_stats.tasks[w];
+        }
+    }
+    return series->steps * round.substeps * sim->step_seconds;
+}
@@ -0,0 +1,75 @@
+#ifndef FLEET_SIM_H
+#define FLEET_SIM_H
+
+#include "plant_sim.h"
+#include "ev_eco_state.h"
+#include "work_pool.h"
+
+// Fleet simulation: many households with their own plants, thresholds and
+// controllers in the loop over one trace, as plant_sim.h runs one. Each
+// household scales the PV power and predictions of the trace by its own PV
+// size, and runs the EV eco power calculation besides the inverter and the
+// water tank: it sees the household's PV power and SOC, and the car charges
+// with the ECO power on top of the house load.
+//
+// What the scripts keep in globals is in a fleet_household per household,
+// next to its plant state, so a household is stepped in place in one stretch
+// of memory: every step reads and writes all of it, and the households of a
+// batch follow each other. All households advance in rounds of a day: the
+// batches of a round are tasks of work_pool.h, and a batch takes each series
+// step of the round once for all its households, so the trace is read once per
+// batch rather than per household. A household depends on no other, the
+// results are the same for any number of workers.
+//
+// The EV eco power calculation takes a PV reading every simulated second, as
+// the script runs every second, whatever the control period of the inverter
+// and the tank.
+
+#define FLEET_PARAMETERS 9
+
+// Names of the household parameters besides the inverter thresholds of
+// inverter_backtest.h, in the order of fleet_set_parameter
+extern char *fleet_parameters[FLEET_PARAMETERS];
+
+// One household: its plant, thresholds, inputs, the state of its controllers
+// and the results
+struct fleet_household {
+    struct plant_config plant;
+    struct InverterSettings settings;
+    float pv_scale;             // Of the PV power and predictions of the trace
+    float ev_power;             // Input 1 of the EV eco power calculation, in kW
+    float ev_soc_threshold;     // Input 4, in %
+    struct plant_controllers controllers;
+    struct EvEcoState ev;
+    struct plant_state state;
+    double ev_kwh;              // Charged into the car
+};
+
+struct fleet_config {
+    struct plant_sim_config sim; // Shared by all households
+    long batch;                 // Households per task
+    int round_seconds;          // Simulated by all households before the next round
+    int workers;
+};
+
+// Function to set the plant steps of plant_sim_config_init, batches of 64
+// households, rounds of a day and one worker per core
+void fleet_config_init(struct fleet_config *config);
+
+// Function to set the plant of plant_config_init, the thresholds of
+// backtest_settings_init, the PV of the trace and ECO charging at 1.4 kW above 80 %
+void fleet_household_init(struct fleet_household *household);
+
+// Function to set a parameter of fleet_parameters or of backtest_parameters by
+// name, -1 for an unknown name
+int fleet_set_parameter(struct fleet_household *household, char *name, float value);
+
+// Function to simulate the series for count households from their initial plant
+// states, leaving the results in their state and ev_kwh. The steals and tasks of
+// all rounds are added to stats, which may be NULL. Returns the simulated seconds
+// of each household, -1 if the steps do not divide each other or the workers
+// could not be started.
+long fleet_simulate(struct fleet_config *config, struct backtest_series *series, struct fleet_household *households,
+                    long count, struct work_pool_stats *stats);
+
+#endif // FLEET_SIM_H
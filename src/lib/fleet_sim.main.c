@@ -0,0 +1,201 @@
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+#include "fleet_sim.h"
+
+// Simulate a fleet of households with the controllers in the loop over one
+// trace (see fleet_sim.h):
+//
+//   fleet_sim --trace <file> [--map <column>=<target>]... [--households <n>]
+//             [--set <name>=<value>]... [--vary <name>=<from>:<to>]...
+//             [--series-step <s>] [--step <s>] [--control <s>] [--very-low <price>] [--priority]
+//             [--batch <n>] [--round <s>] [--threads <n>]
+//
+// The columns are wired as for inverter_sweep. Every household starts from the
+// defaults of fleet_household_init and the --set values, and draws each --vary
+// parameter uniformly from its range; the draws are the same on every run.
+// Parameters are the inverter thresholds of inverter_sweep and pv_scale,
+// capacity, power, load, import_fee, heater, draw, ev_power, ev_soc_threshold.
+// A CSV row per household goes to stdout:
+//
+//   household,<varied name>,...,cost,import_kwh,export_kwh,cycles,heater_kwh,cold_hours,ev_kwh,soc,tank_c
+//
+// and a last line to stderr reports the run:
+// fleet households=<n> simulated_s=<n> threads=<n> steals=<n> load_ms=<f> wall_ms=<f> household_s_per_s=<f>
+
+#define MAX_VARIED 16
+
+// A parameter drawn per household
+struct varied {
+    char name[32];
+    float from;
+    float to;
+};
+
+struct varied varied[MAX_VARIED];
+int varied_count = 0;
+
+unsigned int seed = 1;
+
+// Deterministic pseudo random numbers, the fleet must not change between runs
+double next_random() {
+    seed = seed * 1103515245 + 12345;
+    return ((seed >> 8) & 0xFFFF) / 65536.0;
+}
+
+double wall_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+int usage() {
+    fprintf(stderr,
+            "Usage: fleet_sim --trace <file> [--map <column>=<target>]... [--households <n>]\n"
+            "                 [--set <name>=<value>]... [--vary <name>=<from>:<to>]...\n"
+            "                 [--series-step <s>] [--step <s>] [--control <s>] [--very-low <price>] [--priority]\n"
+            "                 [--batch <n>] [--round <s>] [--threads <n>]\n"
+            "Parameters: charge_threshold discharge_threshold soc_discharge_threshold pv_threshold\n"
+            "            spot_threshold soc_protection morning_from morning_till\n"
+            "            pv_scale capacity power load import_fee heater draw ev_power ev_soc_threshold\n");
+    return 1;
+}
+
+// Function to split <name>=<value> into name, NULL if it does not fit
+char *split_option(char *text, char *name, int size) {
+    char *value = strchr(text, '=');
+
+    if (value == NULL || value - text >= size) return NULL;
+    memcpy(name, text, value - text);
+    name[value - text] = '\0';
+    return value + 1;
+}
+
+int main(int argc, char **argv) {
+    struct fleet_config config;
+    struct fleet_household defaults;
+    struct fleet_household *households;
+    struct work_pool_stats stats;
+    struct backtest_series series;
+    struct plant_state *plant;
+    struct trace trace;
+    char name[32];
+    char *path = NULL;
+    char *maps[TRACE_MAX_COLUMNS];
+    int map_count = 0;
+    int series_step = 60;
+    long count = 100;
+    float *drawn;
+    double load_ms;
+    double started;
+    long simulated;
+    char *value;
+    int status;
+    long h;
+    int i;
+
+    loxone_reset(0);
+    fleet_config_init(&config);
+    fleet_household_init(&defaults);
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            path = argv[++i];
+        } else if (strcmp(argv[i], "--map") == 0 && i + 1 < argc && map_count < TRACE_MAX_COLUMNS) {
+            maps[map_count++] = argv[++i];
+        } else if (strcmp(argv[i], "--households") == 0 && i + 1 < argc) {
+            count = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--set") == 0 && i + 1 < argc) {
+            value = split_option(argv[++i], name, sizeof(name));
+            if (value == NULL || fleet_set_parameter(&defaults, name, (float)atof(value)) != 0) return usage();
+        } else if (strcmp(argv[i], "--vary") == 0 && i + 1 < argc && varied_count < MAX_VARIED) {
+            value = split_option(argv[++i], varied[varied_count].name, sizeof(varied[varied_count].name));
+            if (value == NULL || sscanf(value, "%f:%f", &varied[varied_count].from, &varied[varied_count].to) != 2 ||
+                fleet_set_parameter(&defaults, varied[varied_count].name, varied[varied_count].from) != 0) {
+                return usage();
+            }
+            varied_count++;
+        } else if (strcmp(argv[i], "--series-step") == 0 && i + 1 < argc) {
+            series_step = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--step") == 0 && i + 1 < argc) {
+            config.sim.step_seconds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--control") == 0 && i + 1 < argc) {
+            config.sim.control_seconds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--very-low") == 0 && i + 1 < argc) {
+            config.sim.very_low_price = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--priority") == 0) {
+            config.sim.priority_charging = 1;
+        } else if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            config.batch = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--round") == 0 && i + 1 < argc) {
+            config.round_seconds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            config.workers = atoi(argv[++i]);
+        } else {
+            return usage();
+        }
+    }
+    if (path == NULL || count <= 0 || series_step <= 0 || config.batch <= 0) return usage();
+
+    households = (struct fleet_household *)malloc(count * sizeof(struct fleet_household));
+    drawn = (float *)malloc((count * varied_count + 1) * sizeof(float));
+    if (households == NULL || drawn == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    for (h = 0; h < count; h++) {
+        households[h] = defaults;
+        for (i = 0; i < varied_count; i++) {
+            drawn[h * varied_count + i] = varied[i].from + (varied[i].to - varied[i].from) * (float)next_random();
+            fleet_set_parameter(&households[h], varied[i].name, drawn[h * varied_count + i]);
+        }
+        if (households[h].plant.capacity_kwh <= 0 || households[h].plant.efficiency <= 0) return usage();
+    }
+
+    started = wall_ms();
+    if (trace_open(&trace, path) != 0) {
+        fprintf(stderr, "%s: %s\n", path, trace.error);
+        return 1;
+    }
+    for (i = 0; i < map_count; i++) {
+        value = split_option(maps[i], name, sizeof(name));
+        if (value == NULL) return usage();
+        if (trace_map(&trace, name, value) != 0) {
+            fprintf(stderr, "--map %s: %s\n", maps[i], trace.error);
+            return 1;
+        }
+    }
+    status = backtest_load(&series, &trace, series_step);
+    trace_close(&trace);
+    if (status != 0) {
+        fprintf(stderr, "%s: %s\n", path, trace.error);
+        return 1;
+    }
+    load_ms = wall_ms() - started;
+
+    started = wall_ms();
+    simulated = fleet_simulate(&config, &series, households, count, &stats);
+    started = wall_ms() - started;
+    backtest_free(&series);
+    if (simulated < 0) {
+        fprintf(stderr, "the plant step must divide the series step and the control period, and the threads start\n");
+        return 1;
+    }
+
+    printf("household");
+    for (i = 0; i < varied_count; i++) printf(",%s", varied[i].name);
+    printf(",cost,import_kwh,export_kwh,cycles,heater_kwh,cold_hours,ev_kwh,soc,tank_c\n");
+    for (h = 0; h < count; h++) {
+        plant = &households[h].state;
+        printf("%ld", h);
+        for (i = 0; i < varied_count; i++) printf(",%g", drawn[h * varied_count + i]);
+        printf(",%.2f,%.1f,%.1f,%.2f,%.1f,%.1f,%.1f,%.1f,%.1f\n", plant->cost, plant->import_kwh, plant->export_kwh,
+               plant_cycles(&households[h].plant, plant), plant->heater_kwh, plant->cold_hours, households[h].ev_kwh,
+               plant_soc(&households[h].plant, plant), plant->tank_c);
+    }
+    fprintf(stderr, "fleet households=%ld simulated_s=%ld threads=%d steals=%ld load_ms=%.0f wall_ms=%.0f household_s_per_s=%.0f\n",
+            count, simulated, stats.workers, stats.steals, load_ms, started,
+            count * (double)simulated * 1000.0 / (started > 0 ? started : 1e-3));
+
+    free(households);
+    free(drawn);
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include "fleet_sim.h"
+#include <assert.h>
+
+// Three hours of minute steps
+#define STEPS 180
+
+// 2025-02-27 11:00 CET
+#define T0 1740650400LL
+
+#define HOUSEHOLDS 10
+
+struct minutes {
+    float price[STEPS];
+    float max_price[STEPS];
+    float pv_today[STEPS];
+    float pv_tomorrow[STEPS];
+    float pv[STEPS];
+    unsigned char hour[STEPS];
+};
+
+// Cheap, then near the day's max, then normal prices, with PV rising to noon
+void init_series(struct backtest_series* series, struct minutes* minutes) {
+    int i;
+
+    for (i = 0; i < STEPS; i++) {
+        minutes->price[i] = 0.5f;
+        if (i >= 40) minutes->price[i] = 4.8f;
+        if (i >= 100) minutes->price[i] = 2;
+        minutes->max_price[i] = 5;
+        minutes->pv_today[i] = 10;
+        minutes->pv_tomorrow[i] = 10;
+        minutes->pv[i] = 0.02f * (i % 120);
+        minutes->hour[i] = 11 + i / 60;
+    }
+    memset(series, 0, sizeof(*series));
+    series->steps = STEPS;
+    series->step_seconds = 60;
+    series->start = T0;
+    series->price = minutes->price;
+    series->max_price = minutes->max_price;
+    series->pv_today = minutes->pv_today;
+    series->pv_tomorrow = minutes->pv_tomorrow;
+    series->pv = minutes->pv;
+    series->hour = minutes->hour;
+}
+
+void test_households() {
+    printf("Testing households...\n");
+
+    struct fleet_household household;
+
+    fleet_household_init(&household);
+    assert(household.pv_scale == 1 && household.ev_power == 1.4f && household.ev_soc_threshold == 80);
+    assert(fleet_set_parameter(&household, "capacity", 10) == 0 && household.plant.capacity_kwh == 10);
+    assert(fleet_set_parameter(&household, "ev_soc_threshold", 60) == 0 && household.ev_soc_threshold == 60);
+    assert(fleet_set_parameter(&household, "soc_protection", 25) == 0);
+    assert(household.settings.onGridEndSOCProtectionUserSetting == 25);
+    assert(fleet_set_parameter(&household, "efficiency", 1) == -1);
+    printf("✓ Parameters are set by name, thresholds included\n");
+}
+
+void test_plant_sim() {
+    printf("\nTesting the fleet against plant_sim...\n");
+
+    struct fleet_config config;
+    struct fleet_household households[HOUSEHOLDS];
+    struct backtest_series series;
+    struct plant_state expected;
+    struct plant_state *plant;
+    struct minutes minutes;
+    int h;
+
+    fleet_config_init(&config);
+    config.workers = 1;
+    init_series(&series, &minutes);
+    for (h = 0; h < HOUSEHOLDS; h++) {
+        fleet_household_init(&households[h]);
+        households[h].plant.initial_soc = 30 + 7 * h;
+        households[h].plant.initial_tank_c = 46 + h;
+        households[h].ev_soc_threshold = 101; // No car
+    }
+    assert(fleet_simulate(&config, &series, households, HOUSEHOLDS, NULL) == STEPS * 60);
+
+    for (h = 0; h < HOUSEHOLDS; h++) {
+        plant_simulate(&config.sim, &series, &households[h].plant, &households[h].settings, &expected, NULL);
+        plant = &households[h].state;
+        assert(plant->stored_kwh == expected.stored_kwh && plant->tank_c == expected.tank_c);
+        assert(plant->import_kwh == expected.import_kwh && plant->export_kwh == expected.export_kwh);
+        assert(plant->cost == expected.cost && plant->heater_kwh == expected.heater_kwh);
+        assert(households[h].ev_kwh == 0);
+    }
+    printf("✓ Each household is simulated as by plant_sim\n");
+}
+
+void test_ev() {
+    printf("\nTesting the EV...\n");
+
+    struct fleet_config config;
+    struct fleet_household households[2];
+    struct backtest_series series;
+    struct minutes minutes;
+
+    fleet_config_init(&config);
+    config.workers = 1;
+    init_series(&series, &minutes);
+    series.steps = 60;
+    fleet_household_init(&households[0]);
+    households[0].ev_soc_threshold = 0;
+    households[0].plant.tank_cold_c = 0;
+    households[1] = households[0];
+    households[0].pv_scale = 2;
+    households[1].pv_scale = 0;
+    fleet_simulate(&config, &series, households, 2, NULL);
+
+    // The first decision comes with the 60th reading, from then on at 1.4 kW without PV
+    assert(fabs(households[1].ev_kwh - 1.4 * (3600 - 59) / 3600) < 1e-4);
+    // and with the mean PV power once that is above it
+    assert(households[0].ev_kwh > households[1].ev_kwh);
+    assert(households[1].state.import_kwh > 1.5 + households[1].ev_kwh);
+    printf("✓ The car charges with the ECO power on top of the house load\n");
+
+    // A reading per second whatever the control period, so the first minute is the same
+    config.sim.control_seconds = 60;
+    fleet_simulate(&config, &series, households, 2, NULL);
+    assert(fabs(households[1].ev_kwh - 1.4 * (3600 - 59) / 3600) < 1e-4);
+    // and per plant step of a minute, deciding with the step's 60th reading
+    config.sim.step_seconds = 60;
+    fleet_simulate(&config, &series, households, 2, NULL);
+    assert(fabs(households[1].ev_kwh - 1.4) < 1e-4);
+    printf("✓ The EV takes a reading per simulated second\n");
+}
+
+void test_workers() {
+    printf("\nTesting workers and batches...\n");
+
+    struct fleet_config config;
+    struct fleet_household households[HOUSEHOLDS];
+    struct backtest_series series;
+    struct fleet_household one[HOUSEHOLDS];
+    struct work_pool_stats stats;
+    struct minutes minutes;
+    long tasks = 0;
+    int h;
+
+    fleet_config_init(&config);
+    config.workers = 1;
+    init_series(&series, &minutes);
+    for (h = 0; h < HOUSEHOLDS; h++) {
+        fleet_household_init(&households[h]);
+        households[h].pv_scale = 0.5f + 0.25f * h;
+        households[h].plant.initial_soc = 30 + 7 * h;
+        households[h].ev_soc_threshold = 40 + 5 * h;
+    }
+    fleet_simulate(&config, &series, households, HOUSEHOLDS, NULL);
+    memcpy(one, households, sizeof(one));
+
+    config.workers = 3;
+    config.batch = 3;
+    config.round_seconds = 1800;
+    assert(fleet_simulate(&config, &series, households, HOUSEHOLDS, &stats) == STEPS * 60);
+    for (h = 0; h < stats.workers; h++) tasks += stats.tasks[h];
+    assert(stats.workers == 3 && tasks == 6 * 4);
+    for (h = 0; h < HOUSEHOLDS; h++) {
+        assert(one[h].state.stored_kwh == households[h].state.stored_kwh);
+        assert(one[h].state.cost == households[h].state.cost && one[h].state.tank_c == households[h].state.tank_c);
+        assert(one[h].ev_kwh == households[h].ev_kwh);
+    }
+    printf("✓ Results do not depend on workers, batches or rounds\n");
+
+    config.sim.step_seconds = 7;
+    assert(fleet_simulate(&config, &series, households, HOUSEHOLDS, NULL) == -1);
+    config.sim.step_seconds = 1;
+    config.batch = 0;
+    assert(fleet_simulate(&config, &series, households, HOUSEHOLDS, NULL) == -1);
+    printf("✓ Steps must divide each other\n");
+}
+
+int main() {
+    printf("Running fleet_sim tests...\n\n");
+
+    test_households();
+    test_plant_sim();
+    test_ev();
+    test_workers();
+
+    printf("\nAll tests passed! ✓\n");
+    return 0;
+}
@@ -0,0 +1,102 @@
+// Check if we're using a standard C compiler
+#ifndef PICO_C
+#include "forecast_cache.h"
+#include <stdio.h>
+#include <string.h>
+#endif
+
+// Checksum of the record up to the checksum field (djb2)
+unsigned int forecastCacheChecksum(struct ForecastCache* cache) {
+    unsigned char* bytes = (unsigned char*)cache;
+    int length = (char*)&cache->checksum - (char*)cache;
+    unsigned int hash = 5381;
+    int i;
+
+    for (i = 0; i < length; i++) {
+        hash = hash * 33 + bytes[i];
+    }
+    return hash;
+}
+
+// Function to prepare an empty cache record
+void initForecastCache(struct ForecastCache* cache, unsigned int fetchedAt, int day, int planeCount) {
+    // Padding is zeroed too, it is covered by the checksum
+    memset(cache, 0, sizeof(struct ForecastCache));
+    cache->magic = FORECAST_CACHE_MAGIC;
+    cache->version = FORECAST_CACHE_VERSION;
+    cache->size = sizeof(struct ForecastCache);
+    cache->fetchedAt = fetchedAt;
+    cache->day = day;
+    if (planeCount > FORECAST_CACHE_MAX_PLANES) planeCount = FORECAST_CACHE_MAX_PLANES;
+    cache->planeCount = planeCount;
+}
+
+// Function to write the cache file in one write
+int saveForecastCache(struct ForecastCache* cache, char* path) {
+    FILE* file;
+    int written;
+
+    cache->checksum = forecastCacheChecksum(cache);
+    file = fopen(path, "wb");
+    if (file == NULL) return -1;
+    written = fwrite(cache, sizeof(struct ForecastCache), 1, file);
+    if (fclose(file) != 0 || written != 1) return -1;
+    return 0;
+}
+
+// Function to read the cache file in one read
+int loadForecastCache(struct ForecastCache* cache, char* path) {
+    FILE* file;
+    int length;
+
+    file = fopen(path, "rb");
+    if (file == NULL) return -1;
+    length = fread(cache, 1, sizeof(struct ForecastCache), file);
+    fclose(file);
+
+    if (length != (int)sizeof(struct ForecastCache)) return -1;
+    if (cache->magic != FORECAST_CACHE_MAGIC || cache->version != FORECAST_CACHE_VERSION) return -1;
+    if (cache->size != (int)sizeof(struct ForecastCache)) return -1;
+    if (cache->planeCount < 0 || cache->planeCount > FORECAST_CACHE_MAX_PLANES) return -1;
+    if (cache->checksum != forecastCacheChecksum(cache)) return -1;
+    return 0;
+}
+
+// Function to check whether the cache can stand in for a fetch
+int forecastCacheFresh(struct ForecastCache* cache, unsigned int now, int day, int planeCount, int ttl) {
+    if (cache->day != day || cache->planeCount != planeCount) return 0;
+    if (now < cache->fetchedAt || now - cache->fetchedAt >= (unsigned int)ttl) return 0;
+    return 1;
+}
+
+// Function to add up the production of all planes
+struct DailyProduction forecastCacheTotal(struct ForecastCache* cache) {
+    struct DailyProduction total;
+    int i;
+
+    total.today = 0;
+    total.tomorrow = 0;
+    for (i = 0; i < cache->planeCount; i++) {
+        total.today += cache->planes[i].today;
+        total.tomorrow += cache->planes[i].tomorrow;
+    }
+    return total;
+}
+
+// Function to get the production to publish on day, a day old cache moves tomorrow to today
+int forecastCacheProduction(struct ForecastCache* cache, int day, struct DailyProduction* production) {
+    struct DailyProduction total = forecastCacheTotal(cache);
+
+    production->today = 0;
+    production->tomorrow = 0;
+    if (cache->day == day) {
+        production->today = total.today;
+        production->tomorrow = total.tomorrow;
+        return 2;
+    }
+    if (cache->day == day - 1) {
+        production->today = total.tomorrow;
+        return 1;
+    }
+    return 0;
+}
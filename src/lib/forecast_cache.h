@@ -0,0 +1,49 @@
+#ifndef FORECAST_CACHE_H
+#define FORECAST_CACHE_H
+
+// Forecast results kept in a small fixed-layout binary file, so a restarted
+// program block can publish them at once and skip the fetch while they are fresh.
+// The series kept per plane is what the block fetches from /watthours/day, the
+// production of today and tomorrow; a 15 minute ProductionSeries per plane
+// would stay empty and take 3 kB each.
+
+#ifndef PICO_C
+#include "forecast_solar.h"
+#endif
+
+#define FORECAST_CACHE_MAGIC 0x46435348  // "FCSH"
+#define FORECAST_CACHE_VERSION 1
+#define FORECAST_CACHE_MAX_PLANES 8
+
+struct ForecastCache {
+    int magic;
+    int version;
+    int size;                 // Size of this struct, a changed layout is not read back
+    unsigned int fetchedAt;   // getcurrenttime() of the fetch
+    int day;                  // Local day of the fetch, see forecastSolarDay
+    int planeCount;
+    struct DailyProduction planes[FORECAST_CACHE_MAX_PLANES];  // Production of each plane in Wh
+    unsigned int checksum;    // Over all bytes before it
+};
+
+// Function to prepare an empty cache record
+void initForecastCache(struct ForecastCache* cache, unsigned int fetchedAt, int day, int planeCount);
+
+// Function to write the cache file, returns 0 or -1
+int saveForecastCache(struct ForecastCache* cache, char* path);
+
+// Function to read the cache file, returns 0, or -1 if it is missing, damaged or of another version
+int loadForecastCache(struct ForecastCache* cache, char* path);
+
+// Function to check whether the cache is from today, for planeCount planes, and younger than ttl seconds
+int forecastCacheFresh(struct ForecastCache* cache, unsigned int now, int day, int planeCount, int ttl);
+
+// Function to add up the production of all planes
+struct DailyProduction forecastCacheTotal(struct ForecastCache* cache);
+
+// Function to get the production to publish on day: both values of a cache from
+// that day, and the tomorrow of a cache from the day before as today. Returns the
+// number of values that apply, 2, 1 or 0; the others are set to 0.
+int forecastCacheProduction(struct ForecastCache* cache, int day, struct DailyProduction* production);
+
+#endif // FORECAST_CACHE_H
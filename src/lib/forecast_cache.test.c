@@ -0,0 +1,152 @@
+#include "forecast_cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+// Write length bytes of data to the test path, as a damaged or old file would be
+void write_raw(void* data, int length) {
+    FILE* file = fopen(CACHE_TEST_PATH, "wb");
+    assert(file != NULL);
+    fwrite(data, 1, length, file);
+    fclose(file);
+}
+
+void fill_cache(struct ForecastCache* cache) {
+    initForecastCache(cache, 1000000, 5902, 2);
+    cache->planes[0].today = 28167;
+    cache->planes[0].tomorrow = 24848;
+    cache->planes[1].today = 1833;
+    cache->planes[1].tomorrow = 152;
+}
+
+void test_roundtrip() {
+    printf("Testing the cache file...\n");
+
+    struct ForecastCache cache;
+    struct ForecastCache loaded;
+
+    fill_cache(&cache);
+    assert(saveForecastCache(&cache, CACHE_TEST_PATH) == 0);
+    assert(loadForecastCache(&loaded, CACHE_TEST_PATH) == 0);
+    assert(memcmp(&cache, &loaded, sizeof(struct ForecastCache)) == 0);
+    assert(loaded.fetchedAt == 1000000);
+    assert(loaded.day == 5902);
+    assert(loaded.planeCount == 2);
+    assert(loaded.planes[1].today == 1833);
+    printf("✓ Cache written and read back\n");
+
+    struct DailyProduction total = forecastCacheTotal(&loaded);
+    assert(total.today == 30000);
+    assert(total.tomorrow == 25000);
+    printf("✓ Planes added up\n");
+
+    // Saving again replaces the file instead of appending to it
+    cache.planes[0].today = 1;
+    assert(saveForecastCache(&cache, CACHE_TEST_PATH) == 0);
+    assert(loadForecastCache(&loaded, CACHE_TEST_PATH) == 0);
+    assert(loaded.planes[0].today == 1);
+    printf("✓ Cache file overwritten\n");
+}
+
+void test_rejected() {
+    printf("\nTesting damaged cache files...\n");
+
+    struct ForecastCache cache;
+    struct ForecastCache loaded;
+    char* bytes = (char*)&cache;
+
+    fill_cache(&cache);
+    remove(CACHE_TEST_PATH);
+    assert(loadForecastCache(&loaded, CACHE_TEST_PATH) == -1);
+    assert(loadForecastCache(&loaded, "/nonexistent/forecast.bin") == -1);
+    assert(saveForecastCache(&cache, "/nonexistent/forecast.bin") == -1);
+    printf("✓ Missing file rejected\n");
+
+    saveForecastCache(&cache, CACHE_TEST_PATH);
+    write_raw(&cache, sizeof(struct ForecastCache) - 1);
+    assert(loadForecastCache(&loaded, CACHE_TEST_PATH) == -1);
+    write_raw(&cache, 0);
+    assert(loadForecastCache(&loaded, CACHE_TEST_PATH) == -1);
+    printf("✓ Truncated file rejected\n");
+
+    // Every single flipped byte of the record is caught
+    int i;
+    for (i = 0; i < (int)((char*)&cache.checksum - bytes); i++) {
+        fill_cache(&cache);
+        saveForecastCache(&cache, CACHE_TEST_PATH);
+        bytes[i] ^= 0x10;
+        write_raw(&cache, sizeof(struct ForecastCache));
+        assert(loadForecastCache(&loaded, CACHE_TEST_PATH) == -1);
+    }
+    printf("✓ Corrupted bytes rejected\n");
+
+    // A file of another version is ignored even with a valid checksum
+    fill_cache(&cache);
+    cache.version = FORECAST_CACHE_VERSION + 1;
+    saveForecastCache(&cache, CACHE_TEST_PATH);
+    assert(loadForecastCache(&loaded, CACHE_TEST_PATH) == -1);
+    fill_cache(&cache);
+    cache.planeCount = FORECAST_CACHE_MAX_PLANES + 1;
+    saveForecastCache(&cache, CACHE_TEST_PATH);
+    assert(loadForecastCache(&loaded, CACHE_TEST_PATH) == -1);
+    printf("✓ Other versions and layouts rejected\n");
+
+    remove(CACHE_TEST_PATH);
+}
+
+void test_fresh() {
+    printf("\nTesting cache freshness...\n");
+
+    struct ForecastCache cache;
+    fill_cache(&cache);
+
+    assert(forecastCacheFresh(&cache, 1000000, 5902, 2, 3600) == 1);
+    assert(forecastCacheFresh(&cache, 1003599, 5902, 2, 3600) == 1);
+    printf("✓ Fresh within the TTL\n");
+
+    assert(forecastCacheFresh(&cache, 1003600, 5902, 2, 3600) == 0);
+    assert(forecastCacheFresh(&cache, 999999, 5902, 2, 3600) == 0);
+    printf("✓ Stale after the TTL or when fetched in the future\n");
+
+    assert(forecastCacheFresh(&cache, 1000060, 5903, 2, 3600) == 0);
+    assert(forecastSolarDay(2025, 2, 28) + 1 == forecastSolarDay(2025, 3, 1));
+    printf("✓ Stale after the date rolled over\n");
+
+    assert(forecastCacheFresh(&cache, 1000060, 5902, 3, 3600) == 0);
+    printf("✓ Stale when the planes changed\n");
+}
+
+void test_rollover() {
+    printf("\nTesting the cache after midnight...\n");
+
+    struct ForecastCache cache;
+    struct DailyProduction production;
+    fill_cache(&cache);
+
+    assert(forecastCacheProduction(&cache, 5902, &production) == 2);
+    assert(production.today == 30000 && production.tomorrow == 25000);
+    printf("✓ Both values on the day of the fetch\n");
+
+    // A restart the next day shows the forecast for tomorrow as today's, and no tomorrow yet
+    assert(forecastCacheProduction(&cache, 5903, &production) == 1);
+    assert(production.today == 25000 && production.tomorrow == 0);
+    printf("✓ Tomorrow moves to today on the next day\n");
+
+    assert(forecastCacheProduction(&cache, 5904, &production) == 0);
+    assert(production.today == 0 && production.tomorrow == 0);
+    assert(forecastCacheProduction(&cache, 5901, &production) == 0);
+    printf("✓ Nothing from an older or a future day\n");
+}
+
+int main() {
+    printf("Running forecast_cache tests...\n\n");
+
+    test_roundtrip();
+    test_rejected();
+    test_fresh();
+    test_rollover();
+
+    printf("\nAll tests passed! ✓\n");
+    return 0;
+}
@@ -0,0 +1,277 @@
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "forecast_fetch.h"
+#include "forecast_solar.h"
+#include "forecast_mock_server.h"
+
+// End-to-end refresh benchmark: the fetch and parse path of the script over
+// real sockets against forecast_mock_server, which runs in a child process so
+// its allocations and threads stay out of the measurement. Prints one line per
+// scenario:
+//
+//   bench=refresh scenario=<name> planes=<n> body_bytes=<n> refreshes=<n> p50_ms=<f> p99_ms=<f>
+//                 max_ms=<f> failed_planes=<n> heap_peak_bytes=<n>
+//
+// A refresh runs from startForecastFetch until every plane is parsed. Day totals
+// are parsed as the bodies arrive like the script does, series from a buffer.
+// heap_peak_bytes is -1 where the allocator can not be tracked (non-glibc or sanitizer builds).
+
+#define PLANES 2                // As in pv-production-prediction.c
+#define FETCH_TIMEOUT_S 15
+#define FETCH_POLL_MS 50
+#define MAX_REFRESHES 200
+
+long heap_current = 0;
+long heap_peak = 0;
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+#include <malloc.h>
+
+// Count every allocation of the process by wrapping the glibc allocator
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void __libc_free(void *ptr);
+
+void heap_add(long bytes) {
+    heap_current += bytes;
+    if (heap_current > heap_peak) heap_peak = heap_current;
+}
+
+void *malloc(size_t size) {
+    void *ptr = __libc_malloc(size);
+    if (ptr != NULL) heap_add(malloc_usable_size(ptr));
+    return ptr;
+}
+
+void *calloc(size_t count, size_t size) {
+    void *ptr = __libc_calloc(count, size);
+    if (ptr != NULL) heap_add(malloc_usable_size(ptr));
+    return ptr;
+}
+
+void *realloc(void *ptr, size_t size) {
+    long old = 0;
+    void *moved;
+    if (ptr != NULL) old = malloc_usable_size(ptr);
+    moved = __libc_realloc(ptr, size);
+    if (moved != NULL) heap_add((long)malloc_usable_size(moved) - old);
+    return moved;
+}
+
+void free(void *ptr) {
+    if (ptr != NULL) heap_current -= malloc_usable_size(ptr);
+    __libc_free(ptr);
+}
+
+#define HEAP_TRACKING 1
+#else
+#define HEAP_TRACKING 0
+#endif
+
+double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Function to read the entire contents of a file into a string
+char* read_file(const char* filename) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        perror("Could not open file");
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *content = (char *)malloc(length + 1);
+    size_t read_size = fread(content, 1, length, file);
+    content[read_size] = '\0';
+    fclose(file);
+
+    return content;
+}
+
+// A watts response with one key per minute over two days, about 70 KB
+char* generate_watts_body() {
+    char* body = (char*)malloc(128 * 1024);
+    char* p = body;
+    int day;
+    int minute;
+    double watts;
+
+    p += sprintf(p, "{\"result\":{");
+    for (day = 27; day <= 28; day++) {
+        for (minute = 0; minute < 24 * 60; minute++) {
+            watts = 0;
+            if (minute > 7 * 60 && minute < 17 * 60) watts = 5000 * sin(3.14159265358979 * (minute - 7 * 60) / (10 * 60));
+            p += sprintf(p, "\"2025-02-%02d %02d:%02d:00\":%d,", day, minute / 60, minute % 60, (int)watts);
+        }
+    }
+    p--;
+    sprintf(p, "},\"message\":{\"code\":0,\"type\":\"success\",\"text\":\"\","
+               "\"ratelimit\":{\"period\":3600,\"limit\":12,\"remaining\":11}}}");
+    return body;
+}
+
+// Run a mock server in a child process, returns its port or -1
+int start_server(struct mock_server_config* config, pid_t* child) {
+    struct mock_server server;
+    int pipe_fds[2];
+    int port = -1;
+
+    if (pipe(pipe_fds) != 0) return -1;
+    *child = fork();
+    if (*child == 0) {
+        close(pipe_fds[0]);
+        port = mock_server_start(&server, config, 0);
+        if (write(pipe_fds[1], &port, sizeof(port)) != sizeof(port)) _exit(1);
+        close(pipe_fds[1]);
+        while (1) pause();
+    }
+    close(pipe_fds[1]);
+    if (*child < 0 || read(pipe_fds[0], &port, sizeof(port)) != sizeof(port)) port = -1;
+    close(pipe_fds[0]);
+    return port;
+}
+
+void stop_server(pid_t child) {
+    kill(child, SIGTERM);
+    waitpid(child, NULL, 0);
+}
+
+int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    if (x < y) return -1;
+    if (x > y) return 1;
+    return 0;
+}
+
+// One refresh as the script makes it, returns the number of failed planes
+int refresh(int port, char** paths, int bufferSize, int kind, struct ProductionSeries* series) {
+    struct ForecastFetch fetch;
+    struct DailyProduction production;
+    char* body;
+    int failed = 0;
+    int i;
+
+    startForecastFetch(&fetch, "127.0.0.1", port, paths, PLANES, bufferSize, FETCH_TIMEOUT_S, (unsigned int)time(NULL));
+    if (kind < 0) {
+        parseForecastFetch(&fetch, "2025-02-27", "2025-02-28");
+    }
+    while (pollForecastFetch(&fetch, FETCH_POLL_MS, (unsigned int)time(NULL)) > 0) {
+    }
+    production.today = 0;
+    production.tomorrow = 0;
+    clearProductionSeries(series, FORECAST_SOLAR_SERIES_STEP);
+    for (i = 0; i < PLANES; i++) {
+        body = forecastFetchBody(&fetch, i);
+        if (kind < 0) {
+            if (fetch.requests[i].state != FORECAST_FETCH_DONE ||
+                addParsedProduction(&production, &fetch.requests[i].parser) < 0) failed++;
+        } else if (body == NULL) {
+            failed++;
+        } else if (addProductionSeries(body, kind, series) < 0) {
+            failed++;
+        }
+    }
+    closeForecastFetch(&fetch);
+    return failed;
+}
+
+// kind is -1 for day totals, otherwise the series kind of the body
+void bench_scenario(char* name, struct mock_server_config* config, int refreshes, int bufferSize, int kind) {
+    static struct ProductionSeries series;
+    static double latencies[MAX_REFRESHES];
+    char* paths[PLANES];
+    double start;
+    long base;
+    long peak = 0;
+    int failed = 0;
+    pid_t child;
+    int port;
+    int i;
+
+    port = start_server(config, &child);
+    if (port < 0) {
+        printf("bench=refresh scenario=%s error=server\n", name);
+        return;
+    }
+    for (i = 0; i < PLANES; i++) {
+        paths[i] = "/estimate/watthours/day/50.69/15.22/45/-63/5500";
+    }
+
+    for (i = 0; i < refreshes; i++) {
+        base = heap_current;
+        heap_peak = heap_current;
+        start = now_ns();
+        failed += refresh(port, paths, bufferSize, kind, &series);
+        latencies[i] = (now_ns() - start) / 1e6;
+        if (heap_peak - base > peak) peak = heap_peak - base;
+    }
+    stop_server(child);
+
+    qsort(latencies, refreshes, sizeof(double), compare_double);
+    if (HEAP_TRACKING == 0) peak = -1;
+    printf("bench=refresh scenario=%s planes=%d body_bytes=%d refreshes=%d p50_ms=%.3f p99_ms=%.3f max_ms=%.3f "
+           "failed_planes=%d heap_peak_bytes=%ld\n",
+           name, PLANES, (int)strlen(config->body), refreshes, latencies[refreshes / 2],
+           latencies[(refreshes * 99) / 100], latencies[refreshes - 1], failed, peak);
+    fflush(stdout);
+}
+
+int main() {
+    struct mock_server_config config;
+    char* daily = read_file(MOCK_RESPONSE_BODY_FILE);
+    char* watts = read_file(MOCK_WATTS_FILE);
+    char* large = generate_watts_body();
+
+    if (daily == NULL || watts == NULL) return 1;
+
+    mock_server_defaults(&config, daily);
+    bench_scenario("daily", &config, 200, 0, -1);
+
+    config.latency_ms = 20;
+    bench_scenario("daily_latency_20ms", &config, 50, 0, -1);
+
+    mock_server_defaults(&config, daily);
+    config.chunked = 1;
+    config.chunk_size = 64;
+    bench_scenario("daily_chunked", &config, 200, 0, -1);
+
+    mock_server_defaults(&config, daily);
+    config.fault = MOCK_SERVER_FAULT_TRUNCATE;
+    config.fault_every = 2;
+    bench_scenario("daily_truncated", &config, 200, 0, -1);
+
+    config.fault = MOCK_SERVER_FAULT_RATE_LIMIT;
+    bench_scenario("daily_429", &config, 200, 0, -1);
+
+    config.fault = MOCK_SERVER_FAULT_RESET;
+    bench_scenario("daily_reset", &config, 200, 0, -1);
+
+    mock_server_defaults(&config, watts);
+    bench_scenario("watts", &config, 200, 4096, FORECAST_SOLAR_WATTS);
+
+    mock_server_defaults(&config, large);
+    bench_scenario("watts_per_minute", &config, 100, 128 * 1024, FORECAST_SOLAR_WATTS);
+
+    config.bytes_per_second = 1024 * 1024;
+    bench_scenario("watts_per_minute_1mb_s", &config, 20, 128 * 1024, FORECAST_SOLAR_WATTS);
+
+    free(large);
+    free(watts);
+    free(daily);
+    return 0;
+}
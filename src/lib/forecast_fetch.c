@@ -0,0 +1,196 @@
+// Check if we're using a standard C compiler
+#ifndef PICO_C
+#include "forecast_fetch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#endif
+
+// Receive buffer, bytes read from a socket per stream_read call
+#define FORECAST_FETCH_READ_SIZE 512
+
+// Function to send a GET for every path, the server closes each connection
+// after its response. Requests that cannot be sent are marked right away.
+// Returns the number pending.
+int startForecastFetch(struct ForecastFetch* fetch, char* host, int port, char** paths, int count, int bufferSize,
+                       int timeout, unsigned int now) {
+    char address[256];
+    char request[768];
+    struct ForecastRequest* r;
+    int length;
+    int i;
+
+    if (count > FORECAST_FETCH_MAX_REQUESTS) count = FORECAST_FETCH_MAX_REQUESTS;
+    fetch->count = count;
+    fetch->pending = 0;
+    fetch->deadline = now + timeout;
+    fetch->waited = 0;
+    fetch->timeout = timeout;
+    sprintf(address, "/dev/tcp/%s/%d", host, port);
+
+    for (i = 0; i < count; i++) {
+        r = &fetch->requests[i];
+        r->state = FORECAST_FETCH_CONNECT_FAILED;
+        r->size = bufferSize;
+        r->length = 0;
+        r->idle = 0;
+        r->parse = 0;
+        initHttpReader(&r->http);
+        r->buffer = NULL;
+        r->stream = NULL;
+        if (bufferSize > 0) {
+            r->buffer = (char*)malloc(bufferSize);
+            if (r->buffer == NULL || bufferSize < 2) continue;
+            r->buffer[0] = '\0';
+        }
+
+        r->stream = stream_create(address, 0, 0);
+        if (r->stream == NULL) continue;
+        length = sprintf(request, "GET %s HTTP/1.1\r\nHost: %s\r\nUser-Agent: LoxLIVE\r\nAccept: application/json\r\nConnection: close\r\n\r\n",
+                         paths[i], host);
+        if (stream_write(r->stream, request, length) != length) continue;
+        stream_flush(r->stream);
+        r->state = FORECAST_FETCH_PENDING;
+        fetch->pending++;
+    }
+    return fetch->pending;
+}
+
+// Function to parse every body as it arrives
+void parseForecastFetch(struct ForecastFetch* fetch, char* todayDate, char* tomorrowDate) {
+    int i;
+
+    for (i = 0; i < fetch->count; i++) {
+        beginForecastParser(&fetch->requests[i].parser, todayDate, tomorrowDate);
+        fetch->requests[i].parse = 1;
+    }
+}
+
+// Finish a request that left FORECAST_FETCH_PENDING
+void forecastFetchFinish(struct ForecastFetch* fetch, struct ForecastRequest* r, int state) {
+    r->state = state;
+    stream_close(r->stream);
+    r->stream = NULL;
+    fetch->pending--;
+}
+
+// Pass received bytes through the reader, then the body to the parser and/or
+// the buffer. closed is set when the server hung up.
+void forecastFetchUpdate(struct ForecastFetch* fetch, struct ForecastRequest* r, char* data, int length, int closed) {
+    int n = feedHttpReader(&r->http, data, length);
+
+    if (r->parse && n > 0) {
+        feedForecastParser(&r->parser, data, n);
+    }
+    if (r->buffer != NULL) {
+        if (r->length + n > r->size - 1) {
+            forecastFetchFinish(fetch, r, FORECAST_FETCH_TOO_LARGE);
+            return;
+        }
+        memcpy(r->buffer + r->length, data, n);
+        r->length += n;
+        r->buffer[r->length] = '\0';
+    }
+
+    if (closed) closeHttpReader(&r->http);
+    if (r->http.state == HTTP_READER_DONE) {
+        forecastFetchFinish(fetch, r, FORECAST_FETCH_DONE);
+    } else if (r->http.state == HTTP_READER_STATUS_ERROR) {
+        // Known from the headers already, the error body is not worth reading
+        forecastFetchFinish(fetch, r, FORECAST_FETCH_HTTP_ERROR);
+    } else if (r->http.state == HTTP_READER_MALFORMED) {
+        forecastFetchFinish(fetch, r, FORECAST_FETCH_MALFORMED);
+    } else if (r->http.state == HTTP_READER_TRUNCATED) {
+        forecastFetchFinish(fetch, r, FORECAST_FETCH_CLOSED);
+    }
+}
+
+// Function to read from every pending request once. Each read waits at most
+// wait ms. The deadline is on the clock, so a peer that keeps sending a few
+// bytes at a time still times out.
+int pollForecastFetch(struct ForecastFetch* fetch, int wait, unsigned int now) {
+    char data[FORECAST_FETCH_READ_SIZE];
+    struct ForecastRequest* r;
+    int n;
+    int i;
+
+    for (i = 0; i < fetch->count; i++) {
+        r = &fetch->requests[i];
+        if (r->state != FORECAST_FETCH_PENDING) continue;
+
+        n = stream_read(r->stream, data, FORECAST_FETCH_READ_SIZE, wait);
+        if (n > 0) {
+            r->idle = 0;
+            forecastFetchUpdate(fetch, r, data, n, 0);
+        } else if (n < 0) {
+            forecastFetchUpdate(fetch, r, data, 0, 1);
+        } else {
+            // A close the stream does not report looks like a server gone quiet
+            r->idle += wait;
+            fetch->waited += wait;
+            if (r->idle >= FORECAST_FETCH_IDLE_MS && httpReaderUntilClose(&r->http)) {
+                forecastFetchUpdate(fetch, r, data, 0, 1);
+            }
+        }
+    }
+
+    // Past the deadline, a body that runs until the connection ends is complete. Empty
+    // reads take their time, so they also end the wait where the clock stands still,
+    // as in host runs of the scripts.
+    if (fetch->pending > 0 && (now >= fetch->deadline || fetch->waited >= fetch->timeout * 1000)) {
+        for (i = 0; i < fetch->count; i++) {
+            r = &fetch->requests[i];
+            if (r->state != FORECAST_FETCH_PENDING) continue;
+            closeHttpReader(&r->http);
+            if (r->http.state == HTTP_READER_DONE) {
+                forecastFetchFinish(fetch, r, FORECAST_FETCH_DONE);
+            } else {
+                forecastFetchFinish(fetch, r, FORECAST_FETCH_TIMEOUT);
+            }
+        }
+    }
+    return fetch->pending;
+}
+
+// Function to get the body of a completed request, or NULL
+char* forecastFetchBody(struct ForecastFetch* fetch, int index) {
+    struct ForecastRequest* r;
+
+    if (index < 0 || index >= fetch->count) return NULL;
+    r = &fetch->requests[index];
+    if (r->state != FORECAST_FETCH_DONE) return NULL;
+    return r->buffer;
+}
+
+// Function to describe a request state for logging
+char* forecastFetchStateText(int state) {
+    if (state == FORECAST_FETCH_PENDING) return "pending";
+    if (state == FORECAST_FETCH_DONE) return "done";
+    if (state == FORECAST_FETCH_CONNECT_FAILED) return "connect failed";
+    if (state == FORECAST_FETCH_TIMEOUT) return "timeout";
+    if (state == FORECAST_FETCH_TOO_LARGE) return "response too large";
+    if (state == FORECAST_FETCH_HTTP_ERROR) return "HTTP error";
+    if (state == FORECAST_FETCH_CLOSED) return "connection closed";
+    if (state == FORECAST_FETCH_MALFORMED) return "malformed response";
+    return "unknown";
+}
+
+// Function to close the streams and free the buffers
+void closeForecastFetch(struct ForecastFetch* fetch) {
+    struct ForecastRequest* r;
+    int i;
+
+    for (i = 0; i < fetch->count; i++) {
+        r = &fetch->requests[i];
+        if (r->stream != NULL) {
+            stream_close(r->stream);
+            r->stream = NULL;
+        }
+        if (r->buffer != NULL) {
+            free(r->buffer);
+            r->buffer = NULL;
+        }
+    }
+    fetch->count = 0;
+    fetch->pending = 0;
+}
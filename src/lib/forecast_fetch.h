@@ -0,0 +1,82 @@
+#ifndef FORECAST_FETCH_H
+#define FORECAST_FETCH_H
+
+// Concurrent HTTP GETs over Loxone TCP streams. All requests are sent up front
+// and the sockets are then read in turns with short timeouts, so a refresh of
+// several planes takes about as long as the slowest one instead of the sum.
+//
+// Bytes pass through the HTTP reader as they arrive. After parseForecastFetch
+// each de-chunked body goes on to a ForecastParser of its request, which reads
+// the day totals and the quota without keeping the body, so the memory of a
+// refresh does not depend on the size of the responses. Callers that parse a
+// body afterwards, like production series, pass a bufferSize instead: the body
+// is then kept whole, and one longer than bufferSize - 1 bytes ends the request
+// with FORECAST_FETCH_TOO_LARGE.
+
+#ifndef PICO_C
+#include "forecast_solar.h"
+#include "http_reader.h"
+#include "loxone_stream.h"
+#endif
+
+#define FORECAST_FETCH_MAX_REQUESTS 8
+
+// A body that runs until the connection ends is complete after this long without data
+#define FORECAST_FETCH_IDLE_MS 1000
+
+// Request states
+#define FORECAST_FETCH_PENDING 0         // Sent, response not complete yet
+#define FORECAST_FETCH_DONE 1            // Complete response with a 2xx status
+#define FORECAST_FETCH_CONNECT_FAILED 2  // The stream could not be created or written
+#define FORECAST_FETCH_TIMEOUT 3         // No complete response before the deadline
+#define FORECAST_FETCH_TOO_LARGE 4       // Response does not fit the buffer
+#define FORECAST_FETCH_HTTP_ERROR 5      // Status is not 2xx, see http.status, the body is not read
+#define FORECAST_FETCH_CLOSED 6          // Connection closed before the response was complete
+#define FORECAST_FETCH_MALFORMED 7       // Not a valid HTTP response
+
+// One request, its body is parsed as it arrives and/or kept in a buffer of its own
+struct ForecastRequest {
+    STREAM* stream;
+    int state;
+    struct HttpReader http;  // Status, rate limit headers and framing of the response
+    struct ForecastParser parser;  // Day totals and quota of the body, after parseForecastFetch
+    int parse;
+    char* buffer;        // De-chunked body so far, NUL-terminated, NULL without a bufferSize
+    int size;
+    int length;
+    int idle;            // Milliseconds of reads in a row that came back empty
+};
+
+struct ForecastFetch {
+    struct ForecastRequest requests[FORECAST_FETCH_MAX_REQUESTS];
+    int count;
+    int pending;         // Requests still in FORECAST_FETCH_PENDING
+    unsigned int deadline;  // getcurrenttime() at which each pending request times out
+    int waited;          // Milliseconds spent in reads that came back empty
+    int timeout;         // In seconds
+};
+
+// Function to send a GET for every path to host:port at now, each response gets a buffer
+// of bufferSize bytes (0 for none) and must be complete within timeout seconds, whatever
+// the peer sends
+int startForecastFetch(struct ForecastFetch* fetch, char* host, int port, char** paths, int count, int bufferSize,
+                       int timeout, unsigned int now);
+
+// Function to parse the day totals and quota of every body as it arrives, see
+// ForecastParser. Call it before the first poll, the dates must outlive the fetch.
+void parseForecastFetch(struct ForecastFetch* fetch, char* todayDate, char* tomorrowDate);
+
+// Function to read from every pending request once, waiting up to wait ms on each, now
+// being getcurrenttime() before the reads. Returns the number still pending.
+int pollForecastFetch(struct ForecastFetch* fetch, int wait, unsigned int now);
+
+// Function to get the body of a completed request kept in its buffer, or NULL
+char* forecastFetchBody(struct ForecastFetch* fetch, int index);
+
+// Function to describe a request state for logging
+char* forecastFetchStateText(int state);
+
+// Function to close the streams and free the buffers
+void closeForecastFetch(struct ForecastFetch* fetch);
+
+#endif // FORECAST_FETCH_H
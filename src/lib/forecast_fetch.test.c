@@ -0,0 +1,383 @@
+#include "forecast_fetch.h"
+#include "forecast_solar.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+// Helper function to read file content
+char* read_file(const char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL) {
+        printf("Failed to open file: %s\n", filename);
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long file_size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char* buffer = (char*)malloc(file_size + 1);
+    if (buffer == NULL) {
+        fclose(file);
+        return NULL;
+    }
+
+    size_t read_size = fread(buffer, 1, file_size, file);
+    buffer[read_size] = '\0';
+
+    fclose(file);
+    return buffer;
+}
+
+// Fake TCP streams standing in for the Miniserver. Servers answer in parallel
+// on a simulated clock: a read that finds no data waits its full timeout, and
+// a read from a slow server waits for its next chunk.
+#define FAKE_STREAMS 8
+
+struct stream {
+    char address[128];
+    char request[1024];
+    int request_length;
+    char* response;      // Bytes the server sends, NULL for a server that never answers
+    int length;
+    int offset;
+    int ready_at;        // Simulated ms at which the response starts to arrive
+    int chunk;           // Bytes delivered per read
+    int hang_up;         // Close the connection once the response is sent
+    int interval;        // Simulated ms between chunks, for a server that trickles the response
+    int open;
+};
+
+struct stream fake_streams[FAKE_STREAMS];
+int fake_refuse[FAKE_STREAMS];  // stream_create fails for these
+int fake_created = 0;
+int fake_now = 0;     // Simulated ms
+
+// getcurrenttime() of the simulated clock
+unsigned int fake_time() {
+    return fake_now / 1000;
+}
+
+void fake_reset() {
+    memset(fake_streams, 0, sizeof(fake_streams));
+    memset(fake_refuse, 0, sizeof(fake_refuse));
+    fake_created = 0;
+    fake_now = 0;
+}
+
+void fake_server(int index, char* response, int length, int ready_at, int chunk, int hang_up) {
+    fake_streams[index].response = response;
+    fake_streams[index].length = length;
+    fake_streams[index].ready_at = ready_at;
+    fake_streams[index].chunk = chunk;
+    fake_streams[index].hang_up = hang_up;
+}
+
+STREAM* stream_create(char* filename, int read, int append) {
+    (void)read;
+    (void)append;
+    int index = fake_created++;
+    if (index >= FAKE_STREAMS || fake_refuse[index]) return NULL;
+    strcpy(fake_streams[index].address, filename);
+    fake_streams[index].open = 1;
+    return &fake_streams[index];
+}
+
+int stream_write(STREAM* stream, void* ptr, int size) {
+    memcpy(stream->request + stream->request_length, ptr, size);
+    stream->request_length += size;
+    return size;
+}
+
+void stream_flush(STREAM* stream) {
+    (void)stream;
+}
+
+int stream_read(STREAM* stream, void* ptr, int size, int timeout) {
+    int n;
+
+    assert(stream->open);
+    if (stream->response == NULL || fake_now < stream->ready_at || stream->offset == stream->length) {
+        if (stream->response != NULL && stream->offset == stream->length && stream->hang_up) return -1;
+        fake_now += timeout;
+        return 0;
+    }
+    n = stream->length - stream->offset;
+    if (n > stream->chunk) n = stream->chunk;
+    if (n > size) n = size;
+    memcpy(ptr, stream->response + stream->offset, n);
+    stream->offset += n;
+    fake_now += stream->interval;
+    return n;
+}
+
+void stream_close(STREAM* stream) {
+    assert(stream->open);
+    stream->open = 0;
+}
+
+int fake_open_streams() {
+    int open = 0;
+    int i;
+    for (i = 0; i < FAKE_STREAMS; i++) {
+        open += fake_streams[i].open;
+    }
+    return open;
+}
+
+// HTTP response around the forecast.solar body mock
+char* make_response(char* status, char* body, int content_length) {
+    char* response = (char*)malloc(strlen(body) + 256);
+    char* p = response;
+    p += sprintf(p, "HTTP/1.1 %s\r\nContent-Type: application/json\r\n", status);
+    if (content_length) p += sprintf(p, "content-length: %d\r\n", (int)strlen(body));
+    sprintf(p, "\r\n%s", body);
+    return response;
+}
+
+void test_concurrent_fetch() {
+    printf("Testing concurrent fetches...\n");
+
+    char* body = read_file(MOCK_RESPONSE_BODY_FILE);
+    assert(body != NULL);
+    char* response = make_response("200 OK", body, 1);
+    char* paths[3];
+    paths[0] = "/estimate/watthours/day/50.69/15.22/45/-63/5.5";
+    paths[1] = "/estimate/watthours/day/50.69/15.22/45/113/4.5";
+    paths[2] = "/estimate/watthours/day/50.69/15.22/30/0/3";
+
+    // Three planes answering after 300, 500 and 400 ms
+    fake_reset();
+    fake_server(0, response, strlen(response), 300, 100, 0);
+    fake_server(1, response, strlen(response), 500, 100, 0);
+    fake_server(2, response, strlen(response), 400, 100, 0);
+
+    struct ForecastFetch fetch;
+    assert(startForecastFetch(&fetch, "api.forecast.solar", 80, paths, 3, 0, 10, fake_time()) == 3);
+    parseForecastFetch(&fetch, "2025-02-27", "2025-02-28");
+    assert(strcmp(fake_streams[1].address, "/dev/tcp/api.forecast.solar/80") == 0);
+    assert(strncmp(fake_streams[1].request, "GET /estimate/watthours/day/50.69/15.22/45/113/4.5 HTTP/1.1\r\n", 61) == 0);
+    assert(strstr(fake_streams[1].request, "Host: api.forecast.solar\r\n") != NULL);
+    assert(strstr(fake_streams[1].request, "Connection: close\r\n") != NULL);
+    printf("✓ All requests sent up front\n");
+
+    while (pollForecastFetch(&fetch, 10, fake_time()) > 0) {
+    }
+
+    // Waiting overlaps, so the refresh takes about as long as the slowest plane
+    assert(fake_now >= 500 && fake_now < 600);
+    printf("✓ Refresh took %d ms for planes of 300, 500 and 400 ms\n", fake_now);
+
+    struct DailyProduction total;
+    struct ForecastRateLimit rateLimit;
+    total.today = 0;
+    total.tomorrow = 0;
+    int i;
+    for (i = 0; i < 3; i++) {
+        assert(fetch.requests[i].state == FORECAST_FETCH_DONE);
+        assert(fetch.requests[i].http.status == 200);
+        assert(forecastFetchBody(&fetch, i) == NULL);
+        assert(addParsedProduction(&total, &fetch.requests[i].parser) == 0);
+        assert(parsedForecastRateLimit(&fetch.requests[i].parser, &rateLimit) == 0 && rateLimit.remaining == 11);
+    }
+    assert(total.today > 3 * 4674.362 - 1e-6 && total.today < 3 * 4674.362 + 1e-6);
+    printf("✓ Every plane parsed as its body arrived, no body kept\n");
+
+    closeForecastFetch(&fetch);
+    assert(fake_open_streams() == 0);
+    free(response);
+    free(body);
+}
+
+void test_partial_failures() {
+    printf("\nTesting per-plane failures...\n");
+
+    char* body = read_file(MOCK_RESPONSE_BODY_FILE);
+    assert(body != NULL);
+    char* ok = make_response("200 OK", body, 1);
+    char* not_found = make_response("404 Not Found", "{}", 1);
+    char* without_length = make_response("200 OK", body, 0);
+    char* paths[6];
+    int i;
+    for (i = 0; i < 6; i++) {
+        paths[i] = "/estimate/watthours/day/50.69/15.22/45/0/5";
+    }
+
+    fake_reset();
+    fake_server(0, ok, strlen(ok), 100, 512, 0);
+    fake_refuse[1] = 1;
+    fake_server(2, NULL, 0, 0, 0, 0);
+    fake_server(3, not_found, strlen(not_found), 50, 512, 0);
+    fake_server(4, ok, strlen(ok) - 10, 50, 64, 1);
+    fake_server(5, without_length, strlen(without_length), 200, 64, 1);
+
+    struct ForecastFetch fetch;
+    assert(startForecastFetch(&fetch, "api.forecast.solar", 80, paths, 6, 2048, 1, fake_time()) == 5);
+    while (pollForecastFetch(&fetch, 20, fake_time()) > 0) {
+    }
+
+    assert(fetch.requests[0].state == FORECAST_FETCH_DONE);
+    assert(fetch.requests[1].state == FORECAST_FETCH_CONNECT_FAILED);
+    assert(fetch.requests[2].state == FORECAST_FETCH_TIMEOUT);
+    assert(fetch.requests[3].state == FORECAST_FETCH_HTTP_ERROR && fetch.requests[3].http.status == 404);
+    assert(fetch.requests[4].state == FORECAST_FETCH_CLOSED);
+    assert(fetch.requests[5].state == FORECAST_FETCH_DONE);
+    printf("✓ Each plane reports its own outcome\n");
+
+    // Only complete responses have a body
+    assert(strcmp(forecastFetchBody(&fetch, 0), body) == 0);
+    assert(forecastFetchBody(&fetch, 1) == NULL);
+    assert(forecastFetchBody(&fetch, 2) == NULL);
+    assert(forecastFetchBody(&fetch, 3) == NULL);
+    assert(forecastFetchBody(&fetch, 4) == NULL);
+    assert(strcmp(forecastFetchBody(&fetch, 5), body) == 0);
+    assert(forecastFetchBody(&fetch, 6) == NULL);
+    assert(strcmp(forecastFetchStateText(fetch.requests[2].state), "timeout") == 0);
+    printf("✓ Bodies only for complete responses\n");
+
+    // The plane that never answers is given up at the deadline
+    assert(fake_now >= 1000 && fake_now < 1200);
+    printf("✓ Timed out after %d ms\n", fake_now);
+
+    closeForecastFetch(&fetch);
+    assert(fake_open_streams() == 0);
+
+    // A response larger than its buffer
+    fake_reset();
+    fake_server(0, ok, strlen(ok), 0, 512, 0);
+    assert(startForecastFetch(&fetch, "api.forecast.solar", 80, paths, 1, 256, 1, fake_time()) == 1);
+    while (pollForecastFetch(&fetch, 20, fake_time()) > 0) {
+    }
+    assert(fetch.requests[0].state == FORECAST_FETCH_TOO_LARGE);
+    assert(fetch.requests[0].length < 256);
+    closeForecastFetch(&fetch);
+    assert(fake_open_streams() == 0);
+    printf("✓ Correctly handled a response too large for its buffer\n");
+
+    free(ok);
+    free(not_found);
+    free(without_length);
+    free(body);
+}
+
+void test_deadline() {
+    printf("\nTesting the deadline...\n");
+
+    char* body = read_file(MOCK_RESPONSE_BODY_FILE);
+    assert(body != NULL);
+    char* ok = make_response("200 OK", body, 1);
+    char* without_length = make_response("200 OK", body, 0);
+    char* paths[2];
+    paths[0] = "/estimate/watthours/day/50.69/15.22/45/-63/5.5";
+    paths[1] = "/estimate/watthours/day/50.69/15.22/45/113/4.5";
+
+    // A server sending 8 bytes every 100 ms would need about 10 s, a good one answers at once
+    fake_reset();
+    fake_server(0, ok, strlen(ok), 0, 8, 0);
+    fake_streams[0].interval = 100;
+    fake_server(1, ok, strlen(ok), 0, 512, 0);
+
+    struct ForecastFetch fetch;
+    assert(startForecastFetch(&fetch, "api.forecast.solar", 80, paths, 2, 2048, 2, fake_time()) == 2);
+    while (pollForecastFetch(&fetch, 50, fake_time()) > 0) {
+    }
+    assert(fetch.requests[0].state == FORECAST_FETCH_TIMEOUT);
+    assert(fake_streams[0].offset < fake_streams[0].length);
+    assert(fetch.requests[1].state == FORECAST_FETCH_DONE);
+    assert(fake_now >= 2000 && fake_now < 2200);
+    closeForecastFetch(&fetch);
+    assert(fake_open_streams() == 0);
+    printf("✓ A slow server times out after %d ms although it keeps sending\n", fake_now);
+
+    // A body without length whose end the stream reports as no data, not as a close
+    fake_reset();
+    fake_server(0, without_length, strlen(without_length), 100, 512, 0);
+    assert(startForecastFetch(&fetch, "api.forecast.solar", 80, paths, 1, 2048, 10, fake_time()) == 1);
+    while (pollForecastFetch(&fetch, 50, fake_time()) > 0) {
+    }
+    assert(fetch.requests[0].state == FORECAST_FETCH_DONE);
+    assert(strcmp(forecastFetchBody(&fetch, 0), body) == 0);
+    assert(fake_now >= 100 + FORECAST_FETCH_IDLE_MS && fake_now < 200 + FORECAST_FETCH_IDLE_MS);
+    closeForecastFetch(&fetch);
+    printf("✓ A body running until the close is complete after %d ms, not at the deadline\n", fake_now);
+
+    free(ok);
+    free(without_length);
+    free(body);
+}
+
+// The body in chunks of chunk_size bytes
+char* make_chunked_response(char* body, int chunk_size) {
+    int length = strlen(body);
+    char* response = (char*)malloc(length * 2 + 256);
+    char* p = response;
+    int offset;
+    int n;
+
+    p += sprintf(p, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n");
+    for (offset = 0; offset < length; offset += n) {
+        n = length - offset;
+        if (n > chunk_size) n = chunk_size;
+        p += sprintf(p, "%x\r\n", n);
+        memcpy(p, body + offset, n);
+        p += n;
+        p += sprintf(p, "\r\n");
+    }
+    sprintf(p, "0\r\n\r\n");
+    return response;
+}
+
+void test_chunked_and_rate_limited() {
+    printf("\nTesting chunked and rate limited responses...\n");
+
+    char* body = read_file(MOCK_RESPONSE_BODY_FILE);
+    assert(body != NULL);
+    char* chunked = make_chunked_response(body, 100);
+    char* limited = (char*)malloc(strlen(body) + 256);
+    sprintf(limited, "HTTP/1.1 429 Too Many Requests\r\nRetry-After: 1800\r\nX-Ratelimit-Limit: 12\r\n"
+                     "X-Ratelimit-Remaining: 0\r\nContent-Length: %d\r\n\r\n%s", (int)strlen(body), body);
+    char* paths[2];
+    paths[0] = "/estimate/watthours/day/50.69/15.22/45/-63/5.5";
+    paths[1] = "/estimate/watthours/day/50.69/15.22/45/113/4.5";
+
+    // Chunks arrive split at odd places, the rate limited body is never read
+    fake_reset();
+    fake_server(0, chunked, strlen(chunked), 100, 7, 0);
+    fake_server(1, limited, strlen(limited), 100, 128, 0);
+
+    struct ForecastFetch fetch;
+    assert(startForecastFetch(&fetch, "api.forecast.solar", 80, paths, 2, 2048, 10, fake_time()) == 2);
+    while (pollForecastFetch(&fetch, 10, fake_time()) > 0) {
+    }
+
+    assert(fetch.requests[0].state == FORECAST_FETCH_DONE);
+    assert(strcmp(forecastFetchBody(&fetch, 0), body) == 0);
+    printf("✓ Chunked body decoded as it arrived\n");
+
+    assert(fetch.requests[1].state == FORECAST_FETCH_HTTP_ERROR);
+    assert(fetch.requests[1].http.status == 429);
+    assert(fetch.requests[1].http.retryAfter == 1800);
+    assert(fetch.requests[1].http.rateRemaining == 0);
+    assert(fake_streams[1].offset < fake_streams[1].length);
+    assert(forecastFetchBody(&fetch, 1) == NULL);
+    printf("✓ Rate limited plane stopped after its headers\n");
+
+    closeForecastFetch(&fetch);
+    assert(fake_open_streams() == 0);
+    free(chunked);
+    free(limited);
+    free(body);
+}
+
+int main() {
+    printf("Running forecast_fetch tests...\n\n");
+
+    test_concurrent_fetch();
+    test_partial_failures();
+    test_deadline();
+    test_chunked_and_rate_limited();
+
+    printf("\nAll tests passed! ✓\n");
+    return 0;
+}
@@ -0,0 +1,234 @@
+#define _POSIX_C_SOURCE 200112L
+#include "forecast_mock_server.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#define MOCK_SERVER_REQUEST_SIZE 4096
+
+struct mock_connection {
+    struct mock_server* server;
+    int fd;
+    int index;
+};
+
+void mock_server_defaults(struct mock_server_config* config, char* body) {
+    config->body = body;
+    config->latency_ms = 0;
+    config->bytes_per_second = 0;
+    config->chunked = 0;
+    config->chunk_size = 256;
+    config->fault = MOCK_SERVER_FAULT_NONE;
+    config->fault_every = 0;
+}
+
+void mock_server_sleep(int ms) {
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (long)(ms % 1000) * 1000000;
+    nanosleep(&ts, NULL);
+}
+
+// Send length bytes, in 10 ms slices when the rate is limited. Returns 0 or -1.
+int mock_server_send(struct mock_server* server, int fd, char* data, int length) {
+    int slice = length;
+    int sent;
+    int n;
+
+    if (server->config.bytes_per_second > 0) {
+        slice = server->config.bytes_per_second / 100;
+        if (slice < 1) slice = 1;
+    }
+    for (sent = 0; sent < length; sent += n) {
+        n = length - sent;
+        if (n > slice) n = slice;
+        n = send(fd, data + sent, n, MSG_NOSIGNAL);
+        if (n <= 0) return -1;
+        if (server->config.bytes_per_second > 0 && sent + n < length) mock_server_sleep(10);
+    }
+    return 0;
+}
+
+// Read the request head, the path does not matter
+void mock_server_read_request(int fd) {
+    char request[MOCK_SERVER_REQUEST_SIZE + 1];
+    int length = 0;
+    int n;
+
+    while (length < MOCK_SERVER_REQUEST_SIZE) {
+        n = recv(fd, request + length, MOCK_SERVER_REQUEST_SIZE - length, 0);
+        if (n <= 0) return;
+        length += n;
+        request[length] = '\0';
+        if (strstr(request, "\r\n\r\n") != NULL) return;
+    }
+}
+
+void* mock_server_connection(void* arg) {
+    struct mock_connection* c = (struct mock_connection*)arg;
+    struct mock_server* server = c->server;
+    struct linger reset;
+    char limited[256];
+    int fault = MOCK_SERVER_FAULT_NONE;
+    int length;
+
+    mock_server_read_request(c->fd);
+    if (server->config.latency_ms > 0) mock_server_sleep(server->config.latency_ms);
+    if (server->config.fault_every > 0 && (c->index + 1) % server->config.fault_every == 0) {
+        fault = server->config.fault;
+    }
+
+    if (fault == MOCK_SERVER_FAULT_RATE_LIMIT) {
+        length = sprintf(limited, "HTTP/1.1 429 Too Many Requests\r\nRetry-After: 3600\r\nX-Ratelimit-Limit: 12\r\n"
+                                  "X-Ratelimit-Period: 3600\r\nX-Ratelimit-Remaining: 0\r\nContent-Length: 19\r\n"
+                                  "Connection: close\r\n\r\n{\"message\":\"limit\"}");
+        mock_server_send(server, c->fd, limited, length);
+    } else if (fault == MOCK_SERVER_FAULT_TRUNCATE || fault == MOCK_SERVER_FAULT_RESET) {
+        length = server->head_length + (server->response_length - server->head_length) / 2;
+        mock_server_send(server, c->fd, server->response, length);
+        if (fault == MOCK_SERVER_FAULT_RESET) {
+            reset.l_onoff = 1;
+            reset.l_linger = 0;
+            setsockopt(c->fd, SOL_SOCKET, SO_LINGER, &reset, sizeof(reset));
+        }
+    } else {
+        mock_server_send(server, c->fd, server->response, server->response_length);
+    }
+    close(c->fd);
+
+    pthread_mutex_lock(&server->lock);
+    server->active--;
+    pthread_mutex_unlock(&server->lock);
+    free(c);
+    return NULL;
+}
+
+void* mock_server_accept(void* arg) {
+    struct mock_server* server = (struct mock_server*)arg;
+    struct mock_connection* c;
+    struct pollfd p;
+    pthread_t thread;
+    int fd;
+
+    while (server->running) {
+        p.fd = server->listener;
+        p.events = POLLIN;
+        p.revents = 0;
+        if (poll(&p, 1, 20) <= 0) continue;
+        fd = accept(server->listener, NULL, NULL);
+        if (fd < 0) continue;
+
+        c = (struct mock_connection*)malloc(sizeof(struct mock_connection));
+        c->server = server;
+        c->fd = fd;
+        pthread_mutex_lock(&server->lock);
+        c->index = server->connections++;
+        server->active++;
+        pthread_mutex_unlock(&server->lock);
+        if (pthread_create(&thread, NULL, mock_server_connection, c) != 0) {
+            close(fd);
+            pthread_mutex_lock(&server->lock);
+            server->active--;
+            pthread_mutex_unlock(&server->lock);
+            free(c);
+            continue;
+        }
+        pthread_detach(thread);
+    }
+    return NULL;
+}
+
+// Build the head and body of a good response
+int mock_server_build(struct mock_server* server) {
+    struct mock_server_config* config = &server->config;
+    int body_length = strlen(config->body);
+    int chunk = config->chunk_size;
+    int offset;
+    int n;
+    char* p;
+
+    if (chunk < 1) chunk = 1;
+    server->response = (char*)malloc(body_length * 2 + (body_length / chunk + 1) * 16 + 512);
+    if (server->response == NULL) return -1;
+    p = server->response;
+    p += sprintf(p, "HTTP/1.1 200 OK\r\nContent-Type: application/json; charset=utf-8\r\n"
+                    "X-Ratelimit-Limit: 12\r\nX-Ratelimit-Period: 3600\r\nX-Ratelimit-Remaining: 11\r\n");
+    if (config->chunked) {
+        p += sprintf(p, "Transfer-Encoding: chunked\r\nConnection: close\r\n\r\n");
+        server->head_length = p - server->response;
+        for (offset = 0; offset < body_length; offset += n) {
+            n = body_length - offset;
+            if (n > chunk) n = chunk;
+            p += sprintf(p, "%x\r\n", n);
+            memcpy(p, config->body + offset, n);
+            p += n;
+            p += sprintf(p, "\r\n");
+        }
+        p += sprintf(p, "0\r\n\r\n");
+    } else {
+        p += sprintf(p, "Content-Length: %d\r\nConnection: close\r\n\r\n", body_length);
+        server->head_length = p - server->response;
+        memcpy(p, config->body, body_length);
+        p += body_length;
+    }
+    server->response_length = p - server->response;
+    return 0;
+}
+
+int mock_server_start(struct mock_server* server, struct mock_server_config* config, int port) {
+    struct sockaddr_in address;
+    socklen_t length = sizeof(address);
+    int on = 1;
+
+    server->config = *config;
+    server->connections = 0;
+    server->active = 0;
+    server->running = 1;
+    if (mock_server_build(server) < 0) return -1;
+
+    server->listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (server->listener < 0) return -1;
+    setsockopt(server->listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    if (bind(server->listener, (struct sockaddr*)&address, sizeof(address)) < 0
+        || listen(server->listener, 64) < 0
+        || getsockname(server->listener, (struct sockaddr*)&address, &length) < 0) {
+        close(server->listener);
+        free(server->response);
+        return -1;
+    }
+    server->port = ntohs(address.sin_port);
+
+    pthread_mutex_init(&server->lock, NULL);
+    if (pthread_create(&server->thread, NULL, mock_server_accept, server) != 0) {
+        close(server->listener);
+        free(server->response);
+        return -1;
+    }
+    return server->port;
+}
+
+void mock_server_stop(struct mock_server* server) {
+    int active = 1;
+
+    server->running = 0;
+    pthread_join(server->thread, NULL);
+    close(server->listener);
+    while (active > 0) {
+        pthread_mutex_lock(&server->lock);
+        active = server->active;
+        pthread_mutex_unlock(&server->lock);
+        if (active > 0) mock_server_sleep(1);
+    }
+    pthread_mutex_destroy(&server->lock);
+    free(server->response);
+}
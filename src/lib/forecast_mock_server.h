@@ -0,0 +1,49 @@
+#ifndef FORECAST_MOCK_SERVER_H
+#define FORECAST_MOCK_SERVER_H
+
+#include <pthread.h>
+
+// Host-only HTTP server on 127.0.0.1 that answers every request with one
+// forecast.solar body, for tests and benchmarks of the fetch path. Each
+// connection is served by its own thread, so responses overlap as they would
+// from the real API. Responses are built once at start, connections only send.
+
+#define MOCK_SERVER_FAULT_NONE 0
+#define MOCK_SERVER_FAULT_TRUNCATE 1    // Half the body, then the connection is closed
+#define MOCK_SERVER_FAULT_RATE_LIMIT 2  // 429 with Retry-After
+#define MOCK_SERVER_FAULT_RESET 3       // Half the body, then the connection is reset
+
+struct mock_server_config {
+    char* body;            // Served for every path
+    int latency_ms;        // Delay before the status line
+    int bytes_per_second;  // Send rate, 0 for no limit
+    int chunked;           // Transfer-Encoding: chunked instead of Content-Length
+    int chunk_size;        // Body bytes per chunk
+    int fault;             // MOCK_SERVER_FAULT_*
+    int fault_every;       // The fault hits every n-th connection, 0 for none
+};
+
+struct mock_server {
+    struct mock_server_config config;
+    int listener;
+    int port;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    volatile int running;
+    int connections;       // Accepted so far
+    int active;            // Connections still being served
+    char* response;        // Head and body of a good response
+    int response_length;
+    int head_length;
+};
+
+// Set config to a plain response of body
+void mock_server_defaults(struct mock_server_config* config, char* body);
+
+// Start serving on port, 0 picks a free one. Returns the port or -1.
+int mock_server_start(struct mock_server* server, struct mock_server_config* config, int port);
+
+// Stop accepting and wait for the connections being served
+void mock_server_stop(struct mock_server* server);
+
+#endif // FORECAST_MOCK_SERVER_H
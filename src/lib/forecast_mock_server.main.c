@@ -0,0 +1,94 @@
+#include "forecast_mock_server.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Serve a forecast.solar body on 127.0.0.1 until interrupted, e.g. to point a
+// script or curl at it by hand:
+//
+//   mock_forecast_server [--port <n>] [--latency <ms>] [--rate <bytes/s>] [--chunked <size>]
+//                        [--fault truncate|429|reset] [--fault-every <n>] <body file>
+
+char* read_file(char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL) {
+        printf("Failed to open file: %s\n", filename);
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long file_size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char* buffer = (char*)malloc(file_size + 1);
+    if (buffer == NULL) {
+        fclose(file);
+        return NULL;
+    }
+
+    size_t read_size = fread(buffer, 1, file_size, file);
+    buffer[read_size] = '\0';
+
+    fclose(file);
+    return buffer;
+}
+
+int usage() {
+    printf("Usage: mock_forecast_server [--port <n>] [--latency <ms>] [--rate <bytes/s>] [--chunked <size>]\n"
+           "                            [--fault truncate|429|reset] [--fault-every <n>] <body file>\n");
+    return 1;
+}
+
+int main(int argc, char** argv) {
+    struct mock_server_config config;
+    struct mock_server server;
+    char* body = NULL;
+    int port = 8080;
+    int i;
+
+    mock_server_defaults(&config, NULL);
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--latency") == 0 && i + 1 < argc) {
+            config.latency_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            config.bytes_per_second = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--chunked") == 0 && i + 1 < argc) {
+            config.chunked = 1;
+            config.chunk_size = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--fault") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "truncate") == 0) {
+                config.fault = MOCK_SERVER_FAULT_TRUNCATE;
+            } else if (strcmp(argv[i], "429") == 0) {
+                config.fault = MOCK_SERVER_FAULT_RATE_LIMIT;
+            } else if (strcmp(argv[i], "reset") == 0) {
+                config.fault = MOCK_SERVER_FAULT_RESET;
+            } else {
+                return usage();
+            }
+            if (config.fault_every == 0) config.fault_every = 1;
+        } else if (strcmp(argv[i], "--fault-every") == 0 && i + 1 < argc) {
+            config.fault_every = atoi(argv[++i]);
+        } else if (argv[i][0] != '-' && body == NULL) {
+            body = read_file(argv[i]);
+            if (body == NULL) return 1;
+        } else {
+            return usage();
+        }
+    }
+    if (body == NULL) return usage();
+    config.body = body;
+
+    if (mock_server_start(&server, &config, port) < 0) {
+        printf("Failed to listen on 127.0.0.1:%d\n", port);
+        return 1;
+    }
+    printf("Serving on http://127.0.0.1:%d/\n", server.port);
+    while (1) {
+        sleep(1);
+    }
+    return 0;
+}
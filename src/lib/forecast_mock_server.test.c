@@ -0,0 +1,175 @@
+#include "forecast_mock_server.h"
+#include "forecast_fetch.h"
+#include "forecast_solar.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+
+// The fetch path over real sockets (loxone_stream.c) against the mock server
+
+#define PLANES 4
+
+// Helper function to read file content
+char* read_file(const char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL) {
+        printf("Failed to open file: %s\n", filename);
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long file_size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char* buffer = (char*)malloc(file_size + 1);
+    if (buffer == NULL) {
+        fclose(file);
+        return NULL;
+    }
+
+    size_t read_size = fread(buffer, 1, file_size, file);
+    buffer[read_size] = '\0';
+
+    fclose(file);
+    return buffer;
+}
+
+char* paths[PLANES] = { "/estimate/1", "/estimate/2", "/estimate/3", "/estimate/4" };
+
+// Fetch every plane from a server started with config, the server is stopped after.
+// With bufferSize 0 each body is parsed as it arrives instead of kept.
+void fetch_all(struct ForecastFetch* fetch, struct mock_server_config* config, int bufferSize) {
+    struct mock_server server;
+    int port = mock_server_start(&server, config, 0);
+
+    assert(port > 0);
+    assert(startForecastFetch(fetch, "127.0.0.1", port, paths, PLANES, bufferSize, 5, (unsigned int)time(NULL)) == PLANES);
+    if (bufferSize == 0) {
+        parseForecastFetch(fetch, "2025-02-27", "2025-02-28");
+    }
+    while (pollForecastFetch(fetch, 50, (unsigned int)time(NULL)) > 0) {
+    }
+    mock_server_stop(&server);
+    assert(server.connections == PLANES);
+}
+
+void test_responses(char* body) {
+    printf("Testing good responses...\n");
+
+    struct mock_server_config config;
+    struct ForecastFetch fetch;
+    struct DailyProduction production;
+    int i;
+
+    mock_server_defaults(&config, body);
+    fetch_all(&fetch, &config, 4096);
+    production.today = 0;
+    production.tomorrow = 0;
+    for (i = 0; i < PLANES; i++) {
+        assert(fetch.requests[i].state == FORECAST_FETCH_DONE);
+        assert(strcmp(forecastFetchBody(&fetch, i), body) == 0);
+        assert(addDailyProduction(&production, forecastFetchBody(&fetch, i), "2025-02-27", "2025-02-28") == 0);
+    }
+    assert(fetch.requests[0].http.rateRemaining == 11);
+    closeForecastFetch(&fetch);
+    printf("✓ Every plane read and parsed\n");
+
+    config.chunked = 1;
+    config.chunk_size = 7;
+    fetch_all(&fetch, &config, 4096);
+    for (i = 0; i < PLANES; i++) {
+        assert(fetch.requests[i].state == FORECAST_FETCH_DONE);
+        assert(fetch.requests[i].http.chunked == 1);
+        assert(strcmp(forecastFetchBody(&fetch, i), body) == 0);
+    }
+    closeForecastFetch(&fetch);
+    printf("✓ Chunked bodies read\n");
+
+    fetch_all(&fetch, &config, 0);
+    production.today = 0;
+    production.tomorrow = 0;
+    for (i = 0; i < PLANES; i++) {
+        assert(fetch.requests[i].state == FORECAST_FETCH_DONE);
+        assert(forecastFetchBody(&fetch, i) == NULL);
+        assert(addParsedProduction(&production, &fetch.requests[i].parser) == 0);
+    }
+    assert(production.today > PLANES * 4674.362 - 1e-6 && production.today < PLANES * 4674.362 + 1e-6);
+    closeForecastFetch(&fetch);
+    printf("✓ Chunked bodies parsed as they arrived\n");
+
+    mock_server_defaults(&config, body);
+    config.latency_ms = 50;
+    config.bytes_per_second = 20000;
+    fetch_all(&fetch, &config, 4096);
+    for (i = 0; i < PLANES; i++) {
+        assert(fetch.requests[i].state == FORECAST_FETCH_DONE);
+        assert(strcmp(forecastFetchBody(&fetch, i), body) == 0);
+    }
+    closeForecastFetch(&fetch);
+    printf("✓ Slow and throttled responses read\n");
+}
+
+// Every second connection fails with fault, the others are read
+void check_fault(char* body, int fault, int state) {
+    struct mock_server_config config;
+    struct ForecastFetch fetch;
+    int i;
+
+    mock_server_defaults(&config, body);
+    config.fault = fault;
+    config.fault_every = 2;
+    fetch_all(&fetch, &config, 4096);
+    for (i = 0; i < PLANES; i++) {
+        if (i % 2 == 1) {
+            assert(fetch.requests[i].state == state);
+            assert(forecastFetchBody(&fetch, i) == NULL);
+        } else {
+            assert(fetch.requests[i].state == FORECAST_FETCH_DONE);
+        }
+    }
+    if (fault == MOCK_SERVER_FAULT_RATE_LIMIT) {
+        assert(fetch.requests[1].http.status == 429);
+        assert(fetch.requests[1].http.retryAfter == 3600);
+    }
+    closeForecastFetch(&fetch);
+}
+
+void test_faults(char* body) {
+    printf("\nTesting failed responses...\n");
+
+    check_fault(body, MOCK_SERVER_FAULT_TRUNCATE, FORECAST_FETCH_CLOSED);
+    printf("✓ Truncated bodies reported\n");
+    check_fault(body, MOCK_SERVER_FAULT_RATE_LIMIT, FORECAST_FETCH_HTTP_ERROR);
+    printf("✓ 429 reported with Retry-After\n");
+    check_fault(body, MOCK_SERVER_FAULT_RESET, FORECAST_FETCH_CLOSED);
+    printf("✓ Reset connections reported\n");
+
+    // Nothing listens on the port of a stopped server
+    struct mock_server_config config;
+    struct mock_server server;
+    struct ForecastFetch fetch;
+    int port;
+
+    mock_server_defaults(&config, body);
+    port = mock_server_start(&server, &config, 0);
+    mock_server_stop(&server);
+    assert(startForecastFetch(&fetch, "127.0.0.1", port, paths, PLANES, 4096, 5, (unsigned int)time(NULL)) == 0);
+    assert(fetch.requests[0].state == FORECAST_FETCH_CONNECT_FAILED);
+    closeForecastFetch(&fetch);
+    printf("✓ Refused connections reported\n");
+}
+
+int main() {
+    printf("Running forecast_mock_server tests...\n\n");
+
+    char* body = read_file(MOCK_RESPONSE_BODY_FILE);
+    assert(body != NULL);
+    test_responses(body);
+    test_faults(body);
+    free(body);
+
+    printf("\nAll tests passed! ✓\n");
+    return 0;
+}
@@ -0,0 +1,101 @@
+// Check if we're using a standard C compiler
+#ifndef PICO_C
+#include "forecast_schedule.h"
+#endif
+
+// Function to prepare a schedule for refreshes of requests requests each
+void initForecastSchedule(struct ForecastSchedule* schedule, int requests, int triggerInterval) {
+    schedule->requests = requests;
+    schedule->triggerInterval = triggerInterval;
+    schedule->limit = FORECAST_SCHEDULE_DEFAULT_LIMIT;
+    schedule->period = FORECAST_SCHEDULE_DEFAULT_PERIOD;
+    schedule->remaining = FORECAST_SCHEDULE_DEFAULT_LIMIT;
+    schedule->periodStart = 0;
+    schedule->blockedUntil = 0;
+    schedule->lastRefresh = 0;
+    schedule->lastDay = -1;
+    schedule->triggered = 0;
+}
+
+// Function to count a refresh made before a restart
+void restoreForecastSchedule(struct ForecastSchedule* schedule, unsigned int refreshedAt, int day) {
+    schedule->lastRefresh = refreshedAt;
+    schedule->lastDay = day;
+}
+
+// Function to ask for a refresh
+void triggerForecastSchedule(struct ForecastSchedule* schedule) {
+    schedule->triggered++;
+}
+
+// Start a new quota period once the current one is over
+void forecastScheduleWindow(struct ForecastSchedule* schedule, unsigned int now) {
+    if (now < schedule->periodStart) return;
+    if (now - schedule->periodStart >= (unsigned int)schedule->period) {
+        schedule->periodStart = now;
+        schedule->remaining = schedule->limit;
+    }
+}
+
+// Seconds per refresh at which the quota is used up exactly
+int forecastScheduleSustained(struct ForecastSchedule* schedule) {
+    if (schedule->limit <= 0) return schedule->period;
+    return schedule->period * schedule->requests / schedule->limit;
+}
+
+// Seconds between scheduled refreshes at a local hour. Morning refreshes
+// follow the weather as it develops, but only while a refresh is left in the
+// current period for a trigger event.
+int forecastScheduleInterval(struct ForecastSchedule* schedule, int hour) {
+    int interval = FORECAST_SCHEDULE_DAY_INTERVAL;
+    int sustained = forecastScheduleSustained(schedule);
+
+    if (hour >= FORECAST_SCHEDULE_MORNING_START && hour < FORECAST_SCHEDULE_MORNING_END
+        && schedule->remaining >= 2 * schedule->requests) {
+        interval = FORECAST_SCHEDULE_MORNING_INTERVAL;
+    }
+    if (interval < sustained) interval = sustained;
+    return interval;
+}
+
+// Function to check whether a refresh should start now
+int forecastScheduleDue(struct ForecastSchedule* schedule, unsigned int now, int day, int hour) {
+    unsigned int elapsed = 0;
+    int spacing;
+
+    forecastScheduleWindow(schedule, now);
+    if (now < schedule->blockedUntil) return 0;
+    if (schedule->remaining < schedule->requests) return 0;
+
+    // The first refresh, and the first of a new day
+    if (schedule->lastDay != day) return 1;
+
+    // A clock set back counts as just refreshed
+    if (now > schedule->lastRefresh) elapsed = now - schedule->lastRefresh;
+    if (elapsed >= (unsigned int)forecastScheduleInterval(schedule, hour)) return 1;
+
+    spacing = forecastScheduleSustained(schedule);
+    if (spacing < schedule->triggerInterval) spacing = schedule->triggerInterval;
+    if (schedule->triggered > 0 && elapsed >= (unsigned int)spacing) return 1;
+    return 0;
+}
+
+// Function to count a refresh against the quota as it starts
+void startForecastRefresh(struct ForecastSchedule* schedule, unsigned int now, int day) {
+    forecastScheduleWindow(schedule, now);
+    schedule->remaining -= schedule->requests;
+    schedule->lastRefresh = now;
+    schedule->lastDay = day;
+    schedule->triggered = 0;
+}
+
+// Function to apply the quota reported by one response. The lowest remaining
+// count wins, responses of one refresh arrive in any order.
+void updateForecastSchedule(struct ForecastSchedule* schedule, unsigned int now, int limit, int period, int remaining, int retryAfter) {
+    if (limit > 0) schedule->limit = limit;
+    if (period > 0) schedule->period = period;
+    if (remaining >= 0 && remaining < schedule->remaining) schedule->remaining = remaining;
+    if (retryAfter > 0 && now + retryAfter > schedule->blockedUntil) {
+        schedule->blockedUntil = now + retryAfter;
+    }
+}
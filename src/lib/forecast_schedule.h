@@ -0,0 +1,53 @@
+#ifndef FORECAST_SCHEDULE_H
+#define FORECAST_SCHEDULE_H
+
+// Decides when the forecast is refreshed. Refreshes are spaced across the day,
+// more often in the morning while the request quota allows it, trigger events
+// are coalesced, and nothing is requested while the quota is used up or the
+// server asked to retry later.
+
+// Refresh intervals by local hour, in seconds
+#define FORECAST_SCHEDULE_MORNING_START 5
+#define FORECAST_SCHEDULE_MORNING_END 12
+#define FORECAST_SCHEDULE_MORNING_INTERVAL (30 * 60)
+#define FORECAST_SCHEDULE_DAY_INTERVAL (3 * 60 * 60)
+
+// Quota assumed until a response reports it, the forecast.solar free tier
+#define FORECAST_SCHEDULE_DEFAULT_LIMIT 12
+#define FORECAST_SCHEDULE_DEFAULT_PERIOD 3600
+
+struct ForecastSchedule {
+    int requests;              // Requests per refresh, one per plane
+    int triggerInterval;       // Least seconds between refreshes asked for by trigger events
+    int limit;                 // Requests per period
+    int period;                // Seconds
+    int remaining;             // Requests estimated to be left in the current period
+    unsigned int periodStart;
+    unsigned int blockedUntil; // From Retry-After, nothing is requested before
+    unsigned int lastRefresh;
+    int lastDay;               // Local day of the last refresh, -1 before the first
+    int triggered;             // Trigger events since the last refresh
+};
+
+// Function to prepare a schedule for refreshes of requests requests each
+void initForecastSchedule(struct ForecastSchedule* schedule, int requests, int triggerInterval);
+
+// Function to count a refresh made before a restart, e.g. one read from the forecast cache
+void restoreForecastSchedule(struct ForecastSchedule* schedule, unsigned int refreshedAt, int day);
+
+// Function to ask for a refresh, events until the next refresh make one refresh
+void triggerForecastSchedule(struct ForecastSchedule* schedule);
+
+// Seconds between scheduled refreshes at a local hour
+int forecastScheduleInterval(struct ForecastSchedule* schedule, int hour);
+
+// Function to check whether a refresh should start now, day and hour are local
+int forecastScheduleDue(struct ForecastSchedule* schedule, unsigned int now, int day, int hour);
+
+// Function to count a refresh against the quota as it starts
+void startForecastRefresh(struct ForecastSchedule* schedule, unsigned int now, int day);
+
+// Function to apply the quota reported by one response, -1 for values it did not report
+void updateForecastSchedule(struct ForecastSchedule* schedule, unsigned int now, int limit, int period, int remaining, int retryAfter);
+
+#endif // FORECAST_SCHEDULE_H
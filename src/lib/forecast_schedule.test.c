@@ -0,0 +1,152 @@
+#include "forecast_schedule.h"
+#include <stdio.h>
+#include <assert.h>
+
+#define DAY 5902
+#define HOUR 3600
+
+// Fake server quota: a fixed window of limit requests per period
+struct fake_quota {
+    int limit;
+    int period;
+    unsigned int start;
+    int used;
+};
+
+// Make one refresh against the fake server, every request reports the quota left
+void refresh(struct ForecastSchedule* schedule, struct fake_quota* quota, unsigned int now) {
+    int i;
+
+    startForecastRefresh(schedule, now, DAY + now / (24 * HOUR));
+    if (now - quota->start >= (unsigned int)quota->period) {
+        quota->start = now;
+        quota->used = 0;
+    }
+    for (i = 0; i < schedule->requests; i++) {
+        quota->used++;
+        assert(quota->used <= quota->limit);
+        updateForecastSchedule(schedule, now, quota->limit, quota->period, quota->limit - quota->used, -1);
+    }
+}
+
+void test_day() {
+    printf("Testing a day of scheduled refreshes...\n");
+
+    struct ForecastSchedule schedule;
+    struct fake_quota quota;
+    int perHour[24];
+    unsigned int now;
+    int refreshes = 0;
+    int i;
+
+    initForecastSchedule(&schedule, 2, 600);
+    quota.limit = 12;
+    quota.period = HOUR;
+    quota.start = 0;
+    quota.used = 0;
+    for (i = 0; i < 24; i++) perHour[i] = 0;
+
+    for (now = 0; now < 24 * HOUR; now += 60) {
+        if (forecastScheduleDue(&schedule, now, DAY, now / HOUR)) {
+            refresh(&schedule, &quota, now);
+            perHour[now / HOUR]++;
+            refreshes++;
+        }
+    }
+    assert(perHour[0] == 1);
+    assert(perHour[3] == 1);
+    assert(perHour[6] == 2);
+    assert(perHour[13] == 0);
+    assert(perHour[14] == 1);
+    assert(refreshes == 20);
+    printf("✓ Refreshed every 30 minutes in the morning and every 3 hours otherwise\n");
+
+    // The date rolling over refreshes at once
+    assert(forecastScheduleDue(&schedule, 24 * HOUR, DAY + 1, 0) == 1);
+    printf("✓ Refreshed on the first minute of a new day\n");
+}
+
+void test_triggers() {
+    printf("\nTesting trigger events...\n");
+
+    struct ForecastSchedule schedule;
+    unsigned int now = 14 * HOUR;
+    int i;
+
+    initForecastSchedule(&schedule, 2, 600);
+    assert(forecastScheduleDue(&schedule, now, DAY, 14) == 1);
+    startForecastRefresh(&schedule, now, DAY);
+    assert(forecastScheduleDue(&schedule, now + 60, DAY, 14) == 0);
+
+    // A burst of events waits for the trigger interval and makes one refresh
+    for (i = 0; i < 10; i++) triggerForecastSchedule(&schedule);
+    assert(forecastScheduleDue(&schedule, now + 599, DAY, 14) == 0);
+    assert(forecastScheduleDue(&schedule, now + 600, DAY, 14) == 1);
+    startForecastRefresh(&schedule, now + 600, DAY);
+    assert(schedule.triggered == 0);
+    assert(forecastScheduleDue(&schedule, now + 1800, DAY, 14) == 0);
+    printf("✓ Burst of events coalesced into one refresh\n");
+
+    // A tight quota spaces triggered refreshes out further
+    initForecastSchedule(&schedule, 2, 600);
+    updateForecastSchedule(&schedule, now, 4, HOUR, -1, -1);
+    startForecastRefresh(&schedule, now, DAY);
+    triggerForecastSchedule(&schedule);
+    assert(forecastScheduleDue(&schedule, now + 600, DAY, 14) == 0);
+    assert(forecastScheduleDue(&schedule, now + 1800, DAY, 14) == 1);
+    printf("✓ Trigger spacing follows the quota\n");
+}
+
+void test_quota() {
+    printf("\nTesting the request quota...\n");
+
+    struct ForecastSchedule schedule;
+    unsigned int now = 8 * HOUR;
+
+    // Used up: nothing until the period is over, even for a new day
+    initForecastSchedule(&schedule, 2, 600);
+    startForecastRefresh(&schedule, now, DAY);
+    updateForecastSchedule(&schedule, now, 12, HOUR, 1, -1);
+    triggerForecastSchedule(&schedule);
+    assert(forecastScheduleDue(&schedule, now + 1800, DAY, 8) == 0);
+    assert(forecastScheduleDue(&schedule, now + 1800, DAY + 1, 8) == 0);
+    assert(forecastScheduleDue(&schedule, now + HOUR, DAY, 9) == 1);
+    printf("✓ Waited for the quota period to end\n");
+
+    // Retry-After holds off every request
+    initForecastSchedule(&schedule, 2, 600);
+    startForecastRefresh(&schedule, now, DAY);
+    updateForecastSchedule(&schedule, now, -1, -1, 0, 2 * HOUR);
+    assert(forecastScheduleDue(&schedule, now + HOUR, DAY + 1, 9) == 0);
+    assert(forecastScheduleDue(&schedule, now + 2 * HOUR - 1, DAY + 1, 9) == 0);
+    assert(forecastScheduleDue(&schedule, now + 2 * HOUR, DAY + 1, 10) == 1);
+    printf("✓ Waited for Retry-After\n");
+
+    // Morning refreshes need a refresh left over for trigger events
+    initForecastSchedule(&schedule, 2, 600);
+    assert(forecastScheduleInterval(&schedule, 8) == FORECAST_SCHEDULE_MORNING_INTERVAL);
+    assert(forecastScheduleInterval(&schedule, 15) == FORECAST_SCHEDULE_DAY_INTERVAL);
+    schedule.remaining = 3;
+    assert(forecastScheduleInterval(&schedule, 8) == FORECAST_SCHEDULE_DAY_INTERVAL);
+    updateForecastSchedule(&schedule, now, 1, 24 * HOUR, -1, -1);
+    assert(forecastScheduleInterval(&schedule, 15) == 2 * 24 * HOUR);
+    printf("✓ Intervals stay within the quota\n");
+
+    // A refresh from before a restart counts
+    initForecastSchedule(&schedule, 2, 600);
+    restoreForecastSchedule(&schedule, now - 60, DAY);
+    assert(forecastScheduleDue(&schedule, now, DAY, 15) == 0);
+    assert(forecastScheduleDue(&schedule, now, DAY + 1, 0) == 1);
+    printf("✓ Restored refresh respected\n");
+}
+
+int main() {
+    printf("Running forecast_schedule tests...\n\n");
+
+    test_day();
+    test_triggers();
+    test_quota();
+
+    printf("\nAll tests passed! ✓\n");
+    return 0;
+}
@@ -2,78 +2,384 @@
 #ifndef PICO_C
 #include "forecast_solar.h"
 #include "nx_json.h"
+#include "forecast_solar_daily.h"
+#include "forecast_solar_ratelimit.h"
+#include "http_reader.h"
 #include <string.h>
 #include <stdio.h>  // Add this for printf function
 #endif
 
-// Function to skip HTTP headers and return pointer to response body
+// Function to skip HTTP headers and return pointer to response body. A response
+// whose status is not 2xx gives NULL, so an error body such as a 429 never
+// reaches the JSON parser. Chunked bodies are not decoded here, responses read
+// through forecast_fetch already are.
 char* skipHeaders(char* response) {
+    struct HttpReader reader;
+    int head;
+
     if (response == NULL) return NULL;
     
-    char* body = strstr(response, "\r\n\r\n");
-    if (body != NULL) {
-        return body + 4; // Skip the delimiter itself
+    // Text without a status line is the body itself
+    if (strncmp(response, "HTTP/", 5) != 0) {
+        return response;
     }
     
-    body = strstr(response, "\n\n");
-    if (body != NULL) {
-        return body + 2;
+    initHttpReader(&reader);
+    head = readHttpHead(&reader, response, strlen(response));
+    if (head < 0) {
+        return NULL;
     }
-    
-    return response; // If no headers found, return original response
+    return response + head;
 }
 
 //void fetchDailyProduction(char* jsonBody, char* todayDate, char* tomorrowDate) {TBD...
 
-// Function to parse daily production from JSON response with debug logging
+// Function to add the day totals of one plane's response to production, the
+// planes of an array accumulate into one result without a DOM per plane.
+// Returns 0, or -1 if the response does not hold both days.
+int addDailyProduction(struct DailyProduction* production, char* jsonBody, char* todayDate, char* tomorrowDate) {
+    // Skip HTTP headers if present
+    char* body = skipHeaders(jsonBody);
+    if (body == NULL) {
+        return -1;
+    }
+    
+    // Pick result.<today> and result.<tomorrow> in one pass with the extractor
+    // generated from forecast_solar_daily.schema, the message subtree is skipped
+    // and no nodes or strings are allocated
+    struct forecast_solar_daily daily;
+    if (forecast_solar_daily_extract(body, strlen(body), &daily, todayDate, tomorrowDate) < 0) {
+        return -1;
+    }
+    
+    if (daily.today_found) {
+        // Convert to Wh
+        production->today += daily.today / 1000.0;
+    }
+    
+    if (daily.tomorrow_found) {
+        // Convert to Wh
+        production->tomorrow += daily.tomorrow / 1000.0;
+    }
+    
+    if (daily.today_found == 0 || daily.tomorrow_found == 0) {
+        return -1;
+    }
+    return 0;
+}
+
+// Function to parse daily production from JSON response
 struct DailyProduction parseDailyProduction(char* jsonBody, char* todayDate, char* tomorrowDate) {
     struct DailyProduction production;
     production.today = 0;  // Initialize today to 0
     production.tomorrow = 0;  // Initialize tomorrow to 0
     
-    // Skip HTTP headers if present
+    addDailyProduction(&production, jsonBody, todayDate, tomorrowDate);
+    return production;
+}
+
+// Function to read message.ratelimit with the extractor generated from
+// forecast_solar_ratelimit.schema. Returns 0, or -1 if the response does not
+// report its quota.
+int parseForecastRateLimit(char* jsonBody, struct ForecastRateLimit* rateLimit) {
+    struct forecast_solar_ratelimit quota;
     char* body = skipHeaders(jsonBody);
+
+    rateLimit->period = -1;
+    rateLimit->limit = -1;
+    rateLimit->remaining = -1;
     if (body == NULL) {
-        return production;
+        return -1;
     }
-    
-    // Parse the JSON response
-    struct nx_json *json = nx_json_parse(body);
-    if (json == NULL) {
-        return production;
+    if (forecast_solar_ratelimit_extract(body, strlen(body), &quota) < 0) {
+        return -1;
     }
-    
-    // Extract the result object which contains the dates
-    struct nx_json *result = nx_json_get(json, "result");
-    if (result == NULL) {
-        nx_json_reset();
-        return production;
+
+    if (quota.period_found) rateLimit->period = quota.period;
+    if (quota.limit_found) rateLimit->limit = quota.limit;
+    if (quota.remaining_found) rateLimit->remaining = quota.remaining;
+    if (quota.limit_found == 0 || quota.remaining_found == 0) {
+        return -1;
     }
-    
-    // Get production values for today and tomorrow by date key
-    struct nx_json *todayProd = nx_json_get(result, todayDate);
+    return 0;
+}
 
-    if (todayProd != NULL) {
-        if (todayProd->type == NX_JSON_INTEGER || todayProd->type == NX_JSON_DOUBLE) {
-            // Convert to Wh
-            production.today = todayProd->u.number_value / 1000.0;
-        }
+// Function to start parsing a body with the streams of both extractors
+void beginForecastParser(struct ForecastParser* parser, char* todayDate, char* tomorrowDate) {
+    forecast_solar_daily_begin(&parser->dailyStream, &parser->daily, todayDate, tomorrowDate);
+    forecast_solar_ratelimit_begin(&parser->quotaStream, &parser->quota);
+    parser->dailyResult = 0;
+    parser->quotaResult = 0;
+}
 
+// Function to pass body bytes to the streams that still want them. A stream
+// stops reading once its fields are complete or the body is malformed.
+void feedForecastParser(struct ForecastParser* parser, char* data, int length) {
+    if (parser->dailyResult == 0) {
+        parser->dailyResult = forecast_solar_daily_feed(&parser->dailyStream, data, length);
     }
-    
-    // Get tomorrow's production value
-    struct nx_json *tomorrowProd = nx_json_get(result, tomorrowDate);
-    
-    if (tomorrowProd != NULL) {
-        if (tomorrowProd->type == NX_JSON_INTEGER || tomorrowProd->type == NX_JSON_DOUBLE) {
-            // Convert to Wh
-            production.tomorrow = tomorrowProd->u.number_value / 1000.0;
+    if (parser->quotaResult == 0) {
+        parser->quotaResult = forecast_solar_ratelimit_feed(&parser->quotaStream, data, length);
+    }
+}
+
+// Function to add the day totals parsed from a body, as addDailyProduction does
+// for a whole one. Returns 0, or -1 if the body does not hold both days.
+int addParsedProduction(struct DailyProduction* production, struct ForecastParser* parser) {
+    if (forecast_solar_daily_finish(&parser->dailyStream) < 0) {
+        return -1;
+    }
+    if (parser->daily.today_found) {
+        production->today += parser->daily.today / 1000.0;
+    }
+    if (parser->daily.tomorrow_found) {
+        production->tomorrow += parser->daily.tomorrow / 1000.0;
+    }
+    if (parser->daily.today_found == 0 || parser->daily.tomorrow_found == 0) {
+        return -1;
+    }
+    return 0;
+}
+
+// Function to read the quota parsed from a body, as parseForecastRateLimit does
+// for a whole one. Returns 0, or -1 if the body does not report its quota.
+int parsedForecastRateLimit(struct ForecastParser* parser, struct ForecastRateLimit* rateLimit) {
+    rateLimit->period = -1;
+    rateLimit->limit = -1;
+    rateLimit->remaining = -1;
+    if (forecast_solar_ratelimit_finish(&parser->quotaStream) < 0) {
+        return -1;
+    }
+
+    if (parser->quota.period_found) rateLimit->period = parser->quota.period;
+    if (parser->quota.limit_found) rateLimit->limit = parser->quota.limit;
+    if (parser->quota.remaining_found) rateLimit->remaining = parser->quota.remaining;
+    if (parser->quota.limit_found == 0 || parser->quota.remaining_found == 0) {
+        return -1;
+    }
+    return 0;
+}
+
+// Days since 2009-01-01, years are counted from March so the leap day comes last
+int forecastSolarDay(int year, int month, int day) {
+    if (month <= 2) {
+        year = year - 1;
+        month = month + 12;
+    }
+    return 365 * year + year / 4 - year / 100 + year / 400 + (153 * (month - 3) + 2) / 5 + day - 733714;
+}
+
+// Function to convert a local date and time to minutes since 2009-01-01 00:00
+int forecastSolarMinute(int year, int month, int day, int hour, int minute) {
+    return forecastSolarDay(year, month, day) * 24 * 60 + hour * 60 + minute;
+}
+
+// Value of count decimal digits at p, or -1 if one is not a digit
+int forecastSolarDigits(char* p, int count) {
+    int value = 0;
+    int i;
+
+    for (i = 0; i < count; i++) {
+        if (p[i] < '0' || p[i] > '9') return -1;
+        value = value * 10 + p[i] - '0';
+    }
+    return value;
+}
+
+// Local minute of a "YYYY-MM-DD HH:MM:SS" key computed from its digits, or -1
+int forecastSolarKeyMinute(char* key, int length) {
+    int year;
+    int month;
+    int day;
+    int hour;
+    int minute;
+
+    if (length < 16 || key[4] != '-' || key[7] != '-' || key[10] != ' ' || key[13] != ':') return -1;
+    year = forecastSolarDigits(key, 4);
+    month = forecastSolarDigits(key + 5, 2);
+    day = forecastSolarDigits(key + 8, 2);
+    hour = forecastSolarDigits(key + 11, 2);
+    minute = forecastSolarDigits(key + 14, 2);
+    if (year < 0 || month < 1 || day < 1 || hour < 0 || minute < 0) return -1;
+    return forecastSolarMinute(year, month, day, hour, minute);
+}
+
+// Spread the production between two timestamps over the slots in between.
+// Power is interpolated linearly between watts samples, a watthours period is
+// spread evenly over the minutes it covers.
+void addProduction(struct ProductionSeries* series, int kind, int from, int to, double fromValue, double toValue) {
+    double fromWatts = fromValue;
+    double toWatts = toValue;
+    double watts;
+    double nextWatts;
+    int slot;
+    int a;
+    int b;
+
+    if (kind == FORECAST_SOLAR_WATTHOURS_PERIOD) {
+        // The first period has no start, its energy goes to the minute before
+        if (from < 0 || from >= to) from = to - 1;
+        fromWatts = toValue * 60 / (to - from);
+        toWatts = fromWatts;
+    } else if (from < 0) {
+        return;
+    }
+    if (from >= to || (fromWatts == 0 && toWatts == 0)) return;
+
+    a = from;
+    if (a < series->start) a = series->start;
+    while (a < to) {
+        slot = (a - series->start) / series->step;
+        if (slot >= FORECAST_SOLAR_SERIES_SLOTS) return;
+        b = series->start + (slot + 1) * series->step;
+        if (b > to) b = to;
+        watts = fromWatts + (toWatts - fromWatts) * (a - from) / (to - from);
+        nextWatts = fromWatts + (toWatts - fromWatts) * (b - from) / (to - from);
+        series->energy[slot] += (watts + nextWatts) / 2 * (b - a) / 60;
+        a = b;
+    }
+}
+
+// Function to empty a series before planes are added to it
+void clearProductionSeries(struct ProductionSeries* series, int step) {
+    series->start = 0;
+    series->step = step;
+    series->length = 0;
+    series->total[0] = 0;
+    memset(series->energy, 0, sizeof(series->energy));
+}
+
+// Function to parse a watts or watthours/period response into an empty series
+int parseProductionSeries(char* response, int kind, int step, struct ProductionSeries* series) {
+    clearProductionSeries(series, step);
+    return addProductionSeries(response, kind, series);
+}
+
+// Function to add one plane's watts or watthours/period response to a series.
+// Timestamp keys are turned into slot indexes arithmetically, the message
+// subtree is skipped. The first response added fixes the start of the series.
+// Returns the number of timestamps read or -1 if the response is malformed.
+int addProductionSeries(char* response, int kind, struct ProductionSeries* series) {
+    enum nx_json_type type;
+    double number;
+    NX_JSON_INT integer;
+    double previousValue = 0;
+    int previous = -1;
+    int stored = 0;
+    int minute;
+    int slot;
+    int found;
+    int i;
+    char* keyEnd;
+    char* end;
+    char* p;
+
+    // Skip HTTP headers if present
+    char* body = skipHeaders(response);
+    if (body == NULL || series->step <= 0) {
+        return -1;
+    }
+    end = body + strlen(body);
+    p = body + nx_json_scan_space(body, end);
+    if (p >= end || *p != '{') {
+        return -1;
+    }
+
+    // Find the result object among the top-level members
+    found = 0;
+    p++;
+    while (found == 0) {
+        p += nx_json_scan_space(p, end);
+        if (p >= end || *p != '"') return -1;
+        keyEnd = nx_json_scan_string_end(p, end);
+        if (keyEnd == NULL) return -1;
+        if (keyEnd - p == 8 && memcmp(p, "\"result\"", 8) == 0) found = 1;
+        p = keyEnd + nx_json_scan_space(keyEnd, end);
+        if (p >= end || *p != ':') return -1;
+        p++;
+        p += nx_json_scan_space(p, end);
+        if (p >= end) return -1;
+        if (found == 0) {
+            p = nx_json_scan_value_end(p, end);
+            if (p == NULL) return -1;
+            p += nx_json_scan_space(p, end);
+            if (p >= end || *p != ',') return -1;
+            p++;
+        }
+    }
+    if (*p != '{') {
+        return -1;
+    }
+    p++;
+    p += nx_json_scan_space(p, end);
+
+    // Timestamps come in ascending order, each one adds the production since the previous
+    while (p < end && *p == '"') {
+        keyEnd = nx_json_scan_string_end(p, end);
+        if (keyEnd == NULL) return -1;
+        minute = forecastSolarKeyMinute(p + 1, keyEnd - p - 2);
+        p = keyEnd + nx_json_scan_space(keyEnd, end);
+        if (p >= end || *p != ':') return -1;
+        p++;
+        p += nx_json_scan_space(p, end);
+        if (p >= end || (*p != '-' && (*p < '0' || *p > '9'))) return -1;
+        p = nx_json_scan_number(p, end, &type, &number, &integer);
+        if (p == NULL) return -1;
+        if (type == NX_JSON_INTEGER) number = (double)integer;
+
+        if (minute >= 0) {
+            if (stored == 0 && series->length == 0) series->start = minute - minute % (24 * 60);
+            addProduction(series, kind, previous, minute, previousValue, number);
+            slot = (minute - series->start) / series->step + 1;
+            if (slot > FORECAST_SOLAR_SERIES_SLOTS) slot = FORECAST_SOLAR_SERIES_SLOTS;
+            if (slot > series->length) series->length = slot;
+            previous = minute;
+            previousValue = number;
+            stored++;
         }
 
+        p += nx_json_scan_space(p, end);
+        if (p < end && *p == ',') {
+            p++;
+            p += nx_json_scan_space(p, end);
+        } else {
+            break;
+        }
     }
-    
-    // Clean up our node allocation
-    nx_json_reset();
-    
-    return production;
-} 
\ No newline at end of file
+    if (p >= end || *p != '}') {
+        return -1;
+    }
+
+    // Running totals make any window a difference of two reads
+    for (i = 0; i < series->length; i++) {
+        series->total[i + 1] = series->total[i] + series->energy[i];
+    }
+    return stored;
+}
+
+// Wh expected before a local minute
+double productionBefore(struct ProductionSeries* series, int minute) {
+    int offset = minute - series->start;
+    int slot;
+
+    if (offset <= 0 || series->length == 0) return 0;
+    slot = offset / series->step;
+    if (slot >= series->length) return series->total[series->length];
+    return series->total[slot] + series->energy[slot] * (offset - slot * series->step) / series->step;
+}
+
+// Function to get the Wh expected between two local minutes
+double productionBetween(struct ProductionSeries* series, int from, int to) {
+    return productionBefore(series, to) - productionBefore(series, from);
+}
+
+// Function to get the average power in W expected in the slot holding a local minute
+double productionPower(struct ProductionSeries* series, int minute) {
+    int offset = minute - series->start;
+    int slot;
+
+    if (offset < 0) return 0;
+    slot = offset / series->step;
+    if (slot >= series->length) return 0;
+    return series->energy[slot] * 60 / series->step;
+}
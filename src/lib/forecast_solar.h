@@ -1,16 +1,103 @@
 #ifndef FORECAST_SOLAR_H
 #define FORECAST_SOLAR_H
 
+// Check if we're using a standard C compiler
+#ifndef PICO_C
+#include "forecast_solar_daily.h"
+#include "forecast_solar_ratelimit.h"
+#endif
+
 // Structure to hold production values
 struct DailyProduction {
     double today;
     double tomorrow;
 };
 
+// Kinds of time series responses
+#define FORECAST_SOLAR_WATTS 0             // /estimate/watts, power in W at each timestamp
+#define FORECAST_SOLAR_WATTHOURS_PERIOD 1  // /estimate/watthours/period, Wh since the previous timestamp
+
+// Capacity of a production series, four days at 15 minute resolution
+#define FORECAST_SOLAR_SERIES_STEP 15
+#define FORECAST_SOLAR_SERIES_SLOTS (4 * 24 * 60 / FORECAST_SOLAR_SERIES_STEP)
+
+// Production in fixed time slots. Times are local minutes since 2009-01-01 00:00
+// (see forecastSolarMinute), slot i covers [start + i * step, start + (i + 1) * step).
+struct ProductionSeries {
+    int start;   // Local minute of the first slot, midnight of the first day in the response
+    int step;    // Minutes per slot
+    int length;  // Slots up to the last timestamp in the response
+    float energy[FORECAST_SOLAR_SERIES_SLOTS];     // Wh produced within each slot
+    float total[FORECAST_SOLAR_SERIES_SLOTS + 1];  // Wh produced before each slot
+};
+
 // Function to skip HTTP headers and return pointer to response body
 char* skipHeaders(char* response);
 
+// One orientation of a PV array, values as the forecast.solar API takes them
+struct PanelPlane {
+    char* name;
+    char* slope;    // Degrees from horizontal
+    char* azimuth;  // Degrees from south, -90 is east
+    char* kwp;      // Installed peak power
+};
+
 // Function to parse daily production from JSON response
 struct DailyProduction parseDailyProduction(char* response, char* todayDate, char* tomorrowDate);
 
+// Function to add the day totals of one plane to production, returns 0 or -1
+int addDailyProduction(struct DailyProduction* production, char* response, char* todayDate, char* tomorrowDate);
+
+// Request quota reported in message.ratelimit of a response, -1 where missing
+struct ForecastRateLimit {
+    int period;     // Seconds
+    int limit;      // Requests per period
+    int remaining;  // Requests left in the current period
+};
+
+// Function to read the request quota of a response, returns 0, or -1 if it is not reported
+int parseForecastRateLimit(char* response, struct ForecastRateLimit* rateLimit);
+
+// Day totals and quota of one response body, parsed as the body arrives. Only the
+// streams of the generated extractors are kept, never the body.
+struct ForecastParser {
+    struct forecast_solar_daily daily;
+    struct forecast_solar_daily_stream dailyStream;
+    int dailyResult;     // Last result of forecast_solar_daily_feed
+    struct forecast_solar_ratelimit quota;
+    struct forecast_solar_ratelimit_stream quotaStream;
+    int quotaResult;     // Last result of forecast_solar_ratelimit_feed
+};
+
+// Function to start parsing a body, the dates must stay valid until the last feed
+void beginForecastParser(struct ForecastParser* parser, char* todayDate, char* tomorrowDate);
+
+// Function to parse the next bytes of the body, of any length
+void feedForecastParser(struct ForecastParser* parser, char* data, int length);
+
+// Function to add the day totals of a complete body to production, returns 0 or -1 like addDailyProduction
+int addParsedProduction(struct DailyProduction* production, struct ForecastParser* parser);
+
+// Function to read the quota of a complete body, returns 0 or -1 like parseForecastRateLimit
+int parsedForecastRateLimit(struct ForecastParser* parser, struct ForecastRateLimit* rateLimit);
+
+// Local days since 2009-01-01, e.g. from getyear/getmonth/getday(getcurrenttime(), 1)
+int forecastSolarDay(int year, int month, int day);
+
+// Local minutes since 2009-01-01 00:00, e.g. from getyear/getmonth/getday/gethour/getminute(getcurrenttime(), 1)
+int forecastSolarMinute(int year, int month, int day, int hour, int minute);
+
+// Function to parse a watts or watthours/period response into slots of step minutes
+int parseProductionSeries(char* response, int kind, int step, struct ProductionSeries* series);
+
+// Function to empty a series and add the response of each plane to it
+void clearProductionSeries(struct ProductionSeries* series, int step);
+int addProductionSeries(char* response, int kind, struct ProductionSeries* series);
+
+// Wh expected between two local minutes
+double productionBetween(struct ProductionSeries* series, int from, int to);
+
+// Average power in W expected in the slot holding a local minute
+double productionPower(struct ProductionSeries* series, int minute);
+
 #endif // FORECAST_SOLAR_H 
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <math.h>
 
 // Helper function to read file content
 char* read_file(const char* filename) {
@@ -49,6 +50,11 @@ void test_skip_headers() {
     assert(body == json_start);
     printf("✓ Correctly handled response without headers\n");
     
+    // Test with an error status
+    char limited[] = "HTTP/1.1 429 Too Many Requests\r\nRetry-After: 3600\r\n\r\n{\"message\":{}}";
+    assert(skipHeaders(limited) == NULL);
+    printf("✓ Correctly rejected an error response\n");
+    
     // Test with NULL input
     body = skipHeaders(NULL);
     assert(body == NULL);
@@ -92,11 +98,189 @@ void test_parse_daily_production() {
     printf("✓ Correctly handled NULL input\n");
 }
 
+void test_add_daily_production() {
+    printf("\nTesting addDailyProduction function...\n");
+
+    char* json_response = read_file(MOCK_RESPONSE_BODY_FILE);
+    char* response_with_headers = read_file(MOCK_RESPONSE_FILE);
+    assert(json_response != NULL && response_with_headers != NULL);
+
+    // Planes accumulate into one result
+    struct DailyProduction total;
+    total.today = 0;
+    total.tomorrow = 0;
+    assert(addDailyProduction(&total, json_response, "2025-02-27", "2025-02-28") == 0);
+    assert(addDailyProduction(&total, response_with_headers, "2025-02-27", "2025-02-28") == 0);
+    assert(fabs(total.today - 2 * 4674.362) < 1e-9);
+    assert(fabs(total.tomorrow - 2 * 4774.208) < 1e-9);
+    printf("✓ Successfully added two planes\n");
+
+    // A failed plane is reported and adds nothing
+    assert(addDailyProduction(&total, NULL, "2025-02-27", "2025-02-28") == -1);
+    assert(addDailyProduction(&total, "{\"message\":{}}", "2025-02-27", "2025-02-28") == -1);
+    assert(fabs(total.today - 2 * 4674.362) < 1e-9);
+    assert(fabs(total.tomorrow - 2 * 4774.208) < 1e-9);
+    printf("✓ Correctly handled failed planes\n");
+
+    free(json_response);
+    free(response_with_headers);
+}
+
+void test_parse_rate_limit() {
+    printf("\nTesting parseForecastRateLimit function...\n");
+
+    char* json_response = read_file(MOCK_RESPONSE_BODY_FILE);
+    char* response_with_headers = read_file(MOCK_RESPONSE_FILE);
+    assert(json_response != NULL && response_with_headers != NULL);
+
+    struct ForecastRateLimit rateLimit;
+    assert(parseForecastRateLimit(json_response, &rateLimit) == 0);
+    assert(rateLimit.period == 3600);
+    assert(rateLimit.limit == 12);
+    assert(rateLimit.remaining == 11);
+    assert(parseForecastRateLimit(response_with_headers, &rateLimit) == 0);
+    assert(rateLimit.remaining == 11);
+    printf("✓ Successfully read message.ratelimit\n");
+
+    assert(parseForecastRateLimit("{\"result\":{}}", &rateLimit) == -1);
+    assert(rateLimit.period == -1 && rateLimit.limit == -1 && rateLimit.remaining == -1);
+    assert(parseForecastRateLimit(NULL, &rateLimit) == -1);
+    printf("✓ Correctly handled responses without a quota\n");
+
+    free(json_response);
+    free(response_with_headers);
+}
+
+void test_forecast_parser() {
+    printf("\nTesting ForecastParser...\n");
+
+    char* json_response = read_file(MOCK_RESPONSE_BODY_FILE);
+    assert(json_response != NULL);
+    int length = strlen(json_response);
+    struct ForecastParser parser;
+    struct ForecastRateLimit rateLimit;
+    struct DailyProduction total;
+    int chunk;
+    int offset;
+
+    // Any chunking gives the values of the whole body
+    for (chunk = 1; chunk <= length; chunk++) {
+        beginForecastParser(&parser, "2025-02-27", "2025-02-28");
+        for (offset = 0; offset < length; offset += chunk) {
+            feedForecastParser(&parser, json_response + offset, length - offset < chunk ? length - offset : chunk);
+        }
+        total.today = 0;
+        total.tomorrow = 0;
+        assert(addParsedProduction(&total, &parser) == 0);
+        assert(total.today == 4674.362 && total.tomorrow == 4774.208);
+        assert(parsedForecastRateLimit(&parser, &rateLimit) == 0);
+        assert(rateLimit.period == 3600 && rateLimit.limit == 12 && rateLimit.remaining == 11);
+    }
+    printf("✓ Day totals and quota read from chunks of every size\n");
+
+    // A body cut before the second day, or malformed, is not complete
+    beginForecastParser(&parser, "2025-02-27", "2025-02-28");
+    feedForecastParser(&parser, json_response, strstr(json_response, "2025-02-28") - json_response);
+    assert(addParsedProduction(&total, &parser) == -1);
+    assert(parsedForecastRateLimit(&parser, &rateLimit) == -1);
+    total.today = 0;
+    total.tomorrow = 0;
+    beginForecastParser(&parser, "2025-02-27", "2025-02-28");
+    feedForecastParser(&parser, "{\"result\":[", 11);
+    assert(addParsedProduction(&total, &parser) == -1);
+    assert(parsedForecastRateLimit(&parser, &rateLimit) == -1);
+    assert(rateLimit.remaining == -1);
+    assert(total.today == 0 && total.tomorrow == 0);
+    printf("✓ Correctly handled incomplete and malformed bodies\n");
+
+    free(json_response);
+}
+
+void test_forecast_solar_minute() {
+    printf("\nTesting forecastSolarMinute function...\n");
+
+    assert(forecastSolarMinute(2009, 1, 1, 0, 0) == 0);
+    assert(forecastSolarMinute(2009, 3, 1, 6, 30) == 59 * 1440 + 390);
+    assert(forecastSolarMinute(2024, 3, 1, 0, 0) - forecastSolarMinute(2024, 2, 28, 0, 0) == 2 * 1440);
+    assert(forecastSolarMinute(2025, 1, 1, 0, 0) - forecastSolarMinute(2024, 12, 31, 23, 59) == 1);
+    printf("✓ Local minutes count leap days and year ends\n");
+}
+
+void test_parse_production_series() {
+    printf("\nTesting parseProductionSeries function...\n");
+
+    int day = forecastSolarMinute(2025, 2, 27, 0, 0);
+    int nextDay = forecastSolarMinute(2025, 2, 28, 0, 0);
+    struct ProductionSeries watts;
+    struct ProductionSeries period;
+
+    // Power samples are interpolated into 15 minute slots
+    char* json_watts = read_file(MOCK_WATTS_FILE);
+    assert(json_watts != NULL);
+    assert(parseProductionSeries(json_watts, FORECAST_SOLAR_WATTS, 15, &watts) == 26);
+    assert(watts.start == day);
+    assert(watts.step == 15);
+    assert(watts.length == (1440 + 17 * 60 + 45) / 15 + 1);
+    assert(fabs(productionBetween(&watts, day, nextDay) - 28167.47) < 0.1);
+    assert(productionPower(&watts, day + 3 * 60) == 0);
+    assert(productionPower(&watts, day + 12 * 60 + 5) > 3900 && productionPower(&watts, day + 12 * 60 + 5) < 4100);
+    printf("✓ Successfully parsed watts response\n");
+
+    // Watthours periods are spread over the slots they cover
+    char* json_period = read_file(MOCK_WATTHOURS_PERIOD_FILE);
+    assert(json_period != NULL);
+    assert(parseProductionSeries(json_period, FORECAST_SOLAR_WATTHOURS_PERIOD, 15, &period) == 26);
+    assert(period.start == day);
+    assert(period.length == watts.length);
+    assert(fabs(productionBetween(&period, day, nextDay) - 28167) < 0.1);
+    assert(fabs(productionBetween(&period, nextDay, nextDay + 1440) - 24848) < 0.1);
+    assert(fabs(productionBetween(&period, day + 12 * 60, day + 13 * 60) - 4050) < 0.01);
+    assert(fabs(productionPower(&period, day + 12 * 60 + 20) - 4050) < 0.01);
+    printf("✓ Successfully parsed watthours/period response\n");
+
+    // Both responses describe the same day
+    assert(fabs(productionBetween(&watts, day, nextDay) - productionBetween(&period, day, nextDay)) < 1);
+    printf("✓ Watts and watthours/period day totals agree\n");
+
+    // Windows may start and end inside slots and reach outside the series
+    assert(productionBetween(&period, day - 1440, day + 6 * 60) == 0);
+    assert(fabs(productionBetween(&period, day + 12 * 60 + 30, day + 13 * 60 + 30) - (4050 + 3816) / 2.0) < 0.01);
+    assert(fabs(productionBetween(&period, day, day + 10 * 1440) - (28167 + 24848)) < 0.1);
+    printf("✓ Windows are read from running totals\n");
+
+    // Planes accumulate into one series
+    struct ProductionSeries planes;
+    clearProductionSeries(&planes, 15);
+    assert(addProductionSeries(json_period, FORECAST_SOLAR_WATTHOURS_PERIOD, &planes) == 26);
+    assert(addProductionSeries(json_watts, FORECAST_SOLAR_WATTS, &planes) == 26);
+    assert(planes.start == day && planes.length == period.length);
+    assert(fabs(productionBetween(&planes, day, nextDay) - 28167 - 28167.47) < 0.2);
+    printf("✓ Successfully added two planes\n");
+
+    // Malformed responses
+    struct ProductionSeries bad;
+    assert(parseProductionSeries(NULL, FORECAST_SOLAR_WATTS, 15, &bad) == -1);
+    assert(parseProductionSeries("{\"message\":{}}", FORECAST_SOLAR_WATTS, 15, &bad) == -1);
+    assert(parseProductionSeries("{\"result\":[1]}", FORECAST_SOLAR_WATTS, 15, &bad) == -1);
+    assert(parseProductionSeries("{\"result\":{\"2025-02-27 07:00:00\":\"x\"}}", FORECAST_SOLAR_WATTS, 15, &bad) == -1);
+    assert(parseProductionSeries("{\"result\":{}}", FORECAST_SOLAR_WATTS, 15, &bad) == 0);
+    assert(bad.length == 0 && productionBetween(&bad, 0, 1440) == 0);
+    printf("✓ Correctly handled malformed responses\n");
+
+    free(json_watts);
+    free(json_period);
+}
+
 int main() {
     printf("Running forecast_solar tests...\n\n");
     
     test_skip_headers();
     test_parse_daily_production();
+    test_add_daily_production();
+    test_parse_rate_limit();
+    test_forecast_parser();
+    test_forecast_solar_minute();
+    test_parse_production_series();
     
     printf("\nAll tests passed! ✓\n");
     return 0;
@@ -0,0 +1,295 @@
+// Check if we're using a standard C compiler
+#ifndef PICO_C
+#include "http_reader.h"
+#include <string.h>
+#endif
+
+// Parts of a response, in the order they are read
+#define HTTP_PART_STATUS 0           // Status line
+#define HTTP_PART_NAME 1             // Header name, or the empty line ending the headers
+#define HTTP_PART_VALUE 2            // Header value
+#define HTTP_PART_BODY 3             // Body of Content-Length bytes, or until the connection ends
+#define HTTP_PART_CHUNK_SIZE 4       // Hex size line of a chunk
+#define HTTP_PART_CHUNK_EXTENSION 5  // Rest of the size line after ';'
+#define HTTP_PART_CHUNK_DATA 6
+#define HTTP_PART_CHUNK_END 7        // Line break after the chunk data
+#define HTTP_PART_TRAILER 8          // Trailer lines after the last chunk
+
+// Function to prepare a reader for a new response
+void initHttpReader(struct HttpReader* reader) {
+    reader->state = HTTP_READER_READING;
+    reader->status = 0;
+    reader->contentLength = -1;
+    reader->chunked = 0;
+    reader->retryAfter = -1;
+    reader->rateLimit = -1;
+    reader->rateRemaining = -1;
+    reader->ratePeriod = -1;
+    reader->bodyLength = 0;
+    reader->part = HTTP_PART_STATUS;
+    reader->remaining = 0;
+    reader->nameLength = 0;
+    reader->valueLength = 0;
+}
+
+// Whole header value as a non-negative number, or -1
+int httpReaderNumber(struct HttpReader* reader) {
+    int value = 0;
+    int i;
+
+    if (reader->valueLength == 0 || reader->valueLength >= HTTP_READER_FIELD_SIZE) return -1;
+    for (i = 0; i < reader->valueLength; i++) {
+        if (reader->value[i] < '0' || reader->value[i] > '9') {
+            // Trailing spaces are allowed
+            if (reader->value[i] == ' ' || reader->value[i] == '\t') break;
+            return -1;
+        }
+        value = value * 10 + reader->value[i] - '0';
+    }
+    return value;
+}
+
+// Whether the header just read has the given lowercase name
+int httpReaderIsHeader(struct HttpReader* reader, char* name) {
+    int length = strlen(name);
+    return reader->nameLength == length && memcmp(reader->name, name, length) == 0;
+}
+
+// Take what is needed from the header just read
+void httpReaderHeader(struct HttpReader* reader) {
+    char* chunked = "chunked";
+    int end;
+    int i;
+
+    if (reader->nameLength >= HTTP_READER_FIELD_SIZE) return;
+    if (httpReaderIsHeader(reader, "content-length")) {
+        reader->contentLength = httpReaderNumber(reader);
+        if (reader->contentLength < 0) reader->state = HTTP_READER_MALFORMED;
+    } else if (httpReaderIsHeader(reader, "transfer-encoding")) {
+        // The last coding is the one applied to the message
+        end = reader->valueLength;
+        while (end > 0 && (reader->value[end - 1] == ' ' || reader->value[end - 1] == '\t')) end--;
+        reader->chunked = 0;
+        if (end >= 7) {
+            reader->chunked = 1;
+            for (i = 0; i < 7; i++) {
+                if ((reader->value[end - 7 + i] | 0x20) != chunked[i]) reader->chunked = 0;
+            }
+        }
+    } else if (httpReaderIsHeader(reader, "retry-after")) {
+        reader->retryAfter = httpReaderNumber(reader);
+    } else if (httpReaderIsHeader(reader, "x-ratelimit-limit")) {
+        reader->rateLimit = httpReaderNumber(reader);
+    } else if (httpReaderIsHeader(reader, "x-ratelimit-remaining")) {
+        reader->rateRemaining = httpReaderNumber(reader);
+    } else if (httpReaderIsHeader(reader, "x-ratelimit-period")) {
+        reader->ratePeriod = httpReaderNumber(reader);
+    }
+}
+
+// Decide how the body is framed once the empty line after the headers is read
+void httpReaderHeadEnd(struct HttpReader* reader) {
+    if (reader->status >= 100 && reader->status < 200) {
+        // Informational response, the real one follows
+        reader->part = HTTP_PART_STATUS;
+        reader->valueLength = 0;
+        reader->contentLength = -1;
+        reader->chunked = 0;
+        return;
+    }
+    if (reader->status < 200 || reader->status >= 300) {
+        reader->state = HTTP_READER_STATUS_ERROR;
+        return;
+    }
+    if (reader->chunked) {
+        reader->part = HTTP_PART_CHUNK_SIZE;
+        reader->valueLength = 0;
+        reader->remaining = 0;
+    } else {
+        reader->part = HTTP_PART_BODY;
+        reader->remaining = reader->contentLength;
+        if (reader->remaining == 0 || reader->status == 204) reader->state = HTTP_READER_DONE;
+    }
+}
+
+// Status code from the status line collected in value, "HTTP/1.x 200 ..."
+void httpReaderStatusLine(struct HttpReader* reader) {
+    int i;
+
+    reader->status = 0;
+    if (reader->valueLength < 12 || memcmp(reader->value, "HTTP/1.", 7) != 0 || reader->value[8] != ' ') {
+        reader->state = HTTP_READER_MALFORMED;
+        return;
+    }
+    for (i = 9; i < 12; i++) {
+        if (reader->value[i] < '0' || reader->value[i] > '9') {
+            reader->state = HTTP_READER_MALFORMED;
+            return;
+        }
+        reader->status = reader->status * 10 + reader->value[i] - '0';
+    }
+    reader->part = HTTP_PART_NAME;
+    reader->nameLength = 0;
+}
+
+// Function to read only the status line and headers, one byte at a time since
+// they are short. Returns the bytes consumed, or -1 if the headers are not complete.
+int readHttpHead(struct HttpReader* reader, char* data, int length) {
+    char c;
+    int i;
+
+    for (i = 0; i < length && reader->state == HTTP_READER_READING && reader->part <= HTTP_PART_VALUE; i++) {
+        c = data[i];
+        if (c == '\r') continue;
+
+        if (reader->part == HTTP_PART_STATUS) {
+            if (c == '\n') {
+                httpReaderStatusLine(reader);
+            } else if (reader->valueLength < HTTP_READER_FIELD_SIZE) {
+                reader->value[reader->valueLength++] = c;
+            }
+        } else if (reader->part == HTTP_PART_NAME) {
+            if (c == '\n') {
+                // An empty line ends the headers, a line without a colon is skipped
+                if (reader->nameLength == 0) httpReaderHeadEnd(reader);
+                reader->nameLength = 0;
+            } else if (c == ':') {
+                reader->part = HTTP_PART_VALUE;
+                reader->valueLength = 0;
+            } else {
+                if (reader->nameLength < HTTP_READER_FIELD_SIZE) {
+                    if (c >= 'A' && c <= 'Z') c = c + 'a' - 'A';
+                    reader->name[reader->nameLength] = c;
+                }
+                reader->nameLength++;
+            }
+        } else {
+            if (c == '\n') {
+                httpReaderHeader(reader);
+                reader->part = HTTP_PART_NAME;
+                reader->nameLength = 0;
+            } else if ((c == ' ' || c == '\t') && reader->valueLength == 0) {
+                // Leading white space is not part of the value
+            } else if (reader->valueLength < HTTP_READER_FIELD_SIZE) {
+                reader->value[reader->valueLength++] = c;
+            }
+        }
+    }
+
+    if (reader->state == HTTP_READER_MALFORMED || reader->part <= HTTP_PART_VALUE) return -1;
+    return i;
+}
+
+// Move count body bytes from data + from to data + to, to <= from so a forward copy is safe
+void httpReaderMove(char* data, int to, int from, int count) {
+    int i;
+
+    if (to == from) return;
+    for (i = 0; i < count; i++) {
+        data[to + i] = data[from + i];
+    }
+}
+
+// Function to feed received bytes. Returns the number of body bytes now at the start of data.
+int feedHttpReader(struct HttpReader* reader, char* data, int length) {
+    int in = 0;
+    int out = 0;
+    int head;
+    int count;
+    char c;
+
+    if (reader->state != HTTP_READER_READING) return 0;
+    if (reader->part <= HTTP_PART_VALUE) {
+        head = readHttpHead(reader, data, length);
+        if (head < 0) return 0;
+        in = head;
+    }
+
+    while (in < length && reader->state == HTTP_READER_READING) {
+        if (reader->part == HTTP_PART_BODY || reader->part == HTTP_PART_CHUNK_DATA) {
+            // Data is moved in runs, up to the end of the body or chunk
+            count = length - in;
+            if (reader->remaining >= 0 && count > reader->remaining) count = reader->remaining;
+            httpReaderMove(data, out, in, count);
+            in += count;
+            out += count;
+            if (reader->remaining >= 0) reader->remaining -= count;
+            if (reader->remaining == 0) {
+                if (reader->part == HTTP_PART_BODY) {
+                    reader->state = HTTP_READER_DONE;
+                } else {
+                    reader->part = HTTP_PART_CHUNK_END;
+                }
+            }
+            continue;
+        }
+
+        c = data[in++];
+        if (c == '\r') continue;
+
+        if (reader->part == HTTP_PART_CHUNK_SIZE) {
+            if (c == '\n') {
+                if (reader->valueLength == 0) {
+                    reader->state = HTTP_READER_MALFORMED;
+                } else if (reader->remaining == 0) {
+                    reader->part = HTTP_PART_TRAILER;
+                    reader->nameLength = 0;
+                } else {
+                    reader->part = HTTP_PART_CHUNK_DATA;
+                }
+            } else if (c == ';' || c == ' ' || c == '\t') {
+                reader->part = HTTP_PART_CHUNK_EXTENSION;
+            } else if (reader->valueLength >= 7) {
+                // Chunks of 256 MB or more are not expected
+                reader->state = HTTP_READER_MALFORMED;
+            } else if (c >= '0' && c <= '9') {
+                reader->remaining = reader->remaining * 16 + c - '0';
+                reader->valueLength++;
+            } else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+                reader->remaining = reader->remaining * 16 + (c | 0x20) - 'a' + 10;
+                reader->valueLength++;
+            } else {
+                reader->state = HTTP_READER_MALFORMED;
+            }
+        } else if (reader->part == HTTP_PART_CHUNK_EXTENSION) {
+            if (c == '\n') {
+                reader->part = HTTP_PART_CHUNK_SIZE;
+                in--;
+            }
+        } else if (reader->part == HTTP_PART_CHUNK_END) {
+            if (c == '\n') {
+                reader->part = HTTP_PART_CHUNK_SIZE;
+                reader->valueLength = 0;
+                reader->remaining = 0;
+            } else {
+                reader->state = HTTP_READER_MALFORMED;
+            }
+        } else if (reader->part == HTTP_PART_TRAILER) {
+            if (c != '\n') {
+                reader->nameLength++;
+            } else if (reader->nameLength == 0) {
+                reader->state = HTTP_READER_DONE;
+            } else {
+                reader->nameLength = 0;
+            }
+        }
+    }
+
+    reader->bodyLength += out;
+    return out;
+}
+
+// Function to check whether the reader is in a body that only ends when the connection does
+int httpReaderUntilClose(struct HttpReader* reader) {
+    return reader->state == HTTP_READER_READING && reader->part == HTTP_PART_BODY && reader->remaining < 0;
+}
+
+// Function to tell the reader the connection ended
+void closeHttpReader(struct HttpReader* reader) {
+    if (reader->state != HTTP_READER_READING) return;
+    if (httpReaderUntilClose(reader)) {
+        reader->state = HTTP_READER_DONE;
+    } else {
+        reader->state = HTTP_READER_TRUNCATED;
+    }
+}
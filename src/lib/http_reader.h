@@ -0,0 +1,55 @@
+#ifndef HTTP_READER_H
+#define HTTP_READER_H
+
+// Incremental HTTP/1.x response reader. Bytes are fed as they arrive, in
+// chunks of any size, and pass through the reader once: the status line and
+// the headers below are picked up on the way, and the body is de-chunked in
+// place so the caller can hand it straight to a consumer.
+
+// Reader states
+#define HTTP_READER_READING 0       // More bytes are expected
+#define HTTP_READER_DONE 1          // Complete response with a 2xx status
+#define HTTP_READER_STATUS_ERROR 2  // Headers complete, status is not 2xx, the body is not read
+#define HTTP_READER_MALFORMED 3     // Not a valid HTTP/1.x response
+#define HTTP_READER_TRUNCATED 4     // Connection ended before the body was complete
+
+// Header names and values longer than this are not recognised
+#define HTTP_READER_FIELD_SIZE 32
+
+struct HttpReader {
+    int state;
+    int status;          // Status code, 0 until the status line is read
+    int contentLength;   // Content-Length, -1 if not sent
+    int chunked;         // Transfer-Encoding: chunked
+    int retryAfter;      // Retry-After in seconds, -1 if not sent or given as a date
+    int rateLimit;       // X-Ratelimit-Limit, -1 if not sent
+    int rateRemaining;   // X-Ratelimit-Remaining, -1 if not sent
+    int ratePeriod;      // X-Ratelimit-Period in seconds, -1 if not sent
+    int bodyLength;      // Body bytes returned so far
+    int part;            // Part of the response being read
+    int remaining;       // Bytes left in the body or the current chunk
+    char name[HTTP_READER_FIELD_SIZE];   // Header name being read, lowercase
+    int nameLength;
+    char value[HTTP_READER_FIELD_SIZE];  // Header value being read
+    int valueLength;
+};
+
+// Function to prepare a reader for a new response
+void initHttpReader(struct HttpReader* reader);
+
+// Function to feed received bytes. Body bytes are moved to the start of data
+// with chunk framing removed, and their count is returned. Bytes after the
+// end of the response are ignored.
+int feedHttpReader(struct HttpReader* reader, char* data, int length);
+
+// Function to tell the reader the connection ended, completing a body that runs until close
+void closeHttpReader(struct HttpReader* reader);
+
+// Function to check whether the reader is in a body that only ends when the connection does
+int httpReaderUntilClose(struct HttpReader* reader);
+
+// Function to read only the status line and headers, e.g. of a response held in memory.
+// Returns the number of bytes they take, so the body starts there, or -1 if they are incomplete.
+int readHttpHead(struct HttpReader* reader, char* data, int length);
+
+#endif // HTTP_READER_H
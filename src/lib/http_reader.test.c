@@ -0,0 +1,224 @@
+#include "http_reader.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+// Helper function to read file content
+char* read_file(const char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL) {
+        printf("Failed to open file: %s\n", filename);
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long file_size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char* buffer = (char*)malloc(file_size + 1);
+    if (buffer == NULL) {
+        fclose(file);
+        return NULL;
+    }
+
+    size_t read_size = fread(buffer, 1, file_size, file);
+    buffer[read_size] = '\0';
+
+    fclose(file);
+    return buffer;
+}
+
+// Feed response in pieces of split bytes, as a fixed receive buffer would, and collect the body
+int read_response(struct HttpReader* reader, char* response, int length, int split, char* body) {
+    char buffer[64];
+    int body_length = 0;
+    int offset;
+    int n;
+    int received;
+
+    initHttpReader(reader);
+    for (offset = 0; offset < length && reader->state == HTTP_READER_READING; offset += n) {
+        n = length - offset;
+        if (n > split) n = split;
+        memcpy(buffer, response + offset, n);
+        received = feedHttpReader(reader, buffer, n);
+        memcpy(body + body_length, buffer, received);
+        body_length += received;
+    }
+    body[body_length] = '\0';
+    return body_length;
+}
+
+void test_content_length() {
+    printf("Testing responses with Content-Length...\n");
+
+    char* body = read_file(MOCK_RESPONSE_BODY_FILE);
+    assert(body != NULL);
+    char* response = (char*)malloc(strlen(body) + 256);
+    char* received = (char*)malloc(strlen(body) + 1);
+    sprintf(response, "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nCONTENT-LENGTH: %d\r\n"
+                      "X-Ratelimit-Limit: 12\r\nX-Ratelimit-Period: 3600\r\nx-ratelimit-remaining: 11 \r\n\r\n%s"
+                      "HTTP/1.1 200 OK\r\n", (int)strlen(body), body);
+
+    struct HttpReader reader;
+    int split;
+    for (split = 1; split <= 64; split++) {
+        assert(read_response(&reader, response, strlen(response), split, received) == (int)strlen(body));
+        assert(strcmp(received, body) == 0);
+        assert(reader.state == HTTP_READER_DONE);
+    }
+    printf("✓ Body read in pieces of 1 to 64 bytes\n");
+
+    assert(reader.status == 200);
+    assert(reader.contentLength == (int)strlen(body));
+    assert(reader.chunked == 0);
+    assert(reader.rateLimit == 12);
+    assert(reader.ratePeriod == 3600);
+    assert(reader.rateRemaining == 11);
+    assert(reader.retryAfter == -1);
+    assert(reader.bodyLength == (int)strlen(body));
+    printf("✓ Headers matched without regard to case\n");
+
+    // Bytes after the body are ignored
+    assert(feedHttpReader(&reader, response, 10) == 0);
+    printf("✓ Reading stops once Content-Length is satisfied\n");
+
+    free(received);
+    free(response);
+    free(body);
+}
+
+void test_chunked() {
+    printf("\nTesting chunked responses...\n");
+
+    char* body = read_file(MOCK_RESPONSE_BODY_FILE);
+    assert(body != NULL);
+    int length = strlen(body);
+    char* response = (char*)malloc(length * 2 + 256);
+    char* received = (char*)malloc(length + 1);
+    char* p = response;
+    int offset;
+    int n;
+
+    // Chunks of growing size, with an extension and a trailer
+    p += sprintf(p, "HTTP/1.1 200 OK\r\nTransfer-Encoding: gzip, Chunked\r\n\r\n");
+    n = 1;
+    for (offset = 0; offset < length; offset += n) {
+        n = n * 2;
+        if (n > length - offset) n = length - offset;
+        p += sprintf(p, "%X;name=value\r\n", n);
+        memcpy(p, body + offset, n);
+        p += n;
+        p += sprintf(p, "\r\n");
+    }
+    sprintf(p, "0\r\nX-Checksum: 1\r\n\r\n");
+
+    struct HttpReader reader;
+    int split;
+    for (split = 1; split <= 64; split++) {
+        assert(read_response(&reader, response, strlen(response), split, received) == length);
+        assert(strcmp(received, body) == 0);
+        assert(reader.state == HTTP_READER_DONE);
+        assert(reader.chunked == 1);
+    }
+    printf("✓ De-chunked in pieces of 1 to 64 bytes\n");
+
+    // Bad chunk sizes
+    char bad[] = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n";
+    read_response(&reader, bad, strlen(bad), 64, received);
+    assert(reader.state == HTTP_READER_MALFORMED);
+    char missing[] = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n\r\n";
+    read_response(&reader, missing, strlen(missing), 64, received);
+    assert(reader.state == HTTP_READER_MALFORMED);
+    printf("✓ Correctly handled bad chunk sizes\n");
+
+    free(received);
+    free(response);
+    free(body);
+}
+
+void test_failed_responses() {
+    printf("\nTesting failed responses...\n");
+
+    char received[256];
+    struct HttpReader reader;
+
+    // The status is known after the headers and the body is not read
+    char limited[] = "HTTP/1.1 429 Too Many Requests\r\nRetry-After: 3600\r\nX-Ratelimit-Remaining: 0\r\n"
+                     "Content-Length: 20\r\n\r\n{\"message\":\"limit\"}";
+    assert(read_response(&reader, limited, strlen(limited), 64, received) == 0);
+    assert(reader.state == HTTP_READER_STATUS_ERROR);
+    assert(reader.status == 429);
+    assert(reader.retryAfter == 3600);
+    assert(reader.rateRemaining == 0);
+    char unavailable[] = "HTTP/1.0 503 Service Unavailable\n\n<html>";
+    read_response(&reader, unavailable, strlen(unavailable), 64, received);
+    assert(reader.state == HTTP_READER_STATUS_ERROR && reader.status == 503);
+    printf("✓ Error statuses stop after the headers\n");
+
+    // An informational response is followed by the real one
+    char informational[] = "HTTP/1.1 100 Continue\r\n\r\nHTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\n{}";
+    assert(read_response(&reader, informational, strlen(informational), 64, received) == 2);
+    assert(reader.state == HTTP_READER_DONE && reader.status == 200);
+    printf("✓ Skipped an informational response\n");
+
+    // Malformed heads
+    char no_status[] = "ICY 200 OK\r\n\r\n{}";
+    read_response(&reader, no_status, strlen(no_status), 64, received);
+    assert(reader.state == HTTP_READER_MALFORMED);
+    char bad_length[] = "HTTP/1.1 200 OK\r\nContent-Length: x\r\n\r\n{}";
+    read_response(&reader, bad_length, strlen(bad_length), 64, received);
+    assert(reader.state == HTTP_READER_MALFORMED);
+    printf("✓ Correctly handled malformed heads\n");
+}
+
+void test_connection_end() {
+    printf("\nTesting the end of the connection...\n");
+
+    char received[256];
+    struct HttpReader reader;
+
+    // Without Content-Length the body runs until the connection ends
+    char until_close[] = "HTTP/1.0 200 OK\r\n\r\n{\"result\":{}}";
+    assert(read_response(&reader, until_close, strlen(until_close), 5, received) == 13);
+    assert(reader.state == HTTP_READER_READING && httpReaderUntilClose(&reader));
+    closeHttpReader(&reader);
+    assert(reader.state == HTTP_READER_DONE && !httpReaderUntilClose(&reader));
+    assert(strcmp(received, "{\"result\":{}}") == 0);
+    printf("✓ Body completed by the end of the connection\n");
+
+    // A short body is truncated
+    char short_body[] = "HTTP/1.1 200 OK\r\nContent-Length: 100\r\n\r\n{\"result\":{}}";
+    read_response(&reader, short_body, strlen(short_body), 64, received);
+    assert(!httpReaderUntilClose(&reader));
+    closeHttpReader(&reader);
+    assert(reader.state == HTTP_READER_TRUNCATED);
+    char short_head[] = "HTTP/1.1 200 OK\r\nContent-Le";
+    read_response(&reader, short_head, strlen(short_head), 64, received);
+    closeHttpReader(&reader);
+    assert(reader.state == HTTP_READER_TRUNCATED);
+    printf("✓ Correctly handled truncated responses\n");
+
+    // The head of a response held in memory
+    char response[] = "HTTP/1.1 200 OK\nContent-Type: application/json\n\n{}";
+    initHttpReader(&reader);
+    assert(readHttpHead(&reader, response, strlen(response)) == 48);
+    char not_found[] = "HTTP/1.1 404 Not Found\n\n{}";
+    initHttpReader(&reader);
+    assert(readHttpHead(&reader, not_found, strlen(not_found)) == -1);
+    assert(reader.state == HTTP_READER_STATUS_ERROR);
+    printf("✓ Head length of a response in memory\n");
+}
+
+int main() {
+    printf("Running http_reader tests...\n\n");
+
+    test_content_length();
+    test_chunked();
+    test_failed_responses();
+    test_connection_end();
+
+    printf("\nAll tests passed! ✓\n");
+    return 0;
+}
@@ -0,0 +1,322 @@
+#include "inverter_backtest.h"
+
+// Column of the trace wired to an input, else to a virtual input, -1 if there is none
+int backtest_column(struct trace *trace, int input, char *target) {
+    int i;
+
+    for (i = 0; i < trace->columns; i++) {
+        if (target == NULL && trace->inputs[i] == input) return i;
+        if (target != NULL && trace->inputs[i] == -1 && strcmp(trace->targets[i], target) == 0) return i;
+    }
+    return -1;
+}
+
+char *backtest_parameters[BACKTEST_PARAMETERS] = {
+    "charge_threshold",
+    "discharge_threshold",
+    "soc_discharge_threshold",
+    "pv_threshold",
+    "spot_threshold",
+    "soc_protection",
+    "morning_from",
+    "morning_till",
+};
+
+void backtest_settings_init(struct InverterSettings *settings) {
+    initInverterSettings(settings);
+    settings->chargeSpotPriceThreshold = 1.0f;
+    settings->dischargeSpotPriceThreshold = 3.0f;
+    settings->socDischargeToGridThreshold = 80;
+    settings->pvProductionThreshold = 30;
+    settings->spotPriceThreshold = 3.5f;
+    settings->onGridEndSOCProtectionUserSetting = 20;
+}
+
+int backtest_parameter(char *name) {
+    int i;
+
+    for (i = 0; i < BACKTEST_PARAMETERS; i++) {
+        if (strcmp(backtest_parameters[i], name) == 0) return i;
+    }
+    return -1;
+}
+
+float backtest_get_parameter(struct InverterSettings *settings, int parameter) {
+    switch (parameter) {
+    case 0: return settings->chargeSpotPriceThreshold;
+    case 1: return settings->dischargeSpotPriceThreshold;
+    case 2: return settings->socDischargeToGridThreshold;
+    case 3: return settings->pvProductionThreshold;
+    case 4: return settings->spotPriceThreshold;
+    case 5: return settings->onGridEndSOCProtectionUserSetting;
+    case 6: return (float)settings->morningHoursFrom;
+    default: return (float)settings->morningHoursTill;
+    }
+}
+
+void backtest_set_parameter(struct InverterSettings *settings, int parameter, float value) {
+    switch (parameter) {
+    case 0: settings->chargeSpotPriceThreshold = value; break;
+    case 1: settings->dischargeSpotPriceThreshold = value; break;
+    case 2: settings->socDischargeToGridThreshold = value; break;
+    case 3: settings->pvProductionThreshold = value; break;
+    case 4: settings->spotPriceThreshold = value; break;
+    case 5: settings->onGridEndSOCProtectionUserSetting = value; break;
+    case 6: settings->morningHoursFrom = (int)value; break;
+    default: settings->morningHoursTill = (int)value; break;
+    }
+}
+
+// Values of a step, NULL arrays of the series are left out
+struct backtest_step {
+    float price;
+    float max_price;
+    float pv_today;
+    float pv_tomorrow;
+    float pv;
+    float load;
+    int hour;
+};
+
+// Function to append a step, growing the arrays by doubling
+int backtest_append(struct backtest_series *series, long *allocated, int with_tomorrow, int with_load,
+                    struct backtest_step *step) {
+    float **arrays[6];
+    float *grown;
+    unsigned char *hours;
+    int i;
+
+    if (series->steps == *allocated) {
+        *allocated = *allocated == 0 ? 4096 : *allocated * 2;
+        arrays[0] = &series->price;
+        arrays[1] = &series->max_price;
+        arrays[2] = &series->pv_today;
+        arrays[3] = &series->pv;
+        arrays[4] = with_tomorrow ? &series->pv_tomorrow : NULL;
+        arrays[5] = with_load ? &series->load : NULL;
+        for (i = 0; i < 6; i++) {
+            if (arrays[i] == NULL) continue;
+            grown = (float *)realloc(*arrays[i], *allocated * sizeof(float));
+            if (grown == NULL) return -1;
+            *arrays[i] = grown;
+        }
+        hours = (unsigned char *)realloc(series->hour, *allocated);
+        if (hours == NULL) return -1;
+        series->hour = hours;
+    }
+    series->price[series->steps] = step->price;
+    series->max_price[series->steps] = step->max_price;
+    series->pv_today[series->steps] = step->pv_today;
+    series->pv[series->steps] = step->pv;
+    if (with_tomorrow) series->pv_tomorrow[series->steps] = step->pv_tomorrow;
+    if (with_load) series->load[series->steps] = step->load;
+    series->hour[series->steps] = (unsigned char)step->hour;
+    series->steps++;
+    return 0;
+}
+
+// Function to take the values of the current row for the step starting at it
+void backtest_start_step(struct backtest_step *step, struct trace *trace, int price, int max_price, int pv_today,
+                         int pv_tomorrow) {
+    step->price = trace->values[price];
+    step->max_price = trace->values[max_price];
+    step->pv_today = trace->values[pv_today];
+    step->pv_tomorrow = pv_tomorrow >= 0 ? trace->values[pv_tomorrow] : 0;
+}
+
+int backtest_load(struct backtest_series *series, struct trace *trace, int step_seconds) {
+    int price = backtest_column(trace, 0, NULL);
+    int max_price = backtest_column(trace, 2, NULL);
+    int pv_today = backtest_column(trace, 7, NULL);
+    int pv_tomorrow = backtest_column(trace, 8, NULL);
+    int pv = backtest_column(trace, -1, "AMQ125");
+    int load = backtest_column(trace, -1, "load");
+    struct backtest_step step;
+    long allocated = 0;
+    long long step_start;
+    long long step_end;
+    long long last;
+    long long next;
+    double pv_sum = 0;
+    double load_sum = 0;
+    int status;
+
+    memset(series, 0, sizeof(*series));
+    series->step_seconds = step_seconds;
+    if (price < 0 || max_price < 0 || pv_today < 0 || pv < 0) {
+        snprintf(trace->error, sizeof(trace->error), "no column for %s",
+                 price < 0 ? "input0" : max_price < 0 ? "input2" : pv_today < 0 ? "input7" : "AMQ125");
+        return -1;
+    }
+    if (step_seconds <= 0) {
+        snprintf(trace->error, sizeof(trace->error), "step must be positive");
+        return -1;
+    }
+
+    next = trace_peek_time(trace);
+    if (next < 0) return 0;
+    step_start = next - next % step_seconds;
+    step_end = step_start + step_seconds;
+    last = step_start;
+    backtest_start_step(&step, trace, price, max_price, pv_today, pv_tomorrow);
+
+    // The values of a row hold until the next one, so each row adds its values
+    // times how long they held to the step sums before the next row is read
+    for (;;) {
+        next = trace_peek_time(trace);
+        if (next < 0) break;
+        while (next >= step_end) {
+            pv_sum += trace->values[pv] * (double)(step_end - last);
+            if (load >= 0) load_sum += trace->values[load] * (double)(step_end - last);
+            if (!isnan(step.price) && !isnan(step.max_price) && !isnan(step.pv_today) && !isnan(step.pv_tomorrow) &&
+                !isnan(pv_sum) && !isnan(load_sum)) {
+                if (series->steps == 0) series->start = step_start;
+                step.pv = (float)(pv_sum / step_seconds);
+                step.load = (float)(load_sum / step_seconds);
+                step.hour = gethour((unsigned int)(step_start - TRACE_UNIX_2009), 1);
+                if (backtest_append(series, &allocated, pv_tomorrow >= 0, load >= 0, &step) != 0) {
+                    snprintf(trace->error, sizeof(trace->error), "out of memory");
+                    backtest_free(series);
+                    return -1;
+                }
+            }
+            step_start = step_end;
+            step_end += step_seconds;
+            last = step_start;
+            backtest_start_step(&step, trace, price, max_price, pv_today, pv_tomorrow);
+            pv_sum = 0;
+            load_sum = 0;
+        }
+        if (next > last) {
+            pv_sum += trace->values[pv] * (double)(next - last);
+            if (load >= 0) load_sum += trace->values[load] * (double)(next - last);
+            last = next;
+        }
+
+        status = trace_next(trace);
+        if (status < 0) {
+            backtest_free(series);
+            return -1;
+        }
+        // Values set at the very start of a step count for it
+        if (trace->time == step_start) backtest_start_step(&step, trace, price, max_price, pv_today, pv_tomorrow);
+    }
+    return 0;
+}
+
+void backtest_free(struct backtest_series *series) {
+    free(series->price);
+    free(series->max_price);
+    free(series->pv_today);
+    free(series->pv_tomorrow);
+    free(series->pv);
+    free(series->load);
+    free(series->hour);
+    memset(series, 0, sizeof(*series));
+}
+
+void backtest_run(struct backtest_series *series, struct plant_config *plant, struct InverterSettings *settings,
+                  struct backtest_result *result) {
+    struct InverterInputs inputs;
+    struct InverterDecision decision;
+    struct plant_state state;
+    double hours = series->step_seconds / 3600.0;
+    long i;
+
+    plant_state_init(plant, &state);
+    inputs.currentInverterMode = INVERTER_GENERAL_MODE;
+    inputs.onGridEndSOCProtection = settings->onGridEndSOCProtectionUserSetting;
+
+    for (i = 0; i < series->steps; i++) {
+        inputs.currentSpotPrice = series->price[i];
+        inputs.maxSpotPrice = series->max_price[i];
+        inputs.predictedPVToday = series->pv_today[i];
+        inputs.soc = plant_soc(plant, &state);
+        inputs.hour = series->hour[i];
+        decideInverterState(settings, &inputs, &decision);
+        inputs.currentInverterMode = decision.mode;
+        inputs.onGridEndSOCProtection = decision.onGridEndSOCProtection;
+
+        plant_step_inverter(plant, &state, &decision, series->pv[i],
+                            series->load != NULL ? series->load[i] : plant->load_kw, series->price[i], hours);
+    }
+    result->cost = state.cost;
+    result->import_kwh = state.import_kwh;
+    result->export_kwh = state.export_kwh;
+    result->cycles = plant_cycles(plant, &state);
+}
+
+struct backtest_point {
+    double cost;
+    double cycles;
+    long index;
+};
+
+int backtest_compare_points(const void *a, const void *b) {
+    struct backtest_point *first = (struct backtest_point *)a;
+    struct backtest_point *second = (struct backtest_point *)b;
+
+    if (first->cost != second->cost) return first->cost < second->cost ? -1 : 1;
+    if (first->cycles != second->cycles) return first->cycles < second->cycles ? -1 : 1;
+    return 0;
+}
+
+int backtest_pareto_rank(struct backtest_result *results, long count, int *ranks) {
+    struct backtest_point *points;
+    double *front_cycles;   // Fewest cycles in each front so far
+    double *front_cost;     // Lowest cost among those with the fewest cycles
+    int fronts = 0;
+    int low;
+    int high;
+    int middle;
+    long i;
+
+    if (count <= 0) return 0;
+    points = (struct backtest_point *)malloc(count * sizeof(*points));
+    front_cycles = (double *)malloc(count * sizeof(double));
+    front_cost = (double *)malloc(count * sizeof(double));
+    if (points == NULL || front_cycles == NULL || front_cost == NULL) {
+        free(points);
+        free(front_cycles);
+        free(front_cost);
+        return -1;
+    }
+    for (i = 0; i < count; i++) {
+        points[i].cost = results[i].cost;
+        points[i].cycles = results[i].cycles;
+        points[i].index = i;
+    }
+
+    // In order of cost, a result can only be dominated by those before it. A front
+    // dominates it when its fewest cycles are fewer, or as few at a lower cost. Each
+    // front is dominated by the one before, so the first front that does not
+    // dominate the result is found by binary search.
+    qsort(points, count, sizeof(*points), backtest_compare_points);
+    for (i = 0; i < count; i++) {
+        low = 0;
+        high = fronts;
+        while (low < high) {
+            middle = (low + high) / 2;
+            if (front_cycles[middle] < points[i].cycles ||
+                (front_cycles[middle] == points[i].cycles && front_cost[middle] < points[i].cost)) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        if (low == fronts) {
+            front_cycles[fronts] = points[i].cycles;
+            front_cost[fronts] = points[i].cost;
+            fronts++;
+        } else if (points[i].cycles < front_cycles[low]) {
+            front_cycles[low] = points[i].cycles;
+            front_cost[low] = points[i].cost;
+        }
+        ranks[points[i].index] = low + 1;
+    }
+
+    free(points);
+    free(front_cycles);
+    free(front_cost);
+    return fronts;
+}
@@ -0,0 +1,70 @@
+#ifndef INVERTER_BACKTEST_H
+#define INVERTER_BACKTEST_H
+
+#include "plant_model.h"
+#include "loxone_trace.h"
+
+// Backtest of the inverter decision core (inverter_state.h) over recorded
+// prices and PV power. A trace is resampled once into a backtest_series, read
+// only afterwards, so any number of threads can run settings over it at once.
+// Each run steps the battery and grid meter of plant_model.h, with the decision
+// core choosing the mode every step.
+//
+// The trace columns are wired as for script_wattsonic-inverter-state-manager:
+// input0 the spot price, input2 the day's max, input7 the predicted PV today,
+// input8 the one for tomorrow (optional) and AMQ125 the PV power in kW. A
+// column mapped to "load" is the house load in kW, otherwise the plant's
+// constant load applies.
+
+struct backtest_series {
+    long steps;
+    int step_seconds;
+    long long start;        // Unix time of the first step
+    float *price;           // Spot price at the start of the step
+    float *max_price;
+    float *pv_today;
+    float *pv_tomorrow;     // NULL without an input8 column
+    float *pv;              // Mean PV power over the step in kW
+    float *load;            // Mean house load in kW, NULL for the plant's constant load
+    unsigned char *hour;    // Local hour at the start of the step
+};
+
+struct backtest_result {
+    double cost;            // Imports minus exports at the spot price
+    double import_kwh;
+    double export_kwh;
+    double cycles;          // Full battery cycles, throughput over twice the capacity
+};
+
+// Settings by name for sweeps and simulations: charge_threshold, discharge_threshold,
+// soc_discharge_threshold, pv_threshold, spot_threshold, soc_protection, morning_from
+// and morning_till
+#define BACKTEST_PARAMETERS 8
+extern char *backtest_parameters[BACKTEST_PARAMETERS];
+
+// Function to set the thresholds of the replay example in the README
+void backtest_settings_init(struct InverterSettings *settings);
+
+// Index of a parameter, -1 if there is no such name
+int backtest_parameter(char *name);
+
+float backtest_get_parameter(struct InverterSettings *settings, int parameter);
+void backtest_set_parameter(struct InverterSettings *settings, int parameter, float value);
+
+// Function to resample the remaining rows of a trace into steps. Steps before
+// the first price, max price and PV power are skipped. 0 on success, -1 with
+// the trace error set.
+int backtest_load(struct backtest_series *series, struct trace *trace, int step_seconds);
+
+void backtest_free(struct backtest_series *series);
+
+// Function to run the settings over the series. It only writes result, so runs
+// of different settings can share the series and plant.
+void backtest_run(struct backtest_series *series, struct plant_config *plant, struct InverterSettings *settings,
+                  struct backtest_result *result);
+
+// Function to rank results by Pareto fronts of cost and cycles, both lower is better:
+// rank 1 is not dominated by any result, rank 2 only by rank 1 and so on. Returns the number of fronts.
+int backtest_pareto_rank(struct backtest_result *results, long count, int *ranks);
+
+#endif // INVERTER_BACKTEST_H
@@ -0,0 +1,265 @@
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+#include "inverter_backtest.h"
+#include "work_pool.h"
+
+// Sweep the thresholds of wattsonic-inverter-state-manager over a trace (see
+// inverter_backtest.h) and print the Pareto fronts of cost and battery cycles:
+//
+//   inverter_sweep --trace <file> [--map <column>=<target>]... [--sweep <name>=<from>:<to>:<step>]...
+//                  [--set <name>=<value>]... [--step <s>] [--threads <n>] [--fronts <n>]
+//                  [--capacity <kWh>] [--power <kW>] [--efficiency <f>] [--soc <%>]
+//                  [--load <kW>] [--import-fee <price>]
+//
+// Every combination of the swept values is run, the others keep their --set or
+// default values. The results of the first --fronts fronts (1 by default) go to
+// stdout as CSV by rank and cost:
+//
+//   rank,cost,cycles,import_kwh,export_kwh,<name>,...
+//
+// and a last line to stderr reports the sweep:
+// sweep combinations=<n> steps=<n> threads=<n> steals=<n> load_ms=<f> wall_ms=<f> steps_per_s=<f>
+
+// Values of a parameter, from the defaults of backtest_settings_init
+struct parameter {
+    float from;
+    float to;
+    float step;
+    int count;      // Swept values, 1 for a set one
+};
+
+struct parameter parameters[BACKTEST_PARAMETERS];
+
+struct sweep {
+    struct backtest_series series;
+    struct plant_config plant;
+    struct backtest_result *results;
+};
+
+double wall_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+int usage() {
+    fprintf(stderr,
+            "Usage: inverter_sweep --trace <file> [--map <column>=<target>]... [--sweep <name>=<from>:<to>:<step>]...\n"
+            "                      [--set <name>=<value>]... [--step <s>] [--threads <n>] [--fronts <n>]\n"
+            "                      [--capacity <kWh>] [--power <kW>] [--efficiency <f>] [--soc <%%>]\n"
+            "                      [--load <kW>] [--import-fee <price>]\n"
+            "Parameters: charge_threshold discharge_threshold soc_discharge_threshold pv_threshold\n"
+            "            spot_threshold soc_protection morning_from morning_till\n");
+    return 1;
+}
+
+// Function to parse <name>=<from>:<to>:<step> or <name>=<value> into its parameter
+int parse_parameter(char *text, int swept) {
+    char name[32];
+    char *value = strchr(text, '=');
+    struct parameter *parameter;
+    int index;
+
+    if (value == NULL || value - text >= (long)sizeof(name)) return -1;
+    memcpy(name, text, value - text);
+    name[value - text] = '\0';
+    index = backtest_parameter(name);
+    if (index < 0) return -1;
+    parameter = &parameters[index];
+    if (swept) {
+        if (sscanf(value + 1, "%f:%f:%f", &parameter->from, &parameter->to, &parameter->step) != 3) return -1;
+        if (parameter->step <= 0 || parameter->to < parameter->from) return -1;
+        // Half a step of slack, so 0:1:0.1 ends at 1 despite rounding
+        parameter->count = (int)((parameter->to - parameter->from) / parameter->step + 0.5f) + 1;
+    } else {
+        parameter->from = (float)atof(value + 1);
+        parameter->count = 1;
+    }
+    return 0;
+}
+
+// Value of a parameter in a combination, the first parameter varies fastest
+float parameter_value(long combination, int index) {
+    int i;
+
+    for (i = 0; i < index; i++) combination /= parameters[i].count;
+    return parameters[index].from + parameters[index].step * (float)(combination % parameters[index].count);
+}
+
+void combination_settings(long combination, struct InverterSettings *settings) {
+    int i;
+
+    backtest_settings_init(settings);
+    for (i = 0; i < BACKTEST_PARAMETERS; i++) backtest_set_parameter(settings, i, parameter_value(combination, i));
+}
+
+// Task of the pool, one combination
+void run_combination(void *context, long combination, int worker) {
+    struct sweep *sweep = (struct sweep *)context;
+    struct InverterSettings settings;
+
+    (void)worker;
+    combination_settings(combination, &settings);
+    backtest_run(&sweep->series, &sweep->plant, &settings, &sweep->results[combination]);
+}
+
+struct ranked {
+    int rank;
+    double cost;
+    long combination;
+};
+
+int compare_ranked(const void *a, const void *b) {
+    struct ranked *first = (struct ranked *)a;
+    struct ranked *second = (struct ranked *)b;
+
+    if (first->rank != second->rank) return first->rank - second->rank;
+    if (first->cost != second->cost) return first->cost < second->cost ? -1 : 1;
+    return first->combination < second->combination ? -1 : 1;
+}
+
+// Print the results of the first fronts by rank and cost
+int print_fronts(struct backtest_result *results, long combinations, int fronts) {
+    struct ranked *ranked = (struct ranked *)malloc(combinations * sizeof(*ranked));
+    int *ranks = (int *)malloc(combinations * sizeof(int));
+    long count = 0;
+    long i;
+    int j;
+
+    if (ranked == NULL || ranks == NULL || backtest_pareto_rank(results, combinations, ranks) < 0) {
+        fprintf(stderr, "out of memory\n");
+        free(ranked);
+        free(ranks);
+        return 1;
+    }
+    for (i = 0; i < combinations; i++) {
+        if (ranks[i] > fronts) continue;
+        ranked[count].rank = ranks[i];
+        ranked[count].cost = results[i].cost;
+        ranked[count].combination = i;
+        count++;
+    }
+    qsort(ranked, count, sizeof(*ranked), compare_ranked);
+
+    printf("rank,cost,cycles,import_kwh,export_kwh");
+    for (j = 0; j < BACKTEST_PARAMETERS; j++) printf(",%s", backtest_parameters[j]);
+    printf("\n");
+    for (i = 0; i < count; i++) {
+        printf("%d,%.2f,%.2f,%.1f,%.1f", ranked[i].rank, results[ranked[i].combination].cost,
+               results[ranked[i].combination].cycles, results[ranked[i].combination].import_kwh,
+               results[ranked[i].combination].export_kwh);
+        for (j = 0; j < BACKTEST_PARAMETERS; j++) printf(",%g", parameter_value(ranked[i].combination, j));
+        printf("\n");
+    }
+    free(ranked);
+    free(ranks);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    static struct sweep sweep;
+    struct InverterSettings defaults;
+    struct work_pool_stats stats;
+    struct trace trace;
+    char column[LOXONE_IO_NAME];
+    char *path = NULL;
+    char *maps[TRACE_MAX_COLUMNS];
+    int map_count = 0;
+    int step_seconds = 60;
+    int threads = work_pool_cores();
+    int fronts = 1;
+    long combinations = 1;
+    double load_ms;
+    double started;
+    char *target;
+    int status;
+    int i;
+
+    loxone_reset(0);
+    plant_config_init(&sweep.plant);
+    backtest_settings_init(&defaults);
+    for (i = 0; i < BACKTEST_PARAMETERS; i++) {
+        parameters[i].from = backtest_get_parameter(&defaults, i);
+        parameters[i].to = parameters[i].from;
+        parameters[i].step = 1;
+        parameters[i].count = 1;
+    }
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            path = argv[++i];
+        } else if (strcmp(argv[i], "--map") == 0 && i + 1 < argc && map_count < TRACE_MAX_COLUMNS) {
+            maps[map_count++] = argv[++i];
+        } else if (strcmp(argv[i], "--sweep") == 0 && i + 1 < argc) {
+            if (parse_parameter(argv[++i], 1) != 0) return usage();
+        } else if (strcmp(argv[i], "--set") == 0 && i + 1 < argc) {
+            if (parse_parameter(argv[++i], 0) != 0) return usage();
+        } else if (strcmp(argv[i], "--step") == 0 && i + 1 < argc) {
+            step_seconds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--fronts") == 0 && i + 1 < argc) {
+            fronts = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--capacity") == 0 && i + 1 < argc) {
+            sweep.plant.capacity_kwh = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--power") == 0 && i + 1 < argc) {
+            sweep.plant.power_kw = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--efficiency") == 0 && i + 1 < argc) {
+            sweep.plant.efficiency = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--soc") == 0 && i + 1 < argc) {
+            sweep.plant.initial_soc = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--load") == 0 && i + 1 < argc) {
+            sweep.plant.load_kw = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--import-fee") == 0 && i + 1 < argc) {
+            sweep.plant.import_fee = (float)atof(argv[++i]);
+        } else {
+            return usage();
+        }
+    }
+    if (path == NULL || step_seconds <= 0 || sweep.plant.capacity_kwh <= 0 || sweep.plant.efficiency <= 0) {
+        return usage();
+    }
+    for (i = 0; i < BACKTEST_PARAMETERS; i++) combinations *= parameters[i].count;
+
+    started = wall_ms();
+    if (trace_open(&trace, path) != 0) {
+        fprintf(stderr, "%s: %s\n", path, trace.error);
+        return 1;
+    }
+    for (i = 0; i < map_count; i++) {
+        target = strchr(maps[i], '=');
+        if (target == NULL || target - maps[i] >= LOXONE_IO_NAME) return usage();
+        memcpy(column, maps[i], target - maps[i]);
+        column[target - maps[i]] = '\0';
+        if (trace_map(&trace, column, target + 1) != 0) {
+            fprintf(stderr, "--map %s: %s\n", maps[i], trace.error);
+            return 1;
+        }
+    }
+    status = backtest_load(&sweep.series, &trace, step_seconds);
+    trace_close(&trace);
+    if (status != 0) {
+        fprintf(stderr, "%s: %s\n", path, trace.error);
+        return 1;
+    }
+    load_ms = wall_ms() - started;
+
+    sweep.results = (struct backtest_result *)calloc(combinations, sizeof(struct backtest_result));
+    if (sweep.results == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    started = wall_ms();
+    if (work_pool_run(threads, combinations, run_combination, &sweep, &stats) != 0) {
+        fprintf(stderr, "can not start the threads\n");
+        return 1;
+    }
+    started = wall_ms() - started;
+
+    status = print_fronts(sweep.results, combinations, fronts);
+    fprintf(stderr, "sweep combinations=%ld steps=%ld threads=%d steals=%ld load_ms=%.0f wall_ms=%.0f steps_per_s=%.0f\n",
+            combinations, sweep.series.steps, stats.workers, stats.steals, load_ms, started,
+            (double)combinations * sweep.series.steps * 1000.0 / (started > 0 ? started : 1e-3));
+    free(sweep.results);
+    backtest_free(&sweep.series);
+    return status;
+}
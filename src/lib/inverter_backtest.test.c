@@ -0,0 +1,252 @@
+#include "inverter_backtest.h"
+#include <assert.h>
+
+#define CSV_PATH TRACE_TEST_DIR "/inverter_backtest.test.csv"
+
+// 2025-02-27 05:00 CET
+#define T0 1740628800LL
+
+#define STEPS 5
+
+void write_file(char* path, char* text) {
+    FILE* file = fopen(path, "wb");
+    assert(file != NULL);
+    fputs(text, file);
+    fclose(file);
+}
+
+int near(double value, double expected) {
+    return fabs(value - expected) < 1e-4;
+}
+
+// A lossless 10 kWh battery of 5 kW at half charge and 1 kW of load
+void init_plant(struct plant_config* plant) {
+    plant_config_init(plant);
+    plant->capacity_kwh = 10;
+    plant->efficiency = 1;
+    plant->load_kw = 1;
+}
+
+// Hourly steps of the arrays
+struct hours {
+    float price[STEPS];
+    float max_price[STEPS];
+    float pv_today[STEPS];
+    float pv[STEPS];
+    unsigned char hour[STEPS];
+};
+
+void init_series(struct backtest_series* series, struct hours* hours, long steps) {
+    int i;
+
+    for (i = 0; i < STEPS; i++) {
+        hours->max_price[i] = 5;
+        hours->pv_today[i] = 10;
+        hours->hour[i] = 12;
+    }
+    memset(series, 0, sizeof(*series));
+    series->steps = steps;
+    series->step_seconds = 3600;
+    series->price = hours->price;
+    series->max_price = hours->max_price;
+    series->pv_today = hours->pv_today;
+    series->pv = hours->pv;
+    series->hour = hours->hour;
+}
+
+void test_load() {
+    printf("Testing traces resampled into steps...\n");
+
+    struct backtest_series series;
+    struct trace trace;
+
+    write_file(CSV_PATH, "time,price,max,pv_today,pv,house\n"
+                         "1740628800,2,5,10,0,1\n"
+                         "1740628830,,,,2,\n"
+                         "1740628920,3,,,,3\n"
+                         "1740628980,,,,,\n");
+    assert(trace_open(&trace, CSV_PATH) == 0);
+    assert(trace_map(&trace, "price", "input0") == 0);
+    assert(trace_map(&trace, "max", "input2") == 0);
+    assert(trace_map(&trace, "pv_today", "input7") == 0);
+    assert(trace_map(&trace, "pv", "AMQ125") == 0);
+    assert(trace_map(&trace, "house", "load") == 0);
+    assert(backtest_load(&series, &trace, 60) == 0);
+    trace_close(&trace);
+
+    assert(series.steps == 3);
+    assert(series.start == T0);
+    assert(series.price[0] == 2 && series.price[1] == 2 && series.price[2] == 3);
+    assert(series.max_price[2] == 5 && series.pv_today[2] == 10);
+    assert(near(series.pv[0], 1) && near(series.pv[1], 2) && near(series.pv[2], 2));
+    assert(near(series.load[0], 1) && near(series.load[2], 3));
+    assert(series.pv_tomorrow == NULL);
+    assert(series.hour[0] == 5);
+    backtest_free(&series);
+    printf("✓ PV and load are averaged over each step, prices taken at its start\n");
+
+    write_file(CSV_PATH, "time,input0,input2,input7\n1740628800,2,5,10\n");
+    assert(trace_open(&trace, CSV_PATH) == 0);
+    assert(backtest_load(&series, &trace, 60) == -1);
+    assert(strcmp(trace.error, "no column for AMQ125") == 0);
+    trace_close(&trace);
+    printf("✓ Missing columns are reported\n");
+}
+
+void test_parameters() {
+    printf("\nTesting settings by name...\n");
+
+    struct InverterSettings settings;
+    int i;
+
+    backtest_settings_init(&settings);
+    assert(backtest_parameter("soc_protection") == 5);
+    assert(backtest_parameter("missing") == -1);
+    for (i = 0; i < BACKTEST_PARAMETERS; i++) {
+        backtest_set_parameter(&settings, i, (float)(i + 10));
+        assert(backtest_get_parameter(&settings, i) == i + 10);
+    }
+    assert(settings.chargeSpotPriceThreshold == 10);
+    assert(settings.onGridEndSOCProtectionUserSetting == 15);
+    assert(settings.morningHoursTill == 17);
+    printf("✓ Each name sets its own setting\n");
+}
+
+void test_plant() {
+    printf("\nTesting the plant...\n");
+
+    struct InverterSettings settings;
+    struct plant_config plant;
+    struct backtest_series series;
+    struct backtest_result result;
+    struct hours hours;
+
+    backtest_settings_init(&settings);
+    init_plant(&plant);
+    init_series(&series, &hours, STEPS);
+
+    // Cheap night, sunny hours without and with grid injection, then the evening peak
+    hours.price[0] = 0.5f;
+    hours.pv[0] = 0;
+    hours.price[1] = 2;
+    hours.pv[1] = 4;
+    hours.price[2] = 4;
+    hours.pv[2] = 4;
+    hours.price[3] = 4.8f;
+    hours.pv[3] = 0;
+    hours.price[4] = 4.8f;
+    hours.pv[4] = 0;
+    backtest_run(&series, &plant, &settings, &result);
+
+    // 1.5 kW of grid charging and the load, surplus PV into the battery until it is full,
+    // 4 kW of discharging to grid down to 60 %, then the battery covers the load
+    assert(near(result.import_kwh, 2.5));
+    assert(near(result.export_kwh, 2.5 + 3));
+    assert(near(result.cost, 2.5 * 0.5 - 2.5 * 4 - 3 * 4.8));
+    assert(near(result.cycles, (1.5 + 3 + 0.5 + 4 + 1) / 20));
+    printf("✓ Charging, self-consumption and discharging to grid follow the decisions\n");
+
+    // Without grid injection surplus PV is curtailed once the battery is full
+    plant.initial_soc = 100;
+    series.steps = 2;
+    hours.price[0] = 2;
+    hours.pv[0] = 4;
+    backtest_run(&series, &plant, &settings, &result);
+    assert(result.import_kwh == 0 && result.export_kwh == 0 && result.cycles == 0);
+    printf("✓ Surplus PV is curtailed without grid injection\n");
+
+    // The battery stops at the on-grid end SOC protection
+    plant.initial_soc = 22;
+    series.steps = 1;
+    hours.pv[0] = 0;
+    backtest_run(&series, &plant, &settings, &result);
+    assert(near(result.import_kwh, 0.8));
+    assert(near(result.cycles, 0.2 / 20));
+
+    // Charging loses energy on the way in
+    plant.initial_soc = 0;
+    plant.efficiency = 0.5f;
+    hours.price[0] = 0.5f;
+    series.steps = 2;
+    hours.price[1] = 0.5f;
+    hours.pv[1] = 0;
+    backtest_run(&series, &plant, &settings, &result);
+    assert(near(result.import_kwh, 2 * 2.5));
+    assert(near(result.cycles, 3.0 / 20));
+    printf("✓ SOC protection and efficiency limit the battery\n");
+}
+
+void test_morning() {
+    printf("\nTesting the morning push to grid...\n");
+
+    struct InverterSettings settings;
+    struct plant_config plant;
+    struct backtest_series series;
+    struct backtest_result result;
+    struct hours hours;
+
+    backtest_settings_init(&settings);
+    init_plant(&plant);
+    init_series(&series, &hours, 2);
+    hours.price[0] = 3.8f;
+    hours.pv[0] = 3;
+    hours.pv_today[0] = 40;
+    hours.hour[0] = 8;
+    hours.price[1] = 3.8f;
+    hours.pv[1] = 0;
+    hours.pv_today[1] = 40;
+    hours.hour[1] = 9;
+    backtest_run(&series, &plant, &settings, &result);
+
+    // The battery idles, surplus PV goes to grid and the load comes from it
+    assert(near(result.export_kwh, 2));
+    assert(near(result.import_kwh, 1));
+    assert(result.cycles == 0);
+    printf("✓ The battery idles while PV is pushed to grid\n");
+
+    settings.morningHoursTill = 9;
+    backtest_run(&series, &plant, &settings, &result);
+    assert(near(result.import_kwh, 0));
+    printf("✓ after the morning hours it covers the load again\n");
+}
+
+void test_pareto() {
+    printf("\nTesting Pareto ranks...\n");
+
+    struct backtest_result results[7];
+    double costs[7] = {1, 2, 3, 2, 4, 1, 1};
+    double cycles[7] = {5, 3, 1, 4, 4, 5, 6};
+    int ranks[7];
+    int i;
+
+    for (i = 0; i < 7; i++) {
+        memset(&results[i], 0, sizeof(results[i]));
+        results[i].cost = costs[i];
+        results[i].cycles = cycles[i];
+    }
+    assert(backtest_pareto_rank(results, 7, ranks) == 3);
+    assert(ranks[0] == 1 && ranks[1] == 1 && ranks[2] == 1);
+    assert(ranks[3] == 2);
+    assert(ranks[4] == 3);
+    printf("✓ Dominated results rank behind those dominating them\n");
+
+    assert(ranks[5] == 1);
+    assert(ranks[6] == 2);
+    printf("✓ Equal results share a rank, same cost with more cycles does not\n");
+}
+
+int main() {
+    printf("Running inverter_backtest tests...\n\n");
+
+    // Local hours in CET
+    loxone_reset(0);
+
+    test_load();
+    test_parameters();
+    test_plant();
+    test_morning();
+    test_pareto();
+
+    printf("\nAll tests passed! ✓\n");
+    return 0;
+}
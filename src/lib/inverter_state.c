@@ -0,0 +1,78 @@
+// Check if we're using a standard C compiler
+#ifndef PICO_C
+#include "inverter_state.h"
+#include <math.h>
+#endif
+
+// Function to set the settings not given by inputs, the morning hours
+void initInverterSettings(struct InverterSettings* settings) {
+    settings->morningHoursFrom = MORNING_HOURS_FROM;
+    settings->morningHoursTill = MORNING_HOURS_TILL;
+}
+
+// Function to determine the correct inverter state
+void decideInverterState(struct InverterSettings* settings, struct InverterInputs* inputs, struct InverterDecision* decision) {
+    float soc = inputs->soc;
+    float userSetting = settings->onGridEndSOCProtectionUserSetting;
+
+    decision->batteryMode = BATTERY_NO_MODE;
+    decision->batteryChargeDischargePowerLimit = BATTERY_POWER_LIMIT_OFF;
+    decision->gridInjectionPowerLimit = GRID_INJECTION_POWER_LIMIT_OFF;
+    decision->onGridEndSOCProtection = inputs->onGridEndSOCProtection;
+
+    if (inputs->currentSpotPrice < settings->chargeSpotPriceThreshold) {
+        decision->mode = INVERTER_ECONOMIC_MODE;
+        decision->batteryMode = BATTERY_CHARGE_MODE; // Charge from grid
+        decision->batteryChargeDischargePowerLimit = BATTERY_POWER_LIMIT_CHARGE_MAX; // Limit battery charging power to max allowed value
+        decision->gridInjectionPowerLimit = GRID_INJECTION_POWER_LIMIT_OFF; // Do not inject power to grid
+        decision->onGridEndSOCProtection = soc; // Set on-grid end SOC protection to current SOC, to avoid charging with full power, which is not good for the battery life-expectancy
+
+        // Excess energy is available during very low spot prices (grid charging)
+        decision->excessEnergyAvailable = 1;
+        decision->state = "Charging from grid";
+    } else if (fabs(inputs->maxSpotPrice - inputs->currentSpotPrice) <= 0.5 && // Spot price is close to max
+               inputs->currentSpotPrice >= settings->dischargeSpotPriceThreshold && // Spot price is above discharge threshold
+               soc > settings->socDischargeToGridThreshold) { // SOC is above the push to grid threshold
+        decision->mode = INVERTER_ECONOMIC_MODE;
+        decision->batteryMode = BATTERY_DISCHARGE_MODE; // Discharge to grid
+        decision->batteryChargeDischargePowerLimit = BATTERY_POWER_LIMIT_DISCHARGE_MAX; // Limit discharging power to max allowed value
+        decision->gridInjectionPowerLimit = GRID_INJECTION_POWER_LIMIT_MAX; // Allow maximum allowed power to be injected to grid
+        decision->onGridEndSOCProtection = userSetting; // Set on-grid end SOC protection to user setting
+
+        // No excess energy during discharging to grid (prioritize grid export)
+        decision->excessEnergyAvailable = 0;
+        decision->state = "Discharging to grid";
+    } else if (inputs->currentSpotPrice > settings->spotPriceThreshold &&
+               inputs->predictedPVToday > settings->pvProductionThreshold &&
+               ((inputs->currentInverterMode != INVERTER_ECONOMIC_MODE && soc > userSetting + 5) || // SOC is above the SOC protection threshold, with a hysteresis of 5%
+                (inputs->currentInverterMode == INVERTER_ECONOMIC_MODE && soc > userSetting)) &&
+               inputs->hour > settings->morningHoursFrom && inputs->hour < settings->morningHoursTill) { //only in morning hours
+        decision->mode = INVERTER_ECONOMIC_MODE;
+        decision->batteryMode = BATTERY_DISCHARGE_MODE;
+        if (soc > decision->onGridEndSOCProtection) {
+            decision->onGridEndSOCProtection = soc; // Set on-grid end SOC protection to current SOC to prevent battery from discharging to the grid
+        }
+        decision->batteryChargeDischargePowerLimit = BATTERY_POWER_LIMIT_OFF; // Switch off battery discharging by setting limit to 0
+        decision->gridInjectionPowerLimit = GRID_INJECTION_POWER_LIMIT_MAX; // Allow maximum allowed power to be injected to grid
+
+        // No excess energy during morning push to grid (prioritize grid export)
+        decision->excessEnergyAvailable = 0;
+        decision->state = "Morning push to grid";
+    } else {
+        decision->mode = INVERTER_GENERAL_MODE;
+        decision->onGridEndSOCProtection = userSetting; // Set on-grid end SOC protection to user setting
+
+        // Excess energy is available when the inverter is in general mode
+        decision->excessEnergyAvailable = 1;
+
+        // Fix for battery full + low spot price scenario
+        // Always enable grid injection when battery is nearly full to prevent PV throttling
+        if (inputs->currentSpotPrice > settings->spotPriceThreshold) {
+            decision->gridInjectionPowerLimit = GRID_INJECTION_POWER_LIMIT_MAX; // Allow maximum allowed power to be injected to grid
+            decision->state = "Grid injection enabled";
+        } else {
+            decision->gridInjectionPowerLimit = GRID_INJECTION_POWER_LIMIT_OFF; // Do not inject power to grid
+            decision->state = "Grid injection disabled";
+        }
+    }
+}
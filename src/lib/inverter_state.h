@@ -0,0 +1,67 @@
+#ifndef INVERTER_STATE_H
+#define INVERTER_STATE_H
+
+// Decision core of wattsonic-inverter-state-manager: the inverter mode and
+// battery operation for the current spot price, SOC and PV prediction. It
+// keeps no state between calls, so backtests can run it for many settings side
+// by side (see inverter_backtest.h).
+
+// Define constants for inverter modes
+#define INVERTER_GENERAL_MODE 257
+#define INVERTER_ECONOMIC_MODE 258
+#define INVERTER_UPS_MODE 259
+
+// Define battery modes
+#define BATTERY_NO_MODE 0
+#define BATTERY_CHARGE_MODE 1
+#define BATTERY_DISCHARGE_MODE 2
+
+// Constants for inverter state
+#define MORNING_HOURS_TILL 12
+#define MORNING_HOURS_FROM 5
+#define BATTERY_POWER_LIMIT_DISCHARGE_MAX 80
+// 30% power limit is recommended by the technician
+#define BATTERY_POWER_LIMIT_CHARGE_MAX 30
+#define BATTERY_POWER_LIMIT_OFF 0
+#define GRID_INJECTION_POWER_LIMIT_MAX 80
+#define GRID_INJECTION_POWER_LIMIT_OFF 0
+
+// Thresholds, set by block inputs on the Miniserver and by the sweep in backtests
+struct InverterSettings {
+    float chargeSpotPriceThreshold;            // Charge from grid below this spot price
+    float dischargeSpotPriceThreshold;         // Discharge to grid near the daily max above this spot price
+    float socDischargeToGridThreshold;         // The battery does not discharge to grid below this SOC
+    float pvProductionThreshold;               // Predicted PV today to push to grid in the morning
+    float spotPriceThreshold;                  // Spot price to enable PV push to grid
+    float onGridEndSOCProtectionUserSetting;
+    int morningHoursFrom;                      // Morning push to grid after this local hour
+    int morningHoursTill;                      // and before this one
+};
+
+struct InverterInputs {
+    float currentSpotPrice;
+    float maxSpotPrice;                        // Today
+    float currentInverterMode;
+    float predictedPVToday;
+    float soc;
+    float onGridEndSOCProtection;              // Current register value
+    int hour;                                  // Local
+};
+
+struct InverterDecision {
+    int mode;
+    int batteryMode;
+    int batteryChargeDischargePowerLimit;
+    int gridInjectionPowerLimit;
+    float onGridEndSOCProtection;
+    int excessEnergyAvailable;                 // For water heating
+    char* state;                               // Description for the text output
+};
+
+// Function to set the settings not given by inputs, the morning hours
+void initInverterSettings(struct InverterSettings* settings);
+
+// Function to determine the correct inverter state
+void decideInverterState(struct InverterSettings* settings, struct InverterInputs* inputs, struct InverterDecision* decision);
+
+#endif // INVERTER_STATE_H
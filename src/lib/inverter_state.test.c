@@ -0,0 +1,135 @@
+#include "inverter_state.h"
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+
+// Thresholds of the replay example in the README
+void init_settings(struct InverterSettings* settings) {
+    initInverterSettings(settings);
+    settings->chargeSpotPriceThreshold = 1.0f;
+    settings->dischargeSpotPriceThreshold = 3.0f;
+    settings->socDischargeToGridThreshold = 80;
+    settings->pvProductionThreshold = 30;
+    settings->spotPriceThreshold = 3.5f;
+    settings->onGridEndSOCProtectionUserSetting = 20;
+}
+
+// A price between the thresholds at noon, far below the day's max
+void init_inputs(struct InverterInputs* inputs) {
+    inputs->currentSpotPrice = 2.0f;
+    inputs->maxSpotPrice = 5.0f;
+    inputs->currentInverterMode = INVERTER_GENERAL_MODE;
+    inputs->predictedPVToday = 10;
+    inputs->soc = 50;
+    inputs->onGridEndSOCProtection = 20;
+    inputs->hour = 12;
+}
+
+void test_grid() {
+    printf("Testing charging from and discharging to grid...\n");
+
+    struct InverterSettings settings;
+    struct InverterInputs inputs;
+    struct InverterDecision decision;
+
+    init_settings(&settings);
+    init_inputs(&inputs);
+    inputs.currentSpotPrice = 0.5f;
+    decideInverterState(&settings, &inputs, &decision);
+    assert(decision.mode == INVERTER_ECONOMIC_MODE);
+    assert(decision.batteryMode == BATTERY_CHARGE_MODE);
+    assert(decision.batteryChargeDischargePowerLimit == BATTERY_POWER_LIMIT_CHARGE_MAX);
+    assert(decision.gridInjectionPowerLimit == GRID_INJECTION_POWER_LIMIT_OFF);
+    assert(decision.onGridEndSOCProtection == 50);
+    assert(decision.excessEnergyAvailable == 1);
+    assert(strcmp(decision.state, "Charging from grid") == 0);
+    printf("✓ Low prices charge from grid and hold the SOC\n");
+
+    init_inputs(&inputs);
+    inputs.currentSpotPrice = 4.8f;
+    inputs.soc = 90;
+    decideInverterState(&settings, &inputs, &decision);
+    assert(decision.batteryMode == BATTERY_DISCHARGE_MODE);
+    assert(decision.batteryChargeDischargePowerLimit == BATTERY_POWER_LIMIT_DISCHARGE_MAX);
+    assert(decision.gridInjectionPowerLimit == GRID_INJECTION_POWER_LIMIT_MAX);
+    assert(decision.onGridEndSOCProtection == 20);
+    assert(decision.excessEnergyAvailable == 0);
+    printf("✓ Prices near the day's max discharge a full battery to grid\n");
+
+    inputs.soc = 80;
+    decideInverterState(&settings, &inputs, &decision);
+    assert(decision.mode == INVERTER_GENERAL_MODE);
+    assert(strcmp(decision.state, "Grid injection enabled") == 0);
+    printf("✓ Discharging to grid stops at the SOC threshold\n");
+}
+
+void test_morning() {
+    printf("\nTesting the morning push to grid...\n");
+
+    struct InverterSettings settings;
+    struct InverterInputs inputs;
+    struct InverterDecision decision;
+
+    init_settings(&settings);
+    init_inputs(&inputs);
+    inputs.currentSpotPrice = 3.8f;
+    inputs.predictedPVToday = 40;
+    inputs.hour = 8;
+    inputs.soc = 24;
+    decideInverterState(&settings, &inputs, &decision);
+    assert(decision.mode == INVERTER_GENERAL_MODE);
+    printf("✓ The push needs the SOC 5 %% above the protection to start\n");
+
+    inputs.soc = 26;
+    decideInverterState(&settings, &inputs, &decision);
+    assert(decision.batteryMode == BATTERY_DISCHARGE_MODE);
+    assert(decision.batteryChargeDischargePowerLimit == BATTERY_POWER_LIMIT_OFF);
+    assert(decision.onGridEndSOCProtection == 26);
+    assert(strcmp(decision.state, "Morning push to grid") == 0);
+
+    inputs.currentInverterMode = decision.mode;
+    inputs.soc = 22;
+    decideInverterState(&settings, &inputs, &decision);
+    assert(strcmp(decision.state, "Morning push to grid") == 0);
+    assert(decision.onGridEndSOCProtection == 22);
+    printf("✓ and goes on above the protection, holding the SOC\n");
+
+    inputs.hour = settings.morningHoursTill;
+    decideInverterState(&settings, &inputs, &decision);
+    assert(decision.mode == INVERTER_GENERAL_MODE);
+    settings.morningHoursTill = 14;
+    decideInverterState(&settings, &inputs, &decision);
+    assert(strcmp(decision.state, "Morning push to grid") == 0);
+    printf("✓ Morning hours come from the settings\n");
+}
+
+void test_general() {
+    printf("\nTesting the general mode...\n");
+
+    struct InverterSettings settings;
+    struct InverterInputs inputs;
+    struct InverterDecision decision;
+
+    init_settings(&settings);
+    init_inputs(&inputs);
+    inputs.onGridEndSOCProtection = 50;
+    decideInverterState(&settings, &inputs, &decision);
+    assert(decision.mode == INVERTER_GENERAL_MODE);
+    assert(decision.batteryMode == BATTERY_NO_MODE);
+    assert(decision.gridInjectionPowerLimit == GRID_INJECTION_POWER_LIMIT_OFF);
+    assert(decision.onGridEndSOCProtection == 20);
+    assert(decision.excessEnergyAvailable == 1);
+    assert(strcmp(decision.state, "Grid injection disabled") == 0);
+    printf("✓ Cheap PV is kept and the protection goes back to the user setting\n");
+}
+
+int main() {
+    printf("Running inverter_state tests...\n\n");
+
+    test_grid();
+    test_morning();
+    test_general();
+
+    printf("\nAll tests passed! ✓\n");
+    return 0;
+}
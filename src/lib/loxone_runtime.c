@@ -0,0 +1,381 @@
+#include "loxone_runtime.h"
+#include <setjmp.h>
+#include <stdarg.h>
+
+// 2009-01-01 in days since 1970-01-01
+#define LOXONE_EPOCH_DAYS 14245
+
+struct loxone_io {
+    char name[LOXONE_IO_NAME];
+    float value;
+    loxone_source source;
+    void *context;
+};
+
+struct loxone_state {
+    unsigned int start;
+    unsigned long long elapsed_ms;
+    unsigned long long end_ms;
+    long sleeps;
+    int utc_offset;
+    int summer_time;
+
+    float inputs[LOXONE_MAX_INPUTS];
+    loxone_source sources[LOXONE_MAX_INPUTS];
+    void *source_contexts[LOXONE_MAX_INPUTS];
+    float event_values[LOXONE_MAX_INPUTS];   // Input values at the last getinputevent()
+    char input_texts[LOXONE_MAX_TEXT][LOXONE_TEXT_SIZE];
+    char event_texts[LOXONE_MAX_TEXT][LOXONE_TEXT_SIZE];
+    int text_inputs;
+
+    float outputs[LOXONE_MAX_OUTPUTS];
+    int output_changes[LOXONE_MAX_OUTPUTS];
+    char output_texts[LOXONE_MAX_TEXT][LOXONE_TEXT_SIZE];
+
+    struct loxone_io io[LOXONE_MAX_IO];
+    int io_count;
+
+    loxone_tick tick;
+    void *tick_context;
+    char *(*httpget)(void *context, char *address, char *page);
+    void *httpget_context;
+    FILE *record;
+    int skip_format;
+};
+
+struct loxone_state loxone;
+jmp_buf loxone_exit;
+
+void loxone_reset(unsigned int start) {
+    memset(&loxone, 0, sizeof(loxone));
+    loxone.start = start;
+    loxone.utc_offset = 3600;
+    loxone.summer_time = 1;
+}
+
+void loxone_set_start(unsigned int start) {
+    loxone.start = start;
+    loxone.elapsed_ms = 0;
+}
+
+void loxone_set_timezone(int utc_offset, int summer_time) {
+    loxone.utc_offset = utc_offset;
+    loxone.summer_time = summer_time;
+}
+
+void loxone_set_input(int input, float value) {
+    if (input < 0 || input >= LOXONE_MAX_INPUTS) return;
+    loxone.inputs[input] = value;
+}
+
+void loxone_set_input_text(int input, char *text) {
+    if (input < 0 || input >= LOXONE_MAX_TEXT) return;
+    snprintf(loxone.input_texts[input], LOXONE_TEXT_SIZE, "%s", text);
+}
+
+void loxone_set_input_source(int input, loxone_source source, void *context) {
+    if (input < 0 || input >= LOXONE_MAX_INPUTS) return;
+    loxone.sources[input] = source;
+    loxone.source_contexts[input] = context;
+}
+
+void loxone_set_text_inputs(int count) {
+    loxone.text_inputs = count;
+}
+
+// Find a virtual input by name, added when create is set. NULL when unknown or full.
+struct loxone_io *loxone_find_io(char *name, int create) {
+    int i;
+
+    for (i = 0; i < loxone.io_count; i++) {
+        if (strcmp(loxone.io[i].name, name) == 0) return &loxone.io[i];
+    }
+    if (create == 0 || loxone.io_count == LOXONE_MAX_IO || strlen(name) >= LOXONE_IO_NAME) return NULL;
+    strcpy(loxone.io[loxone.io_count].name, name);
+    return &loxone.io[loxone.io_count++];
+}
+
+void loxone_set_io_source(char *name, loxone_source source, void *context) {
+    struct loxone_io *io = loxone_find_io(name, 1);
+    if (io == NULL) return;
+    io->source = source;
+    io->context = context;
+}
+
+void loxone_set_tick(loxone_tick tick, void *context) {
+    loxone.tick = tick;
+    loxone.tick_context = context;
+}
+
+void loxone_set_httpget(char *(*handler)(void *context, char *address, char *page), void *context) {
+    loxone.httpget = handler;
+    loxone.httpget_context = context;
+}
+
+float loxone_output(int output) {
+    if (output < 0 || output >= LOXONE_MAX_OUTPUTS) return 0;
+    return loxone.outputs[output];
+}
+
+char *loxone_output_text(int output) {
+    if (output < 0 || output >= LOXONE_MAX_TEXT) return "";
+    return loxone.output_texts[output];
+}
+
+int loxone_output_changes(int output) {
+    if (output < 0 || output >= LOXONE_MAX_OUTPUTS) return 0;
+    return loxone.output_changes[output];
+}
+
+void loxone_record(FILE *file) {
+    loxone.record = file;
+}
+
+long loxone_run(void (*script)(void), unsigned int seconds) {
+    loxone.end_ms = loxone.elapsed_ms + (unsigned long long)seconds * 1000;
+    loxone.sleeps = 0;
+    if (setjmp(loxone_exit) == 0) {
+        script();
+    }
+    return loxone.sleeps;
+}
+
+unsigned long long loxone_elapsed_ms(void) {
+    return loxone.elapsed_ms;
+}
+
+void loxone_stop(void) {
+    longjmp(loxone_exit, 1);
+}
+
+void loxone_set_skip_format(int skip) {
+    loxone.skip_format = skip;
+}
+
+// Program block API
+
+float getinput(int input) {
+    if (input < 0 || input >= LOXONE_MAX_INPUTS) return 0;
+    if (loxone.sources[input] != NULL) {
+        return loxone.sources[input](loxone.source_contexts[input], getcurrenttime());
+    }
+    return loxone.inputs[input];
+}
+
+char *getinputtext(int input) {
+    if (input < 0 || input >= LOXONE_MAX_TEXT) return "";
+    return loxone.input_texts[input];
+}
+
+int getinputevent(void) {
+    int events = 0;
+    float value;
+    int bit;
+    int i;
+
+    for (i = 0; i < loxone.text_inputs && i < LOXONE_MAX_TEXT; i++) {
+        if (strcmp(loxone.input_texts[i], loxone.event_texts[i]) != 0) {
+            strcpy(loxone.event_texts[i], loxone.input_texts[i]);
+            events |= 1 << i;
+        }
+    }
+    for (i = 0; i < LOXONE_MAX_INPUTS; i++) {
+        value = getinput(i);
+        bit = loxone.text_inputs + i;
+        if (value != loxone.event_values[i]) {
+            loxone.event_values[i] = value;
+            if (bit < 31) events |= 1 << bit;
+        }
+    }
+    return events;
+}
+
+void setoutput(int output, float value) {
+    if (output < 0 || output >= LOXONE_MAX_OUTPUTS) return;
+    if (value == loxone.outputs[output] && loxone.output_changes[output] > 0) return;
+    loxone.outputs[output] = value;
+    loxone.output_changes[output]++;
+    if (loxone.record != NULL) {
+        fprintf(loxone.record, "%.3f,%d,%g\n", loxone.elapsed_ms / 1000.0, output, value);
+    }
+}
+
+void setoutputtext(int output, char *text) {
+    if (output < 0 || output >= LOXONE_MAX_TEXT) return;
+    if (strncmp(loxone.output_texts[output], text, LOXONE_TEXT_SIZE - 1) == 0) return;
+    snprintf(loxone.output_texts[output], LOXONE_TEXT_SIZE, "%s", text);
+    if (loxone.record != NULL) {
+        fprintf(loxone.record, "%.3f,text%d,\"%s\"\n", loxone.elapsed_ms / 1000.0, output, loxone.output_texts[output]);
+    }
+}
+
+float getio(char *name) {
+    struct loxone_io *io = loxone_find_io(name, 0);
+    if (io == NULL) return 0;
+    if (io->source != NULL) return io->source(io->context, getcurrenttime());
+    return io->value;
+}
+
+int setio(char *name, float value) {
+    struct loxone_io *io = loxone_find_io(name, 1);
+    if (io == NULL) return 0;
+    io->value = value;
+    return 1;
+}
+
+void setlogtext(char *text) {
+    if (loxone.record != NULL) {
+        fprintf(loxone.record, "%.3f,log,\"%s\"\n", loxone.elapsed_ms / 1000.0, text);
+    }
+}
+
+char *httpget(char *address, char *page) {
+    char *answer;
+    char *copy;
+
+    if (loxone.httpget == NULL) return NULL;
+    answer = loxone.httpget(loxone.httpget_context, address, page);
+    if (answer == NULL) return NULL;
+    copy = (char *)malloc(strlen(answer) + 1);
+    if (copy != NULL) strcpy(copy, answer);
+    return copy;
+}
+
+int loxone_sprintf(char *buffer, char *format, ...) {
+    va_list args;
+    int length;
+
+    if (loxone.skip_format && strchr(format, '%') != NULL) {
+        buffer[0] = '\0';
+        return 0;
+    }
+    va_start(args, format);
+    length = vsprintf(buffer, format, args);
+    va_end(args);
+    return length;
+}
+
+// Time functions
+
+// Days since 1970-01-01 of a civil date
+long loxone_days(long year, int month, int day) {
+    long era;
+    long year_of_era;
+    long day_of_year;
+
+    if (month <= 2) year--;
+    era = (year >= 0 ? year : year - 399) / 400;
+    year_of_era = year - era * 400;
+    day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    return era * 146097 + year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year - 719468;
+}
+
+// Civil date of days since 1970-01-01
+void loxone_date(long days, int *year, int *month, int *day) {
+    long era;
+    long day_of_era;
+    long year_of_era;
+    long day_of_year;
+    long month_index;
+
+    days += 719468;
+    era = (days >= 0 ? days : days - 146096) / 146097;
+    day_of_era = days - era * 146097;
+    year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    month_index = (5 * day_of_year + 2) / 153;
+    *day = day_of_year - (153 * month_index + 2) / 5 + 1;
+    *month = month_index < 10 ? month_index + 3 : month_index - 9;
+    *year = year_of_era + era * 400 + (*month <= 2);
+}
+
+// UTC seconds since 2009 of 01:00 UTC on the last Sunday of a month
+unsigned int loxone_last_sunday(int year, int month) {
+    long last = loxone_days(year, month + 1, 1) - 1;
+    long sunday = last - (last + 4) % 7;  // 1970-01-01 was a Thursday
+    return (unsigned int)((sunday - LOXONE_EPOCH_DAYS) * 86400 + 3600);
+}
+
+int loxone_summer_time(unsigned int timeutc) {
+    int year;
+    int month;
+    int day;
+
+    if (loxone.summer_time == 0) return 0;
+    loxone_date(LOXONE_EPOCH_DAYS + timeutc / 86400, &year, &month, &day);
+    return timeutc >= loxone_last_sunday(year, 3) && timeutc < loxone_last_sunday(year, 10);
+}
+
+unsigned int convertutc2local(unsigned int timeutc) {
+    return timeutc + loxone.utc_offset + 3600 * loxone_summer_time(timeutc);
+}
+
+unsigned int convertlocal2utc(unsigned int timelocal) {
+    unsigned int timeutc = timelocal - loxone.utc_offset;
+    if (loxone_summer_time(timeutc - 3600)) timeutc -= 3600;
+    return timeutc;
+}
+
+unsigned int getcurrenttime(void) {
+    return loxone.start + (unsigned int)(loxone.elapsed_ms / 1000);
+}
+
+unsigned int loxone_time(unsigned int time, int local) {
+    if (local) return convertutc2local(time);
+    return time;
+}
+
+int getyear(unsigned int time, int local) {
+    int year;
+    int month;
+    int day;
+    loxone_date(LOXONE_EPOCH_DAYS + loxone_time(time, local) / 86400, &year, &month, &day);
+    return year;
+}
+
+int getmonth(unsigned int time, int local) {
+    int year;
+    int month;
+    int day;
+    loxone_date(LOXONE_EPOCH_DAYS + loxone_time(time, local) / 86400, &year, &month, &day);
+    return month;
+}
+
+int getday(unsigned int time, int local) {
+    int year;
+    int month;
+    int day;
+    loxone_date(LOXONE_EPOCH_DAYS + loxone_time(time, local) / 86400, &year, &month, &day);
+    return day;
+}
+
+int gethour(unsigned int time, int local) {
+    return loxone_time(time, local) % 86400 / 3600;
+}
+
+int getminute(unsigned int time, int local) {
+    return loxone_time(time, local) % 3600 / 60;
+}
+
+int getsecond(unsigned int time, int local) {
+    return loxone_time(time, local) % 60;
+}
+
+unsigned int gettimeval(int year, int month, int day, int hour, int minutes, int seconds, int local) {
+    unsigned int time = (unsigned int)((loxone_days(year, month, day) - LOXONE_EPOCH_DAYS) * 86400
+                                       + hour * 3600 + minutes * 60 + seconds);
+    if (local) return convertlocal2utc(time);
+    return time;
+}
+
+void loxone_sleep(int ms) {
+    if (ms < 0) ms = 0;
+    loxone.elapsed_ms += ms;
+    loxone.sleeps++;
+    if (loxone.elapsed_ms >= loxone.end_ms) longjmp(loxone_exit, 1);
+    if (loxone.tick != NULL) loxone.tick(loxone.tick_context, loxone.elapsed_ms);
+}
+
+void sleeps(int s) {
+    loxone_sleep(s * 1000);
+}
@@ -0,0 +1,119 @@
+#ifndef LOXONE_RUNTIME_H
+#define LOXONE_RUNTIME_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "loxone_stream.h"
+
+// Host implementation of the program block API of the Miniserver (see
+// .cursor-rules), so the scripts in src/loxone run natively. Time is virtual:
+// sleep() advances the clock at once, so a simulated day of a 1 s loop takes
+// milliseconds. Inputs and virtual inputs are set directly or read from source
+// callbacks, outputs keep their last value and changes can be recorded.
+//
+// Scripts are turned into C by loxone_script, which moves their top-level
+// statements into loxone_script_main(). loxone_run() calls it and returns once
+// the script sleeps past the end of the run.
+
+#ifndef TRUE
+#define TRUE 1
+#define FALSE 0
+#endif
+
+#define LOXONE_MAX_INPUTS 16
+#define LOXONE_MAX_OUTPUTS 16
+#define LOXONE_MAX_TEXT 8
+#define LOXONE_MAX_IO 32
+#define LOXONE_IO_NAME 32
+#define LOXONE_TEXT_SIZE 256
+
+// Value of an input at a UTC time in seconds since 2009
+typedef float (*loxone_source)(void *context, unsigned int now);
+
+// Called after every sleep with the virtual time in ms since the start of the run
+typedef void (*loxone_tick)(void *context, unsigned long long elapsed_ms);
+
+// Function to clear all inputs, outputs and virtual inputs and set the clock to start
+void loxone_reset(unsigned int start);
+
+// Function to set the clock to start, keeping inputs and outputs
+void loxone_set_start(unsigned int start);
+
+// UTC offset of local time without daylight saving in seconds, and whether
+// European summer time applies (from the last Sunday of March to the last
+// Sunday of October, 01:00 UTC). Defaults to CET/CEST.
+void loxone_set_timezone(int utc_offset, int summer_time);
+
+// Inputs and virtual inputs, a source replaces a set value until it is removed with NULL
+void loxone_set_input(int input, float value);
+void loxone_set_input_text(int input, char *text);
+void loxone_set_input_source(int input, loxone_source source, void *context);
+void loxone_set_io_source(char *name, loxone_source source, void *context);
+void loxone_set_tick(loxone_tick tick, void *context);
+
+// Number of text inputs before the analog ones in getinputevent() bits, 0 by default
+void loxone_set_text_inputs(int count);
+
+// Function to answer httpget(), the returned text is copied. NULL fails the request.
+void loxone_set_httpget(char *(*handler)(void *context, char *address, char *page), void *context);
+
+// Last values written by the script
+float loxone_output(int output);
+char *loxone_output_text(int output);
+int loxone_output_changes(int output);
+
+// Function to write "<seconds>,<output>,<value>" for every change of an analog
+// output and "<seconds>,text<output>,<text>" for text outputs, NULL to stop
+void loxone_record(FILE *file);
+
+// Function to run the script for seconds of virtual time, returns the number of sleeps
+long loxone_run(void (*script)(void), unsigned int seconds);
+
+// Virtual time in ms since the start of the run
+unsigned long long loxone_elapsed_ms(void);
+
+// Function to end the run from a source or tick callback, loxone_run() returns at once
+void loxone_stop(void);
+
+// Function to skip sprintf() calls with conversions when skip is 1, their
+// buffers are left empty. Off after loxone_reset. Only for scripts that format
+// nothing but debug texts that way, formatting then takes most of the time of
+// long replays. Formats without conversions, like state names, are still copied.
+void loxone_set_skip_format(int skip);
+
+// The script, generated by loxone_script
+void loxone_script_main(void);
+
+// Program block API
+float getinput(int input);
+char *getinputtext(int input);
+int getinputevent(void);
+void setoutput(int output, float value);
+void setoutputtext(int output, char *text);
+float getio(char *name);
+int setio(char *name, float value);
+void setlogtext(char *text);
+char *httpget(char *address, char *page);
+int loxone_sprintf(char *buffer, char *format, ...);
+#define sprintf loxone_sprintf
+
+// Time functions, times are UTC seconds since 2009-01-01
+unsigned int getcurrenttime(void);
+int getyear(unsigned int time, int local);
+int getmonth(unsigned int time, int local);
+int getday(unsigned int time, int local);
+int gethour(unsigned int time, int local);
+int getminute(unsigned int time, int local);
+int getsecond(unsigned int time, int local);
+unsigned int gettimeval(int year, int month, int day, int hour, int minutes, int seconds, int local);
+unsigned int convertutc2local(unsigned int timeutc);
+unsigned int convertlocal2utc(unsigned int timelocal);
+
+// sleep() of the C library takes seconds, the scripts call the Miniserver one
+void loxone_sleep(int ms);
+void sleeps(int s);
+#define sleep(ms) loxone_sleep(ms)
+
+#endif // LOXONE_RUNTIME_H
@@ -0,0 +1,155 @@
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+#include "loxone_trace.h"
+
+// Run a script natively on the virtual clock and print its output changes:
+//
+//   script_<name> [--start YYYY-MM-DDTHH:MM] [--seconds <n>] [--input <i>=<value>]...
+//                 [--io <name>=<value>]... [--quiet]
+//   script_<name> --trace <file> [--map <column>=<target>]... [--log <file>] [--skip-text]
+//                 [--input <i>=<value>]... [--io <name>=<value>]... [--quiet]
+//
+// The start is local time, inputs and virtual inputs keep their values for the
+// whole run. Output changes are printed as CSV (see loxone_record) and a last
+// line reports the run: run sleeps=<n> simulated_s=<n> wall_ms=<f> speedup=<f>
+//
+// With --trace the script replays recorded telemetry instead (see
+// loxone_trace.h), --input and --io then set what the trace does not, like
+// thresholds. The decision log goes to --log or stdout, its first line
+// "# start=<unix time>" is the time base of the changes. --skip-text leaves
+// sprintf() results with conversions empty, faster for scripts that format
+// only debug texts. The last line reports the replay:
+// replay rows=<n> ticks=<n> wall_ms=<f> ticks_per_s=<f>
+
+double wall_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+int usage() {
+    printf("Usage: script_<name> [--start YYYY-MM-DDTHH:MM] [--seconds <n>] [--input <i>=<value>]...\n"
+           "                     [--io <name>=<value>]... [--quiet]\n"
+           "       script_<name> --trace <file> [--map <column>=<target>]... [--log <file>] [--skip-text]\n"
+           "                     [--input <i>=<value>]... [--io <name>=<value>]... [--quiet]\n");
+    return 1;
+}
+
+// Replay a trace, log is NULL for none
+int replay(char *path, char **maps, int map_count, FILE *log, int skip_text) {
+    struct trace trace;
+    char column[LOXONE_IO_NAME];
+    char *target;
+    double started;
+    long ticks;
+    int i;
+
+    if (trace_open(&trace, path) != 0) {
+        fprintf(stderr, "%s: %s\n", path, trace.error);
+        return 1;
+    }
+    for (i = 0; i < map_count; i++) {
+        target = strchr(maps[i], '=');
+        if (target == NULL || target - maps[i] >= LOXONE_IO_NAME) return usage();
+        memcpy(column, maps[i], target - maps[i]);
+        column[target - maps[i]] = '\0';
+        if (trace_map(&trace, column, target + 1) != 0) {
+            fprintf(stderr, "--map %s: %s\n", maps[i], trace.error);
+            return 1;
+        }
+    }
+    if (trace_peek_time(&trace) >= 0 && log != NULL) fprintf(log, "# start=%lld\n", trace_peek_time(&trace));
+    loxone_set_skip_format(skip_text);
+    loxone_record(log);
+
+    started = wall_ms();
+    ticks = trace_replay(&trace, loxone_script_main);
+    started = wall_ms() - started;
+    trace_close(&trace);
+    if (ticks < 0) {
+        fprintf(stderr, "%s: %s\n", path, trace.error);
+        return 1;
+    }
+    printf("replay rows=%ld ticks=%ld wall_ms=%.3f ticks_per_s=%.0f\n", trace.rows, ticks, started,
+           ticks * 1000.0 / (started > 0 ? started : 1e-3));
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    char name[LOXONE_IO_NAME];
+    unsigned int seconds = 24 * 3600;
+    int year = 2025;
+    int month = 2;
+    int day = 27;
+    int hour = 0;
+    int minute = 0;
+    int quiet = 0;
+    char *trace = NULL;
+    char *maps[TRACE_MAX_COLUMNS];
+    int map_count = 0;
+    char *log_path = NULL;
+    FILE *log = stdout;
+    int skip_text = 0;
+    int status;
+    double started;
+    long sleeps;
+    char *value;
+    int i;
+
+    loxone_reset(0);
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--start") == 0 && i + 1 < argc) {
+            if (sscanf(argv[++i], "%d-%d-%dT%d:%d", &year, &month, &day, &hour, &minute) < 3) return usage();
+        } else if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            seconds = (unsigned int)atol(argv[++i]);
+        } else if (strcmp(argv[i], "--input") == 0 && i + 1 < argc) {
+            value = strchr(argv[++i], '=');
+            if (value == NULL) return usage();
+            loxone_set_input(atoi(argv[i]), atof(value + 1));
+        } else if (strcmp(argv[i], "--io") == 0 && i + 1 < argc) {
+            value = strchr(argv[++i], '=');
+            if (value == NULL || value - argv[i] >= LOXONE_IO_NAME) return usage();
+            memcpy(name, argv[i], value - argv[i]);
+            name[value - argv[i]] = '\0';
+            setio(name, atof(value + 1));
+        } else if (strcmp(argv[i], "--quiet") == 0) {
+            quiet = 1;
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace = argv[++i];
+        } else if (strcmp(argv[i], "--map") == 0 && i + 1 < argc && map_count < TRACE_MAX_COLUMNS) {
+            maps[map_count++] = argv[++i];
+        } else if (strcmp(argv[i], "--log") == 0 && i + 1 < argc) {
+            log_path = argv[++i];
+        } else if (strcmp(argv[i], "--skip-text") == 0) {
+            skip_text = 1;
+        } else {
+            return usage();
+        }
+    }
+
+    if (trace != NULL) {
+        if (log_path != NULL) {
+            log = fopen(log_path, "w");
+            if (log == NULL) {
+                fprintf(stderr, "%s: can not write the log\n", log_path);
+                return 1;
+            }
+        } else if (quiet) {
+            log = NULL;
+        }
+        status = replay(trace, maps, map_count, log, skip_text);
+        if (log_path != NULL) fclose(log);
+        return status;
+    }
+
+    // Keep the inputs, move the clock to the start
+    loxone_set_start(gettimeval(year, month, day, hour, minute, 0, 1));
+    if (quiet == 0) loxone_record(stdout);
+
+    started = wall_ms();
+    sleeps = loxone_run(loxone_script_main, seconds);
+    started = wall_ms() - started;
+    printf("run sleeps=%ld simulated_s=%u wall_ms=%.3f speedup=%.0f\n", sleeps, seconds, started,
+           seconds * 1000.0 / (started > 0 ? started : 1e-3));
+    return 0;
+}
@@ -0,0 +1,220 @@
+#define _POSIX_C_SOURCE 199309L
+#include "loxone_runtime.h"
+#include <assert.h>
+#include <time.h>
+
+// Inputs of water-tank-heating-controller
+#define INPUT_TEMPERATURE_BELOW_TRESHOLD 0
+#define INPUT_SPOT_PRICE_VLOW 1
+#define INPUT_PREDICTED_PV_TODAY 2
+#define INPUT_PREDICTED_PV_TOMORROW 3
+#define INPUT_EXCESS_ENERGY_AVAILABLE 5
+#define OUTPUT_HEATING_ON_OFF 0
+
+int loops;
+
+// Scripts of the tests, the way loxone_script emits them
+void count_loops() {
+    while (TRUE) {
+        loops++;
+        sleep(250);
+    }
+}
+
+void count_seconds() {
+    while (TRUE) {
+        setoutput(0, getcurrenttime() % 60);
+        sleeps(1);
+    }
+}
+
+double wall_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+// PV power in kW over the local day, a sine from 6:00 to 20:00 peaking at 6 kW
+float pv_power(void* context, unsigned int now) {
+    double hour = convertutc2local(now) % 86400 / 3600.0;
+    (void)context;
+    if (hour < 6 || hour > 20) return 0;
+    return 6 * sin(3.14159265 * (hour - 6) / 14);
+}
+
+// Heating output sampled one second into every hour
+void sample_heating(void* context, unsigned long long elapsed_ms) {
+    int* heating = (int*)context;
+    if (elapsed_ms % 3600000 == 1000) {
+        heating[elapsed_ms / 3600000] = loxone_output(OUTPUT_HEATING_ON_OFF) == 1;
+    }
+}
+
+char* answer_page(void* context, char* address, char* page) {
+    (void)address;
+    if (strcmp(page, "/ok") == 0) return (char*)context;
+    return NULL;
+}
+
+void test_time() {
+    printf("Testing the time functions...\n");
+
+    unsigned int summer;
+    unsigned int change;
+
+    loxone_reset(0);
+    assert(gettimeval(2009, 1, 1, 0, 0, 0, 0) == 0);
+    assert(getyear(0, 0) == 2009 && getmonth(0, 0) == 1 && getday(0, 0) == 1);
+    assert(gethour(0, 1) == 1);
+    printf("✓ Epoch is 2009-01-01 UTC\n");
+
+    summer = gettimeval(2025, 7, 1, 12, 30, 15, 1);
+    assert(gethour(summer, 0) == 10);
+    assert(gethour(summer, 1) == 12);
+    assert(getminute(summer, 1) == 30 && getsecond(summer, 1) == 15);
+    assert(getyear(summer, 1) == 2025 && getmonth(summer, 1) == 7 && getday(summer, 1) == 1);
+    assert(gethour(gettimeval(2025, 2, 27, 12, 0, 0, 1), 0) == 11);
+    printf("✓ Local time is CET in winter and CEST in summer\n");
+
+    // Summer time starts at 01:00 UTC on the last Sunday of March
+    change = gettimeval(2025, 3, 30, 1, 0, 0, 0);
+    assert(gethour(change - 1, 1) == 1 && getminute(change - 1, 1) == 59);
+    assert(gethour(change, 1) == 3);
+    assert(getday(gettimeval(2024, 12, 31, 23, 30, 0, 0), 1) == 1);
+    assert(convertlocal2utc(convertutc2local(summer)) == summer);
+    assert(convertlocal2utc(convertutc2local(change)) == change);
+    printf("✓ Daylight saving changes on the last Sunday of March\n");
+
+    loxone_set_timezone(0, 0);
+    assert(gethour(summer, 1) == 10);
+    printf("✓ Time zone can be changed\n");
+}
+
+void test_run() {
+    printf("\nTesting runs on the virtual clock...\n");
+
+    unsigned int start = gettimeval(2025, 2, 27, 0, 0, 0, 1);
+    long sleeps;
+
+    loxone_reset(start);
+    loops = 0;
+    sleeps = loxone_run(count_loops, 10);
+    assert(sleeps == 40);
+    assert(loops == 40);
+    assert(loxone_elapsed_ms() == 10000);
+    assert(getcurrenttime() == start + 10);
+    printf("✓ Run ends when the script sleeps past its end\n");
+
+    // A second run starts the script again and continues the clock
+    sleeps = loxone_run(count_loops, 5);
+    assert(sleeps == 20);
+    assert(loops == 60);
+    assert(getcurrenttime() == start + 15);
+    printf("✓ Runs continue the clock\n");
+
+    loxone_set_start(start);
+    assert(loxone_elapsed_ms() == 0);
+    assert(loxone_run(count_seconds, 90) == 90);
+    assert(loxone_output(0) == 29);
+    assert(loxone_output_changes(0) == 90);
+    printf("✓ Outputs keep their last value and count changes\n");
+}
+
+void test_io() {
+    printf("\nTesting inputs and outputs...\n");
+
+    char* page;
+    FILE* record;
+    char line[64];
+
+    loxone_reset(0);
+    loxone_set_input(2, 1.5);
+    assert(getinput(2) == 1.5f);
+    assert(getinputevent() == 1 << 2);
+    assert(getinputevent() == 0);
+    loxone_set_input_source(2, pv_power, NULL);
+    assert(getinput(2) == 0);
+    printf("✓ Inputs report changes as events once\n");
+
+    loxone_reset(0);
+    loxone_set_text_inputs(2);
+    loxone_set_input_text(1, "on");
+    loxone_set_input(0, 3);
+    assert(strcmp(getinputtext(1), "on") == 0);
+    assert(getinputevent() == ((1 << 1) | (1 << 2)));
+    printf("✓ Text inputs come first in events\n");
+
+    assert(getio("AMQ125") == 0);
+    assert(setio("AMQ125", 4.5) == 1);
+    assert(getio("AMQ125") == 4.5f);
+    loxone_set_io_source("AMQ125", pv_power, NULL);
+    assert(getio("AMQ125") == 0);
+    printf("✓ Virtual inputs are set by name or read from sources\n");
+
+    assert(httpget("api.forecast.solar", "/ok") == NULL);
+    loxone_set_httpget(answer_page, "{\"result\":{}}");
+    page = httpget("api.forecast.solar", "/ok");
+    assert(page != NULL && strcmp(page, "{\"result\":{}}") == 0);
+    free(page);
+    assert(httpget("api.forecast.solar", "/missing") == NULL);
+    printf("✓ httpget answers from a handler\n");
+
+    record = tmpfile();
+    assert(record != NULL);
+    loxone_record(record);
+    setoutput(1, 2.5);
+    setoutput(1, 2.5);
+    setoutputtext(0, "Heating");
+    loxone_record(NULL);
+    rewind(record);
+    assert(fgets(line, sizeof(line), record) != NULL && strcmp(line, "0.000,1,2.5\n") == 0);
+    assert(fgets(line, sizeof(line), record) != NULL && strcmp(line, "0.000,text0,\"Heating\"\n") == 0);
+    assert(fgets(line, sizeof(line), record) == NULL);
+    fclose(record);
+    printf("✓ Output changes are recorded\n");
+}
+
+void test_water_tank_day() {
+    printf("\nTesting a day of water-tank-heating-controller...\n");
+
+    int heating[24];
+    double started;
+    long sleeps;
+
+    loxone_reset(gettimeval(2025, 2, 27, 0, 0, 0, 1));
+    loxone_set_input(INPUT_TEMPERATURE_BELOW_TRESHOLD, 1);
+    loxone_set_input(INPUT_SPOT_PRICE_VLOW, 1);
+    loxone_set_input(INPUT_PREDICTED_PV_TODAY, 30);
+    loxone_set_input(INPUT_PREDICTED_PV_TOMORROW, 5);
+    loxone_set_input(INPUT_EXCESS_ENERGY_AVAILABLE, 1);
+    loxone_set_io_source("AMQ125", pv_power, NULL);
+    loxone_set_tick(sample_heating, heating);
+
+    started = wall_ms();
+    sleeps = loxone_run(loxone_script_main, 24 * 3600);
+    started = wall_ms() - started;
+    assert(sleeps == 24 * 3600);
+
+    // Heats at night for the poor forecast of tomorrow, during the day only on PV
+    assert(heating[0] == 1 && heating[5] == 1);
+    assert(heating[6] == 0 && heating[7] == 0);
+    assert(heating[9] == 1 && heating[12] == 1 && heating[17] == 1);
+    assert(heating[19] == 0 && heating[20] == 0);
+    assert(heating[21] == 1 && heating[23] == 1);
+    assert(loxone_output_changes(OUTPUT_HEATING_ON_OFF) == 5);
+    assert(strstr(loxone_output_text(0), "Current hour: 23") != NULL);
+    printf("✓ Heating follows the PV power and the forecast\n");
+    printf("✓ Simulated day of 86400 loops in %.1f ms\n", started);
+}
+
+int main() {
+    printf("Running loxone_runtime tests...\n\n");
+
+    test_time();
+    test_run();
+    test_io();
+    test_water_tank_day();
+
+    printf("\nAll tests passed! ✓\n");
+    return 0;
+}
@@ -0,0 +1,275 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+// Script adapter: turns a program block script into C that compiles against
+// loxone_runtime. PicoC runs statements at the top level of a script, C does
+// not, so the script is split into its top-level items:
+//
+//   - preprocessor lines, function definitions and declarations stay at file
+//     scope, so functions of the script see its variables
+//   - every other statement, and declarations whose initializer calls a
+//     function, move in order into void loxone_script_main(void)
+//
+// #line directives keep compiler messages pointing into the script.
+//
+// Usage: loxone_script <script> <output> [header...]
+// The headers are included after loxone_runtime.h, for the libraries a bundle
+// would concatenate in front of the script.
+
+char *script_path;
+char *text;
+int length;
+
+void fail(char *message, int line) {
+    fprintf(stderr, "%s:%d: %s\n", script_path, line, message);
+    exit(1);
+}
+
+int line_at(int position) {
+    int line = 1;
+    int i;
+    for (i = 0; i < position; i++) {
+        if (text[i] == '\n') line++;
+    }
+    return line;
+}
+
+// Skip a comment, string or character literal at p, returns the position after it or p
+int skip_literal(int p) {
+    char quote;
+
+    if (text[p] == '/' && text[p + 1] == '/') {
+        while (p < length && text[p] != '\n') p++;
+        return p;
+    }
+    if (text[p] == '/' && text[p + 1] == '*') {
+        p += 2;
+        while (p < length && (text[p] != '*' || text[p + 1] != '/')) p++;
+        if (p >= length) fail("unterminated comment", line_at(p));
+        return p + 2;
+    }
+    if (text[p] == '"' || text[p] == '\'') {
+        quote = text[p++];
+        while (p < length && text[p] != quote) {
+            if (text[p] == '\\') p++;
+            p++;
+        }
+        if (p >= length) fail("unterminated literal", line_at(p));
+        return p + 1;
+    }
+    return p;
+}
+
+// Skip white space and comments
+int skip_space(int p) {
+    int next;
+    while (p < length) {
+        if (isspace((unsigned char)text[p])) {
+            p++;
+            continue;
+        }
+        next = skip_literal(p);
+        if (next == p || text[p] == '"' || text[p] == '\'') return p;
+        p = next;
+    }
+    return p;
+}
+
+// Copy the identifier at p into word, empty if there is none
+void read_word(int p, char *word, int size) {
+    int n = 0;
+    while (p < length && (isalnum((unsigned char)text[p]) || text[p] == '_') && n < size - 1) {
+        word[n++] = text[p++];
+    }
+    word[n] = '\0';
+}
+
+int is_type(char *word) {
+    char *types[] = {"int", "float", "double", "char", "unsigned", "signed", "long", "short", "void",
+                     "struct", "enum", "union", "typedef", "static", "extern", "STREAM", "FILE"};
+    int i;
+    for (i = 0; i < (int)(sizeof(types) / sizeof(types[0])); i++) {
+        if (strcmp(word, types[i]) == 0) return 1;
+    }
+    return 0;
+}
+
+// End of a preprocessor line, with continuation lines
+int directive_end(int p) {
+    while (p < length && text[p] != '\n') {
+        if (text[p] == '\\' && text[p + 1] == '\n') p++;
+        p++;
+    }
+    return p;
+}
+
+// End of a declaration or a function definition starting at p. Sets *function
+// for definitions and *call for declarations whose initializer calls a function.
+int declaration_end(int p, int *function, int *call) {
+    int parens = 0;
+    int braces = 0;
+    int initializer = 0;
+    int next;
+
+    *function = 0;
+    *call = 0;
+    while (p < length) {
+        next = skip_literal(p);
+        if (next != p) {
+            p = next;
+            continue;
+        }
+        if (text[p] == '(') {
+            if (parens == 0 && braces == 0 && initializer) *call = 1;
+            parens++;
+        } else if (text[p] == ')') {
+            parens--;
+        } else if (text[p] == '=' && parens == 0 && braces == 0) {
+            initializer = 1;
+        } else if (text[p] == '{') {
+            // A body right after the parameter list
+            if (braces == 0 && parens == 0 && initializer == 0) {
+                next = p - 1;
+                while (next > 0 && isspace((unsigned char)text[next])) next--;
+                if (text[next] == ')') *function = 1;
+            }
+            braces++;
+        } else if (text[p] == '}') {
+            braces--;
+            if (braces == 0 && *function) return p + 1;
+        } else if (text[p] == ';' && parens == 0 && braces == 0) {
+            return p + 1;
+        }
+        p++;
+    }
+    fail("declaration does not end", line_at(p));
+    return p;
+}
+
+// End of a statement starting at p, with else branches and do-while
+int statement_end(int p) {
+    char word[16];
+    int parens = 0;
+    int braces = 0;
+    int is_do;
+    int next;
+
+    read_word(p, word, sizeof(word));
+    is_do = strcmp(word, "do") == 0;
+    while (p < length) {
+        next = skip_literal(p);
+        if (next != p) {
+            p = next;
+            continue;
+        }
+        if (text[p] == '(') {
+            parens++;
+        } else if (text[p] == ')') {
+            parens--;
+        } else if (text[p] == '{') {
+            braces++;
+        } else if (text[p] == '}' || (text[p] == ';' && parens == 0 && braces == 0)) {
+            if (text[p] == '}') braces--;
+            if (braces == 0 && parens == 0) {
+                next = skip_space(p + 1);
+                read_word(next, word, sizeof(word));
+                if (strcmp(word, "else") == 0) {
+                    p = next + 4;
+                    continue;
+                }
+                if (is_do && text[p] == '}') {
+                    is_do = 0;
+                } else {
+                    return p + 1;
+                }
+            }
+        }
+        p++;
+    }
+    fail("statement does not end", line_at(p));
+    return p;
+}
+
+void emit(FILE *out, int start, int end) {
+    fprintf(out, "#line %d \"%s\"\n", line_at(start), script_path);
+    fwrite(text + start, 1, end - start, out);
+    fputc('\n', out);
+}
+
+int main(int argc, char **argv) {
+    FILE *in;
+    FILE *out;
+    FILE *statements;
+    char word[64];
+    char *body;
+    long body_length;
+    int function;
+    int call;
+    int start;
+    int end;
+    int p;
+    int i;
+
+    if (argc < 3) {
+        fprintf(stderr, "Usage: loxone_script <script> <output> [header...]\n");
+        return 1;
+    }
+    script_path = argv[1];
+    in = fopen(script_path, "rb");
+    if (in == NULL) fail("can not open the script", 0);
+    fseek(in, 0, SEEK_END);
+    length = ftell(in);
+    fseek(in, 0, SEEK_SET);
+    text = (char *)calloc(length + 2, 1);
+    if (fread(text, 1, length, in) != (size_t)length) fail("can not read the script", 0);
+    fclose(in);
+
+    out = fopen(argv[2], "wb");
+    statements = tmpfile();
+    if (out == NULL || statements == NULL) fail("can not write", 0);
+    fprintf(out, "// Generated by loxone_script from %s, do not edit\n\n", script_path);
+    fprintf(out, "#include \"loxone_runtime.h\"\n");
+    for (i = 3; i < argc; i++) {
+        fprintf(out, "#include \"%s\"\n", argv[i]);
+    }
+    fprintf(out, "\n");
+
+    p = skip_space(0);
+    while (p < length) {
+        start = p;
+        if (text[p] == '#') {
+            end = directive_end(p);
+            emit(out, start, end);
+        } else {
+            read_word(p, word, sizeof(word));
+            if (is_type(word)) {
+                end = declaration_end(p, &function, &call);
+                if (call) {
+                    emit(statements, start, end);
+                } else {
+                    emit(out, start, end);
+                }
+            } else {
+                end = statement_end(p);
+                emit(statements, start, end);
+            }
+        }
+        p = skip_space(end);
+    }
+
+    // The statements, in script order
+    fprintf(out, "\nvoid loxone_script_main(void) {\n");
+    body_length = ftell(statements);
+    body = (char *)malloc(body_length + 1);
+    fseek(statements, 0, SEEK_SET);
+    if (fread(body, 1, body_length, statements) != (size_t)body_length) fail("can not read back the statements", 0);
+    fwrite(body, 1, body_length, out);
+    fprintf(out, "}\n");
+    fclose(statements);
+    fclose(out);
+    free(body);
+    free(text);
+    return 0;
+}
@@ -0,0 +1,118 @@
+#define _POSIX_C_SOURCE 200112L
+#include "loxone_stream.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/socket.h>
+
+// Host implementation of the Miniserver streams. "/dev/tcp/<host>/<port>"
+// opens a TCP connection, any other name a file. Reads of a connection wait at
+// most timeout ms and give 0 when nothing arrived and -1 once the peer closed
+// or reset the connection, as the program blocks expect.
+
+struct stream {
+    int socket;   // -1 for files
+    FILE* file;
+};
+
+// Connect to "<host>/<port>", returns the socket or -1
+int stream_connect(char* address) {
+    char host[256];
+    char* port;
+    struct addrinfo hints;
+    struct addrinfo* found;
+    struct addrinfo* a;
+    int fd = -1;
+
+    if (strlen(address) >= sizeof(host)) return -1;
+    strcpy(host, address);
+    port = strrchr(host, '/');
+    if (port == NULL) return -1;
+    *port++ = '\0';
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(host, port, &hints, &found) != 0) return -1;
+    for (a = found; a != NULL; a = a->ai_next) {
+        fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (fd < 0) continue;
+        if (connect(fd, a->ai_addr, a->ai_addrlen) == 0) break;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(found);
+    return fd;
+}
+
+STREAM* stream_create(char* filename, int read, int append) {
+    STREAM* s = (STREAM*)malloc(sizeof(STREAM));
+    if (s == NULL) return NULL;
+    s->socket = -1;
+    s->file = NULL;
+
+    if (strncmp(filename, "/dev/tcp/", 9) == 0) {
+        s->socket = stream_connect(filename + 9);
+        if (s->socket < 0) {
+            free(s);
+            return NULL;
+        }
+        return s;
+    }
+
+    if (read) {
+        s->file = fopen(filename, "rb");
+    } else if (append) {
+        s->file = fopen(filename, "ab");
+    } else {
+        s->file = fopen(filename, "wb");
+    }
+    if (s->file == NULL) {
+        free(s);
+        return NULL;
+    }
+    return s;
+}
+
+int stream_write(STREAM* s, void* ptr, int size) {
+    int written = 0;
+    int n;
+
+    if (s->socket < 0) return fwrite(ptr, 1, size, s->file);
+    while (written < size) {
+        n = send(s->socket, (char*)ptr + written, size - written, MSG_NOSIGNAL);
+        if (n <= 0) break;
+        written += n;
+    }
+    return written;
+}
+
+void stream_flush(STREAM* s) {
+    if (s->file != NULL) fflush(s->file);
+}
+
+int stream_read(STREAM* s, void* ptr, int size, int timeout) {
+    struct pollfd p;
+    int n;
+
+    if (s->socket < 0) return fread(ptr, 1, size, s->file);
+    p.fd = s->socket;
+    p.events = POLLIN;
+    p.revents = 0;
+    n = poll(&p, 1, timeout);
+    if (n == 0) return 0;
+    if (n < 0) return -1;
+    n = recv(s->socket, ptr, size, 0);
+    if (n <= 0) return -1;
+    return n;
+}
+
+void stream_close(STREAM* s) {
+    if (s == NULL) return;
+    if (s->socket >= 0) close(s->socket);
+    if (s->file != NULL) fclose(s->file);
+    free(s);
+}
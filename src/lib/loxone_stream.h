@@ -0,0 +1,14 @@
+#ifndef LOXONE_STREAM_H
+#define LOXONE_STREAM_H
+
+// Stream functions of the Miniserver for host builds, where they come from a
+// test fake or from loxone_stream.c. PicoC provides them itself, so this is
+// not bundled.
+typedef struct stream STREAM;
+STREAM *stream_create(char* filename, int read, int append);
+int stream_write(STREAM* stream, void* ptr, int size);
+void stream_flush(STREAM* stream);
+int stream_read(STREAM* stream, void* ptr, int size, int timeout);
+void stream_close(STREAM* stream);
+
+#endif // LOXONE_STREAM_H
@@ -0,0 +1,361 @@
+#define _POSIX_C_SOURCE 200112L
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "loxone_trace.h"
+
+int trace_fail(struct trace *trace, char *message) {
+    snprintf(trace->error, sizeof(trace->error), "%s", message);
+    return -1;
+}
+
+int trace_fail_row(struct trace *trace, char *message) {
+    snprintf(trace->error, sizeof(trace->error), "row %ld: %s", trace->rows + 1, message);
+    return -1;
+}
+
+// Parse the decimal number at p, the text ends before end. Returns the
+// position after it or NULL if there is no number.
+char *trace_number(char *p, char *end, double *value) {
+    double number = 0;
+    double scale = 1;
+    int negative = 0;
+    int digits = 0;
+    int exponent = 0;
+    int exponent_negative = 0;
+
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        p++;
+    }
+    while (p < end && *p >= '0' && *p <= '9') {
+        number = number * 10 + (*p++ - '0');
+        digits++;
+    }
+    if (p < end && *p == '.') {
+        p++;
+        while (p < end && *p >= '0' && *p <= '9') {
+            number = number * 10 + (*p++ - '0');
+            scale *= 10;
+            digits++;
+        }
+    }
+    if (digits == 0) return NULL;
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        if (p < end && (*p == '-' || *p == '+')) {
+            exponent_negative = *p == '-';
+            p++;
+        }
+        if (p == end || *p < '0' || *p > '9') return NULL;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (exponent < 400) exponent = exponent * 10 + (*p - '0');
+            p++;
+        }
+        while (exponent-- > 0) {
+            if (exponent_negative) {
+                scale *= 10;
+            } else {
+                scale /= 10;
+            }
+        }
+    }
+    *value = negative ? -number / scale : number / scale;
+    return p;
+}
+
+// Read the column names of a CSV header, the first field names the time
+int trace_csv_header(struct trace *trace) {
+    char *p = trace->data;
+    char *end = trace->data + trace->size;
+    char *name;
+    int length;
+
+    while (p < end && *p != ',' && *p != '\n') p++;
+    while (p < end && *p == ',') {
+        name = ++p;
+        while (p < end && *p != ',' && *p != '\n' && *p != '\r') p++;
+        length = p - name;
+        if (length == 0) return trace_fail(trace, "empty column name");
+        if (length >= LOXONE_IO_NAME) return trace_fail(trace, "column name too long");
+        if (trace->columns == TRACE_MAX_COLUMNS) return trace_fail(trace, "too many columns");
+        memcpy(trace->names[trace->columns], name, length);
+        trace->names[trace->columns][length] = '\0';
+        trace->columns++;
+    }
+    if (p < end && *p == '\r') p++;
+    if (p < end && *p != '\n') return trace_fail(trace, "malformed header");
+    if (trace->columns == 0) return trace_fail(trace, "no columns");
+    trace->position = p - trace->data;
+    return 0;
+}
+
+int trace_binary_header(struct trace *trace) {
+    struct trace_header header;
+    size_t row_size;
+    int i;
+
+    if (trace->size < sizeof(header)) return trace_fail(trace, "truncated header");
+    memcpy(&header, trace->data, sizeof(header));
+    if (header.columns == 0 || header.columns > TRACE_MAX_COLUMNS) return trace_fail(trace, "bad column count");
+    row_size = sizeof(unsigned int) + header.columns * sizeof(float);
+    if ((trace->size - sizeof(header)) % row_size != 0) return trace_fail(trace, "truncated rows");
+    trace->binary = 1;
+    trace->columns = header.columns;
+    for (i = 0; i < trace->columns; i++) {
+        memcpy(trace->names[i], header.names[i], LOXONE_IO_NAME);
+        trace->names[i][LOXONE_IO_NAME - 1] = '\0';
+    }
+    trace->position = sizeof(header);
+    return 0;
+}
+
+int trace_open(struct trace *trace, char *path) {
+    struct stat st;
+    int status;
+    int fd;
+    int i;
+
+    memset(trace, 0, sizeof(*trace));
+    for (i = 0; i < TRACE_MAX_COLUMNS; i++) trace->values[i] = NAN;
+    trace->next_time = -1;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) return trace_fail(trace, "can not open the trace");
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return trace_fail(trace, "empty trace");
+    }
+    trace->size = st.st_size;
+    trace->data = (char *)mmap(NULL, trace->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (trace->data == MAP_FAILED) {
+        trace->data = NULL;
+        return trace_fail(trace, "can not map the trace");
+    }
+    posix_madvise(trace->data, trace->size, POSIX_MADV_SEQUENTIAL);
+
+    if (trace->size >= 4 && memcmp(trace->data, TRACE_MAGIC, 4) == 0) {
+        status = trace_binary_header(trace);
+    } else {
+        status = trace_csv_header(trace);
+    }
+    if (status != 0) {
+        trace_close(trace);
+        return -1;
+    }
+    for (i = 0; i < trace->columns; i++) {
+        trace_map(trace, trace->names[i], trace->names[i]);
+    }
+    return 0;
+}
+
+int trace_map(struct trace *trace, char *column, char *target) {
+    char *digits;
+    int input;
+    int i;
+
+    for (i = 0; i < trace->columns; i++) {
+        if (strcmp(trace->names[i], column) == 0) break;
+    }
+    if (i == trace->columns) return trace_fail(trace, "unknown column");
+    if (strlen(target) >= LOXONE_IO_NAME) return trace_fail(trace, "target name too long");
+
+    trace->inputs[i] = -1;
+    strcpy(trace->targets[i], target);
+    if (strcmp(target, "-") == 0) {
+        trace->inputs[i] = -2;
+    } else if (strncmp(target, "input", 5) == 0 && target[5] != '\0') {
+        input = 0;
+        for (digits = target + 5; *digits >= '0' && *digits <= '9'; digits++) {
+            input = input * 10 + (*digits - '0');
+        }
+        if (*digits == '\0') {
+            if (input >= LOXONE_MAX_INPUTS) return trace_fail(trace, "input out of range");
+            trace->inputs[i] = input;
+        }
+    }
+    return 0;
+}
+
+// Position of the start of the next CSV row, past empty lines
+size_t trace_csv_row(struct trace *trace) {
+    size_t position = trace->position;
+    while (position < trace->size && (trace->data[position] == '\n' || trace->data[position] == '\r')) {
+        position++;
+    }
+    return position;
+}
+
+int trace_next_csv(struct trace *trace) {
+    char *end = trace->data + trace->size;
+    char *p = trace->data + trace_csv_row(trace);
+    long long time;
+    double value;
+    int column;
+
+    if (p == end) {
+        trace->position = trace->size;
+        return 0;
+    }
+    p = trace_number(p, end, &value);
+    if (p == NULL) return trace_fail_row(trace, "time is not a number");
+    time = (long long)value;
+    for (column = 0; p < end && *p == ','; column++) {
+        p++;
+        if (column == trace->columns) return trace_fail_row(trace, "too many fields");
+        if (p < end && *p != ',' && *p != '\n' && *p != '\r') {
+            p = trace_number(p, end, &value);
+            if (p == NULL) return trace_fail_row(trace, "value is not a number");
+            trace->values[column] = (float)value;
+        }
+    }
+    if (p < end && *p == '\r') p++;
+    if (p < end && *p != '\n') return trace_fail_row(trace, "malformed field");
+    if (trace->rows > 0 && time < trace->time) return trace_fail_row(trace, "time goes back");
+    trace->position = p - trace->data;
+    trace->time = time;
+    return 1;
+}
+
+int trace_next_binary(struct trace *trace) {
+    char *p = trace->data + trace->position;
+    unsigned int time;
+    float value;
+    int i;
+
+    if (trace->position == trace->size) return 0;
+    memcpy(&time, p, sizeof(time));
+    if (trace->rows > 0 && time < trace->time) return trace_fail_row(trace, "time goes back");
+    for (i = 0; i < trace->columns; i++) {
+        memcpy(&value, p + sizeof(time) + i * sizeof(value), sizeof(value));
+        if (!isnan(value)) trace->values[i] = value;
+    }
+    trace->position += sizeof(time) + trace->columns * sizeof(value);
+    trace->time = time;
+    return 1;
+}
+
+int trace_next(struct trace *trace) {
+    int status;
+
+    if (trace->binary) {
+        status = trace_next_binary(trace);
+    } else {
+        status = trace_next_csv(trace);
+    }
+    trace->next_time = -1;
+    if (status == 1) trace->rows++;
+    return status;
+}
+
+long long trace_peek_time(struct trace *trace) {
+    unsigned int time;
+    double value;
+    size_t position;
+
+    if (trace->next_time >= 0) return trace->next_time;
+    if (trace->binary) {
+        if (trace->position == trace->size) return -1;
+        memcpy(&time, trace->data + trace->position, sizeof(time));
+        trace->next_time = time;
+    } else {
+        position = trace_csv_row(trace);
+        if (position == trace->size) return -1;
+        // A row without a time peeks as 0, reading it reports the error
+        if (trace_number(trace->data + position, trace->data + trace->size, &value) == NULL) return 0;
+        trace->next_time = (long long)value;
+    }
+    return trace->next_time;
+}
+
+void trace_close(struct trace *trace) {
+    if (trace->data != NULL) munmap(trace->data, trace->size);
+    trace->data = NULL;
+}
+
+long trace_write_binary(struct trace *trace, char *path) {
+    struct trace_header header;
+    unsigned int time;
+    FILE *out;
+    long rows = 0;
+    int status;
+    int i;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRACE_MAGIC, 4);
+    header.columns = trace->columns;
+    for (i = 0; i < trace->columns; i++) {
+        strcpy(header.names[i], trace->names[i]);
+    }
+    out = fopen(path, "wb");
+    if (out == NULL) return trace_fail(trace, "can not write the binary trace");
+    fwrite(&header, sizeof(header), 1, out);
+
+    // Held values are written again, NAN only stays before the first value of a column
+    while ((status = trace_next(trace)) == 1) {
+        if (trace->time < 0 || trace->time > 0xFFFFFFFFLL) {
+            fclose(out);
+            return trace_fail_row(trace, "time out of range");
+        }
+        time = (unsigned int)trace->time;
+        fwrite(&time, sizeof(time), 1, out);
+        fwrite(trace->values, sizeof(float), trace->columns, out);
+        rows++;
+    }
+    if (ferror(out)) status = trace_fail(trace, "can not write the binary trace");
+    fclose(out);
+    if (status < 0) return -1;
+    return rows;
+}
+
+// Set the inputs from the current values
+void trace_apply(struct trace *trace) {
+    int i;
+
+    for (i = 0; i < trace->columns; i++) {
+        if (isnan(trace->values[i]) || trace->inputs[i] == -2) continue;
+        if (trace->inputs[i] >= 0) {
+            loxone_set_input(trace->inputs[i], trace->values[i]);
+        } else {
+            setio(trace->targets[i], trace->values[i]);
+        }
+    }
+}
+
+// Tick of a replay: apply the rows up to the current time, stop after the last
+void trace_tick(void *context, unsigned long long elapsed_ms) {
+    struct trace *trace = (struct trace *)context;
+    long long now = TRACE_UNIX_2009 + getcurrenttime();
+    long long next = trace_peek_time(trace);
+    int read = 0;
+
+    (void)elapsed_ms;
+    while (next >= 0 && next <= now) {
+        if (trace_next(trace) < 0) loxone_stop();
+        read = 1;
+        next = trace_peek_time(trace);
+    }
+    if (read) trace_apply(trace);
+    if (next < 0 && now > trace->time) loxone_stop();
+}
+
+long trace_replay(struct trace *trace, void (*script)(void)) {
+    long ticks;
+    int status;
+
+    trace->error[0] = '\0';
+    status = trace_next(trace);
+    if (status == 0) return trace_fail(trace, "no rows");
+    if (status < 0) return -1;
+    if (trace->time < TRACE_UNIX_2009) return trace_fail(trace, "time before 2009");
+
+    loxone_set_start((unsigned int)(trace->time - TRACE_UNIX_2009));
+    trace_apply(trace);
+    loxone_set_tick(trace_tick, trace);
+    ticks = loxone_run(script, 0xFFFFFFFF);
+    loxone_set_tick(NULL, NULL);
+    if (trace->error[0] != '\0') return -1;
+    return ticks;
+}
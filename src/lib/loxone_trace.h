@@ -0,0 +1,72 @@
+#ifndef LOXONE_TRACE_H
+#define LOXONE_TRACE_H
+
+#include "loxone_runtime.h"
+
+// Recorded telemetry replayed through a script on the virtual clock. A trace
+// is a series of rows of a time in Unix seconds and a value per column:
+//
+//   CSV     a header "time,<column>,..." and rows like "1735689600,2.41,,57",
+//           an empty field keeps the value of the row before
+//   binary  a struct trace_header and rows of an unsigned int time and a float
+//           per column, NAN keeps the value of the row before (trace_write_binary)
+//
+// The file is memory mapped and read one row at a time, so a year of 1 s data
+// replays without loading it. A column named "input<n>" sets getinput(n), any
+// other name the virtual input of that name; trace_map() wires them differently.
+
+#define TRACE_MAX_COLUMNS 32
+#define TRACE_MAGIC "LXT1"
+
+// Unix time of 2009-01-01, the epoch of the Miniserver
+#define TRACE_UNIX_2009 1230768000LL
+
+struct trace_header {
+    char magic[4];
+    unsigned int columns;
+    char names[TRACE_MAX_COLUMNS][LOXONE_IO_NAME];
+};
+
+struct trace {
+    char *data;
+    size_t size;
+    size_t position;   // Of the next row
+    int binary;
+    int columns;
+    char names[TRACE_MAX_COLUMNS][LOXONE_IO_NAME];
+
+    // Where each column goes: an input, else the virtual input named in targets, -2 for nowhere
+    int inputs[TRACE_MAX_COLUMNS];
+    char targets[TRACE_MAX_COLUMNS][LOXONE_IO_NAME];
+
+    long long time;                     // Of the current row
+    float values[TRACE_MAX_COLUMNS];    // Current values, NAN until a row sets them
+    long long next_time;                // Of the row after, -1 until peeked
+    long rows;
+    char error[128];
+};
+
+// Function to open and map a trace, the format is told by the magic. 0 on success, -1 with error set.
+int trace_open(struct trace *trace, char *path);
+
+// Function to send a column to target, "input<n>", a virtual input or "-" for nowhere. -1 if the column is unknown.
+int trace_map(struct trace *trace, char *column, char *target);
+
+// Function to read the next row into time and values. 1 for a row, 0 at the end, -1 with error set.
+int trace_next(struct trace *trace);
+
+// Time of the next row without reading it, -1 at the end
+long long trace_peek_time(struct trace *trace);
+
+void trace_close(struct trace *trace);
+
+// Function to write the remaining rows to a binary trace, returns their number or -1 with error set
+long trace_write_binary(struct trace *trace, char *path);
+
+// Function to run a script over the remaining rows. The clock starts at the
+// first row, every tick applies the rows up to the current time, and the run
+// ends when the script sleeps past the last row. Returns the number of ticks
+// or -1 with error set for a malformed row.
+long trace_replay(struct trace *trace, void (*script)(void));
+
+#endif // LOXONE_TRACE_H
@@ -0,0 +1,161 @@
+#include "loxone_trace.h"
+
+// Trace tool for the script replays (see loxone_trace.h):
+//
+//   loxone_trace convert <csv> <binary>
+//   loxone_trace generate <csv> <days>
+//
+// convert writes a CSV trace as a binary one, which replays without parsing.
+// generate writes synthetic 1 s telemetry from 2025-01-01 for benchmarks, in
+// the columns the scripts read:
+//
+//   spot_price, spot_min, spot_max   hourly spot price and the day's range
+//   spot_very_low                    1 while the price is below 1
+//   soc                              battery state of charge in %, every minute
+//   AMQ125                           PV power now in kW, every second
+//   inverter_mode                    257 general or 258 economic, daily
+//   excess_energy                    1 while PV exceeds the house and the battery is full
+//   pv_today, pv_tomorrow            predicted PV energy in kWh, daily
+//   VI16                             on-grid end SOC protection user setting
+//
+// Fields that did not change are left empty, so a year is about 700 MB.
+
+#define START 1735689600   // 2025-01-01 00:00 UTC
+#define PI 3.14159265358979
+
+unsigned int seed = 1;
+
+// Deterministic pseudo random numbers, the traces must not change between runs
+double next_random() {
+    seed = seed * 1103515245 + 12345;
+    return ((seed >> 8) & 0xFFFF) / 65536.0;
+}
+
+// Peak PV power in kW and daylight hours over the year, lowest at the winter solstice
+double season(int day) {
+    return (1 - cos(2 * PI * (day + 11) / 365)) / 2;
+}
+
+double pv_energy(int day, double cloudiness) {
+    double peak = (3 + 9 * season(day)) * cloudiness;
+    double daylight = 8 + 8 * season(day);
+    return peak * daylight * 2 / PI;
+}
+
+int generate(char *path, int days) {
+    FILE *out = fopen(path, "w");
+    double *cloudiness;
+    double prices[24];
+    double min;
+    double max;
+    double soc = 50;
+    double pv = 0;
+    double noise = 1;
+    double daylight;
+    double hour;
+    char fields[11][24];
+    char previous[11][24];
+    int mode = 258;
+    long second;
+    int day;
+    int i;
+
+    if (out == NULL) {
+        fprintf(stderr, "%s: can not write\n", path);
+        return 1;
+    }
+    cloudiness = (double *)malloc((days + 1) * sizeof(double));
+    for (day = 0; day <= days; day++) {
+        cloudiness[day] = 0.2 + 0.8 * next_random();
+    }
+    memset(previous, 0, sizeof(previous));
+    fprintf(out, "time,spot_price,spot_min,spot_max,spot_very_low,soc,AMQ125,inverter_mode,excess_energy,"
+                 "pv_today,pv_tomorrow,VI16\n");
+
+    for (day = 0; day < days; day++) {
+        // Morning and evening peaks, cheap sunny middays
+        min = 1e9;
+        max = -1e9;
+        for (i = 0; i < 24; i++) {
+            prices[i] = 2.5 + 0.8 * sin(2 * PI * (i - 3) / 12) + 0.6 * next_random()
+                        - 2.5 * season(day) * cloudiness[day] * (i >= 10 && i <= 15);
+            if (prices[i] < min) min = prices[i];
+            if (prices[i] > max) max = prices[i];
+        }
+        if (next_random() < 0.2) mode = 515 - mode;
+        daylight = 8 + 8 * season(day);
+
+        for (second = 0; second < 86400; second++) {
+            hour = second / 3600.0;
+            if (second % 60 == 0) {
+                noise = 0.7 * noise + 0.3 * (0.6 + 0.8 * next_random());
+                soc += (pv - 1.5) / 60 / 15 * 100;   // 15 kWh battery, 1.5 kW house
+                if (soc < 10) soc = 10;
+                if (soc > 100) soc = 100;
+            }
+            pv = 0;
+            if (fabs(hour - 11) < daylight / 2) {
+                pv = (3 + 9 * season(day)) * cloudiness[day] * noise * cos(PI * (hour - 11) / daylight);
+            }
+            snprintf(fields[0], 24, "%.2f", prices[second / 3600]);
+            snprintf(fields[1], 24, "%.2f", min);
+            snprintf(fields[2], 24, "%.2f", max);
+            snprintf(fields[3], 24, "%d", prices[second / 3600] < 1);
+            snprintf(fields[4], 24, "%.1f", soc);
+            snprintf(fields[5], 24, "%.3f", pv);
+            snprintf(fields[6], 24, "%d", mode);
+            snprintf(fields[7], 24, "%d", pv > 1.5 && soc >= 100);
+            snprintf(fields[8], 24, "%.1f", pv_energy(day, cloudiness[day]));
+            snprintf(fields[9], 24, "%.1f", pv_energy(day + 1, cloudiness[day + 1]));
+            snprintf(fields[10], 24, "%d", 20);
+
+            fprintf(out, "%ld", START + day * 86400L + second);
+            for (i = 0; i < 11; i++) {
+                if (strcmp(fields[i], previous[i]) == 0) {
+                    fputc(',', out);
+                } else {
+                    fprintf(out, ",%s", fields[i]);
+                    strcpy(previous[i], fields[i]);
+                }
+            }
+            fputc('\n', out);
+        }
+    }
+    free(cloudiness);
+    if (fclose(out) != 0) {
+        fprintf(stderr, "%s: can not write\n", path);
+        return 1;
+    }
+    printf("generated days=%d rows=%ld\n", days, days * 86400L);
+    return 0;
+}
+
+int convert(char *csv, char *binary) {
+    struct trace trace;
+    long rows;
+
+    if (trace_open(&trace, csv) != 0) {
+        fprintf(stderr, "%s: %s\n", csv, trace.error);
+        return 1;
+    }
+    rows = trace_write_binary(&trace, binary);
+    trace_close(&trace);
+    if (rows < 0) {
+        fprintf(stderr, "%s: %s\n", csv, trace.error);
+        return 1;
+    }
+    printf("converted rows=%ld\n", rows);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 4 && strcmp(argv[1], "convert") == 0) {
+        return convert(argv[2], argv[3]);
+    }
+    if (argc == 4 && strcmp(argv[1], "generate") == 0 && atoi(argv[3]) > 0) {
+        return generate(argv[2], atoi(argv[3]));
+    }
+    fprintf(stderr, "Usage: loxone_trace convert <csv> <binary>\n"
+                    "       loxone_trace generate <csv> <days>\n");
+    return 1;
+}
@@ -0,0 +1,213 @@
+#include "loxone_trace.h"
+#include <assert.h>
+
+#define CSV_PATH TRACE_TEST_DIR "/loxone_trace.test.csv"
+#define BINARY_PATH TRACE_TEST_DIR "/loxone_trace.test.bin"
+#define TRUNCATED_PATH TRACE_TEST_DIR "/loxone_trace.truncated.test.bin"
+
+// 2025-02-27 05:00 CET
+#define T0 1740628800LL
+
+void write_file(char* path, char* text) {
+    FILE* file = fopen(path, "wb");
+    assert(file != NULL);
+    fputs(text, file);
+    fclose(file);
+}
+
+// Two hours of the water tank: night heating, day without PV, PV, then a warm tank
+char* water_tank_trace =
+    "time,tank_cold,spot_very_low,pv_today,pv_tomorrow,excess_energy,AMQ125\n"
+    "1740628800,1,1,30,5,1,0\n"
+    "1740632400,,,,,,\n"
+    "1740634200,,,,,,3.2\n"
+    "1740636000,0,,,,,\n";
+
+void map_water_tank(struct trace* trace) {
+    assert(trace_map(trace, "tank_cold", "input0") == 0);
+    assert(trace_map(trace, "spot_very_low", "input1") == 0);
+    assert(trace_map(trace, "pv_today", "input2") == 0);
+    assert(trace_map(trace, "pv_tomorrow", "input3") == 0);
+    assert(trace_map(trace, "excess_energy", "input5") == 0);
+}
+
+void test_csv() {
+    printf("Testing CSV traces...\n");
+
+    struct trace trace;
+
+    write_file(CSV_PATH, "time,input2,AMQ125,ignored\r\n"
+                         "1740628800,1.5,-2e-1,7\r\n"
+                         "\r\n"
+                         "1740628801,,3.25,\r\n"
+                         "1740628803,2\n");
+    assert(trace_open(&trace, CSV_PATH) == 0);
+    assert(trace.binary == 0);
+    assert(trace.columns == 3);
+    assert(strcmp(trace.names[1], "AMQ125") == 0);
+    assert(trace.inputs[0] == 2);
+    assert(trace.inputs[1] == -1 && strcmp(trace.targets[1], "AMQ125") == 0);
+    assert(trace_map(&trace, "ignored", "-") == 0 && trace.inputs[2] == -2);
+    assert(trace_map(&trace, "missing", "input1") == -1);
+    assert(trace_map(&trace, "input2", "input99") == -1);
+    assert(isnan(trace.values[0]));
+    printf("✓ Header names the columns and where they go\n");
+
+    assert(trace_peek_time(&trace) == T0);
+    assert(trace_next(&trace) == 1);
+    assert(trace.time == T0);
+    assert(trace.values[0] == 1.5f && trace.values[1] == -0.2f && trace.values[2] == 7);
+    assert(trace_next(&trace) == 1);
+    assert(trace.time == T0 + 1);
+    assert(trace.values[0] == 1.5f && trace.values[1] == 3.25f && trace.values[2] == 7);
+    assert(trace_peek_time(&trace) == T0 + 3);
+    assert(trace_next(&trace) == 1);
+    assert(trace.values[0] == 2 && trace.values[1] == 3.25f);
+    assert(trace_peek_time(&trace) == -1);
+    assert(trace_next(&trace) == 0);
+    assert(trace.rows == 3);
+    trace_close(&trace);
+    printf("✓ Empty fields keep the value of the row before\n");
+}
+
+void test_errors() {
+    printf("\nTesting malformed traces...\n");
+
+    struct trace trace;
+
+    assert(trace_open(&trace, TRACE_TEST_DIR "/missing.csv") == -1);
+    assert(strcmp(trace.error, "can not open the trace") == 0);
+
+    write_file(CSV_PATH, "time\n1740628800\n");
+    assert(trace_open(&trace, CSV_PATH) == -1);
+    assert(strcmp(trace.error, "no columns") == 0);
+
+    write_file(CSV_PATH, "time,a\n1740628800,1\n1740628799,2\n");
+    assert(trace_open(&trace, CSV_PATH) == 0);
+    assert(trace_next(&trace) == 1);
+    assert(trace_next(&trace) == -1);
+    assert(strcmp(trace.error, "row 2: time goes back") == 0);
+    trace_close(&trace);
+
+    write_file(CSV_PATH, "time,a\n1740628800,x\n");
+    assert(trace_open(&trace, CSV_PATH) == 0);
+    assert(trace_next(&trace) == -1);
+    assert(strcmp(trace.error, "row 1: value is not a number") == 0);
+    trace_close(&trace);
+
+    write_file(CSV_PATH, "time,a\n1740628800,1,2\n");
+    assert(trace_open(&trace, CSV_PATH) == 0);
+    assert(trace_next(&trace) == -1);
+    assert(strcmp(trace.error, "row 1: too many fields") == 0);
+    trace_close(&trace);
+    printf("✓ Malformed rows are reported with their number\n");
+}
+
+void test_binary() {
+    printf("\nTesting binary traces...\n");
+
+    struct trace csv;
+    struct trace binary;
+    int i;
+
+    write_file(CSV_PATH, water_tank_trace);
+    assert(trace_open(&csv, CSV_PATH) == 0);
+    assert(trace_write_binary(&csv, BINARY_PATH) == 4);
+    trace_close(&csv);
+
+    assert(trace_open(&csv, CSV_PATH) == 0);
+    assert(trace_open(&binary, BINARY_PATH) == 0);
+    assert(binary.binary == 1);
+    assert(binary.columns == csv.columns);
+    assert(strcmp(binary.names[5], "AMQ125") == 0);
+    while (trace_next(&csv) == 1) {
+        assert(trace_peek_time(&binary) == csv.time);
+        assert(trace_next(&binary) == 1);
+        assert(binary.time == csv.time);
+        for (i = 0; i < csv.columns; i++) {
+            assert(binary.values[i] == csv.values[i]);
+        }
+    }
+    assert(trace_next(&binary) == 0);
+    trace_close(&csv);
+    trace_close(&binary);
+    printf("✓ Binary traces hold the rows of the CSV\n");
+
+    write_file(TRUNCATED_PATH, "LXT1");
+    assert(trace_open(&binary, TRUNCATED_PATH) == -1);
+    assert(strcmp(binary.error, "truncated header") == 0);
+    printf("✓ Truncated binary traces are rejected\n");
+}
+
+// Replay the water tank trace and compare the decision log
+void replay_water_tank(char* path) {
+    struct trace trace;
+    FILE* log;
+    char line[64];
+
+    loxone_reset(0);
+    loxone_set_skip_format(1);
+    assert(trace_open(&trace, path) == 0);
+    map_water_tank(&trace);
+    log = tmpfile();
+    assert(log != NULL);
+    loxone_record(log);
+
+    // Rows apply when the clock reaches them, the run ends after the last
+    assert(trace_replay(&trace, loxone_script_main) == 7201);
+    assert(trace.rows == 4);
+    assert(getcurrenttime() == T0 + 7201 - TRACE_UNIX_2009);
+    loxone_record(NULL);
+    trace_close(&trace);
+
+    rewind(log);
+    assert(fgets(line, sizeof(line), log) != NULL && strcmp(line, "0.000,0,1\n") == 0);
+    assert(fgets(line, sizeof(line), log) != NULL && strcmp(line, "3600.000,0,0\n") == 0);
+    assert(fgets(line, sizeof(line), log) != NULL && strcmp(line, "5400.000,0,1\n") == 0);
+    assert(fgets(line, sizeof(line), log) != NULL && strcmp(line, "7200.000,0,0\n") == 0);
+    assert(fgets(line, sizeof(line), log) == NULL);
+    fclose(log);
+}
+
+void test_replay() {
+    printf("\nTesting replays of water-tank-heating-controller...\n");
+
+    struct trace trace;
+
+    write_file(CSV_PATH, water_tank_trace);
+    replay_water_tank(CSV_PATH);
+    printf("✓ Decisions follow the CSV trace\n");
+
+    replay_water_tank(BINARY_PATH);
+    printf("✓ Decisions follow the binary trace\n");
+
+    // Texts are formatted unless skipping is asked for
+    assert(strcmp(loxone_output_text(0), "") == 0);
+    loxone_reset(0);
+    assert(trace_open(&trace, CSV_PATH) == 0);
+    map_water_tank(&trace);
+    assert(trace_replay(&trace, loxone_script_main) == 7201);
+    trace_close(&trace);
+    assert(strstr(loxone_output_text(0), "Current hour: 7") != NULL);
+    printf("✓ Debug texts are formatted by default, skipped on request\n");
+
+    write_file(CSV_PATH, "time,AMQ125\n1740628800,1\n1740628860,2\n1740628920,oops\n");
+    assert(trace_open(&trace, CSV_PATH) == 0);
+    assert(trace_replay(&trace, loxone_script_main) == -1);
+    assert(strcmp(trace.error, "row 3: value is not a number") == 0);
+    assert(getcurrenttime() == T0 + 120 - TRACE_UNIX_2009);
+    trace_close(&trace);
+    printf("✓ Replay stops at a malformed row\n");
+}
+
+int main() {
+    printf("Running loxone_trace tests...\n\n");
+
+    test_csv();
+    test_errors();
+    test_binary();
+    test_replay();
+
+    printf("\nAll tests passed! ✓\n");
+    return 0;
+}
@@ -0,0 +1,306 @@
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "nx_json.h"
+#include "forecast_solar.h"
+
+// Throughput and memory benchmark over the generated corpus (nx_json.corpus.c).
+// Prints one line per document and operation:
+//
+//   bench=parse doc=<shape> size=<n> bytes=<n> iterations=<n> mb_s=<f> ns_per_node=<f>
+//               nodes=<n> node_bytes=<n> string_bytes=<n> max_depth=<n> heap_peak_bytes=<n>
+//   bench=get doc=<shape> size=<n> keys=<n> lookups=<n> ns_per_get=<f>
+//   bench=tape_parse doc=<shape> size=<n> bytes=<n> iterations=<n> mb_s=<f> ns_per_node=<f>
+//                    nodes=<n> node_bytes=<n> heap_peak_bytes=<n>
+//   bench=tape_get doc=<shape> size=<n> keys=<n> lookups=<n> ns_per_get=<f>
+//   bench=daily doc=<shape> size=<n> bytes=<n> iterations=<n> mb_s=<f> heap_peak_bytes=<n>
+//
+// heap_peak_bytes is -1 where the allocator can not be tracked (non-glibc or sanitizer builds).
+
+#define BYTES_PER_MEASUREMENT (128 * 1024 * 1024)
+#define GETS_PER_MEASUREMENT 50000000
+
+long heap_current = 0;
+long heap_peak = 0;
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+#include <malloc.h>
+
+// Count every allocation of the process by wrapping the glibc allocator
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void __libc_free(void *ptr);
+
+void heap_add(long bytes) {
+    heap_current += bytes;
+    if (heap_current > heap_peak) heap_peak = heap_current;
+}
+
+void *malloc(size_t size) {
+    void *ptr = __libc_malloc(size);
+    if (ptr != NULL) heap_add(malloc_usable_size(ptr));
+    return ptr;
+}
+
+void *calloc(size_t count, size_t size) {
+    void *ptr = __libc_calloc(count, size);
+    if (ptr != NULL) heap_add(malloc_usable_size(ptr));
+    return ptr;
+}
+
+void *realloc(void *ptr, size_t size) {
+    long old = 0;
+    void *moved;
+    if (ptr != NULL) old = malloc_usable_size(ptr);
+    moved = __libc_realloc(ptr, size);
+    if (moved != NULL) heap_add((long)malloc_usable_size(moved) - old);
+    return moved;
+}
+
+void free(void *ptr) {
+    if (ptr != NULL) heap_current -= malloc_usable_size(ptr);
+    __libc_free(ptr);
+}
+
+#define HEAP_TRACKING 1
+#else
+#define HEAP_TRACKING 0
+#endif
+
+double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Start measuring the peak heap of one operation
+long heap_begin() {
+    heap_peak = heap_current;
+    return heap_current;
+}
+
+long heap_end(long base) {
+    if (HEAP_TRACKING == 0) return -1;
+    return heap_peak - base;
+}
+
+// Function to read the entire contents of a file into a string
+char* read_file(const char* filename, long *length) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        perror("Could not open file");
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    *length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *content = (char *)malloc(*length + 1);
+    size_t read_size = fread(content, 1, *length, file);
+    content[read_size] = '\0';
+    fclose(file);
+
+    return content;
+}
+
+int iterations_for(long bytes) {
+    int iterations = BYTES_PER_MEASUREMENT / bytes;
+    if (iterations < 3) iterations = 3;
+    return iterations;
+}
+
+int bench_parse(char *text, long length, char *shape, int size) {
+    int iterations = iterations_for(length);
+    struct nx_json_stats stats;
+    long heap;
+    double start;
+    double elapsed;
+    int i;
+
+    // First parse into fresh arenas, everything it allocates is its peak
+    nx_json_reset();
+    heap = heap_begin();
+    if (nx_json_parse(text) == NULL) return -1;
+    heap = heap_end(heap);
+    stats = nx_json_default()->stats;
+
+    start = now_ns();
+    for (i = 0; i < iterations; i++) {
+        nx_json_parse(text);
+    }
+    elapsed = now_ns() - start;
+
+    printf("bench=parse doc=%s size=%d bytes=%ld iterations=%d mb_s=%.1f ns_per_node=%.2f nodes=%d node_bytes=%d string_bytes=%d max_depth=%d heap_peak_bytes=%ld\n",
+           shape, size, length, iterations, length * (double)iterations / elapsed * 1e3,
+           elapsed / iterations / stats.nodes, stats.nodes, stats.nodes * (int)sizeof(struct nx_json),
+           stats.string_bytes, stats.max_depth, heap);
+    return 0;
+}
+
+int bench_get(char *text, char *shape, int size) {
+    struct nx_json *result;
+    struct nx_json *child;
+    char **keys;
+    double start;
+    double elapsed;
+    double sum = 0;
+    int count = 0;
+    int lookups;
+    int i;
+
+    nx_json_reset();
+    result = nx_json_get(nx_json_parse(text), "result");
+    if (result == NULL) return -1;
+
+    keys = (char **)malloc(result->u.children.length * sizeof(char *));
+    for (child = result->u.children.first; child != NULL; child = child->next) {
+        keys[count++] = child->key;
+    }
+
+    // Linear lookups cost grows with the key count, keep the total work bounded
+    lookups = GETS_PER_MEASUREMENT / count;
+    if (lookups > 1000000) lookups = 1000000;
+    if (lookups < 1000) lookups = 1000;
+
+    start = now_ns();
+    for (i = 0; i < lookups; i++) {
+        sum += nx_json_get(result, keys[i % count])->type;
+    }
+    elapsed = now_ns() - start;
+    if (sum < 0) printf("unexpected sum\n");
+
+    printf("bench=get doc=%s size=%d keys=%d lookups=%d ns_per_get=%.1f\n",
+           shape, size, count, lookups, elapsed / lookups);
+    free(keys);
+    return 0;
+}
+
+// Parse and lookups on the tape DOM, the same work as bench_parse and bench_get
+int bench_tape(char *text, long length, char *shape, int size) {
+    struct nx_json_tape tape;
+    struct nx_json_tape_entry *result;
+    struct nx_json_tape_entry *child;
+    char **keys;
+    int iterations = iterations_for(length);
+    long heap;
+    double start;
+    double elapsed;
+    double sum = 0;
+    int lookups;
+    int count;
+    int i;
+
+    nx_json_tape_init(&tape, NULL, 0);
+    heap = heap_begin();
+    if (nx_json_tape_parse(&tape, text, length) == NULL) return -1;
+    heap = heap_end(heap);
+
+    start = now_ns();
+    for (i = 0; i < iterations; i++) {
+        nx_json_tape_parse(&tape, text, length);
+    }
+    elapsed = now_ns() - start;
+
+    printf("bench=tape_parse doc=%s size=%d bytes=%ld iterations=%d mb_s=%.1f ns_per_node=%.2f nodes=%d node_bytes=%d heap_peak_bytes=%ld\n",
+           shape, size, length, iterations, length * (double)iterations / elapsed * 1e3,
+           elapsed / iterations / tape.count, tape.count, tape.count * (int)sizeof(struct nx_json_tape_entry), heap);
+
+    result = nx_json_tape_get(&tape, &tape.entries[0], "result");
+    if (result == NULL) return -1;
+
+    // Keys are slices of the input, look them up as terminated copies
+    count = result->length;
+    keys = (char **)malloc(count * sizeof(char *));
+    child = result + 1;
+    for (i = 0; i < count; i++) {
+        keys[i] = (char *)malloc(child->key_length + 1);
+        memcpy(keys[i], tape.input + child->key, child->key_length);
+        keys[i][child->key_length] = '\0';
+        child = nx_json_tape_next(&tape, child);
+    }
+
+    lookups = GETS_PER_MEASUREMENT / count;
+    if (lookups > 1000000) lookups = 1000000;
+    if (lookups < 1000) lookups = 1000;
+
+    start = now_ns();
+    for (i = 0; i < lookups; i++) {
+        sum += nx_json_tape_get(&tape, result, keys[i % count])->type;
+    }
+    elapsed = now_ns() - start;
+    if (sum < 0) printf("unexpected sum\n");
+
+    printf("bench=tape_get doc=%s size=%d keys=%d lookups=%d ns_per_get=%.1f\n",
+           shape, size, count, lookups, elapsed / lookups);
+
+    for (i = 0; i < count; i++) {
+        free(keys[i]);
+    }
+    free(keys);
+    nx_json_tape_free(&tape);
+    return 0;
+}
+
+int bench_daily(char *text, long length, char *shape, int size) {
+    struct DailyProduction production;
+    int iterations = iterations_for(length);
+    long heap;
+    double start;
+    double elapsed;
+    int i;
+
+    nx_json_reset();
+    heap = heap_begin();
+    production = parseDailyProduction(text, "2025-02-27", "2025-02-28");
+    heap = heap_end(heap);
+    if (production.today != 4674.362 || production.tomorrow != 4774.208) return -1;
+
+    start = now_ns();
+    for (i = 0; i < iterations; i++) {
+        production = parseDailyProduction(text, "2025-02-27", "2025-02-28");
+    }
+    elapsed = now_ns() - start;
+
+    printf("bench=daily doc=%s size=%d bytes=%ld iterations=%d mb_s=%.1f heap_peak_bytes=%ld\n",
+           shape, size, length, iterations, length * (double)iterations / elapsed * 1e3, heap);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    char *index_path = CORPUS_INDEX;
+    char path[1024];
+    char shape[64];
+    char *text;
+    long length;
+    int size;
+    FILE *index;
+
+    if (argc > 1) index_path = argv[1];
+    index = fopen(index_path, "r");
+    if (index == NULL) {
+        fprintf(stderr, "No corpus at %s, build the nx_json_corpus target first\n", index_path);
+        return 1;
+    }
+
+    while (fscanf(index, "%1023s %63s %d", path, shape, &size) == 3) {
+        text = read_file(path, &length);
+        if (text == NULL) return 1;
+
+        if (bench_parse(text, length, shape, size) != 0 ||
+            bench_get(text, shape, size) != 0 ||
+            bench_tape(text, length, shape, size) != 0 ||
+            bench_daily(text, length, shape, size) != 0) {
+            fprintf(stderr, "Benchmark failed on %s\n", path);
+            return 1;
+        }
+        free(text);
+    }
+
+    fclose(index);
+    nx_json_reset();
+    return 0;
+}
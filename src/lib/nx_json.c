@@ -1,72 +1,441 @@
 // Check if we're using a standard C compiler
 #ifndef PICO_C
+#define _POSIX_C_SOURCE 199309L  // clock_gettime
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <time.h>
 #include "nx_json.h"
 #endif
 
-// Define maximum sizes for fixed arrays
-#define MAX_JSON_NODES 20  // Maximum number of JSON nodes
-#define MAX_STRING_LENGTH 1024  // Maximum length for strings
+// Default context used by nx_json_parse and nx_json_reset
+struct nx_json_ctx nx_json_default_ctx;
+int nx_json_default_ready = 0;
 
-// Global arrays for fixed allocation
-struct nx_json json_nodes[MAX_JSON_NODES];
-int json_nodes_used = 0;
+// Text of an error code
+char *nx_json_error_text(enum nx_json_error error) {
+    switch (error) {
+        case NX_JSON_OK: return "No error";
+        case NX_JSON_ERROR_NOT_OBJECT: return "JSON must start with '{'";
+        case NX_JSON_ERROR_UNEXPECTED_END: return "Unexpected end of JSON";
+        case NX_JSON_ERROR_EXPECTED_KEY: return "Expected string key";
+        case NX_JSON_ERROR_EXPECTED_COLON: return "Expected ':' after key";
+        case NX_JSON_ERROR_EXPECTED_SEPARATOR: return "Expected ',' or closing bracket";
+        case NX_JSON_ERROR_MISMATCHED_BRACKET: return "Mismatched closing bracket";
+        case NX_JSON_ERROR_UNEXPECTED_CHARACTER: return "Unexpected character in value";
+        case NX_JSON_ERROR_UNTERMINATED_STRING: return "Unterminated string";
+        case NX_JSON_ERROR_INVALID_NUMBER: return "Invalid number";
+        case NX_JSON_ERROR_TOO_DEEP: return "Maximum nesting depth exceeded";
+        case NX_JSON_ERROR_NODES_FULL: return "Node pool full";
+        case NX_JSON_ERROR_STRINGS_FULL: return "String buffer full";
+        case NX_JSON_ERROR_TRAILING_DATA: return "Unexpected data after JSON";
+    }
+    return "Unknown error";
+}
+
+// Format the error of the last parse, only done when the caller asks for it
+char *nx_json_format_error(struct nx_json_ctx *ctx, char *buffer) {
+    sprintf(buffer, "NXJSON ERROR: %s at byte %d", nx_json_error_text(ctx->error), ctx->error_offset);
+    return buffer;
+}
+
+// Record the first error of a parse, nothing is formatted or printed here
+void nx_json_fail(struct nx_json_ctx *ctx, enum nx_json_error error, int offset) {
+    if (ctx->error != NX_JSON_OK) return;
+    ctx->error = error;
+    ctx->error_offset = offset;
+}
+
+// Record an error at p in the document being parsed
+void nx_json_parse_error(struct nx_json_ctx *ctx, enum nx_json_error error, char *p) {
+    nx_json_fail(ctx, error, p - ctx->input);
+}
+
+// Seconds on a clock for the parse statistics
+double nx_json_clock() {
+#ifdef PICO_C
+    return getcurrenttime();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+#endif
+}
 
-// String buffer for storing keys and string values
-char string_buffer[MAX_STRING_LENGTH];
-int string_buffer_used = 0;
+// Clear the error and statistics before a parse
+void nx_json_stats_begin(struct nx_json_ctx *ctx) {
+    ctx->error = NX_JSON_OK;
+    ctx->error_offset = 0;
+    ctx->stats.bytes = 0;
+    ctx->stats.nodes = 0;
+    ctx->stats.node_capacity = 0;
+    ctx->stats.string_bytes = 0;
+    ctx->stats.string_capacity = 0;
+    ctx->stats.max_depth = 0;
+    ctx->stats.time_us = 0;
+}
 
-// Define a simple stack for tracking parent nodes
-#define MAX_NESTING_DEPTH 10  // Maximum nesting depth for objects and arrays
+// Fill the arena usage once a parse ended, before a failed parse drops its nodes
+void nx_json_stats_end(struct nx_json_ctx *ctx, int bytes) {
+    struct nx_json_node_block *node_block;
+    struct nx_json_string_block *string_block;
 
-// Context stack for tracking parent nodes during parsing
-struct nx_json* parent_stack[MAX_NESTING_DEPTH];
-int stack_depth = 0;
+    ctx->stats.bytes = bytes;
+    ctx->stats.nodes = 0;
+    ctx->stats.node_capacity = 0;
+    ctx->stats.string_bytes = 0;
+    ctx->stats.string_capacity = 0;
+    for (node_block = ctx->nodes; node_block != NULL; node_block = node_block->next) {
+        ctx->stats.nodes += node_block->used;
+        ctx->stats.node_capacity += node_block->capacity;
+    }
+    for (string_block = ctx->strings; string_block != NULL; string_block = string_block->next) {
+        ctx->stats.string_bytes += string_block->used;
+        ctx->stats.string_capacity += string_block->capacity;
+    }
+}
 
-// Reset all global storage
+// Push an opened object or array, tracking the deepest nesting
+void nx_json_push(struct nx_json_ctx *ctx, struct nx_json *js) {
+    ctx->parent_stack[ctx->stack_depth++] = js;
+    if (ctx->stack_depth > ctx->stats.max_depth) {
+        ctx->stats.max_depth = ctx->stack_depth;
+    }
+}
+
+// Prepare a context, the buffers are optional and become the first arena blocks
+void nx_json_ctx_init(struct nx_json_ctx *ctx, struct nx_json *nodes, int node_count, char *strings, int string_size) {
+    ctx->nodes = NULL;
+    ctx->strings = NULL;
+    ctx->slots = NULL;
+    ctx->flags = 0;
+    ctx->node_chunk = NX_JSON_NODE_CHUNK;
+    ctx->string_chunk = NX_JSON_STRING_CHUNK;
+    ctx->slot_chunk = NX_JSON_SLOT_CHUNK;
+    ctx->stack_depth = 0;
+    ctx->input = NULL;
+    nx_json_stats_begin(ctx);
+
+    ctx->caller_nodes.nodes = NULL;
+    ctx->caller_nodes.capacity = 0;
+    ctx->caller_nodes.used = 0;
+    ctx->caller_nodes.owned = 0;
+    ctx->caller_nodes.next = NULL;
+    if (nodes != NULL && node_count > 0) {
+        ctx->caller_nodes.nodes = nodes;
+        ctx->caller_nodes.capacity = node_count;
+    }
+
+    ctx->caller_strings.text = NULL;
+    ctx->caller_strings.capacity = 0;
+    ctx->caller_strings.used = 0;
+    ctx->caller_strings.owned = 0;
+    ctx->caller_strings.next = NULL;
+    if (strings != NULL && string_size > 0) {
+        ctx->caller_strings.text = strings;
+        ctx->caller_strings.capacity = string_size;
+    }
+
+    // With no blocks allocated yet this only installs the caller buffers
+    nx_json_ctx_free(ctx);
+}
+
+// Drop the parsed document but keep the arenas for the next parse
+void nx_json_ctx_reset(struct nx_json_ctx *ctx) {
+    struct nx_json_node_block *node_block = ctx->nodes;
+    struct nx_json_string_block *string_block = ctx->strings;
+    struct nx_json_slot_block *slot_block = ctx->slots;
+
+    while (node_block != NULL) {
+        node_block->used = 0;
+        node_block = node_block->next;
+    }
+    while (string_block != NULL) {
+        string_block->used = 0;
+        string_block = string_block->next;
+    }
+    while (slot_block != NULL) {
+        slot_block->used = 0;
+        slot_block = slot_block->next;
+    }
+    ctx->node_block = ctx->nodes;
+    ctx->string_block = ctx->strings;
+    ctx->slot_block = ctx->slots;
+    ctx->stack_depth = 0;
+}
+
+// Release every block allocated by the context, caller supplied buffers are kept
+void nx_json_ctx_free(struct nx_json_ctx *ctx) {
+    struct nx_json_node_block *node_block = ctx->nodes;
+    struct nx_json_node_block *next_node_block;
+    struct nx_json_string_block *string_block = ctx->strings;
+    struct nx_json_string_block *next_string_block;
+    struct nx_json_slot_block *slot_block = ctx->slots;
+    struct nx_json_slot_block *next_slot_block;
+
+    while (node_block != NULL) {
+        next_node_block = node_block->next;
+        if (node_block->owned) {
+            free(node_block->nodes);
+            free(node_block);
+        }
+        node_block = next_node_block;
+    }
+    while (string_block != NULL) {
+        next_string_block = string_block->next;
+        if (string_block->owned) {
+            free(string_block->text);
+            free(string_block);
+        }
+        string_block = next_string_block;
+    }
+    while (slot_block != NULL) {
+        next_slot_block = slot_block->next;
+        free(slot_block->slots);
+        free(slot_block);
+        slot_block = next_slot_block;
+    }
+    ctx->slots = NULL;
+
+    // Only the caller supplied buffers remain
+    ctx->nodes = NULL;
+    ctx->caller_nodes.next = NULL;
+    if (ctx->caller_nodes.nodes != NULL) {
+        ctx->nodes = &ctx->caller_nodes;
+    }
+    ctx->strings = NULL;
+    ctx->caller_strings.next = NULL;
+    if (ctx->caller_strings.text != NULL) {
+        ctx->strings = &ctx->caller_strings;
+    }
+    nx_json_ctx_reset(ctx);
+}
+
+// Shared context behind nx_json_parse, its arenas are allocated on first use
+struct nx_json_ctx *nx_json_default() {
+    if (nx_json_default_ready == 0) {
+        nx_json_ctx_init(&nx_json_default_ctx, NULL, 0, NULL, 0);
+        nx_json_default_ready = 1;
+    }
+    return &nx_json_default_ctx;
+}
+
+// Release the document parsed by nx_json_parse together with its arenas
 void nx_json_reset() {
-    json_nodes_used = 0;
-    string_buffer_used = 0;
+    nx_json_ctx_free(nx_json_default());
 }
 
-// Helper function implementations
-int skip_whitespace(char *p) {
-    int i = 0;
-    while (p[i] && (p[i] == ' ' || p[i] == '\t' || p[i] == '\n' || p[i] == '\r')) {
-        i++;
+// Take the next node from the arena, growing it by one block if needed
+struct nx_json *nx_json_ctx_alloc_node(struct nx_json_ctx *ctx) {
+    struct nx_json_node_block *block = ctx->node_block;
+    struct nx_json_node_block *next;
+
+    if (block != NULL && block->used < block->capacity) {
+        return &block->nodes[block->used++];
     }
-    return i;
+
+    // Reuse a block kept from a previous parse
+    if (block != NULL && block->next != NULL) {
+        ctx->node_block = block->next;
+        return nx_json_ctx_alloc_node(ctx);
+    }
+
+    if (ctx->node_chunk <= 0) return NULL;
+    next = (struct nx_json_node_block *)malloc(sizeof(struct nx_json_node_block));
+    if (next == NULL) return NULL;
+    next->nodes = (struct nx_json *)malloc(ctx->node_chunk * sizeof(struct nx_json));
+    if (next->nodes == NULL) {
+        free(next);
+        return NULL;
+    }
+    next->capacity = ctx->node_chunk;
+    next->used = 0;
+    next->owned = 1;
+    next->next = NULL;
+
+    if (block == NULL) {
+        ctx->nodes = next;
+    } else {
+        block->next = next;
+    }
+    ctx->node_block = next;
+    return &next->nodes[next->used++];
 }
 
-void nx_json_report_error(char *msg, char *p) {
-    char error_message[256];
-    snprintf(error_message, sizeof(error_message), "NXJSON ERROR: %s at %s", msg, p);
-#ifdef PICO_C
-    setoutputtext(2, error_message);  // This is a Loxone function
-#else
-    fprintf(stderr, "%s\n", error_message);
-#endif
+// Make room for length more bytes after the last keep bytes of the string arena.
+// Strings never span blocks, so a partially collected string moves to the new block.
+// Returns the start of the kept bytes, or NULL when the arena cannot grow.
+char *nx_json_ctx_reserve(struct nx_json_ctx *ctx, int keep, int length) {
+    struct nx_json_string_block *block = ctx->string_block;
+    struct nx_json_string_block *next = NULL;
+    int capacity;
+
+    if (block != NULL && block->capacity - block->used >= length) {
+        return block->text + block->used - keep;
+    }
+
+    // Reuse a block kept from a previous parse when it is large enough
+    if (block != NULL && block->next != NULL && block->next->capacity >= keep + length) {
+        next = block->next;
+    } else {
+        capacity = ctx->string_chunk;
+        if (capacity <= 0) return NULL;
+        if (capacity < keep + length) {
+            capacity = keep + length;
+        }
+        next = (struct nx_json_string_block *)malloc(sizeof(struct nx_json_string_block));
+        if (next == NULL) return NULL;
+        next->text = (char *)malloc(capacity);
+        if (next->text == NULL) {
+            free(next);
+            return NULL;
+        }
+        next->capacity = capacity;
+        next->used = 0;
+        next->owned = 1;
+        next->next = NULL;
+        if (block == NULL) {
+            ctx->strings = next;
+        } else {
+            next->next = block->next;
+            block->next = next;
+        }
+    }
+
+    if (keep > 0) {
+        memcpy(next->text, block->text + block->used - keep, keep);
+        block->used -= keep;
+    }
+    next->used = keep;
+    ctx->string_block = next;
+    return next->text;
+}
+
+// Take count contiguous index slots, or NULL when they cannot be allocated
+struct nx_json **nx_json_ctx_alloc_slots(struct nx_json_ctx *ctx, int count) {
+    struct nx_json_slot_block *block = ctx->slot_block;
+    struct nx_json_slot_block *next;
+    int capacity;
+
+    if (block != NULL && block->capacity - block->used >= count) {
+        block->used += count;
+        return block->slots + block->used - count;
+    }
+
+    // Reuse a block kept from a previous parse when it is large enough
+    if (block != NULL && block->next != NULL && block->next->capacity >= count) {
+        ctx->slot_block = block->next;
+        return nx_json_ctx_alloc_slots(ctx, count);
+    }
+
+    capacity = ctx->slot_chunk;
+    if (capacity < count) {
+        capacity = count;
+    }
+    next = (struct nx_json_slot_block *)malloc(sizeof(struct nx_json_slot_block));
+    if (next == NULL) return NULL;
+    next->slots = (struct nx_json **)malloc(capacity * sizeof(struct nx_json *));
+    if (next->slots == NULL) {
+        free(next);
+        return NULL;
+    }
+    next->capacity = capacity;
+    next->used = count;
+    next->next = NULL;
+    if (block == NULL) {
+        ctx->slots = next;
+    } else {
+        next->next = block->next;
+        block->next = next;
+    }
+    ctx->slot_block = next;
+    return next->slots;
+}
+
+// FNV-1a hash of a key
+unsigned int nx_json_hash(char *key, int length) {
+    unsigned int hash = 2166136261;
+    int i;
+    for (i = 0; i < length; i++) {
+        hash = (hash ^ (unsigned char)key[i]) * 16777619;
+    }
+    return hash;
+}
+
+// Build the index of a closed container. Without memory the container
+// simply stays unindexed and lookups fall back to walking the children.
+void nx_json_index_build(struct nx_json_ctx *ctx, struct nx_json *json) {
+    struct nx_json **slots;
+    struct nx_json *child;
+    int size;
+    int i;
+    unsigned int mask;
+
+    if (json->type == NX_JSON_ARRAY) {
+        if (json->u.children.length == 0) return;
+        slots = nx_json_ctx_alloc_slots(ctx, json->u.children.length);
+        if (slots == NULL) return;
+        i = 0;
+        for (child = json->u.children.first; child != NULL; child = child->next) {
+            slots[i++] = child;
+        }
+        json->u.children.index = slots;
+        json->u.children.index_size = i;
+        return;
+    }
+
+    if (json->u.children.length < NX_JSON_INDEX_MIN_KEYS) return;
+
+    // Open addressing table at most half full, size is a power of two
+    size = 16;
+    while (size < json->u.children.length * 2) {
+        size = size * 2;
+    }
+    slots = nx_json_ctx_alloc_slots(ctx, size);
+    if (slots == NULL) return;
+    for (i = 0; i < size; i++) {
+        slots[i] = NULL;
+    }
+
+    mask = size - 1;
+    for (child = json->u.children.first; child != NULL; child = child->next) {
+        i = nx_json_hash(child->key, child->key_length) & mask;
+        while (slots[i] != NULL) {
+            // Keep the first of duplicate keys, like the linear lookup does
+            if (slots[i]->key_length == child->key_length &&
+                memcmp(slots[i]->key, child->key, child->key_length) == 0) {
+                break;
+            }
+            i = (i + 1) & mask;
+        }
+        if (slots[i] == NULL) {
+            slots[i] = child;
+        }
+    }
+    json->u.children.index = slots;
+    json->u.children.index_size = size;
 }
 
-struct nx_json *create_json(enum nx_json_type type, char *key, struct nx_json *parent) {
-    // Check if we have space for a new node
-    if (json_nodes_used >= MAX_JSON_NODES) {
+// Helper function implementations
+struct nx_json *create_json(struct nx_json_ctx *ctx, enum nx_json_type type, char *key, struct nx_json *parent) {
+    // Get the next available node from the context arena
+    struct nx_json *js = nx_json_ctx_alloc_node(ctx);
+    if (js == NULL) {
         return NULL; // No more nodes available
     }
     
-    // Get the next available node from the global array
-    struct nx_json *js = &json_nodes[json_nodes_used++];
-    
     // Basic initialization - no need for memset, we set all fields directly
     js->type = type;
     js->key = key;
+    js->key_length = 0;
+    js->text_length = 0;
     js->next = NULL;
     js->u.children.first = NULL;
     js->u.children.last = NULL;
     js->u.children.length = 0;
+    js->u.children.index = NULL;
+    js->u.children.index_size = 0;
 
     // Add to parent's children list if parent exists
     if (parent != NULL) {
@@ -83,26 +452,19 @@ struct nx_json *create_json(enum nx_json_type type, char *key, struct nx_json *p
     return js;
 }
 
-// Special handling for known test value to ensure exact comparison in tests
-void parse_numeric_value(char *p, struct nx_json *js) {
-    // Keep track of the original start pointer for atof
-    char *start = p;
-    
-    // Default to integer or double type based on content
-    js->type = NX_JSON_INTEGER;
-    
-    // Check for decimal point or exponent to determine type
-    char *check = p;
-    while (*check && (*check != ',' && *check != '}' && *check != ']' && *check != ' ')) {
-        if (*check == '.' || *check == 'e' || *check == 'E') {
-            js->type = NX_JSON_DOUBLE;
-            break;
-        }
-        check++;
+// Parse a number into js, returns the end of the number or NULL
+char *parse_numeric_value(char *p, char *end, struct nx_json *js) {
+    double number;
+    NX_JSON_INT integer;
+
+    p = nx_json_scan_number(p, end, &js->type, &number, &integer);
+    if (p == NULL) return NULL;
+    if (js->type == NX_JSON_INTEGER) {
+        js->u.int_value = integer;
+    } else {
+        js->u.number_value = number;
     }
-    
-    // Parse the value as double in either case
-    js->u.number_value = atof(start);
+    return p;
 }
 
 // Simple parser for boolean and null values
@@ -118,409 +480,362 @@ void parse_keyword_value(char *p, struct nx_json *js) {
     }
 }
 
-// Simplify the string parsing to not handle Unicode and complex escaping
-char* parse_string(char *p, char **value) {
-    if (*p != '"') return NULL;
+// Value of one hex digit, or -1
+int nx_json_hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Code point of the four hex digits at p, or -1
+int nx_json_hex4(char *p, char *end) {
+    int value = 0;
+    int digit;
+    int i;
+
+    if (end - p < 4) return -1;
+    for (i = 0; i < 4; i++) {
+        digit = nx_json_hex_digit(p[i]);
+        if (digit < 0) return -1;
+        value = value * 16 + digit;
+    }
+    return value;
+}
+
+// Decode escape sequences in place and return the new length.
+// The decoded text is never longer than the raw text, \u escapes become UTF-8.
+int nx_json_unescape(char *text, int length) {
+    char *end = text + length;
+    char *src = text;
+    char *dst = text;
+    int code;
+    int low;
+
+    while (src < end) {
+        if (*src != '\\' || src + 1 >= end) {
+            *dst++ = *src++;
+            continue;
+        }
+
+        src++; // Skip backslash
+        if (*src == 'n') {
+            *dst++ = '\n';
+        } else if (*src == 't') {
+            *dst++ = '\t';
+        } else if (*src == 'r') {
+            *dst++ = '\r';
+        } else if (*src == 'b') {
+            *dst++ = '\b';
+        } else if (*src == 'f') {
+            *dst++ = '\f';
+        } else if (*src == 'u') {
+            code = nx_json_hex4(src + 1, end);
+            if (code < 0) {
+                // Keep malformed escapes as they are
+                *dst++ = '\\';
+                *dst++ = *src++;
+                continue;
+            }
+            src += 4;
+
+            // Combine surrogate pairs into one code point
+            if (code >= 0xD800 && code <= 0xDBFF && end - src >= 7 && src[1] == '\\' && src[2] == 'u') {
+                low = nx_json_hex4(src + 3, end);
+                if (low >= 0xDC00 && low <= 0xDFFF) {
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    src += 6;
+                }
+            }
+
+            if (code < 0x80) {
+                *dst++ = code;
+            } else if (code < 0x800) {
+                *dst++ = 0xC0 | (code >> 6);
+                *dst++ = 0x80 | (code & 0x3F);
+            } else if (code < 0x10000) {
+                *dst++ = 0xE0 | (code >> 12);
+                *dst++ = 0x80 | ((code >> 6) & 0x3F);
+                *dst++ = 0x80 | (code & 0x3F);
+            } else {
+                *dst++ = 0xF0 | (code >> 18);
+                *dst++ = 0x80 | ((code >> 12) & 0x3F);
+                *dst++ = 0x80 | ((code >> 6) & 0x3F);
+                *dst++ = 0x80 | (code & 0x3F);
+            }
+        } else {
+            // \" \\ \/ and unknown escapes keep the escaped character
+            *dst++ = *src;
+        }
+        src++;
+    }
+    return dst - text;
+}
+
+// Parse a string and store it according to the context mode:
+// copied to the string arena, NUL-terminated in the input, or kept as a slice of the input
+char* parse_string(struct nx_json_ctx *ctx, char *p, char *end, char **value, int *value_length) {
+    char *result;
+    int escaped = 0;
+
+    if (p >= end || *p != '"') return NULL;
     p++; // Skip opening quote
     
     char *start = p;
-    while (*p && *p != '"') {
-        // Handle simple escape sequences
-        if (*p == '\\' && *(p+1)) {
-            p += 2;
-        } else {
-            p++;
-        }
+    p = nx_json_scan_quote(p, end);
+    while (p + 1 < end && *p == '\\') {
+        // Handle simple escape sequences, the escaped byte never ends the string
+        escaped = 1;
+        p = nx_json_scan_quote(p + 2, end);
     }
     
-    if (*p != '"') {
-        nx_json_report_error("Unterminated string", start);
+    if (p >= end || *p != '"') {
+        nx_json_parse_error(ctx, NX_JSON_ERROR_UNTERMINATED_STRING, start - 1);
         return NULL;
     }
     
-    // Check if we have enough space in the string buffer
     int length = p - start;
-    if (string_buffer_used + length + 1 > MAX_STRING_LENGTH) {
-        nx_json_report_error("String buffer full", start);
-        return NULL;
+    if (ctx->flags & (NX_JSON_INSITU | NX_JSON_SLICE)) {
+        // Zero-copy, the value points into the input
+        result = start;
+        if (escaped && (ctx->flags & NX_JSON_UNESCAPE)) {
+            length = nx_json_unescape(result, length);
+        }
+        if (ctx->flags & NX_JSON_INSITU) {
+            result[length] = '\0';  // Overwrites the closing quote or decoded leftovers
+        }
+    } else {
+        // Check if we have enough space in the string arena
+        result = nx_json_ctx_reserve(ctx, 0, length + 1);
+        if (result == NULL) {
+            nx_json_parse_error(ctx, NX_JSON_ERROR_STRINGS_FULL, start - 1);
+            return NULL;
+        }
+        
+        // Copy directly to the string arena
+        memcpy(result, start, length);
+        if (escaped && (ctx->flags & NX_JSON_UNESCAPE)) {
+            length = nx_json_unescape(result, length);
+        }
+        result[length] = '\0';  // Null terminate
+        
+        ctx->string_block->used += length + 1;
     }
-    
-    // Copy directly to the string buffer
-    char* result = &string_buffer[string_buffer_used];
-    memcpy(result, start, length);
-    result[length] = '\0';  // Null terminate
-    
-    string_buffer_used += length + 1;
     *value = result;
+    *value_length = length;
     
     return p + 1; // Skip closing quote
 }
 
 // Helper function to parse scalar values (string, number, boolean, null)
-char* parse_scalar_value(struct nx_json *parent, char *key, char *p) {
-    struct nx_json *js = NULL;
+char* parse_scalar_value(struct nx_json_ctx *ctx, struct nx_json *parent, char *key, int key_length, char *p, char *end) {
+    struct nx_json *js;
+    
+    if (*p != '"' && *p != '-' && (*p < '0' || *p > '9') && *p != 't' && *p != 'f' && *p != 'n') {
+        nx_json_parse_error(ctx, NX_JSON_ERROR_UNEXPECTED_CHARACTER, p);
+        return NULL;
+    }
+    
+    js = create_json(ctx, NX_JSON_NULL, key, parent);
+    if (js == NULL) {
+        nx_json_parse_error(ctx, NX_JSON_ERROR_NODES_FULL, p);
+        return NULL;
+    }
+    js->key_length = key_length;
     
     if (*p == '"') {
         // String
-        js = create_json(NX_JSON_STRING, key, parent);
-        if (js == NULL) return NULL;
-        
-        p = parse_string(p, &js->u.text_value);
-        if (p == NULL) return NULL;
-    } else if ((*p >= '0' && *p <= '9') || *p == '-') {
-        // Number
-        js = create_json(NX_JSON_INTEGER, key, parent);
-        if (js == NULL) return NULL;
-        
-        parse_numeric_value(p, js);
-        
-        // Skip to end of number
-        while ((*p >= '0' && *p <= '9') || *p == '.' || *p == '-' || 
-               *p == '+' || *p == 'e' || *p == 'E') {
-            p++;
-        }
-    } else if (*p == 't' || *p == 'f' || *p == 'n') {
+        js->type = NX_JSON_STRING;
+        return parse_string(ctx, p, end, &js->u.text_value, &js->text_length);
+    }
+    
+    if (*p == 't' || *p == 'f' || *p == 'n') {
         // Boolean or null
-        js = create_json(NX_JSON_NULL, key, parent);
-        if (js == NULL) return NULL;
-        
+        if (end - p < 5) {
+            nx_json_parse_error(ctx, NX_JSON_ERROR_UNEXPECTED_END, p);
+            return NULL;
+        }
         parse_keyword_value(p, js);
         
         // Skip keyword
-        if (*p == 't') p += 4; // true
-        else if (*p == 'f') p += 5; // false
-        else p += 4; // null
-    } else {
-        nx_json_report_error("Unexpected character in value", p);
-        return NULL;
+        if (*p == 'f') return p + 5; // false
+        return p + 4; // true or null
     }
     
-    return p;
+    // Number
+    end = parse_numeric_value(p, end, js);
+    if (end == NULL) {
+        nx_json_parse_error(ctx, NX_JSON_ERROR_INVALID_NUMBER, p);
+    }
+    return end;
 }
 
-// Parse JSON with support for two-level nested objects
-struct nx_json* nx_json_parse(char* text) {
-    if (text == NULL) return NULL;
-    
-    // Reset global state
-    nx_json_reset();
-    
+// Parse JSON objects and arrays of any depth up to MAX_NESTING_DEPTH into the context arenas.
+// Returns the root, or NULL with the error recorded in the context.
+struct nx_json* nx_json_ctx_parse_tree(struct nx_json_ctx *ctx, char* text, char *end) {
+    struct nx_json *root;
+    struct nx_json *parent;
+    struct nx_json *js;
+    enum nx_json_type type;
+    char *key;
+    int key_length;
+
     // Skip whitespace
-    text += skip_whitespace(text);
+    text += nx_json_scan_space(text, end);
     
-    if (*text != '{') {
-        nx_json_report_error("JSON must start with '{'", text);
+    if (text >= end || *text != '{') {
+        nx_json_parse_error(ctx, NX_JSON_ERROR_NOT_OBJECT, text);
         return NULL;
     }
     
-    // Create root object node
-    struct nx_json* root = create_json(NX_JSON_ROOT, NULL, NULL);
-    if (root == NULL) return NULL;
-    
-    // Move past opening brace
-    text++;
-    text += skip_whitespace(text);
-    
-    // Handle empty object
-    if (*text == '}') {
-        return root;
+    // Create root object node and make it the current parent
+    root = create_json(ctx, NX_JSON_ROOT, NULL, NULL);
+    if (root == NULL) {
+        nx_json_parse_error(ctx, NX_JSON_ERROR_NODES_FULL, text);
+        return NULL;
     }
+    nx_json_push(ctx, root);
+    text++; // Skip opening brace
     
-    // Parse key-value pairs at top level
-    while (*text) {
-        // Parse key
-        char *key;
-        text += skip_whitespace(text);
-        
-        if (*text != '"') {
-            nx_json_report_error("Expected string key", text);
-            nx_json_reset();
-            return NULL;
-        }
-        
-        text = parse_string(text, &key);
-        if (text == NULL) {
-            nx_json_reset();
-            return NULL;
-        }
-        
-        // Skip whitespace and expect colon
-        text += skip_whitespace(text);
-        if (*text != ':') {
-            nx_json_report_error("Expected ':' after key", text);
-            nx_json_reset();
+    // Each iteration parses one element of the innermost open object or array
+    while (ctx->stack_depth > 0) {
+        parent = ctx->parent_stack[ctx->stack_depth - 1];
+        text += nx_json_scan_space(text, end);
+        if (text >= end) {
+            nx_json_parse_error(ctx, NX_JSON_ERROR_UNEXPECTED_END, text);
             return NULL;
         }
-        text++; // Skip colon
-        text += skip_whitespace(text);
         
-        // Parse value based on first character
-        if (*text == '"') {
-            // String value
-            struct nx_json *js = create_json(NX_JSON_STRING, key, root);
-            if (js == NULL) {
-                nx_json_reset();
-                return NULL;
-            }
-            
-            text = parse_string(text, &js->u.text_value);
-            if (text == NULL) {
-                nx_json_reset();
-                return NULL;
-            }
-        } else if ((*text >= '0' && *text <= '9') || *text == '-') {
-            // Number value
-            struct nx_json *js = create_json(NX_JSON_INTEGER, key, root);
-            if (js == NULL) {
-                nx_json_reset();
-                return NULL;
+        // Empty containers close right after they were opened
+        if (parent->u.children.length > 0 || (*text != '}' && *text != ']')) {
+            // Object members start with a key, array elements do not
+            key = NULL;
+            key_length = 0;
+            if (parent->type != NX_JSON_ARRAY) {
+                if (*text != '"') {
+                    nx_json_parse_error(ctx, NX_JSON_ERROR_EXPECTED_KEY, text);
+                    return NULL;
+                }
+                
+                text = parse_string(ctx, text, end, &key, &key_length);
+                if (text == NULL) return NULL;
+                
+                // Skip whitespace and expect colon
+                text += nx_json_scan_space(text, end);
+                if (text >= end || *text != ':') {
+                    nx_json_parse_error(ctx, NX_JSON_ERROR_EXPECTED_COLON, text);
+                    return NULL;
+                }
+                text++; // Skip colon
+                text += nx_json_scan_space(text, end);
+                if (text >= end) {
+                    nx_json_parse_error(ctx, NX_JSON_ERROR_UNEXPECTED_END, text);
+                    return NULL;
+                }
             }
             
-            parse_numeric_value(text, js);
-            
-            // Skip to end of number
-            while ((*text >= '0' && *text <= '9') || *text == '.' || *text == '-' || 
-                  *text == '+' || *text == 'e' || *text == 'E') {
-                text++;
-            }
-        } else if (*text == 't' || *text == 'f' || *text == 'n') {
-            // Boolean or null value
-            struct nx_json *js = create_json(NX_JSON_NULL, key, root);
-            if (js == NULL) {
-                nx_json_reset();
-                return NULL;
+            if (*text == '{' || *text == '[') {
+                // Nested object or array becomes the new parent
+                if (ctx->stack_depth >= MAX_NESTING_DEPTH) {
+                    nx_json_parse_error(ctx, NX_JSON_ERROR_TOO_DEEP, text);
+                    return NULL;
+                }
+                
+                if (*text == '{') {
+                    type = NX_JSON_OBJECT;
+                } else {
+                    type = NX_JSON_ARRAY;
+                }
+                js = create_json(ctx, type, key, parent);
+                if (js == NULL) {
+                    nx_json_parse_error(ctx, NX_JSON_ERROR_NODES_FULL, text);
+                    return NULL;
+                }
+                js->key_length = key_length;
+                
+                nx_json_push(ctx, js);
+                text++; // Skip opening brace/bracket
+                continue;
             }
             
-            parse_keyword_value(text, js);
+            text = parse_scalar_value(ctx, parent, key, key_length, text, end);
+            if (text == NULL) return NULL;
+            text += nx_json_scan_space(text, end);
+        }
+        
+        // After a value, a comma starts the next element and brackets close containers
+        while (ctx->stack_depth > 0) {
+            parent = ctx->parent_stack[ctx->stack_depth - 1];
             
-            // Skip keyword
-            if (*text == 't') text += 4;      // true
-            else if (*text == 'f') text += 5; // false
-            else text += 4;                   // null
-        } else if (*text == '{') {
-            // Object value - parse one level down for second level
-            struct nx_json *js = create_json(NX_JSON_OBJECT, key, root);
-            if (js == NULL) {
-                nx_json_reset();
+            if (text >= end) {
+                nx_json_parse_error(ctx, NX_JSON_ERROR_UNEXPECTED_END, text);
                 return NULL;
-            }
-            
-            // Parse second-level object contents
-            text++; // Skip opening brace
-            text += skip_whitespace(text);
-            
-            // Handle empty object
-            if (*text == '}') {
-                text++; // Skip closing brace
-            } else {
-                // Parse key-value pairs in second-level object
-                while (*text) {
-                    // Parse second-level key
-                    char *inner_key;
-                    struct nx_json *inner_js = NULL; // Move declaration here, outside of conditional blocks
-                    
-                    if (*text != '"') {
-                        nx_json_report_error("Expected string key in nested object", text);
-                        nx_json_reset();
-                        return NULL;
-                    }
-                    
-                    text = parse_string(text, &inner_key);
-                    if (text == NULL) {
-                        nx_json_reset();
-                        return NULL;
-                    }
-                    
-                    // Skip whitespace and expect colon
-                    text += skip_whitespace(text);
-                    if (*text != ':') {
-                        nx_json_report_error("Expected ':' after key in nested object", text);
-                        nx_json_reset();
-                        return NULL;
-                    }
-                    text++; // Skip colon
-                    text += skip_whitespace(text);
-                    
-                    // Parse second-level value
-                    if (*text == '"') {
-                        // String value
-                        inner_js = create_json(NX_JSON_STRING, inner_key, js);
-                        if (inner_js == NULL) {
-                            nx_json_reset();
-                            return NULL;
-                        }
-                        
-                        text = parse_string(text, &inner_js->u.text_value);
-                        if (text == NULL) {
-                            nx_json_reset();
-                            return NULL;
-                        }
-                    } else if ((*text >= '0' && *text <= '9') || *text == '-') {
-                        // Number value
-                        inner_js = create_json(NX_JSON_INTEGER, inner_key, js);
-                        if (inner_js == NULL) {
-                            nx_json_reset();
-                            return NULL;
-                        }
-                        
-                        parse_numeric_value(text, inner_js);
-                        
-                        // Skip to end of number
-                        while ((*text >= '0' && *text <= '9') || *text == '.' || *text == '-' || 
-                              *text == '+' || *text == 'e' || *text == 'E') {
-                            text++;
-                        }
-                    } else if (*text == 't' || *text == 'f' || *text == 'n') {
-                        // Boolean or null value
-                        inner_js = create_json(NX_JSON_NULL, inner_key, js);
-                        if (inner_js == NULL) {
-                            nx_json_reset();
-                            return NULL;
-                        }
-                        
-                        parse_keyword_value(text, inner_js);
-                        
-                        // Skip keyword
-                        if (*text == 't') text += 4;      // true
-                        else if (*text == 'f') text += 5; // false
-                        else text += 4;                   // null
-                    } else if (*text == '{' || *text == '[') {
-                        // Skip nested objects or arrays within second level
-                        int depth = 1;
-                        
-                        // Create placeholder node
-                        enum nx_json_type type; 
-                        if (*text == '{') {
-                            type = NX_JSON_OBJECT;
-                        } else {
-                            type = NX_JSON_ARRAY;
-                        }
-                        inner_js = create_json(type, inner_key, js);
-                        if (inner_js == NULL) {
-                            nx_json_reset();
-                            return NULL;
-                        }
-                        
-                        text++; // Skip opening brace/bracket
-                        
-                        // Skip until matching closing brace/bracket
-                        while (*text && depth > 0) {
-                            if (*text == '{') {
-                                depth++; // Opening brace increases depth
-                            } else if (*text == '[') {
-                                depth++; // Opening bracket increases depth
-                            } else if (*text == '}') {
-                                depth--; // Closing brace decreases depth
-                            } else if (*text == ']') {
-                                depth--; // Closing bracket decreases depth
-                            } else if (*text == '"') {
-                                // Skip string content properly
-                                text++;
-                                while (*text && *text != '"') {
-                                    if (*text == '\\' && *(text+1)) text++; // Skip escape sequence
-                                    text++;
-                                }
-                                if (*text != '"') {
-                                    nx_json_report_error("Unterminated string", text);
-                                    nx_json_reset();
-                                    return NULL;
-                                }
-                            }
-                            text++;
-                        }
-                        
-                        if (depth != 0) {
-                            nx_json_report_error("Unterminated object/array", text);
-                            nx_json_reset();
-                            return NULL;
-                        }
-                    } else {
-                        nx_json_report_error("Unexpected character in nested object value", text);
-                        nx_json_reset();
-                        return NULL;
-                    }
-                    
-                    // Skip whitespace after value
-                    text += skip_whitespace(text);
-                    
-                    // Expect comma or closing brace
-                    if (*text == '}') {
-                        text++; // Skip closing brace
-                        break;
-                    } else if (*text == ',') {
-                        text++; // Skip comma
-                        text += skip_whitespace(text);
-                    } else {
-                        nx_json_report_error("Expected ',' or '}' in nested object", text);
-                        nx_json_reset();
-                        return NULL;
-                    }
+            } else if (*text == ',') {
+                text++; // Skip comma
+                break;
+            } else if ((*text == '}' && parent->type != NX_JSON_ARRAY) ||
+                       (*text == ']' && parent->type == NX_JSON_ARRAY)) {
+                text++; // Skip closing brace/bracket
+                if (ctx->flags & NX_JSON_INDEX) {
+                    nx_json_index_build(ctx, parent);
                 }
-            }
-        } else if (*text == '[') {
-            // Array value - create placeholder and skip contents
-            struct nx_json *js = create_json(NX_JSON_ARRAY, key, root);
-            if (js == NULL) {
-                nx_json_reset();
+                ctx->stack_depth--;
+                text += nx_json_scan_space(text, end);
+            } else if (*text == '}' || *text == ']') {
+                nx_json_parse_error(ctx, NX_JSON_ERROR_MISMATCHED_BRACKET, text);
                 return NULL;
-            }
-            
-            // Skip past the array without parsing it
-            int bracket_depth = 1;
-            text++; // Skip opening bracket
-            
-            while (*text && bracket_depth > 0) {
-                if (*text == '[') bracket_depth++;
-                else if (*text == ']') bracket_depth--;
-                else if (*text == '"') {
-                    // Skip string content properly
-                    text++;
-                    while (*text && *text != '"') {
-                        if (*text == '\\' && *(text+1)) text++; // Skip escape sequence
-                        text++;
-                    }
-                    if (*text != '"') {
-                        nx_json_report_error("Unterminated string", text);
-                        nx_json_reset();
-                        return NULL;
-                    }
-                }
-                text++;
-            }
-            
-            if (bracket_depth != 0) {
-                nx_json_report_error("Unterminated array", text);
-                nx_json_reset();
+            } else {
+                nx_json_parse_error(ctx, NX_JSON_ERROR_EXPECTED_SEPARATOR, text);
                 return NULL;
             }
-        } else {
-            nx_json_report_error("Unexpected character in value", text);
-            nx_json_reset();
-            return NULL;
-        }
-        
-        // Skip whitespace after value
-        text += skip_whitespace(text);
-        
-        // Expect comma or closing brace
-        if (*text == '}') {
-            text++; // Skip closing brace
-            break;
-        } else if (*text == ',') {
-            text++; // Skip comma
-            text += skip_whitespace(text);
-        } else {
-            nx_json_report_error("Expected ',' or '}'", text);
-            nx_json_reset();
-            return NULL;
         }
     }
     
+    ctx->stats.bytes = text - ctx->input;
     return root;
 }
 
+// Parse a document that does not need to be NUL-terminated into the context arenas.
+// The error and statistics of the parse are kept in the context.
+struct nx_json* nx_json_ctx_parse_length(struct nx_json_ctx *ctx, char* text, int text_length) {
+    struct nx_json *root;
+    double started = nx_json_clock();
+
+    // Drop the previous document, the arenas are reused
+    nx_json_ctx_reset(ctx);
+    nx_json_stats_begin(ctx);
+    if (text == NULL) {
+        nx_json_fail(ctx, NX_JSON_ERROR_UNEXPECTED_END, 0);
+        return NULL;
+    }
+    ctx->input = text;
+    
+    root = nx_json_ctx_parse_tree(ctx, text, text + text_length);
+    if (root == NULL) {
+        nx_json_stats_end(ctx, ctx->error_offset);
+        nx_json_ctx_reset(ctx);
+    } else {
+        nx_json_stats_end(ctx, ctx->stats.bytes);
+    }
+    ctx->stats.time_us = (int)((nx_json_clock() - started) * 1000000);
+    return root;
+}
+
+// Parse a NUL-terminated document into the context arenas
+struct nx_json* nx_json_ctx_parse(struct nx_json_ctx *ctx, char* text) {
+    if (text == NULL) return nx_json_ctx_parse_length(ctx, NULL, 0);
+    return nx_json_ctx_parse_length(ctx, text, strlen(text));
+}
+
+// Parse into the shared default context, the document stays valid until the next parse or nx_json_reset
+struct nx_json* nx_json_parse(char* text) {
+    return nx_json_ctx_parse(nx_json_default(), text);
+}
+
 // Get a child node by key from a JSON object or array
 struct nx_json* nx_json_get(struct nx_json* json, char* key) {
+    int key_length;
+
     if (json == NULL || key == NULL) return NULL;
     
     // Only objects and arrays (and the root node) can have children
@@ -528,12 +843,30 @@ struct nx_json* nx_json_get(struct nx_json* json, char* key) {
         return NULL;
     }
     
+    // Keys may be slices of the input, so compare by length
+    key_length = strlen(key);
+    
+    // Probe the hash table of indexed objects
+    if (json->type != NX_JSON_ARRAY && json->u.children.index != NULL) {
+        struct nx_json **slots = json->u.children.index;
+        unsigned int mask = json->u.children.index_size - 1;
+        unsigned int i = nx_json_hash(key, key_length) & mask;
+        while (slots[i] != NULL) {
+            if (slots[i]->key_length == key_length && memcmp(slots[i]->key, key, key_length) == 0) {
+                return slots[i];
+            }
+            i = (i + 1) & mask;
+        }
+        return NULL;
+    }
+    
     // Start with the first child
     struct nx_json* current = json->u.children.first;
     
     // Iterate through all children
     while (current != NULL) {
-        if (current->key != NULL && strcmp(current->key, key) == 0) {
+        if (current->key != NULL && current->key_length == key_length &&
+            memcmp(current->key, key, key_length) == 0) {
             return current;
         }
         
@@ -552,6 +885,14 @@ struct nx_json* nx_json_item(struct nx_json *json, int idx) {
         return NULL; // Not an array
     }
     
+    // Indexed arrays keep their items in order
+    if (json->u.children.index != NULL) {
+        if (idx < 0 || idx >= json->u.children.index_size) {
+            return NULL;
+        }
+        return json->u.children.index[idx];
+    }
+    
     // Find the element by iterating through the children
     struct nx_json *current = json->u.children.first;
     int current_idx = 0;
@@ -566,4 +907,361 @@ struct nx_json* nx_json_item(struct nx_json *json, int idx) {
     }
     
     return NULL; // Index out of bounds
-}
\ No newline at end of file
+}
+
+// Numeric value of an integer, double or bool node, 0 for other types
+double nx_json_number(struct nx_json *json) {
+    if (json == NULL) return 0;
+    if (json->type == NX_JSON_INTEGER) return (double)json->u.int_value;
+    if (json->type == NX_JSON_DOUBLE || json->type == NX_JSON_BOOL) return json->u.number_value;
+    return 0;
+}
+
+// Streaming parser: what the grammar expects next
+#define NX_JSON_EXPECT_ROOT 0
+#define NX_JSON_EXPECT_KEY_OR_END 1
+#define NX_JSON_EXPECT_KEY 2
+#define NX_JSON_EXPECT_COLON 3
+#define NX_JSON_EXPECT_VALUE_OR_END 4
+#define NX_JSON_EXPECT_VALUE 5
+#define NX_JSON_EXPECT_COMMA_OR_END 6
+#define NX_JSON_EXPECT_EOF 7
+
+// Streaming parser: token that may continue in the next chunk
+#define NX_JSON_LEX_NONE 0
+#define NX_JSON_LEX_KEY 1
+#define NX_JSON_LEX_STRING 2
+#define NX_JSON_LEX_NUMBER 3
+#define NX_JSON_LEX_KEYWORD 4
+
+// Start a new streaming parse into the context, this drops the document it held before
+void nx_json_stream_init(struct nx_json_stream *stream, struct nx_json_ctx *ctx) {
+    nx_json_ctx_reset(ctx);
+    nx_json_stats_begin(ctx);
+    ctx->input = NULL;
+    stream->ctx = ctx;
+    stream->expect = NX_JSON_EXPECT_ROOT;
+    stream->lexer = NX_JSON_LEX_NONE;
+    stream->escape = 0;
+    stream->error = 0;
+    stream->offset = 0;
+    stream->key = NULL;
+    stream->key_length = 0;
+    stream->text = NULL;
+    stream->text_length = 0;
+    stream->token_length = 0;
+    stream->root = NULL;
+}
+
+// Record the error at the current byte offset and drop the partial document
+void nx_json_stream_fail(struct nx_json_stream *stream, enum nx_json_error error) {
+    nx_json_fail(stream->ctx, error, stream->offset);
+    nx_json_stats_end(stream->ctx, stream->offset);
+    stream->error = 1;
+    nx_json_ctx_reset(stream->ctx);
+}
+
+// Open an object or array and make it the current parent
+int nx_json_stream_open(struct nx_json_stream *stream, enum nx_json_type type) {
+    struct nx_json_ctx *ctx = stream->ctx;
+    struct nx_json *parent = NULL;
+    struct nx_json *js;
+
+    if (ctx->stack_depth >= MAX_NESTING_DEPTH) {
+        nx_json_stream_fail(stream, NX_JSON_ERROR_TOO_DEEP);
+        return -1;
+    }
+    if (ctx->stack_depth > 0) {
+        parent = ctx->parent_stack[ctx->stack_depth - 1];
+    }
+
+    js = create_json(ctx, type, stream->key, parent);
+    if (js == NULL) {
+        nx_json_stream_fail(stream, NX_JSON_ERROR_NODES_FULL);
+        return -1;
+    }
+    if (type == NX_JSON_ROOT) {
+        stream->root = js;
+    }
+    js->key_length = stream->key_length;
+    stream->key = NULL;
+    stream->key_length = 0;
+    nx_json_push(ctx, js);
+
+    if (type == NX_JSON_ARRAY) {
+        stream->expect = NX_JSON_EXPECT_VALUE_OR_END;
+    } else {
+        stream->expect = NX_JSON_EXPECT_KEY_OR_END;
+    }
+    return 0;
+}
+
+// Close the current object or array
+int nx_json_stream_close(struct nx_json_stream *stream, char c) {
+    struct nx_json_ctx *ctx = stream->ctx;
+    struct nx_json *top = ctx->parent_stack[ctx->stack_depth - 1];
+
+    if ((c == ']' && top->type != NX_JSON_ARRAY) || (c == '}' && top->type == NX_JSON_ARRAY)) {
+        nx_json_stream_fail(stream, NX_JSON_ERROR_MISMATCHED_BRACKET);
+        return -1;
+    }
+
+    if (ctx->flags & NX_JSON_INDEX) {
+        nx_json_index_build(ctx, top);
+    }
+    ctx->stack_depth--;
+    if (ctx->stack_depth == 0) {
+        stream->expect = NX_JSON_EXPECT_EOF;
+    } else {
+        stream->expect = NX_JSON_EXPECT_COMMA_OR_END;
+    }
+    return 0;
+}
+
+// Attach a finished scalar value to the current parent
+struct nx_json *nx_json_stream_value(struct nx_json_stream *stream, enum nx_json_type type) {
+    struct nx_json_ctx *ctx = stream->ctx;
+    struct nx_json *js = create_json(ctx, type, stream->key, ctx->parent_stack[ctx->stack_depth - 1]);
+    if (js == NULL) {
+        nx_json_stream_fail(stream, NX_JSON_ERROR_NODES_FULL);
+        return NULL;
+    }
+    js->key_length = stream->key_length;
+    stream->key = NULL;
+    stream->key_length = 0;
+    stream->expect = NX_JSON_EXPECT_COMMA_OR_END;
+    return js;
+}
+
+// Finish a number or keyword once the first byte after it arrived
+int nx_json_stream_token_end(struct nx_json_stream *stream) {
+    struct nx_json *js;
+
+    stream->token[stream->token_length] = '\0';
+    stream->lexer = NX_JSON_LEX_NONE;
+
+    if (stream->token[0] == 't' || stream->token[0] == 'f' || stream->token[0] == 'n') {
+        if (strcmp(stream->token, "true") != 0 && strcmp(stream->token, "false") != 0 &&
+            strcmp(stream->token, "null") != 0) {
+            nx_json_stream_fail(stream, NX_JSON_ERROR_UNEXPECTED_CHARACTER);
+            return -1;
+        }
+        js = nx_json_stream_value(stream, NX_JSON_NULL);
+        if (js == NULL) return -1;
+        parse_keyword_value(stream->token, js);
+    } else {
+        js = nx_json_stream_value(stream, NX_JSON_INTEGER);
+        if (js == NULL) return -1;
+        if (parse_numeric_value(stream->token, stream->token + stream->token_length, js) !=
+            stream->token + stream->token_length) {
+            nx_json_stream_fail(stream, NX_JSON_ERROR_INVALID_NUMBER);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Append bytes to the string being collected, moving it if the arena grows
+int nx_json_stream_append(struct nx_json_stream *stream, char *p, int length) {
+    // Keep one spare byte so the terminator always fits
+    char *text = nx_json_ctx_reserve(stream->ctx, stream->text_length, length + 1);
+    if (text == NULL) {
+        nx_json_stream_fail(stream, NX_JSON_ERROR_STRINGS_FULL);
+        return -1;
+    }
+    memcpy(text + stream->text_length, p, length);
+    stream->ctx->string_block->used += length;
+    stream->text = text;
+    stream->text_length += length;
+    return 0;
+}
+
+// Consume string bytes until the closing quote or the end of the chunk
+int nx_json_stream_string(struct nx_json_stream *stream, char *p, int length) {
+    struct nx_json_string_block *block;
+    struct nx_json *js;
+    int i = 0;
+    int start;
+
+    while (i < length) {
+        if (stream->escape) {
+            // Byte after a backslash never ends the string
+            stream->escape = 0;
+            start = i;
+            i++;
+        } else {
+            start = i;
+            i = nx_json_scan_quote(p + i, p + length) - p;
+            if (i < length && p[i] == '\\') {
+                stream->escape = 1;
+                i++;
+            }
+        }
+
+        // Copy the run into the string arena
+        if (nx_json_stream_append(stream, p + start, i - start) != 0) {
+            stream->offset += i;
+            return i;
+        }
+
+        if (i < length && p[i] == '"' && stream->escape == 0) {
+            block = stream->ctx->string_block;
+            block->text[block->used++] = '\0';
+            if (stream->ctx->flags & NX_JSON_UNESCAPE) {
+                stream->text_length = nx_json_unescape(stream->text, stream->text_length);
+                stream->text[stream->text_length] = '\0';
+            }
+            i++; // Skip closing quote
+            stream->offset += i;
+
+            if (stream->lexer == NX_JSON_LEX_KEY) {
+                stream->key = stream->text;
+                stream->key_length = stream->text_length;
+                stream->expect = NX_JSON_EXPECT_COLON;
+            } else {
+                js = nx_json_stream_value(stream, NX_JSON_STRING);
+                if (js == NULL) return i;
+                js->u.text_value = stream->text;
+                js->text_length = stream->text_length;
+            }
+            stream->lexer = NX_JSON_LEX_NONE;
+            return i;
+        }
+    }
+
+    stream->offset += i;
+    return i;
+}
+
+// Consume one byte outside of a string
+int nx_json_stream_char(struct nx_json_stream *stream, char c) {
+    int expect;
+
+    if (stream->lexer == NX_JSON_LEX_NUMBER) {
+        if ((c >= '0' && c <= '9') || c == '.' || c == '-' || c == '+' || c == 'e' || c == 'E') {
+            if (stream->token_length >= NX_JSON_STREAM_TOKEN_SIZE - 1) {
+                nx_json_stream_fail(stream, NX_JSON_ERROR_INVALID_NUMBER);
+                return -1;
+            }
+            stream->token[stream->token_length++] = c;
+            return 0;
+        }
+        if (nx_json_stream_token_end(stream) != 0) return -1;
+    } else if (stream->lexer == NX_JSON_LEX_KEYWORD) {
+        if (c >= 'a' && c <= 'z') {
+            if (stream->token_length >= NX_JSON_STREAM_TOKEN_SIZE - 1) {
+                nx_json_stream_fail(stream, NX_JSON_ERROR_UNEXPECTED_CHARACTER);
+                return -1;
+            }
+            stream->token[stream->token_length++] = c;
+            return 0;
+        }
+        if (nx_json_stream_token_end(stream) != 0) return -1;
+    }
+
+    if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+        return 0;
+    }
+
+    expect = stream->expect;
+    if (expect == NX_JSON_EXPECT_KEY_OR_END || expect == NX_JSON_EXPECT_KEY) {
+        if (c == '"') {
+            stream->lexer = NX_JSON_LEX_KEY;
+            stream->text_length = 0;
+            if (nx_json_stream_append(stream, "", 0) != 0) return -1;
+        } else if (c == '}' && expect == NX_JSON_EXPECT_KEY_OR_END) {
+            return nx_json_stream_close(stream, c);
+        } else {
+            nx_json_stream_fail(stream, NX_JSON_ERROR_EXPECTED_KEY);
+            return -1;
+        }
+    } else if (expect == NX_JSON_EXPECT_COLON) {
+        if (c != ':') {
+            nx_json_stream_fail(stream, NX_JSON_ERROR_EXPECTED_COLON);
+            return -1;
+        }
+        stream->expect = NX_JSON_EXPECT_VALUE;
+    } else if (expect == NX_JSON_EXPECT_VALUE || expect == NX_JSON_EXPECT_VALUE_OR_END) {
+        if (c == ']' && expect == NX_JSON_EXPECT_VALUE_OR_END) {
+            return nx_json_stream_close(stream, c);
+        } else if (c == '"') {
+            stream->lexer = NX_JSON_LEX_STRING;
+            stream->text_length = 0;
+            if (nx_json_stream_append(stream, "", 0) != 0) return -1;
+        } else if (c == '{') {
+            return nx_json_stream_open(stream, NX_JSON_OBJECT);
+        } else if (c == '[') {
+            return nx_json_stream_open(stream, NX_JSON_ARRAY);
+        } else if ((c >= '0' && c <= '9') || c == '-') {
+            stream->lexer = NX_JSON_LEX_NUMBER;
+            stream->token[0] = c;
+            stream->token_length = 1;
+        } else if (c == 't' || c == 'f' || c == 'n') {
+            stream->lexer = NX_JSON_LEX_KEYWORD;
+            stream->token[0] = c;
+            stream->token_length = 1;
+        } else {
+            nx_json_stream_fail(stream, NX_JSON_ERROR_UNEXPECTED_CHARACTER);
+            return -1;
+        }
+    } else if (expect == NX_JSON_EXPECT_COMMA_OR_END) {
+        if (c == ',') {
+            if (stream->ctx->parent_stack[stream->ctx->stack_depth - 1]->type == NX_JSON_ARRAY) {
+                stream->expect = NX_JSON_EXPECT_VALUE;
+            } else {
+                stream->expect = NX_JSON_EXPECT_KEY;
+            }
+        } else if (c == '}' || c == ']') {
+            return nx_json_stream_close(stream, c);
+        } else {
+            nx_json_stream_fail(stream, NX_JSON_ERROR_EXPECTED_SEPARATOR);
+            return -1;
+        }
+    } else if (expect == NX_JSON_EXPECT_ROOT) {
+        if (c != '{') {
+            nx_json_stream_fail(stream, NX_JSON_ERROR_NOT_OBJECT);
+            return -1;
+        }
+        return nx_json_stream_open(stream, NX_JSON_ROOT);
+    } else {
+        nx_json_stream_fail(stream, NX_JSON_ERROR_TRAILING_DATA);
+        return -1;
+    }
+    return 0;
+}
+
+// Feed the next chunk of input, returns 0 on success and -1 on error
+int nx_json_stream_feed(struct nx_json_stream *stream, char *chunk, int length) {
+    double started;
+    int i = 0;
+
+    if (stream->error) return -1;
+    if (chunk == NULL) return 0;
+
+    // Only the time spent in the parser counts, not the waits between chunks
+    started = nx_json_clock();
+    while (i < length && stream->error == 0) {
+        if (stream->lexer == NX_JSON_LEX_KEY || stream->lexer == NX_JSON_LEX_STRING) {
+            i += nx_json_stream_string(stream, chunk + i, length - i);
+        } else {
+            nx_json_stream_char(stream, chunk[i]);
+            stream->offset++;
+            i++;
+        }
+    }
+    stream->ctx->stats.time_us += (int)((nx_json_clock() - started) * 1000000);
+    if (stream->error) return -1;
+    return 0;
+}
+
+// Signal the end of input, returns the root node or NULL if the document is incomplete
+struct nx_json *nx_json_stream_finish(struct nx_json_stream *stream) {
+    if (stream->error) return NULL;
+
+    if (stream->expect != NX_JSON_EXPECT_EOF || stream->lexer != NX_JSON_LEX_NONE) {
+        nx_json_stream_fail(stream, NX_JSON_ERROR_UNEXPECTED_END);
+        return NULL;
+    }
+    nx_json_stats_end(stream->ctx, stream->offset);
+    return stream->root;
+}
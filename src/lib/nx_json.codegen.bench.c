@@ -0,0 +1,112 @@
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "nx_json.h"
+#include "forecast_solar_daily.h"
+
+// Day totals from the forecast.solar mocks three ways: nx_json_parse with
+// nx_json_get, nx_json_extract, and the extractor generated from
+// forecast_solar_daily.schema. Prints one line per document and method:
+//
+//   bench=<parse|extract|generated> doc=<mock> bytes=<n> iterations=<n> ns_per_doc=<f> mb_s=<f>
+
+#define ITERATIONS 200000
+#define TODAY "2025-02-27"
+#define TOMORROW "2025-02-28"
+
+double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Function to read the entire contents of a file into a string
+char* read_file(const char* filename) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        perror("Could not open file");
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *content = (char *)malloc(length + 1);
+    size_t read_size = fread(content, 1, length, file);
+    content[read_size] = '\0';
+    fclose(file);
+
+    return content;
+}
+
+// Sum of both day totals with the given method, so every method does the same work
+double day_totals(int method, char *text, int length) {
+    struct nx_json *result;
+    struct nx_json_query queries[2];
+    struct forecast_solar_daily daily;
+
+    if (method == 0) {
+        result = nx_json_get(nx_json_parse(text), "result");
+        return nx_json_number(nx_json_get(result, TODAY)) + nx_json_number(nx_json_get(result, TOMORROW));
+    }
+    if (method == 1) {
+        nx_json_query_init(&queries[0]);
+        nx_json_query_key(&queries[0], "result");
+        nx_json_query_key(&queries[0], TODAY);
+        nx_json_query_init(&queries[1]);
+        nx_json_query_key(&queries[1], "result");
+        nx_json_query_key(&queries[1], TOMORROW);
+        nx_json_extract(text, length, queries, 2);
+        return queries[0].number_value + queries[1].number_value;
+    }
+    forecast_solar_daily_extract(text, length, &daily, TODAY, TOMORROW);
+    return daily.today + daily.tomorrow;
+}
+
+int bench_document(char *path, char *name) {
+    char *methods[] = {"parse", "extract", "generated"};
+    char *text = read_file(path);
+    int length;
+    double start;
+    double elapsed;
+    double sum;
+    int method;
+    int i;
+
+    if (text == NULL) return -1;
+    length = strlen(text);
+
+    for (method = 0; method < 3; method++) {
+        if (day_totals(method, text, length) != 4674362.0 + 4774208.0) {
+            fprintf(stderr, "%s returned wrong totals for %s\n", methods[method], name);
+            return -1;
+        }
+
+        sum = 0;
+        start = now_ns();
+        for (i = 0; i < ITERATIONS; i++) {
+            sum += day_totals(method, text, length);
+        }
+        elapsed = now_ns() - start;
+        if (sum < 0) printf("unexpected sum\n");
+
+        printf("bench=%s doc=%s bytes=%d iterations=%d ns_per_doc=%.1f mb_s=%.1f\n",
+               methods[method], name, length, ITERATIONS, elapsed / ITERATIONS,
+               length * (double)ITERATIONS / elapsed * 1e3);
+    }
+
+    nx_json_reset();
+    free(text);
+    return 0;
+}
+
+int main() {
+    if (bench_document(MOCK_RESPONSE_BODY_FILE, "forecast_solar_response_body") != 0 ||
+        bench_document(MOCK_RESPONSE_BODY_ONELINE_FILE, "forecast_solar_response_body_oneline") != 0) {
+        return 1;
+    }
+    return 0;
+}
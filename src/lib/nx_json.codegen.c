@@ -0,0 +1,990 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+// Extractor generator: reads a schema of the few fields a script needs and
+// writes <extractor>.h and <extractor>.c, a parser specialised to those paths.
+// The generated code follows the PicoC subset and only needs nx_json.h and
+// nx_json_scan.c, so the bundle concatenates it instead of a generic parser.
+// There is one function per object or array on the schema paths, keys are
+// compared as literals and every other subtree is skipped without parsing.
+// Nothing is allocated and no key is copied.
+//
+// Text that arrives in chunks goes through the stream of the extractor:
+// <extractor>_begin, <extractor>_feed for every chunk and <extractor>_finish.
+// The stream keeps the open containers on a stack of MAX_NESTING_DEPTH and
+// buffers only the current key and the number of a field, so the memory of
+// a pass does not depend on the size of the text or its chunks.
+//
+// Schema lines, '#' starts a comment:
+//
+//   extractor <name>
+//   <type> <field> <path>          scalar field, type is double, float or int
+//   <type> <field>[<n>] <path>     first n items of the array marked [] in path
+//
+// A path is object keys separated by '.'. {name} is a key passed to the
+// extractor at runtime and key[] visits every item of the array under key,
+// e.g. "result.{today}" or "data[].price". Keys are matched as they appear in
+// the JSON text, escape sequences are not decoded, and a literal key wins over
+// a {name} key at the same level.
+//
+// Usage: nx_json_codegen <schema> <output directory>
+
+#define MAX_NAME 64
+#define MAX_NODES 64
+#define MAX_FIELDS 32
+#define MAX_PARAMS 8
+#define STREAM_KEY_SIZE 32   // Least key buffer of a stream, longer keys of the text match nothing
+
+struct field {
+    char type[MAX_NAME];
+    char name[MAX_NAME];
+    int capacity;    // Array items kept, 0 for scalars
+    int node;
+};
+
+// Schema paths merged into a tree, node 0 is the root object
+struct node {
+    char key[MAX_NAME];
+    int is_param;    // key names a runtime parameter
+    int is_array;    // The value is an array whose items continue the path
+    int field;       // Field stored at this node, -1 if the path continues
+    int parent;
+    int capacity;    // Items visited by an array node, the largest field capacity
+};
+
+char *schema_path;
+int line_number = 0;
+char extractor[MAX_NAME];
+struct field fields[MAX_FIELDS];
+int field_count = 0;
+struct node nodes[MAX_NODES];
+int node_count = 0;
+char params[MAX_PARAMS][MAX_NAME];
+int param_count = 0;
+
+void fail(char *message, char *detail) {
+    fprintf(stderr, "%s:%d: %s '%s'\n", schema_path, line_number, message, detail);
+    exit(1);
+}
+
+int is_identifier(char *name) {
+    int i;
+    if (name[0] == '\0' || isdigit((unsigned char)name[0])) return 0;
+    for (i = 0; name[i] != '\0'; i++) {
+        if (isalnum((unsigned char)name[i]) == 0 && name[i] != '_') return 0;
+    }
+    return 1;
+}
+
+int has_children(int node) {
+    int i;
+    for (i = 1; i < node_count; i++) {
+        if (nodes[i].parent == node) return 1;
+    }
+    return 0;
+}
+
+// Whether functions for this node run inside an array item and take its index
+int is_indexed(int node) {
+    for (; node > 0; node = nodes[node].parent) {
+        if (nodes[node].is_array) return 1;
+    }
+    return 0;
+}
+
+// Find or add the child of parent for one path segment
+int child_node(int parent, char *key, int is_param, int is_array) {
+    int i;
+
+    if (nodes[parent].field >= 0) fail("path continues below the field at", nodes[parent].key);
+    for (i = 1; i < node_count; i++) {
+        if (nodes[i].parent == parent && nodes[i].is_param == is_param && strcmp(nodes[i].key, key) == 0) {
+            if (nodes[i].is_array != is_array) fail("key is used both as an array and an object", key);
+            return i;
+        }
+    }
+    if (node_count == MAX_NODES) fail("too many path segments at", key);
+    strcpy(nodes[node_count].key, key);
+    nodes[node_count].is_param = is_param;
+    nodes[node_count].is_array = is_array;
+    nodes[node_count].field = -1;
+    nodes[node_count].parent = parent;
+    nodes[node_count].capacity = 0;
+    return node_count++;
+}
+
+void add_param(char *name) {
+    char *reserved[] = {"text", "length", "out", "state", "p", "found", "s"};
+    int i;
+
+    if (is_identifier(name) == 0) fail("parameter is not a C identifier", name);
+    for (i = 0; i < 7; i++) {
+        if (strcmp(name, reserved[i]) == 0) fail("parameter name is reserved", name);
+    }
+    for (i = 0; i < param_count; i++) {
+        if (strcmp(params[i], name) == 0) return;
+    }
+    if (param_count == MAX_PARAMS) fail("too many parameters at", name);
+    strcpy(params[param_count++], name);
+}
+
+// Add the nodes of one field path and attach the field to its last node
+void add_path(struct field *field, char *path) {
+    char segment[MAX_NAME];
+    char *p = path;
+    int node = 0;
+    int array_node = -1;
+    int length;
+    int is_array;
+    int is_param;
+
+    while (*p != '\0') {
+        length = strcspn(p, ".");
+        if (length == 0 || length >= MAX_NAME) fail("bad path segment in", path);
+        memcpy(segment, p, length);
+        segment[length] = '\0';
+        p += length;
+        if (*p == '.') p++;
+
+        is_array = 0;
+        if (length > 2 && strcmp(segment + length - 2, "[]") == 0) {
+            is_array = 1;
+            length -= 2;
+            segment[length] = '\0';
+        }
+        is_param = 0;
+        if (segment[0] == '{' && segment[length - 1] == '}' && length > 2) {
+            is_param = 1;
+            segment[length - 1] = '\0';
+            memmove(segment, segment + 1, length - 1);
+            add_param(segment);
+        }
+        if (strpbrk(segment, "\"\\{}[]") != NULL) fail("bad key in", path);
+
+        node = child_node(node, segment, is_param, is_array);
+        if (is_array) {
+            if (array_node >= 0) fail("nested arrays are not supported in", path);
+            array_node = node;
+        }
+    }
+
+    if (node == 0) fail("empty path for field", field->name);
+    if (nodes[node].field >= 0 || has_children(node)) fail("path is used by another field", path);
+    if (field->capacity > 0 && array_node < 0) fail("array field needs a [] in its path", path);
+    if (field->capacity == 0 && array_node >= 0) fail("scalar field can not have a [] in its path", path);
+
+    nodes[node].field = field - fields;
+    field->node = node;
+    if (array_node >= 0 && nodes[array_node].capacity < field->capacity) {
+        nodes[array_node].capacity = field->capacity;
+    }
+}
+
+void read_schema(char *path) {
+    FILE *file = fopen(path, "r");
+    char line[512];
+    char type[MAX_NAME];
+    char name[MAX_NAME];
+    char field_path[256];
+    char extra[8];
+    char *bracket;
+    struct field *field;
+    int i;
+
+    if (file == NULL) {
+        perror(path);
+        exit(1);
+    }
+
+    extractor[0] = '\0';
+    strcpy(nodes[0].key, "");
+    nodes[0].is_param = 0;
+    nodes[0].is_array = 0;
+    nodes[0].field = -1;
+    nodes[0].parent = -1;
+    nodes[0].capacity = 0;
+    node_count = 1;
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        line_number++;
+        if (strchr(line, '#') != NULL) *strchr(line, '#') = '\0';
+
+        i = sscanf(line, "%63s %63s %255s %7s", type, name, field_path, extra);
+        if (i <= 0) continue;
+        if (strcmp(type, "extractor") == 0 && i == 2) {
+            if (is_identifier(name) == 0) fail("extractor name is not a C identifier", name);
+            strcpy(extractor, name);
+            continue;
+        }
+        if (i != 3) fail("expected '<type> <field> <path>', got", line);
+        if (strcmp(type, "double") != 0 && strcmp(type, "float") != 0 && strcmp(type, "int") != 0) {
+            fail("unknown type", type);
+        }
+        if (field_count == MAX_FIELDS) fail("too many fields at", name);
+
+        field = &fields[field_count++];
+        strcpy(field->type, type);
+        field->capacity = 0;
+        bracket = strchr(name, '[');
+        if (bracket != NULL) {
+            field->capacity = atoi(bracket + 1);
+            if (field->capacity <= 0 || strcmp(bracket + strcspn(bracket, "]"), "]") != 0) {
+                fail("bad array capacity", name);
+            }
+            *bracket = '\0';
+        }
+        if (is_identifier(name) == 0) fail("field name is not a C identifier", name);
+        for (i = 0; i < field_count - 1; i++) {
+            if (strcmp(fields[i].name, name) == 0) fail("duplicate field", name);
+        }
+        strcpy(field->name, name);
+        add_path(field, field_path);
+    }
+    fclose(file);
+
+    line_number = 0;
+    if (extractor[0] == '\0') fail("missing extractor line in", path);
+    if (field_count == 0) fail("no fields in", path);
+}
+
+// Path of a node for comments, e.g. result.{today}
+void node_path(int node, char *out) {
+    char parent[512];
+
+    if (node == 0) {
+        strcpy(out, "root");
+        return;
+    }
+    parent[0] = '\0';
+    if (nodes[node].parent > 0) {
+        node_path(nodes[node].parent, parent);
+        strcat(parent, ".");
+    }
+    if (nodes[node].is_param) {
+        sprintf(out, "%s{%s}", parent, nodes[node].key);
+    } else {
+        sprintf(out, "%s%s", parent, nodes[node].key);
+    }
+    if (nodes[node].is_array) strcat(out, "[]");
+}
+
+// Key buffer of a stream, long enough for every literal key of the schema
+int stream_key_size() {
+    int size = STREAM_KEY_SIZE;
+    int i;
+
+    for (i = 1; i < node_count; i++) {
+        if (nodes[i].is_param == 0 && (int)strlen(nodes[i].key) >= size) size = strlen(nodes[i].key) + 1;
+    }
+    return size;
+}
+
+void write_stream_header(FILE *out) {
+    int i;
+
+    fprintf(out, "// Incremental pass over text that arrives in chunks, see %s_begin\n", extractor);
+    fprintf(out, "struct %s_stream {\n", extractor);
+    fprintf(out, "    struct %s *out;\n", extractor);
+    fprintf(out, "    int missing;         // Fields not complete yet, the pass stops at 0\n");
+    fprintf(out, "    int state;           // NX_JSON_EXTRACT_ROOT etc.\n");
+    fprintf(out, "    int depth;           // Open containers\n");
+    fprintf(out, "    int node[MAX_NESTING_DEPTH];      // Schema node of each open container, -1 if skipped\n");
+    fprintf(out, "    int index[MAX_NESTING_DEPTH];     // Item index in arrays, index of the enclosing item in objects\n");
+    fprintf(out, "    char closing[MAX_NESTING_DEPTH];  // Closing bracket of each open container\n");
+    fprintf(out, "    int escape;          // The last byte of the string was a backslash\n");
+    fprintf(out, "    char key[%d];  // Key of the current member, not terminated\n", stream_key_size());
+    fprintf(out, "    int key_length;      // -1 once the key is longer than the buffer\n");
+    fprintf(out, "    char token[NX_JSON_STREAM_TOKEN_SIZE];  // Number of the current field\n");
+    fprintf(out, "    int token_length;    // -1 once the exponent does not fit\n");
+    fprintf(out, "    int part;            // 0 in the integer digits, 1 in the fraction, 2 in the exponent, 3 dropping the fraction\n");
+    fprintf(out, "    int dropped;         // Integer digits past the buffer, each scales the number by 10\n");
+    fprintf(out, "    int value_kind;      // NX_JSON_EXTRACT_SKIP etc. for the value being read\n");
+    fprintf(out, "    int value_node;\n");
+    fprintf(out, "    int value_index;\n");
+    fprintf(out, "    double number;\n");
+    fprintf(out, "    NX_JSON_INT integer;\n");
+    for (i = 0; i < param_count; i++) {
+        fprintf(out, "    char *param_%s;\n", params[i]);
+        fprintf(out, "    int param_%s_length;\n", params[i]);
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "void %s_begin(struct %s_stream *s, struct %s *out", extractor, extractor, extractor);
+    for (i = 0; i < param_count; i++) {
+        fprintf(out, ", char *%s", params[i]);
+    }
+    fprintf(out, ");\n");
+    fprintf(out, "int %s_feed(struct %s_stream *s, char *text, int length);\n", extractor, extractor);
+    fprintf(out, "int %s_finish(struct %s_stream *s);\n\n", extractor, extractor);
+}
+
+void write_header(FILE *out, char *schema_name) {
+    char guard[MAX_NAME];
+    int i;
+
+    for (i = 0; extractor[i] != '\0'; i++) {
+        guard[i] = toupper((unsigned char)extractor[i]);
+    }
+    guard[i] = '\0';
+
+    fprintf(out, "#ifndef %s_H\n#define %s_H\n\n", guard, guard);
+    fprintf(out, "// Generated by nx_json_codegen from %s, do not edit\n\n", schema_name);
+    fprintf(out, "// Check if we're using a standard C compiler\n");
+    fprintf(out, "#ifndef PICO_C\n");
+    fprintf(out, "#include \"nx_json.h\"\n");
+    fprintf(out, "#endif\n\n");
+    fprintf(out, "// Fields filled by %s_extract, fields that were not found stay 0\n", extractor);
+    fprintf(out, "struct %s {\n", extractor);
+    for (i = 0; i < field_count; i++) {
+        if (fields[i].capacity > 0) {
+            fprintf(out, "    %s %s[%d];\n", fields[i].type, fields[i].name, fields[i].capacity);
+            fprintf(out, "    int %s_length;    // Last item stored plus one\n", fields[i].name);
+        } else {
+            fprintf(out, "    %s %s;\n", fields[i].type, fields[i].name);
+            fprintf(out, "    int %s_found;\n", fields[i].name);
+        }
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "int %s_extract(char *text, int length, struct %s *out", extractor, extractor);
+    for (i = 0; i < param_count; i++) {
+        fprintf(out, ", char *%s", params[i]);
+    }
+    fprintf(out, ");\n\n");
+    write_stream_header(out);
+    fprintf(out, "#endif // %s_H\n", guard);
+}
+
+// Condition matching the key just read to a node
+void write_key_match(FILE *out, int node) {
+    if (nodes[node].is_param) {
+        fprintf(out, "s->key_length == s->param_%s_length && memcmp(s->key, s->param_%s, s->key_length) == 0",
+                nodes[node].key, nodes[node].key);
+    } else {
+        fprintf(out, "s->key_length == %d && memcmp(s->key, \"%s\", %d) == 0",
+                (int)strlen(nodes[node].key), nodes[node].key, (int)strlen(nodes[node].key));
+    }
+}
+
+// Read a number into a field, indent is the indentation of the surrounding block
+void write_store(FILE *out, struct field *field, char *indent) {
+    char target[MAX_NAME * 2];
+    char *value = "s->number";
+
+    if (strcmp(field->type, "float") == 0) value = "(float)s->number";
+    if (strcmp(field->type, "int") == 0) value = "(int)s->integer";
+
+    if (field->capacity > 0) {
+        sprintf(target, "s->out->%s[index]", field->name);
+    } else {
+        sprintf(target, "s->out->%s", field->name);
+    }
+
+    fprintf(out, "%sp = %s_number(s, p);\n", indent, extractor);
+    fprintf(out, "%sif (p != NULL && s->stored) {\n", indent);
+    fprintf(out, "%s    %s = %s;\n", indent, target, value);
+    if (field->capacity > 0) {
+        fprintf(out, "%s    s->out->%s_length = index + 1;\n", indent, field->name);
+        fprintf(out, "%s    if (index + 1 == %d) s->missing--;\n", indent, field->capacity);
+    } else {
+        fprintf(out, "%s    s->out->%s_found = 1;\n", indent, field->name);
+        fprintf(out, "%s    s->missing--;\n", indent);
+    }
+    fprintf(out, "%s}\n", indent);
+}
+
+// Members of an object on the schema paths, node is the object (or the array of objects)
+void write_object(FILE *out, int node) {
+    char path[512];
+    char *index_argument = "";
+    char *separator = "";
+    struct field *field;
+    int i;
+
+    if (is_indexed(node)) index_argument = ", index";
+    node_path(node, path);
+    fprintf(out, "// Object at %s\n", path);
+    fprintf(out, "char *%s_object_%d(struct %s_state *s, char *p%s) {\n", extractor, node, extractor,
+            is_indexed(node) ? ", int index" : "");
+    fprintf(out, "    if (*p != '{') return nx_json_scan_value_end(p, s->end);\n");
+    fprintf(out, "    p++;\n");
+    fprintf(out, "    p += nx_json_scan_space(p, s->end);\n");
+    fprintf(out, "    while (s->missing > 0) {\n");
+    fprintf(out, "        if (p >= s->end) return NULL;\n");
+    fprintf(out, "        if (*p == '}') return p + 1;\n");
+    fprintf(out, "        p = %s_key(s, p);\n", extractor);
+    fprintf(out, "        if (p == NULL) return NULL;\n");
+
+    for (i = 1; i < node_count; i++) {
+        if (nodes[i].parent != node) continue;
+        field = NULL;
+        if (nodes[i].field >= 0) field = &fields[nodes[i].field];
+
+        fprintf(out, "        %sif (", separator);
+        write_key_match(out, i);
+        if (field != NULL && nodes[i].is_array == 0 && field->capacity > 0) {
+            fprintf(out, " && index < %d", field->capacity);
+        } else if (field != NULL && nodes[i].is_array == 0) {
+            fprintf(out, " && s->out->%s_found == 0", field->name);
+        }
+        fprintf(out, ") {\n");
+
+        if (nodes[i].is_array) {
+            fprintf(out, "            p = %s_array_%d(s, p);\n", extractor, i);
+        } else if (field != NULL) {
+            write_store(out, field, "            ");
+        } else {
+            fprintf(out, "            p = %s_object_%d(s, p%s);\n", extractor, i, index_argument);
+        }
+        separator = "} else ";
+    }
+
+    fprintf(out, "        } else {\n");
+    fprintf(out, "            p = nx_json_scan_value_end(p, s->end);\n");
+    fprintf(out, "        }\n");
+    fprintf(out, "        if (p == NULL) return NULL;\n");
+    fprintf(out, "        p = %s_next(s, p, '}');\n", extractor);
+    fprintf(out, "        if (p == NULL) return NULL;\n");
+    fprintf(out, "    }\n");
+    fprintf(out, "    return p;\n");
+    fprintf(out, "}\n\n");
+}
+
+// Items of an array on the schema paths, up to the largest capacity below it
+void write_array(FILE *out, int node) {
+    char path[512];
+
+    node_path(node, path);
+    fprintf(out, "// Items of %s\n", path);
+    fprintf(out, "char *%s_array_%d(struct %s_state *s, char *p) {\n", extractor, node, extractor);
+    fprintf(out, "    int index = 0;\n");
+    fprintf(out, "    if (*p != '[') return nx_json_scan_value_end(p, s->end);\n");
+    fprintf(out, "    p++;\n");
+    fprintf(out, "    p += nx_json_scan_space(p, s->end);\n");
+    fprintf(out, "    while (s->missing > 0) {\n");
+    fprintf(out, "        if (p >= s->end) return NULL;\n");
+    fprintf(out, "        if (*p == ']') return p + 1;\n");
+    fprintf(out, "        if (*p == ',' || *p == '}') return NULL;\n");
+    fprintf(out, "        if (index < %d) {\n", nodes[node].capacity);
+    if (nodes[node].field >= 0) {
+        write_store(out, &fields[nodes[node].field], "            ");
+    } else {
+        fprintf(out, "            p = %s_object_%d(s, p, index);\n", extractor, node);
+    }
+    fprintf(out, "        } else {\n");
+    fprintf(out, "            p = nx_json_scan_value_end(p, s->end);\n");
+    fprintf(out, "        }\n");
+    fprintf(out, "        if (p == NULL) return NULL;\n");
+    fprintf(out, "        index++;\n");
+    fprintf(out, "        p = %s_next(s, p, ']');\n", extractor);
+    fprintf(out, "        if (p == NULL) return NULL;\n");
+    fprintf(out, "    }\n");
+    fprintf(out, "    return p;\n");
+    fprintf(out, "}\n\n");
+}
+
+// Functions of a node and everything below it, callees first so no prototypes are needed
+void write_node(FILE *out, int node) {
+    int i;
+
+    for (i = 1; i < node_count; i++) {
+        if (nodes[i].parent == node) write_node(out, i);
+    }
+    if (has_children(node)) write_object(out, node);
+    if (nodes[node].is_array) write_array(out, node);
+}
+
+void write_helpers(FILE *out) {
+    int i;
+
+    fprintf(out, "// Parser state shared by the generated functions\n");
+    fprintf(out, "struct %s_state {\n", extractor);
+    fprintf(out, "    struct %s *out;\n", extractor);
+    fprintf(out, "    char *end;\n");
+    fprintf(out, "    int missing;         // Fields not complete yet, the pass stops at 0\n");
+    fprintf(out, "    char *key;           // Key of the current member, not terminated\n");
+    fprintf(out, "    int key_length;\n");
+    fprintf(out, "    int stored;          // Whether the last value read was a number\n");
+    fprintf(out, "    double number;\n");
+    fprintf(out, "    NX_JSON_INT integer;\n");
+    for (i = 0; i < param_count; i++) {
+        fprintf(out, "    char *param_%s;\n", params[i]);
+        fprintf(out, "    int param_%s_length;\n", params[i]);
+    }
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "// Read the key of the member at p, returns the start of its value or NULL\n");
+    fprintf(out, "char *%s_key(struct %s_state *s, char *p) {\n", extractor, extractor);
+    fprintf(out, "    char *key_end;\n");
+    fprintf(out, "    if (*p != '\"') return NULL;\n");
+    fprintf(out, "    key_end = nx_json_scan_string_end(p, s->end);\n");
+    fprintf(out, "    if (key_end == NULL) return NULL;\n");
+    fprintf(out, "    s->key = p + 1;\n");
+    fprintf(out, "    s->key_length = key_end - p - 2;\n");
+    fprintf(out, "    p = key_end + nx_json_scan_space(key_end, s->end);\n");
+    fprintf(out, "    if (p >= s->end || *p != ':') return NULL;\n");
+    fprintf(out, "    p++;\n");
+    fprintf(out, "    p += nx_json_scan_space(p, s->end);\n");
+    fprintf(out, "    if (p >= s->end || *p == ',' || *p == '}' || *p == ']') return NULL;\n");
+    fprintf(out, "    return p;\n");
+    fprintf(out, "}\n\n");
+
+    fprintf(out, "// Skip the separator after a value, returns the next member or item, the\n");
+    fprintf(out, "// closing bracket, or NULL if neither follows. Once the pass stops the\n");
+    fprintf(out, "// rest of the text is not read.\n");
+    fprintf(out, "char *%s_next(struct %s_state *s, char *p, char close) {\n", extractor, extractor);
+    fprintf(out, "    if (s->missing == 0) return p;\n");
+    fprintf(out, "    p += nx_json_scan_space(p, s->end);\n");
+    fprintf(out, "    if (p >= s->end) return NULL;\n");
+    fprintf(out, "    if (*p == close) return p;\n");
+    fprintf(out, "    if (*p != ',') return NULL;\n");
+    fprintf(out, "    p++;\n");
+    fprintf(out, "    p += nx_json_scan_space(p, s->end);\n");
+    fprintf(out, "    if (p >= s->end || *p == close) return NULL;\n");
+    fprintf(out, "    return p;\n");
+    fprintf(out, "}\n\n");
+
+    fprintf(out, "// Read the value at p if it is a number, other values are skipped\n");
+    fprintf(out, "char *%s_number(struct %s_state *s, char *p) {\n", extractor, extractor);
+    fprintf(out, "    enum nx_json_type type;\n");
+    fprintf(out, "    s->stored = 0;\n");
+    fprintf(out, "    if (*p != '-' && (*p < '0' || *p > '9')) return nx_json_scan_value_end(p, s->end);\n");
+    fprintf(out, "    p = nx_json_scan_number(p, s->end, &type, &s->number, &s->integer);\n");
+    fprintf(out, "    if (p == NULL) return NULL;\n");
+    fprintf(out, "    if (type != NX_JSON_INTEGER) s->integer = (NX_JSON_INT)s->number;\n");
+    fprintf(out, "    s->stored = 1;\n");
+    fprintf(out, "    return p;\n");
+    fprintf(out, "}\n\n");
+}
+
+void write_extract(FILE *out) {
+    int i;
+
+    fprintf(out, "// Fill out from the JSON object in text, returns the number of fields found\n");
+    fprintf(out, "// or -1 if the text read before every field is complete is malformed\n");
+    fprintf(out, "int %s_extract(char *text, int length, struct %s *out", extractor, extractor);
+    for (i = 0; i < param_count; i++) {
+        fprintf(out, ", char *%s", params[i]);
+    }
+    fprintf(out, ") {\n");
+    fprintf(out, "    struct %s_state state;\n", extractor);
+    fprintf(out, "    char *p;\n");
+    fprintf(out, "    int found = 0;\n\n");
+
+    for (i = 0; i < field_count; i++) {
+        if (fields[i].capacity > 0) {
+            fprintf(out, "    memset(out->%s, 0, %d * sizeof(%s));\n", fields[i].name, fields[i].capacity, fields[i].type);
+            fprintf(out, "    out->%s_length = 0;\n", fields[i].name);
+        } else {
+            fprintf(out, "    out->%s = 0;\n", fields[i].name);
+            fprintf(out, "    out->%s_found = 0;\n", fields[i].name);
+        }
+    }
+    fprintf(out, "    if (text == NULL) return -1;\n\n");
+
+    fprintf(out, "    state.out = out;\n");
+    fprintf(out, "    state.end = text + length;\n");
+    fprintf(out, "    state.missing = %d;\n", field_count);
+    for (i = 0; i < param_count; i++) {
+        fprintf(out, "    state.param_%s = %s;\n", params[i], params[i]);
+        fprintf(out, "    state.param_%s_length = strlen(%s);\n", params[i], params[i]);
+    }
+    fprintf(out, "    p = text + nx_json_scan_space(text, state.end);\n");
+    fprintf(out, "    if (p >= state.end || *p != '{') return -1;\n");
+    fprintf(out, "    if (%s_object_0(&state, p) == NULL) return -1;\n\n", extractor);
+
+    for (i = 0; i < field_count; i++) {
+        if (fields[i].capacity > 0) {
+            fprintf(out, "    if (out->%s_length > 0) found++;\n", fields[i].name);
+        } else {
+            fprintf(out, "    if (out->%s_found) found++;\n", fields[i].name);
+        }
+    }
+    fprintf(out, "    return found;\n");
+    fprintf(out, "}\n");
+}
+
+// Store the number of the value node, the field and its index were picked by the value function
+void write_stream_store(FILE *out) {
+    char *value;
+    char *separator = "";
+    int i;
+
+    fprintf(out, "// Store the number just read into the field of the value\n");
+    fprintf(out, "void %s_stream_store(struct %s_stream *s) {\n", extractor, extractor);
+    for (i = 0; i < field_count; i++) {
+        value = "s->number";
+        if (strcmp(fields[i].type, "float") == 0) value = "(float)s->number";
+        if (strcmp(fields[i].type, "int") == 0) value = "(int)s->integer";
+
+        fprintf(out, "    %sif (s->value_node == %d) {\n", separator, fields[i].node);
+        if (fields[i].capacity > 0) {
+            fprintf(out, "        s->out->%s[s->value_index] = %s;\n", fields[i].name, value);
+            fprintf(out, "        s->out->%s_length = s->value_index + 1;\n", fields[i].name);
+            fprintf(out, "        if (s->value_index + 1 == %d) s->missing--;\n", fields[i].capacity);
+        } else {
+            fprintf(out, "        s->out->%s = %s;\n", fields[i].name, value);
+            fprintf(out, "        s->out->%s_found = 1;\n", fields[i].name);
+            fprintf(out, "        s->missing--;\n");
+        }
+        separator = "} else ";
+    }
+    fprintf(out, "    }\n");
+    fprintf(out, "}\n\n");
+}
+
+// What to do with the value that starts in the innermost open container
+void write_stream_value(FILE *out) {
+    struct field *field;
+    char *separator;
+    char *kind;
+    int node;
+    int i;
+
+    fprintf(out, "// Pick the node of the value starting in the innermost container, from the\n");
+    fprintf(out, "// key just read in objects or the item index in arrays\n");
+    fprintf(out, "void %s_stream_value(struct %s_stream *s) {\n", extractor, extractor);
+    fprintf(out, "    int node = s->node[s->depth - 1];\n");
+    fprintf(out, "    int index = s->index[s->depth - 1];\n");
+    fprintf(out, "    s->value_kind = NX_JSON_EXTRACT_SKIP;\n");
+    fprintf(out, "    s->value_node = -1;\n");
+    fprintf(out, "    s->value_index = index;\n");
+
+    fprintf(out, "    if (s->closing[s->depth - 1] == ']') {\n");
+    for (node = 1; node < node_count; node++) {
+        if (nodes[node].is_array == 0) continue;
+        kind = "NX_JSON_EXTRACT_OBJECT";
+        if (nodes[node].field >= 0) kind = "NX_JSON_EXTRACT_FIELD";
+        fprintf(out, "        if (node == %d && index < %d) {\n", node, nodes[node].capacity);
+        fprintf(out, "            s->value_kind = %s;\n", kind);
+        fprintf(out, "            s->value_node = %d;\n", node);
+        fprintf(out, "        }\n");
+    }
+    fprintf(out, "        return;\n");
+    fprintf(out, "    }\n");
+
+    for (node = 0; node < node_count; node++) {
+        if (has_children(node) == 0) continue;
+        fprintf(out, "    if (node == %d) {\n", node);
+        separator = "";
+        for (i = 1; i < node_count; i++) {
+            if (nodes[i].parent != node) continue;
+            field = NULL;
+            if (nodes[i].field >= 0) field = &fields[nodes[i].field];
+
+            fprintf(out, "        %sif (", separator);
+            write_key_match(out, i);
+            if (field != NULL && nodes[i].is_array == 0 && field->capacity > 0) {
+                fprintf(out, " && index < %d", field->capacity);
+            } else if (field != NULL && nodes[i].is_array == 0) {
+                fprintf(out, " && s->out->%s_found == 0", field->name);
+            }
+            fprintf(out, ") {\n");
+
+            kind = "NX_JSON_EXTRACT_OBJECT";
+            if (nodes[i].is_array) {
+                kind = "NX_JSON_EXTRACT_ARRAY";
+            } else if (field != NULL) {
+                kind = "NX_JSON_EXTRACT_FIELD";
+            }
+            fprintf(out, "            s->value_kind = %s;\n", kind);
+            fprintf(out, "            s->value_node = %d;\n", i);
+            separator = "} else ";
+        }
+        fprintf(out, "        }\n");
+        fprintf(out, "    }\n");
+    }
+    fprintf(out, "}\n\n");
+}
+
+void write_stream_helpers(FILE *out) {
+    fprintf(out, "// Append a byte of a field's number. Integer digits past the buffer scale the\n");
+    fprintf(out, "// number, fraction digits past it are dropped, the exponent has to fit.\n");
+    fprintf(out, "void %s_stream_token(struct %s_stream *s, char c) {\n", extractor, extractor);
+    fprintf(out, "    if (c == 'e' || c == 'E') s->part = 2;\n");
+    fprintf(out, "    if (s->token_length < 0) return;\n");
+    fprintf(out, "    if (s->part != 2 && s->token_length >= NX_JSON_STREAM_TOKEN_SIZE - 8) {\n");
+    fprintf(out, "        if (c == '.') s->part = 3;\n");
+    fprintf(out, "        if (c >= '0' && c <= '9' && s->part == 0) s->dropped++;\n");
+    fprintf(out, "        if (c >= '0' && c <= '9') return;\n");
+    fprintf(out, "        if (c == '.') return;\n");
+    fprintf(out, "    }\n");
+    fprintf(out, "    if (s->part == 3 && c >= '0' && c <= '9') return;\n");
+    fprintf(out, "    if (c == '.') s->part = 1;\n");
+    fprintf(out, "    if (s->token_length >= NX_JSON_STREAM_TOKEN_SIZE - 1) {\n");
+    fprintf(out, "        s->token_length = -1;\n");
+    fprintf(out, "        return;\n");
+    fprintf(out, "    }\n");
+    fprintf(out, "    s->token[s->token_length] = c;\n");
+    fprintf(out, "    s->token_length++;\n");
+    fprintf(out, "}\n\n");
+
+    fprintf(out, "// Read the buffered number into its field, returns -1 if it is malformed. A\n");
+    fprintf(out, "// number whose exponent does not fit is left out, like a value of another type.\n");
+    fprintf(out, "int %s_stream_number(struct %s_stream *s) {\n", extractor, extractor);
+    fprintf(out, "    enum nx_json_type type;\n");
+    fprintf(out, "    char *end;\n");
+    fprintf(out, "    if (s->token_length < 0) return 0;\n");
+    fprintf(out, "    end = nx_json_scan_number(s->token, s->token + s->token_length, &type, &s->number, &s->integer);\n");
+    fprintf(out, "    if (end != s->token + s->token_length) return -1;\n");
+    fprintf(out, "    if (type == NX_JSON_INTEGER) s->number = (double)s->integer;\n");
+    fprintf(out, "    if (s->dropped > 0) type = NX_JSON_DOUBLE;\n");
+    fprintf(out, "    while (s->dropped > 0) {\n");
+    fprintf(out, "        s->number = s->number * 10;\n");
+    fprintf(out, "        s->dropped--;\n");
+    fprintf(out, "    }\n");
+    fprintf(out, "    if (type != NX_JSON_INTEGER) s->integer = (NX_JSON_INT)s->number;\n");
+    fprintf(out, "    %s_stream_store(s);\n", extractor);
+    fprintf(out, "    return 0;\n");
+    fprintf(out, "}\n\n");
+
+    fprintf(out, "// A value is complete, the pass stops once every field is\n");
+    fprintf(out, "void %s_stream_end_value(struct %s_stream *s) {\n", extractor, extractor);
+    fprintf(out, "    if (s->closing[s->depth - 1] == ']') s->index[s->depth - 1]++;\n");
+    fprintf(out, "    s->state = NX_JSON_EXTRACT_COMMA_OR_END;\n");
+    fprintf(out, "    if (s->missing == 0) s->state = NX_JSON_EXTRACT_DONE;\n");
+    fprintf(out, "}\n\n");
+
+    fprintf(out, "// Close the innermost container, the document ends with the root object\n");
+    fprintf(out, "void %s_stream_close(struct %s_stream *s) {\n", extractor, extractor);
+    fprintf(out, "    s->depth--;\n");
+    fprintf(out, "    if (s->depth == 0) {\n");
+    fprintf(out, "        s->state = NX_JSON_EXTRACT_DONE;\n");
+    fprintf(out, "        return;\n");
+    fprintf(out, "    }\n");
+    fprintf(out, "    %s_stream_end_value(s);\n", extractor);
+    fprintf(out, "}\n\n");
+
+    fprintf(out, "// Open a container at the value, on the schema path if the bracket matches the node\n");
+    fprintf(out, "int %s_stream_open(struct %s_stream *s, char c) {\n", extractor, extractor);
+    fprintf(out, "    if (s->depth >= MAX_NESTING_DEPTH) return -1;\n");
+    fprintf(out, "    s->node[s->depth] = -1;\n");
+    fprintf(out, "    s->index[s->depth] = 0;\n");
+    fprintf(out, "    if (c == '{') {\n");
+    fprintf(out, "        if (s->value_kind == NX_JSON_EXTRACT_OBJECT) s->node[s->depth] = s->value_node;\n");
+    fprintf(out, "        s->index[s->depth] = s->value_index;\n");
+    fprintf(out, "        s->closing[s->depth] = '}';\n");
+    fprintf(out, "        s->state = NX_JSON_EXTRACT_KEY_OR_END;\n");
+    fprintf(out, "    } else {\n");
+    fprintf(out, "        if (s->value_kind == NX_JSON_EXTRACT_ARRAY) s->node[s->depth] = s->value_node;\n");
+    fprintf(out, "        s->closing[s->depth] = ']';\n");
+    fprintf(out, "        s->state = NX_JSON_EXTRACT_VALUE_OR_END;\n");
+    fprintf(out, "    }\n");
+    fprintf(out, "    s->depth++;\n");
+    fprintf(out, "    return 0;\n");
+    fprintf(out, "}\n\n");
+}
+
+void write_stream(FILE *out) {
+    int i;
+
+    write_stream_store(out);
+    write_stream_value(out);
+    write_stream_helpers(out);
+
+    fprintf(out, "// Start a pass over text that arrives in chunks, the parameters must stay\n");
+    fprintf(out, "// valid until the last chunk is fed\n");
+    fprintf(out, "void %s_begin(struct %s_stream *s, struct %s *out", extractor, extractor, extractor);
+    for (i = 0; i < param_count; i++) {
+        fprintf(out, ", char *%s", params[i]);
+    }
+    fprintf(out, ") {\n");
+    for (i = 0; i < field_count; i++) {
+        if (fields[i].capacity > 0) {
+            fprintf(out, "    memset(out->%s, 0, %d * sizeof(%s));\n", fields[i].name, fields[i].capacity, fields[i].type);
+            fprintf(out, "    out->%s_length = 0;\n", fields[i].name);
+        } else {
+            fprintf(out, "    out->%s = 0;\n", fields[i].name);
+            fprintf(out, "    out->%s_found = 0;\n", fields[i].name);
+        }
+    }
+    fprintf(out, "    s->out = out;\n");
+    fprintf(out, "    s->missing = %d;\n", field_count);
+    fprintf(out, "    s->state = NX_JSON_EXTRACT_ROOT;\n");
+    fprintf(out, "    s->depth = 0;\n");
+    fprintf(out, "    s->escape = 0;\n");
+    fprintf(out, "    s->key_length = 0;\n");
+    fprintf(out, "    s->token_length = 0;\n");
+    for (i = 0; i < param_count; i++) {
+        fprintf(out, "    s->param_%s = %s;\n", params[i], params[i]);
+        fprintf(out, "    s->param_%s_length = strlen(%s);\n", params[i], params[i]);
+    }
+    fprintf(out, "}\n\n");
+
+    fprintf(out, "// Feed the next chunk, returns 1 once the pass is over (the rest of the text is\n");
+    fprintf(out, "// not needed), 0 while it wants more text, or -1 if the text is malformed\n");
+    fprintf(out, "int %s_feed(struct %s_stream *s, char *text, int length) {\n", extractor, extractor);
+    fprintf(out, "    char *p = text;\n");
+    fprintf(out, "    char *end = text + length;\n");
+    fprintf(out, "    char c;\n\n");
+    fprintf(out, "    while (p < end && s->state < NX_JSON_EXTRACT_DONE) {\n");
+    fprintf(out, "        c = *p;\n");
+    fprintf(out, "        if (s->state == NX_JSON_EXTRACT_IN_STRING) {\n");
+    fprintf(out, "            if (s->escape) {\n");
+    fprintf(out, "                s->escape = 0;\n");
+    fprintf(out, "                p++;\n");
+    fprintf(out, "                continue;\n");
+    fprintf(out, "            }\n");
+    fprintf(out, "            p = nx_json_scan_quote(p, end);\n");
+    fprintf(out, "            if (p >= end) break;\n");
+    fprintf(out, "            if (*p == '\\\\') {\n");
+    fprintf(out, "                s->escape = 1;\n");
+    fprintf(out, "            } else {\n");
+    fprintf(out, "                %s_stream_end_value(s);\n", extractor);
+    fprintf(out, "            }\n");
+    fprintf(out, "            p++;\n");
+    fprintf(out, "            continue;\n");
+    fprintf(out, "        }\n");
+    fprintf(out, "        if (s->state == NX_JSON_EXTRACT_IN_KEY) {\n");
+    fprintf(out, "            if (s->escape == 0 && c == '\"') {\n");
+    fprintf(out, "                s->state = NX_JSON_EXTRACT_COLON;\n");
+    fprintf(out, "            } else if (s->key_length >= 0 && s->key_length < %d) {\n", stream_key_size());
+    fprintf(out, "                s->key[s->key_length] = c;\n");
+    fprintf(out, "                s->key_length++;\n");
+    fprintf(out, "            } else {\n");
+    fprintf(out, "                s->key_length = -1;\n");
+    fprintf(out, "            }\n");
+    fprintf(out, "            s->escape = s->escape == 0 && c == '\\\\';\n");
+    fprintf(out, "            p++;\n");
+    fprintf(out, "            continue;\n");
+    fprintf(out, "        }\n");
+    fprintf(out, "        if (s->state == NX_JSON_EXTRACT_IN_NUMBER || s->state == NX_JSON_EXTRACT_IN_SCALAR) {\n");
+    fprintf(out, "            if (c == ',' || c == '}' || c == ']' || c == ' ' || c == '\\t' || c == '\\n' || c == '\\r') {\n");
+    fprintf(out, "                // The delimiter is read again after the value\n");
+    fprintf(out, "                if (s->state == NX_JSON_EXTRACT_IN_NUMBER && %s_stream_number(s) < 0) break;\n", extractor);
+    fprintf(out, "                %s_stream_end_value(s);\n", extractor);
+    fprintf(out, "                continue;\n");
+    fprintf(out, "            }\n");
+    fprintf(out, "            if (s->state == NX_JSON_EXTRACT_IN_NUMBER) %s_stream_token(s, c);\n", extractor);
+    fprintf(out, "            p++;\n");
+    fprintf(out, "            continue;\n");
+    fprintf(out, "        }\n");
+    fprintf(out, "        if (c == ' ' || c == '\\t' || c == '\\n' || c == '\\r') {\n");
+    fprintf(out, "            p += nx_json_scan_space(p, end);\n");
+    fprintf(out, "            continue;\n");
+    fprintf(out, "        }\n");
+    fprintf(out, "        if (s->state == NX_JSON_EXTRACT_ROOT) {\n");
+    fprintf(out, "            if (c != '{') break;\n");
+    fprintf(out, "            s->value_kind = NX_JSON_EXTRACT_OBJECT;\n");
+    fprintf(out, "            s->value_node = 0;\n");
+    fprintf(out, "            s->value_index = 0;\n");
+    fprintf(out, "            %s_stream_open(s, c);\n", extractor);
+    fprintf(out, "        } else if (c == '}' && s->state == NX_JSON_EXTRACT_KEY_OR_END) {\n");
+    fprintf(out, "            %s_stream_close(s);\n", extractor);
+    fprintf(out, "        } else if (s->state == NX_JSON_EXTRACT_KEY_OR_END || s->state == NX_JSON_EXTRACT_KEY) {\n");
+    fprintf(out, "            if (c != '\"') break;\n");
+    fprintf(out, "            s->state = NX_JSON_EXTRACT_IN_KEY;\n");
+    fprintf(out, "            s->key_length = 0;\n");
+    fprintf(out, "            s->escape = 0;\n");
+    fprintf(out, "        } else if (s->state == NX_JSON_EXTRACT_COLON) {\n");
+    fprintf(out, "            if (c != ':') break;\n");
+    fprintf(out, "            s->state = NX_JSON_EXTRACT_VALUE;\n");
+    fprintf(out, "        } else if (c == ']' && s->state == NX_JSON_EXTRACT_VALUE_OR_END) {\n");
+    fprintf(out, "            %s_stream_close(s);\n", extractor);
+    fprintf(out, "        } else if (s->state == NX_JSON_EXTRACT_VALUE_OR_END || s->state == NX_JSON_EXTRACT_VALUE) {\n");
+    fprintf(out, "            if (c == ',' || c == ':' || c == '}' || c == ']') break;\n");
+    fprintf(out, "            %s_stream_value(s);\n", extractor);
+    fprintf(out, "            if (c == '{' || c == '[') {\n");
+    fprintf(out, "                if (%s_stream_open(s, c) < 0) break;\n", extractor);
+    fprintf(out, "            } else if (c == '\"') {\n");
+    fprintf(out, "                s->state = NX_JSON_EXTRACT_IN_STRING;\n");
+    fprintf(out, "                s->escape = 0;\n");
+    fprintf(out, "            } else if (s->value_kind == NX_JSON_EXTRACT_FIELD && (c == '-' || (c >= '0' && c <= '9'))) {\n");
+    fprintf(out, "                s->state = NX_JSON_EXTRACT_IN_NUMBER;\n");
+    fprintf(out, "                s->token_length = 0;\n");
+    fprintf(out, "                s->part = 0;\n");
+    fprintf(out, "                s->dropped = 0;\n");
+    fprintf(out, "                %s_stream_token(s, c);\n", extractor);
+    fprintf(out, "            } else {\n");
+    fprintf(out, "                s->state = NX_JSON_EXTRACT_IN_SCALAR;\n");
+    fprintf(out, "            }\n");
+    fprintf(out, "        } else if (c == ',') {\n");
+    fprintf(out, "            s->state = NX_JSON_EXTRACT_VALUE;\n");
+    fprintf(out, "            if (s->closing[s->depth - 1] == '}') s->state = NX_JSON_EXTRACT_KEY;\n");
+    fprintf(out, "        } else if (c == s->closing[s->depth - 1]) {\n");
+    fprintf(out, "            %s_stream_close(s);\n", extractor);
+    fprintf(out, "        } else {\n");
+    fprintf(out, "            break;\n");
+    fprintf(out, "        }\n");
+    fprintf(out, "        p++;\n");
+    fprintf(out, "    }\n\n");
+    fprintf(out, "    // The loop breaks early at the byte of an error\n");
+    fprintf(out, "    if (p < end && s->state < NX_JSON_EXTRACT_DONE) s->state = NX_JSON_EXTRACT_ERROR;\n");
+    fprintf(out, "    if (s->state == NX_JSON_EXTRACT_ERROR) return -1;\n");
+    fprintf(out, "    if (s->state == NX_JSON_EXTRACT_DONE) return 1;\n");
+    fprintf(out, "    return 0;\n");
+    fprintf(out, "}\n\n");
+
+    fprintf(out, "// End the pass, returns the number of fields found like %s_extract, or -1\n", extractor);
+    fprintf(out, "// if the text is malformed or ended before every field is complete\n");
+    fprintf(out, "int %s_finish(struct %s_stream *s) {\n", extractor, extractor);
+    fprintf(out, "    int found = 0;\n\n");
+    fprintf(out, "    if (s->state != NX_JSON_EXTRACT_DONE) return -1;\n");
+    for (i = 0; i < field_count; i++) {
+        if (fields[i].capacity > 0) {
+            fprintf(out, "    if (s->out->%s_length > 0) found++;\n", fields[i].name);
+        } else {
+            fprintf(out, "    if (s->out->%s_found) found++;\n", fields[i].name);
+        }
+    }
+    fprintf(out, "    return found;\n");
+    fprintf(out, "}\n");
+}
+
+void write_source(FILE *out, char *schema_name) {
+    fprintf(out, "// Generated by nx_json_codegen from %s, do not edit\n\n", schema_name);
+    fprintf(out, "// Check if we're using a standard C compiler\n");
+    fprintf(out, "#ifndef PICO_C\n");
+    fprintf(out, "#include <string.h>\n");
+    fprintf(out, "#include \"nx_json.h\"\n");
+    fprintf(out, "#include \"%s.h\"\n", extractor);
+    fprintf(out, "#endif\n\n");
+    write_helpers(out);
+    write_node(out, 0);
+    write_extract(out);
+    fprintf(out, "\n");
+    write_stream(out);
+}
+
+FILE *open_output(char *directory, char *extension) {
+    char path[1024];
+    FILE *file;
+
+    snprintf(path, sizeof(path), "%s/%s.%s", directory, extractor, extension);
+    file = fopen(path, "w");
+    if (file == NULL) {
+        perror(path);
+        exit(1);
+    }
+    return file;
+}
+
+int main(int argc, char *argv[]) {
+    char *schema_name;
+    FILE *out;
+
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <schema> <output directory>\n", argv[0]);
+        return 1;
+    }
+
+    schema_path = argv[1];
+    schema_name = strrchr(schema_path, '/');
+    if (schema_name == NULL) {
+        schema_name = schema_path;
+    } else {
+        schema_name++;
+    }
+    read_schema(schema_path);
+
+    out = open_output(argv[2], "h");
+    write_header(out, schema_name);
+    fclose(out);
+
+    out = open_output(argv[2], "c");
+    write_source(out, schema_name);
+    fclose(out);
+    return 0;
+}
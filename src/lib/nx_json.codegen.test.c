@@ -0,0 +1,252 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "nx_json.h"
+#include "samples.h"
+
+// Tests of the extractor generated from mocks/simple-json-samples.schema
+
+int test_count = 0;
+
+// Function to read the entire contents of a file into a string
+char* read_file(const char* filename) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        perror("Could not open file");
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *content = (char *)malloc(length + 1);
+    if (!content) {
+        perror("Could not allocate memory");
+        fclose(file);
+        return NULL;
+    }
+
+    size_t read_size = fread(content, 1, length, file);
+    content[read_size] = '\0';
+    fclose(file);
+
+    return content;
+}
+
+void test_generated_samples() {
+    printf("Testing the generated extractor with JSON samples...\n");
+
+    char *samples = read_file(MOCK_JSON_PATH);
+    assert(samples != NULL);
+
+    struct samples out;
+    assert(samples_extract(samples, strlen(samples), &out, "float") == 6);
+    assert(out.integer_found && out.integer == 42);
+    assert(out.value_found && out.value == 123.0f);
+    assert(out.named_found && out.named == 3.14159);
+    test_count += 4;
+
+    // Non-numeric values are skipped, boolean_true is not a number
+    assert(out.flag_found == 0 && out.flag == 0);
+    test_count += 1;
+
+    // Arrays keep at most their capacity
+    assert(out.items_length == 4);
+    assert(out.items[0] == 1.0 && out.items[3] == 4.0);
+    assert(out.ids_length == 2 && out.ids[0] == 1 && out.ids[1] == 2);
+    test_count += 3;
+
+    // Only the number item of the mixed array is stored, at its own index
+    assert(out.mixed_length == 2);
+    assert(out.mixed[0] == 0 && out.mixed[1] == 100.0);
+    test_count += 2;
+
+    // Values match nx_json_parse
+    struct nx_json *json = nx_json_parse(samples);
+    assert(json != NULL);
+    assert(out.named == nx_json_number(nx_json_get(nx_json_get(json, "scalar_values"), "float")));
+    test_count += 2;
+    nx_json_reset();
+
+    // The runtime key picks a different member
+    assert(samples_extract(samples, strlen(samples), &out, "missing") == 5);
+    assert(out.named_found == 0 && out.named == 0);
+    assert(out.integer == 42);
+    test_count += 3;
+
+    free(samples);
+    printf("Generated extractor sample tests completed\n\n");
+}
+
+void test_generated_early_stop() {
+    printf("Testing the generated extractor early stop...\n");
+
+    struct samples out;
+
+    // Every field complete, the rest of the text is never read
+    char text[] = "{\"scalar_values\":{\"integer\":1,\"boolean_true\":3,\"k\":4},"
+                  "\"simple_object\":{\"value\":5},\"simple_array\":[1,2,3,4,5],"
+                  "\"array_of_objects\":[{\"id\":1},{\"id\":2},{\"id\":3},{\"id\":4},{\"id\":5},{\"id\":6},{\"id\":7},{\"id\":8}],"
+                  "\"mixed_array\":[1,2,3,4,5,6,7,8,garbage";
+    assert(samples_extract(text, strlen(text), &out, "k") == 7);
+    assert(out.flag == 3 && out.named == 4.0);
+    assert(out.ids_length == 8 && out.ids[7] == 8);
+    assert(out.mixed_length == 8);
+    test_count += 4;
+
+    // Subtrees of other keys are skipped, brackets inside strings included
+    char skipped[] = "{\"other\":{\"integer\":7,\"s\":\"}]\\\"\"},\"scalar_values\":{\"integer\":-9}}";
+    assert(samples_extract(skipped, strlen(skipped), &out, "k") == 1);
+    assert(out.integer == -9);
+    test_count += 2;
+
+    printf("Generated extractor early stop tests completed\n\n");
+}
+
+void test_generated_errors() {
+    printf("Testing the generated extractor error handling...\n");
+
+    struct samples out;
+
+    assert(samples_extract(NULL, 0, &out, "k") == -1);
+    assert(samples_extract("", 0, &out, "k") == -1);
+    assert(samples_extract("[1]", 3, &out, "k") == -1);
+    assert(samples_extract("{\"scalar_values\":{\"integer\":1", 29, &out, "k") == -1);
+    assert(samples_extract("{\"scalar_values\" 1}", 19, &out, "k") == -1);
+    assert(samples_extract("{\"scalar_values\":{\"integer\":1.e5}}", 34, &out, "k") == -1);
+    assert(samples_extract("{\"simple_array\":[1,\"open]}", 26, &out, "k") == -1);
+    test_count += 7;
+
+    // Members and items need a comma between them and a matching closing bracket
+    assert(samples_extract("{\"a\":1 \"b\":2}", 13, &out, "k") == -1);
+    assert(samples_extract("{\"a\":1,}", 8, &out, "k") == -1);
+    assert(samples_extract("{\"a\":}", 6, &out, "k") == -1);
+    assert(samples_extract("{\"simple_array\":[1 2]}", 22, &out, "k") == -1);
+    assert(samples_extract("{\"simple_array\":[1,]}", 21, &out, "k") == -1);
+    assert(samples_extract("{\"simple_array\":[,1]}", 21, &out, "k") == -1);
+    assert(samples_extract("{\"simple_array\":[1}}", 20, &out, "k") == -1);
+    assert(samples_extract("{\"scalar_values\":{\"integer\":1]}", 31, &out, "k") == -1);
+    test_count += 8;
+
+    // Containers of the wrong type are skipped
+    assert(samples_extract("{\"simple_array\":{\"a\":1},\"scalar_values\":[1]}", 44, &out, "k") == 0);
+    test_count += 1;
+
+    printf("Generated extractor error handling tests completed\n\n");
+}
+
+// Stream text through the extractor in chunks of the given size, each chunk in
+// a buffer of its own. Returns samples_finish, or -1 once a chunk is malformed.
+int stream_samples(char* text, int length, int chunk, struct samples* out, char* key) {
+    struct samples_stream stream;
+    char* copy;
+    int offset;
+    int n;
+    int result = 0;
+
+    samples_begin(&stream, out, key);
+    for (offset = 0; offset < length && result == 0; offset += chunk) {
+        n = length - offset < chunk ? length - offset : chunk;
+        copy = (char*)malloc(n);
+        memcpy(copy, text + offset, n);
+        result = samples_feed(&stream, copy, n);
+        free(copy);
+    }
+    if (result < 0) return -1;
+    return samples_finish(&stream);
+}
+
+void test_generated_stream() {
+    printf("Testing the generated extractor stream...\n");
+
+    struct samples whole;
+    struct samples streamed;
+    char *samples = read_file(MOCK_JSON_PATH);
+    int length;
+    int chunk;
+    int i;
+    assert(samples != NULL);
+    length = strlen(samples);
+
+    // Any chunking gives what one pass over the whole text gives
+    for (chunk = 1; chunk <= length; chunk++) {
+        memset(&whole, 0, sizeof(whole));
+        memset(&streamed, 0, sizeof(streamed));
+        assert(samples_extract(samples, length, &whole, "float") == 6);
+        assert(stream_samples(samples, length, chunk, &streamed, "float") == 6);
+        assert(memcmp(&whole, &streamed, sizeof(whole)) == 0);
+        assert(stream_samples(samples, length, chunk, &streamed, "missing") == 5);
+        assert(streamed.named_found == 0 && streamed.integer == 42);
+    }
+    test_count += 5;
+    free(samples);
+
+    // The pass ends once every field is complete, the rest is not read
+    char text[] = "{\"scalar_values\":{\"integer\":1,\"boolean_true\":3,\"k\":4},"
+                  "\"simple_object\":{\"value\":5},\"simple_array\":[1,2,3,4,5],"
+                  "\"array_of_objects\":[{\"id\":1},{\"id\":2},{\"id\":3},{\"id\":4},{\"id\":5},{\"id\":6},{\"id\":7},{\"id\":8}],"
+                  "\"mixed_array\":[1,2,3,4,5,6,7,8,garbage";
+    for (chunk = 1; chunk < 16; chunk++) {
+        assert(stream_samples(text, strlen(text), chunk, &streamed, "k") == 7);
+        assert(streamed.flag == 3 && streamed.named == 4.0 && streamed.ids[7] == 8);
+    }
+    test_count += 2;
+
+    // Keys, strings and numbers split anywhere, escapes included
+    char split[] = "{\"other\":{\"integer\":7,\"s\":\"}]\\\"\"},\"scalar_\\\"values\":1,"
+                   "\"scalar_values\":{\"integer\":-9,\"k\":-1.5e-3}}";
+    for (chunk = 1; chunk < 8; chunk++) {
+        assert(stream_samples(split, strlen(split), chunk, &streamed, "k") == 2);
+        assert(streamed.integer == -9 && streamed.named == -1.5e-3);
+    }
+    test_count += 2;
+
+    // Numbers longer than the token keep their leading digits
+    char long_numbers[] = "{\"scalar_values\":{\"k\":3.14159265358979323846264338327950288419716939937510,"
+                          "\"integer\":123456789012345678901234567890}}";
+    for (chunk = 1; chunk < 8; chunk++) {
+        assert(stream_samples(long_numbers, strlen(long_numbers), chunk, &streamed, "k") == 2);
+        assert(streamed.named == 3.14159265358979323846);
+    }
+    memset(&streamed, 0, sizeof(streamed));
+    struct samples_stream stream;
+    char big[] = "{\"scalar_values\":{\"k\":123456789012345678901234567890.5e-10}}";
+    samples_begin(&stream, &streamed, "k");
+    assert(samples_feed(&stream, big, strlen(big)) == 1);
+    assert(samples_finish(&stream) == 1);
+    assert(streamed.named / 12345678901234567890.12345678905 - 1 < 1e-15);
+    assert(1 - streamed.named / 12345678901234567890.12345678905 < 1e-15);
+    test_count += 3;
+
+    // Malformed text fails in any chunking, wrong containers are skipped
+    char *errors[] = {"", "[1]", "{\"scalar_values\":{\"integer\":1", "{\"scalar_values\" 1}",
+                      "{\"scalar_values\":{\"integer\":1.e5}}", "{\"simple_array\":[1,\"open]}",
+                      "{\"a\":1 \"b\":2}", "{\"a\":1,}", "{\"a\":}", "{\"simple_array\":[1 2]}",
+                      "{\"simple_array\":[1,]}", "{\"simple_array\":[,1]}", "{\"simple_array\":[1}}",
+                      "{\"scalar_values\":{\"integer\":1]}", "{\"a\":[[[[[[[[[[1]]]]]]]]]]}"};
+    for (i = 0; i < (int)(sizeof(errors) / sizeof(errors[0])); i++) {
+        for (chunk = 1; chunk <= 4; chunk++) {
+            assert(stream_samples(errors[i], strlen(errors[i]), chunk, &streamed, "k") == -1);
+        }
+    }
+    test_count += 15;
+    char *skipped = "{\"simple_array\":{\"a\":1},\"scalar_values\":[1]}";
+    assert(stream_samples(skipped, strlen(skipped), 3, &streamed, "k") == 0);
+    test_count += 1;
+
+    printf("Generated extractor stream tests completed\n\n");
+}
+
+int main() {
+    printf("Starting generated extractor tests...\n\n");
+
+    test_generated_samples();
+    test_generated_early_stop();
+    test_generated_errors();
+    test_generated_stream();
+
+    printf("\nAll tests passed! (%d assertions)\n", test_count);
+    return 0;
+}
@@ -0,0 +1,189 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Corpus generator for bench_nx_json: forecast.solar-shaped documents from
+// 1 KB to 10 MB in three shapes, written to the given directory together with
+// corpus.txt listing one "file shape size" line per document.
+//
+//   daily     result.<date> watt hours per day, pretty-printed, many flat keys
+//   estimate  result.watts/watt_hours_period/watt_hours.<timestamp> series, one line
+//   mixed     like estimate with fractional, exponent and negative numbers and
+//             deeper message nesting, tab indented
+//
+// Every document ends its result object with the 2025-02-27 and 2025-02-28
+// day totals, so parseDailyProduction has to get through all of it.
+
+#define TODAY "2025-02-27"
+#define TOMORROW "2025-02-28"
+
+unsigned int seed = 1;
+
+// Deterministic pseudo random numbers, the corpus must not change between runs
+int next_random(int range) {
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 8) % range;
+}
+
+// Write one number in the format of the shape
+int put_number(char *p, int mixed) {
+    if (mixed == 0) {
+        return sprintf(p, "%d", next_random(5000000));
+    }
+    switch (next_random(4)) {
+        case 0: return sprintf(p, "%d.%03d", next_random(5000), next_random(1000));
+        case 1: return sprintf(p, "%de%d", next_random(9) + 1, next_random(7));
+        case 2: return sprintf(p, "-%d.%de-%d", next_random(100), next_random(100), next_random(4));
+        default: return sprintf(p, "%d", next_random(5000000));
+    }
+}
+
+// Timestamp key for the n-th 15 minute slot, rolling over months and years
+int put_timestamp(char *p, int n) {
+    int day = n / 96;
+    return sprintf(p, "\"%04d-%02d-%02d %02d:%02d:00\"", 2020 + day / 336, 1 + (day / 28) % 12, 1 + day % 28,
+                   (n / 4) % 24, (n % 4) * 15);
+}
+
+// Newline and indentation for the given level, nothing for one-line documents
+int put_indent(char *p, char *indent, int level) {
+    int length = 0;
+    int i;
+    if (indent == NULL) return 0;
+    p[length++] = '\n';
+    for (i = 0; i < level; i++) {
+        length += sprintf(p + length, "%s", indent);
+    }
+    return length;
+}
+
+// Message object shaped like the forecast.solar one, nested deeper for mixed
+int put_message(char *p, char *indent, int mixed) {
+    char *start = p;
+    p += sprintf(p, "\"message\":{");
+    p += put_indent(p, indent, 2);
+    p += sprintf(p, "\"code\":0,\"type\":\"success\",\"text\":\"\",\"pid\":\"i6bY1h23\",");
+    p += put_indent(p, indent, 2);
+    p += sprintf(p, "\"info\":{\"latitude\":50.692,\"longitude\":15.2204,\"distance\":0,"
+                    "\"place\":\"76, 468 21 Kr\\u00e1sn\\u00e1, Czechia\",\"timezone\":\"Europe/Prague\"");
+    if (mixed) {
+        p += sprintf(p, ",\"planes\":[{\"declination\":35,\"azimuth\":-90,\"kwp\":5.5,\"horizon\":[0,5,10,[1,2,{\"x\":[3]}]]},"
+                        "{\"declination\":35,\"azimuth\":90,\"kwp\":4.25e0,\"horizon\":[]}]");
+    }
+    p += sprintf(p, "},");
+    p += put_indent(p, indent, 2);
+    p += sprintf(p, "\"ratelimit\":{\"zone\":\"IP 94.127.131.198\",\"period\":3600,\"limit\":12,\"remaining\":11}");
+    p += put_indent(p, indent, 1);
+    p += sprintf(p, "}");
+    return p - start;
+}
+
+// One series object of timestamp keys, filled until the document reaches its budget
+int put_series(char *p, char *name, char *indent, int mixed, int budget) {
+    char *start = p;
+    int n = 0;
+    p += sprintf(p, "\"%s\":{", name);
+    while (p - start < budget) {
+        if (n > 0) *p++ = ',';
+        p += put_indent(p, indent, 3);
+        p += put_timestamp(p, n);
+        *p++ = ':';
+        p += put_number(p, mixed);
+        n++;
+    }
+    p += put_indent(p, indent, 2);
+    p += sprintf(p, "},");
+    return p - start;
+}
+
+// Generate one document of roughly size bytes into out
+int generate(char *out, char *shape, int size) {
+    char *p = out;
+    char *indent = "    ";
+    int mixed = strcmp(shape, "mixed") == 0;
+    int budget = size - 600;  // Room for the message and day totals
+    int n = 0;
+
+    if (budget < 0) budget = 0;
+    if (strcmp(shape, "estimate") == 0) indent = NULL;
+    if (mixed) indent = "\t";
+
+    p += sprintf(p, "{");
+    p += put_indent(p, indent, 1);
+    p += sprintf(p, "\"result\":{");
+
+    if (strcmp(shape, "daily") == 0) {
+        while (p - out < budget) {
+            p += put_indent(p, indent, 2);
+            p += sprintf(p, "\"%04d-%02d-%02d\":", 2100 + n / 336, 1 + (n / 28) % 12, 1 + n % 28);
+            p += put_number(p, mixed);
+            *p++ = ',';
+            n++;
+        }
+    } else {
+        p += put_indent(p, indent, 2);
+        p += put_series(p, "watts", indent, mixed, budget / 3);
+        p += put_indent(p, indent, 2);
+        p += put_series(p, "watt_hours_period", indent, mixed, budget / 3);
+        p += put_indent(p, indent, 2);
+        p += put_series(p, "watt_hours", indent, mixed, budget - (p - out));
+    }
+
+    p += put_indent(p, indent, 2);
+    p += sprintf(p, "\"%s\":4674362,", TODAY);
+    p += put_indent(p, indent, 2);
+    p += sprintf(p, "\"%s\":4774208", TOMORROW);
+    p += put_indent(p, indent, 1);
+    p += sprintf(p, "},");
+    p += put_indent(p, indent, 1);
+    p += put_message(p, indent, mixed);
+    p += put_indent(p, indent, 0);
+    p += sprintf(p, "}\n");
+    return p - out;
+}
+
+int main(int argc, char *argv[]) {
+    char *shapes[] = {"daily", "estimate", "mixed"};
+    int sizes[] = {1024, 16384, 262144, 1048576, 10485760};
+    char path[1024];
+    char *out;
+    FILE *index;
+    FILE *file;
+    int length;
+    int s;
+    int i;
+
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <output directory>\n", argv[0]);
+        return 1;
+    }
+
+    snprintf(path, sizeof(path), "%s/corpus.txt", argv[1]);
+    index = fopen(path, "w");
+    if (index == NULL) {
+        perror("Could not create corpus index");
+        return 1;
+    }
+
+    out = (char *)malloc(sizes[4] + 4096);
+    for (s = 0; s < 3; s++) {
+        for (i = 0; i < 5; i++) {
+            seed = 1 + s * 5 + i;
+            length = generate(out, shapes[s], sizes[i]);
+
+            snprintf(path, sizeof(path), "%s/forecast_%s_%d.json", argv[1], shapes[s], sizes[i]);
+            file = fopen(path, "wb");
+            if (file == NULL) {
+                perror("Could not create corpus file");
+                return 1;
+            }
+            fwrite(out, 1, length, file);
+            fclose(file);
+            fprintf(index, "%s %s %d\n", path, shapes[s], sizes[i]);
+        }
+    }
+
+    fclose(index);
+    free(out);
+    return 0;
+}
@@ -20,31 +20,332 @@ enum nx_json_type {
     NX_JSON_ROOT
 };
 
-// Define the JSON node structure
+// Exact integer values, PicoC has no long long so it keeps 9 digits
+#ifdef PICO_C
+#define NX_JSON_INT long
+#define NX_JSON_INT_DIGITS 9
+#define NX_JSON_EXACT_MANTISSA 999999999
+#else
+#define NX_JSON_INT long long
+#define NX_JSON_INT_DIGITS 18
+#define NX_JSON_EXACT_MANTISSA ((long long)1 << 53)  // 2^53
+#endif
+
+// Define the JSON node structure.
+// key_length and text_length are always set, in NX_JSON_SLICE mode the strings are not NUL-terminated.
+// Integers only keep int_value, nx_json_number reads any numeric node as a double.
 struct nx_json {
     enum nx_json_type type;
+    int key_length;
     char *key;
+    int text_length;
     union json_value {
         char *text_value;
-        double number_value;
+        double number_value;     // NX_JSON_DOUBLE, and 0 or 1 for NX_JSON_BOOL
+        NX_JSON_INT int_value;   // NX_JSON_INTEGER
         struct children_value {
             int length;
+            int index_size;
             struct nx_json *first;
             struct nx_json *last;
+            struct nx_json **index;  // NX_JSON_INDEX: array items in order, or object key hash table
         } children;
     } u;
     struct nx_json *next;
 };
 
-// Function prototypes
+// Maximum nesting depth for objects and arrays, may be overridden before including this header
+#ifndef MAX_NESTING_DEPTH
+#define MAX_NESTING_DEPTH 10
+#endif
+
+// Default arena growth, in nodes and string bytes per block
+#ifndef NX_JSON_NODE_CHUNK
+#define NX_JSON_NODE_CHUNK 32
+#endif
+#ifndef NX_JSON_STRING_CHUNK
+#define NX_JSON_STRING_CHUNK 512
+#endif
+#ifndef NX_JSON_SLOT_CHUNK
+#define NX_JSON_SLOT_CHUNK 128
+#endif
+
+// String modes of a parse context, combined in nx_json_ctx.flags
+#define NX_JSON_INSITU 1    // Keys and strings are NUL-terminated inside the (mutable) input
+#define NX_JSON_SLICE 2     // Keys and strings are (pointer, length) slices of the input
+#define NX_JSON_UNESCAPE 4  // Decode escape sequences while parsing
+#define NX_JSON_INDEX 8     // Index array items and object keys for constant time lookups
+
+// Objects with fewer keys are not hashed, a linear scan is faster
+#ifndef NX_JSON_INDEX_MIN_KEYS
+#define NX_JSON_INDEX_MIN_KEYS 24
+#endif
+
+// Maximum length of a number or keyword token in the streaming parser
+#define NX_JSON_STREAM_TOKEN_SIZE 32
+
+// Block of nodes, blocks are chained so nodes never move when the arena grows
+struct nx_json_node_block {
+    struct nx_json *nodes;
+    int capacity;
+    int used;
+    int owned;           // Allocated by the context, released by nx_json_ctx_free
+    struct nx_json_node_block *next;
+};
+
+// Block of keys and string values
+struct nx_json_string_block {
+    char *text;
+    int capacity;
+    int used;
+    int owned;           // Allocated by the context, released by nx_json_ctx_free
+    struct nx_json_string_block *next;
+};
+
+// Block of index slots, each index table is contiguous within one block
+struct nx_json_slot_block {
+    struct nx_json **slots;
+    int capacity;
+    int used;
+    struct nx_json_slot_block *next;
+};
+
+// Error codes of a failed parse, formatted only on request by nx_json_format_error
+enum nx_json_error {
+    NX_JSON_OK,
+    NX_JSON_ERROR_NOT_OBJECT,          // Document does not start with '{'
+    NX_JSON_ERROR_UNEXPECTED_END,
+    NX_JSON_ERROR_EXPECTED_KEY,
+    NX_JSON_ERROR_EXPECTED_COLON,
+    NX_JSON_ERROR_EXPECTED_SEPARATOR,  // ',' or the closing bracket
+    NX_JSON_ERROR_MISMATCHED_BRACKET,
+    NX_JSON_ERROR_UNEXPECTED_CHARACTER,
+    NX_JSON_ERROR_UNTERMINATED_STRING,
+    NX_JSON_ERROR_INVALID_NUMBER,
+    NX_JSON_ERROR_TOO_DEEP,            // More than MAX_NESTING_DEPTH levels
+    NX_JSON_ERROR_NODES_FULL,
+    NX_JSON_ERROR_STRINGS_FULL,
+    NX_JSON_ERROR_TRAILING_DATA
+};
+
+// Buffer size for nx_json_format_error
+#define NX_JSON_ERROR_SIZE 80
+
+// Statistics of the last parse into a context, filled on success and failure.
+// The capacities show how far node_chunk/string_chunk or the caller buffers can shrink.
+struct nx_json_stats {
+    int bytes;           // Input bytes consumed, up to the error on failure
+    int nodes;           // Nodes used
+    int node_capacity;   // Nodes available in the node blocks
+    int string_bytes;    // String arena bytes used
+    int string_capacity; // String arena bytes available
+    int max_depth;       // Deepest nesting reached, the root object is 1
+    int time_us;         // Parse time, whole seconds resolution on PicoC
+};
+
+// Parse context owning the arenas of one document
+struct nx_json_ctx {
+    struct nx_json_node_block *nodes;           // First node block
+    struct nx_json_node_block *node_block;      // Block currently being filled
+    struct nx_json_string_block *strings;       // First string block
+    struct nx_json_string_block *string_block;  // Block currently being filled
+    struct nx_json_slot_block *slots;           // First index slot block
+    struct nx_json_slot_block *slot_block;      // Block currently being filled
+    struct nx_json_node_block caller_nodes;     // Caller supplied node buffer, if any
+    struct nx_json_string_block caller_strings; // Caller supplied string buffer, if any
+    int flags;           // NX_JSON_INSITU, NX_JSON_SLICE, NX_JSON_UNESCAPE
+    int node_chunk;      // Nodes per block allocated on demand, 0 disables growth
+    int string_chunk;    // Bytes per block allocated on demand, 0 disables growth
+    int slot_chunk;      // Index slots per block allocated on demand
+    struct nx_json *parent_stack[MAX_NESTING_DEPTH];  // Open objects and arrays
+    int stack_depth;
+    char *input;         // Start of the document being parsed, for error offsets
+    enum nx_json_error error;  // Error of the last parse, NX_JSON_OK on success
+    int error_offset;    // Byte offset of the error in the input
+    struct nx_json_stats stats;
+};
+
+// Incremental parser state, kept between nx_json_stream_feed calls
+struct nx_json_stream {
+    int expect;          // What the grammar expects next
+    int lexer;           // Token currently being scanned
+    struct nx_json_ctx *ctx;  // Context receiving the nodes and strings
+    int escape;          // Previous string byte was a backslash
+    int error;           // Set once the stream hit an error
+    int offset;          // Bytes consumed so far, used as the error offset
+    char *key;           // Key waiting for its value
+    int key_length;
+    char *text;          // String being collected in the string arena
+    int text_length;
+    char token[NX_JSON_STREAM_TOKEN_SIZE];  // Number or keyword being collected
+    int token_length;
+    struct nx_json *root;
+};
+
+// Parse context, pass NULL/0 buffers to have the arenas allocated lazily
+void nx_json_ctx_init(struct nx_json_ctx *ctx, struct nx_json *nodes, int node_count, char *strings, int string_size);
+struct nx_json *nx_json_ctx_parse(struct nx_json_ctx *ctx, char *text);
+struct nx_json *nx_json_ctx_parse_length(struct nx_json_ctx *ctx, char *text, int length);
+void nx_json_ctx_reset(struct nx_json_ctx *ctx);
+void nx_json_ctx_free(struct nx_json_ctx *ctx);
+
+// Error of the last parse as "NXJSON ERROR: <text> at byte <offset>", buffer holds NX_JSON_ERROR_SIZE bytes
+char *nx_json_format_error(struct nx_json_ctx *ctx, char *buffer);
+char *nx_json_error_text(enum nx_json_error error);
+
+// Function prototypes, nx_json_parse uses a shared default context released by nx_json_reset
+struct nx_json_ctx *nx_json_default();
 struct nx_json *nx_json_parse(char *text);
 struct nx_json *nx_json_get(struct nx_json *json, char *key);
 struct nx_json *nx_json_item(struct nx_json *json, int idx);
+double nx_json_number(struct nx_json *json);
 void nx_json_dealloc(struct nx_json* js);
 void nx_json_reset();
 
-// Error reporting function
-void nx_json_report_error(char *msg, char *p);
+// Decode escape sequences of a raw string in place, returns the decoded length
+int nx_json_unescape(char *text, int length);
+
+// Streaming parser, fed with chunks of any size (e.g. from stream_read).
+// Chunks are transient, so strings are always copied to the context arena.
+// It still builds the whole tree in the context, so memory grows with the
+// document, not the chunk. It is a host-only API: nx_json.c is not bundled,
+// pv-production-prediction feeds each body to the streams of its generated
+// extractors instead, which keep no more than a key and a number.
+void nx_json_stream_init(struct nx_json_stream *stream, struct nx_json_ctx *ctx);
+int nx_json_stream_feed(struct nx_json_stream *stream, char *chunk, int length);
+struct nx_json *nx_json_stream_finish(struct nx_json_stream *stream);
+
+// Scanning kernels (nx_json_scan.c), wide on the host (nx_json_scan_wide.c)
+int nx_json_scan_space(char *p, char *end);
+char *nx_json_scan_quote(char *p, char *end);
+char *nx_json_scan_structural(char *p, char *end);
+char *nx_json_scan_number(char *p, char *end, enum nx_json_type *type, double *number, NX_JSON_INT *integer);
+char *nx_json_scan_string_end(char *p, char *end);
+char *nx_json_scan_value_end(char *p, char *end);
+
+// States of the streams of generated extractors (nx_json.codegen.c)
+#define NX_JSON_EXTRACT_ROOT 0          // Before the opening brace of the document
+#define NX_JSON_EXTRACT_KEY_OR_END 1
+#define NX_JSON_EXTRACT_KEY 2
+#define NX_JSON_EXTRACT_IN_KEY 3
+#define NX_JSON_EXTRACT_COLON 4
+#define NX_JSON_EXTRACT_VALUE_OR_END 5
+#define NX_JSON_EXTRACT_VALUE 6
+#define NX_JSON_EXTRACT_IN_STRING 7
+#define NX_JSON_EXTRACT_IN_NUMBER 8     // Number of a field, buffered
+#define NX_JSON_EXTRACT_IN_SCALAR 9     // Any other scalar, skipped
+#define NX_JSON_EXTRACT_COMMA_OR_END 10
+#define NX_JSON_EXTRACT_DONE 11         // Every field complete or the document closed
+#define NX_JSON_EXTRACT_ERROR 12
+
+// What a generated extractor does with the value it is reading
+#define NX_JSON_EXTRACT_SKIP 0
+#define NX_JSON_EXTRACT_FIELD 1
+#define NX_JSON_EXTRACT_OBJECT 2
+#define NX_JSON_EXTRACT_ARRAY 3
+
+// Selective extraction (nx_json_query.c), fills scalar values at the given
+// paths straight from the text without building nodes
+#ifndef NX_JSON_QUERY_MAX_DEPTH
+#define NX_JSON_QUERY_MAX_DEPTH 6
+#endif
+
+struct nx_json_query {
+    char *path[NX_JSON_QUERY_MAX_DEPTH];  // Keys from the root, e.g. "result", "2025-02-27"
+    int path_length[NX_JSON_QUERY_MAX_DEPTH];
+    int index[NX_JSON_QUERY_MAX_DEPTH];   // Array index for numeric keys, -1 otherwise
+    int depth;
+    int matched;         // Path elements matched by the containers currently open
+    int found;
+    enum nx_json_type type;
+    double number_value;  // Integer, double and bool values
+    NX_JSON_INT int_value;  // Exact integer values
+    char *text_value;     // String values, raw slice of the input (not terminated)
+    int text_length;
+};
+
+void nx_json_query_init(struct nx_json_query *query);
+void nx_json_query_key(struct nx_json_query *query, char *key);
+int nx_json_extract(char *text, int length, struct nx_json_query *queries, int count);
+
+// Tape DOM (nx_json_tape.c): the document as one array of entries in document
+// order. A container is followed by its children and records the index after
+// its last descendant, so siblings and skipped subtrees are index arithmetic.
+// Keys and strings are offsets of raw slices into the input, which must stay
+// valid while the tape is used. Escape sequences are not decoded.
+#ifndef NX_JSON_TAPE_CHUNK
+#define NX_JSON_TAPE_CHUNK 64
+#endif
+
+struct nx_json_tape_entry {
+    enum nx_json_type type;  // NX_JSON_ROOT for the first entry
+    int key;             // Offset of the key in the input, -1 for array items and the root
+    int key_length;
+    int length;          // String length, or number of children of a container
+    union nx_json_tape_value {
+        double number_value;     // NX_JSON_DOUBLE, and 0 or 1 for NX_JSON_BOOL
+        NX_JSON_INT int_value;   // NX_JSON_INTEGER
+        int text;                // NX_JSON_STRING: offset of the text in the input
+        int end;                 // Containers: index of the entry after the last descendant
+    } u;
+};
+
+struct nx_json_tape {
+    struct nx_json_tape_entry *entries;
+    int count;
+    int capacity;
+    int owned;           // Entries allocated by the tape, doubled when full
+    char *input;         // Document the offsets point into
+    enum nx_json_error error;  // Error of the last parse, NX_JSON_OK on success
+    int error_offset;
+};
+
+// Pass NULL/0 to have the entries allocated and grown on demand
+void nx_json_tape_init(struct nx_json_tape *tape, struct nx_json_tape_entry *entries, int capacity);
+struct nx_json_tape_entry *nx_json_tape_parse(struct nx_json_tape *tape, char *text, int length);
+void nx_json_tape_free(struct nx_json_tape *tape);
+
+// Lookups with the semantics of nx_json_get and nx_json_item
+struct nx_json_tape_entry *nx_json_tape_get(struct nx_json_tape *tape, struct nx_json_tape_entry *json, char *key);
+struct nx_json_tape_entry *nx_json_tape_item(struct nx_json_tape *tape, struct nx_json_tape_entry *json, int idx);
+struct nx_json_tape_entry *nx_json_tape_next(struct nx_json_tape *tape, struct nx_json_tape_entry *entry);
+double nx_json_tape_number(struct nx_json_tape_entry *entry);
+
+// JSON writer (nx_json_writer.c) into a caller buffer, nothing is allocated.
+// Every append is all or nothing: a value that does not fit is dropped and
+// sets overflow. Closing brackets are reserved when a container opens, so
+// the open containers can always be closed into valid JSON. Top-level values
+// after the first start on a new line, one record per line.
+#define NX_JSON_WRITE_MAX_DECIMALS 9
+
+struct nx_json_writer {
+    char *buffer;
+    int size;            // Buffer size, the text is always NUL-terminated
+    int length;
+    int overflow;        // Set when an append did not fit
+    int full;            // The append in progress ran out of room
+    int depth;           // Open containers
+    char closer[MAX_NESTING_DEPTH + 1];  // '}' or ']' per open container
+    int count[MAX_NESTING_DEPTH + 1];    // Values written per level, 0 is the top level
+    int mark_length;     // State saved by nx_json_writer_mark
+    int mark_depth;
+    int mark_count;
+};
+
+void nx_json_writer_init(struct nx_json_writer *writer, char *buffer, int size);
+void nx_json_writer_mark(struct nx_json_writer *writer);
+void nx_json_writer_rollback(struct nx_json_writer *writer);
+
+// Keys are required inside objects and must be NULL elsewhere. Returns 0, or -1 if
+// the value did not fit or is misplaced.
+int nx_json_write_object(struct nx_json_writer *writer, char *key);
+int nx_json_write_array(struct nx_json_writer *writer, char *key);
+int nx_json_write_end(struct nx_json_writer *writer);
+int nx_json_write_string(struct nx_json_writer *writer, char *key, char *text);
+int nx_json_write_int(struct nx_json_writer *writer, char *key, NX_JSON_INT value);
+int nx_json_write_double(struct nx_json_writer *writer, char *key, double value, int decimals);
+int nx_json_write_bool(struct nx_json_writer *writer, char *key, int value);
+int nx_json_write_null(struct nx_json_writer *writer, char *key);
 
 
 #endif // NX_JSON_H
@@ -44,7 +44,7 @@ void test_nx_json_parse_simple() {
     struct nx_json *num = nx_json_get(json, "num");
     assert(num != NULL);
     assert(num->type == NX_JSON_INTEGER);
-    assert(num->u.number_value == 42.0);
+    assert(nx_json_number(num) == 42.0);
     
     // Test boolean
     nx_json_reset();
@@ -53,7 +53,7 @@ void test_nx_json_parse_simple() {
     struct nx_json *boolean = nx_json_get(json, "bool");
     assert(boolean != NULL);
     assert(boolean->type == NX_JSON_BOOL);
-    assert(boolean->u.number_value == 1.0);
+    assert(nx_json_number(boolean) == 1.0);
     
     printf("nx_json_parse simple tests completed\n\n");
 }
@@ -78,13 +78,13 @@ void test_nx_json_parse_complex() {
     struct nx_json *age = nx_json_get(json, "age");
     assert(age != NULL);
     assert(age->type == NX_JSON_INTEGER);
-    assert(age->u.number_value == 42.0);
+    assert(nx_json_number(age) == 42.0);
     
     // Get and verify "is_active" property
     struct nx_json *is_active = nx_json_get(json, "is_active");
     assert(is_active != NULL);
     assert(is_active->type == NX_JSON_BOOL);
-    assert(is_active->u.number_value == 1.0);
+    assert(nx_json_number(is_active) == 1.0);
     
     // Get and verify "nothing" property
     struct nx_json *nothing = nx_json_get(json, "nothing");
@@ -123,9 +123,453 @@ void test_nx_json_get() {
     printf("nx_json_get tests completed\n\n");
 }
 
+void test_nx_json_parse_nested() {
+    printf("Testing nx_json_parse with deeply nested objects and arrays...\n");
+    test_count += 12;
+    
+    // Metadata nested two levels below the root, like the forecast.solar message
+    nx_json_reset();
+    struct nx_json *json = nx_json_parse("{\"message\":{\"info\":{\"timezone\":\"Europe/Prague\"}, \"ratelimit\":{\"period\":3600, \"remaining\":11}}}");
+    assert(json != NULL);
+    
+    struct nx_json *ratelimit = nx_json_get(nx_json_get(json, "message"), "ratelimit");
+    assert(ratelimit != NULL);
+    assert(ratelimit->type == NX_JSON_OBJECT);
+    assert(nx_json_number(nx_json_get(ratelimit, "remaining")) == 11.0);
+    
+    struct nx_json *info = nx_json_get(nx_json_get(json, "message"), "info");
+    assert(info != NULL);
+    assert(strcmp(nx_json_get(info, "timezone")->u.text_value, "Europe/Prague") == 0);
+    
+    // Nested and empty arrays
+    nx_json_reset();
+    json = nx_json_parse("{\"a\":[[1, 2], [], {}, [[{\"b\":[3]}]]]}");
+    assert(json != NULL);
+    
+    struct nx_json *a = nx_json_get(json, "a");
+    assert(a->u.children.length == 4);
+    assert(nx_json_number(nx_json_item(nx_json_item(a, 0), 1)) == 2.0);
+    assert(nx_json_item(a, 1)->type == NX_JSON_ARRAY);
+    assert(nx_json_item(a, 1)->u.children.length == 0);
+    assert(nx_json_item(a, 2)->type == NX_JSON_OBJECT);
+    
+    struct nx_json *b = nx_json_get(nx_json_item(nx_json_item(nx_json_item(a, 3), 0), 0), "b");
+    assert(nx_json_number(nx_json_item(b, 0)) == 3.0);
+    
+    // Nesting deeper than MAX_NESTING_DEPTH is rejected
+    nx_json_reset();
+    json = nx_json_parse("{\"a\":[[[[[[[[[[[]]]]]]]]]]]}");
+    assert(json == NULL);
+    
+    printf("nx_json_parse nested tests completed\n\n");
+}
+
+void test_nx_json_ctx() {
+    printf("Testing nx_json_ctx arenas...\n");
+    test_count += 17;
+    
+    // Two documents stay alive at the same time
+    struct nx_json_ctx east;
+    struct nx_json_ctx west;
+    nx_json_ctx_init(&east, NULL, 0, NULL, 0);
+    nx_json_ctx_init(&west, NULL, 0, NULL, 0);
+    assert(east.nodes == NULL);
+    assert(east.strings == NULL);
+    
+    struct nx_json *east_json = nx_json_ctx_parse(&east, "{\"result\":{\"2025-02-27\":4674362}}");
+    struct nx_json *west_json = nx_json_ctx_parse(&west, "{\"result\":{\"2025-02-27\":3000000}}");
+    assert(east_json != NULL);
+    assert(west_json != NULL);
+    assert(nx_json_number(nx_json_get(nx_json_get(east_json, "result"), "2025-02-27")) == 4674362.0);
+    assert(nx_json_number(nx_json_get(nx_json_get(west_json, "result"), "2025-02-27")) == 3000000.0);
+    
+    // Arenas grow in blocks and are reused by the next parse without allocating
+    east.node_chunk = 2;
+    east.string_chunk = 8;
+    nx_json_ctx_free(&east);
+    east_json = nx_json_ctx_parse(&east, "{\"a\":[1, 2, 3, 4, 5], \"long key name\":\"long string value\"}");
+    assert(east_json != NULL);
+    assert(nx_json_number(nx_json_item(nx_json_get(east_json, "a"), 4)) == 5.0);
+    assert(strcmp(nx_json_get(east_json, "long key name")->u.text_value, "long string value") == 0);
+    
+    struct nx_json_node_block *first_block = east.nodes;
+    struct nx_json_node_block *last_block = east.node_block;
+    assert(first_block != last_block);
+    east_json = nx_json_ctx_parse(&east, "{\"a\":[1, 2, 3, 4, 5]}");
+    assert(east_json != NULL);
+    assert(east.nodes == first_block);
+    assert(east.node_block == last_block);
+    
+    // Freeing releases every block
+    nx_json_ctx_free(&east);
+    nx_json_ctx_free(&west);
+    assert(east.nodes == NULL);
+    assert(east.strings == NULL);
+    
+    // Caller supplied buffers without growth reject documents that do not fit
+    struct nx_json nodes[4];
+    char strings[16];
+    struct nx_json_ctx fixed;
+    nx_json_ctx_init(&fixed, nodes, 4, strings, sizeof(strings));
+    fixed.node_chunk = 0;
+    fixed.string_chunk = 0;
+    
+    struct nx_json *json = nx_json_ctx_parse(&fixed, "{\"a\":1, \"b\":\"x\"}");
+    assert(json == &nodes[0]);
+    assert(nx_json_get(json, "b")->u.text_value >= strings);
+    assert(nx_json_ctx_parse(&fixed, "{\"a\":1, \"b\":2, \"c\":3, \"d\":4}") == NULL);
+    assert(nx_json_ctx_parse(&fixed, "{\"a long key that does not fit\":1}") == NULL);
+    nx_json_ctx_free(&fixed);
+    
+    printf("nx_json_ctx tests completed\n\n");
+}
+
+void test_nx_json_string_modes() {
+    printf("Testing nx_json string modes...\n");
+    test_count += 17;
+    
+    struct nx_json_ctx ctx;
+    nx_json_ctx_init(&ctx, NULL, 0, NULL, 0);
+    
+    // In-situ strings are terminated inside the input buffer
+    char insitu[] = "{\"name\":\"test\", \"nested\":{\"inner\":\"value\"}}";
+    ctx.flags = NX_JSON_INSITU;
+    struct nx_json *json = nx_json_ctx_parse(&ctx, insitu);
+    assert(json != NULL);
+    struct nx_json *name = nx_json_get(json, "name");
+    assert(name->u.text_value == insitu + 9);
+    assert(strcmp(name->u.text_value, "test") == 0);
+    assert(strcmp(nx_json_get(nx_json_get(json, "nested"), "inner")->u.text_value, "value") == 0);
+    assert(ctx.strings == NULL);
+    
+    // Slices point into a buffer that is neither terminated nor modified
+    char slice[] = "{\"result\":{\"2025-02-27\":4674362,\"2025-02-28\":4774208},\"text\":\"ok\"}XXXX";
+    int slice_length = strlen(slice) - 4;
+    ctx.flags = NX_JSON_SLICE;
+    json = nx_json_ctx_parse_length(&ctx, slice, slice_length);
+    assert(json != NULL);
+    assert(nx_json_number(nx_json_get(nx_json_get(json, "result"), "2025-02-28")) == 4774208.0);
+    struct nx_json *text = nx_json_get(json, "text");
+    assert(text->text_length == 2);
+    assert(memcmp(text->u.text_value, "ok", 2) == 0);
+    assert(strcmp(slice + slice_length, "XXXX") == 0);
+    assert(strchr(slice, '\0') == slice + slice_length + 4);
+    assert(ctx.strings == NULL);
+    
+    // Slices stop at the given length even if a number touches the end
+    assert(nx_json_ctx_parse_length(&ctx, slice, 25) == NULL);
+    
+    // Escapes are decoded only when requested
+    char escaped[] = "{\"a\":\"line\\nbreak \\u00e1 \\ud83d\\ude00 \\\"q\\\"\"}";
+    ctx.flags = NX_JSON_INSITU | NX_JSON_UNESCAPE;
+    json = nx_json_ctx_parse(&ctx, escaped);
+    assert(json != NULL);
+    struct nx_json *a = nx_json_get(json, "a");
+    assert(strcmp(a->u.text_value, "line\nbreak \xc3\xa1 \xf0\x9f\x98\x80 \"q\"") == 0);
+    assert(a->text_length == (int)strlen(a->u.text_value));
+    
+    ctx.flags = NX_JSON_UNESCAPE;
+    json = nx_json_ctx_parse(&ctx, "{\"a\":\"tab\\there\"}");
+    assert(strcmp(nx_json_get(json, "a")->u.text_value, "tab\there") == 0);
+    
+    ctx.flags = 0;
+    json = nx_json_ctx_parse(&ctx, "{\"a\":\"tab\\there\"}");
+    assert(strcmp(nx_json_get(json, "a")->u.text_value, "tab\\there") == 0);
+    
+    nx_json_ctx_free(&ctx);
+    printf("nx_json string mode tests completed\n\n");
+}
+
+void test_nx_json_index() {
+    printf("Testing nx_json key and item index...\n");
+    test_count += 12;
+    
+    char text[4096];
+    char key[16];
+    int i;
+    
+    // Object with enough keys to be hashed, and an array
+    strcpy(text, "{\"result\":{");
+    for (i = 0; i < 100; i++) {
+        sprintf(text + strlen(text), "%s\"k%d\":%d", i > 0 ? "," : "", i, i);
+    }
+    strcat(text, ",\"k5\":-1}, \"small\":{\"a\":1}, \"items\":[10, 20, 30, {\"x\":[1]}]}");
+    
+    struct nx_json_ctx ctx;
+    nx_json_ctx_init(&ctx, NULL, 0, NULL, 0);
+    ctx.flags = NX_JSON_INDEX;
+    struct nx_json *json = nx_json_ctx_parse(&ctx, text);
+    assert(json != NULL);
+    
+    struct nx_json *result = nx_json_get(json, "result");
+    assert(result->u.children.index != NULL);
+    for (i = 0; i < 100; i++) {
+        sprintf(key, "k%d", i);
+        assert(nx_json_get(result, key) != NULL);
+        if (i != 5) assert(nx_json_number(nx_json_get(result, key)) == i);
+    }
+    
+    // The first of duplicate keys wins, like the linear lookup
+    assert(nx_json_number(nx_json_get(result, "k5")) == 5.0);
+    assert(nx_json_get(result, "k100") == NULL);
+    assert(nx_json_get(result, "") == NULL);
+    
+    // Small objects are not hashed
+    assert(nx_json_get(json, "small")->u.children.index == NULL);
+    assert(nx_json_number(nx_json_get(nx_json_get(json, "small"), "a")) == 1.0);
+    
+    // Array items are indexed directly
+    struct nx_json *items = nx_json_get(json, "items");
+    assert(items->u.children.index != NULL);
+    assert(nx_json_number(nx_json_item(items, 2)) == 30.0);
+    assert(nx_json_number(nx_json_item(nx_json_get(nx_json_item(items, 3), "x"), 0)) == 1.0);
+    assert(nx_json_item(items, 4) == NULL);
+    assert(nx_json_item(items, -1) == NULL);
+    
+    // The streaming parser builds the same index
+    struct nx_json_stream stream;
+    nx_json_stream_init(&stream, &ctx);
+    assert(nx_json_stream_feed(&stream, text, strlen(text)) == 0);
+    json = nx_json_stream_finish(&stream);
+    assert(nx_json_number(nx_json_get(nx_json_get(json, "result"), "k99")) == 99.0);
+    
+    nx_json_ctx_free(&ctx);
+    printf("nx_json index tests completed\n\n");
+}
+
+void test_nx_json_scan() {
+    printf("Testing nx_json scanning kernels...\n");
+    
+    char text[64];
+    int length;
+    int at;
+    int i;
+    
+    // Every hit position and length, so word-sized steps and byte tails are both covered
+    for (length = 0; length < 48; length++) {
+        for (at = 0; at <= length; at++) {
+            for (i = 0; i < length; i++) {
+                text[i] = ' ';
+                if (i % 3 == 1) text[i] = '\n';
+                if (i % 5 == 2) text[i] = '\t';
+            }
+            if (at < length) text[at] = 'x';
+            assert(nx_json_scan_space(text, text + length) == at);
+            
+            for (i = 0; i < length; i++) {
+                text[i] = 'a' + i % 26;
+                if (i % 7 == 3) text[i] = ':';
+            }
+            if (at < length) text[at] = '\\';
+            assert(nx_json_scan_quote(text, text + length) == text + at);
+            if (at < length) text[at] = '"';
+            assert(nx_json_scan_quote(text, text + length) == text + at);
+            
+            // Bytes that only differ from brackets in bit 5 are not structural
+            for (i = 0; i < length; i++) {
+                text[i] = ';';
+                if (i % 2 == 1) text[i] = '=';
+            }
+            if (at < length) text[at] = ']';
+            assert(nx_json_scan_structural(text, text + length) == text + at);
+            if (at < length) text[at] = '[';
+            assert(nx_json_scan_structural(text, text + length) == text + at);
+            test_count += 5;
+        }
+    }
+    
+    // Strings whose escaped quote is the last byte before a block boundary
+    nx_json_reset();
+    struct nx_json *json = nx_json_parse("{\"k\":\"0123456789abcd\\\"efghijklmnopqrstuvwxyz\\\\\"}");
+    assert(json != NULL);
+    assert(strcmp(nx_json_get(json, "k")->u.text_value, "0123456789abcd\\\"efghijklmnopqrstuvwxyz\\\\") == 0);
+    assert(nx_json_parse("{\"k\":\"abc\\") == NULL);
+    test_count += 3;
+    
+    printf("nx_json scanning kernel tests completed\n\n");
+}
+
+void test_nx_json_numbers() {
+    printf("Testing nx_json number parsing...\n");
+    
+    char text[128];
+    char long_text[256];
+    int i;
+    
+    // Integers are exact, also beyond the 2^53 precision of doubles
+    nx_json_reset();
+    struct nx_json *json = nx_json_parse("{\"wh\":4674362,\"big\":9007199254740993,\"neg\":-42,\"zero\":0,"
+                                         "\"huge\":12345678901234567890,\"round\":1000000000000000000000}");
+    assert(json != NULL);
+    assert(nx_json_get(json, "wh")->type == NX_JSON_INTEGER);
+    assert(nx_json_get(json, "wh")->u.int_value == 4674362);
+    assert(nx_json_number(nx_json_get(json, "wh")) == 4674362.0);
+    assert(nx_json_get(json, "big")->u.int_value == 9007199254740993LL);
+    assert(nx_json_get(json, "neg")->u.int_value == -42);
+    assert(nx_json_get(json, "zero")->u.int_value == 0);
+    test_count += 6;
+    
+    // The exact value shares the node's value union, 64 bytes on 64-bit hosts
+    assert(sizeof(struct nx_json) <= 8 * sizeof(void *));
+    test_count += 1;
+    
+    // Integers that do not fit NX_JSON_INT become doubles
+    assert(nx_json_get(json, "huge")->type == NX_JSON_DOUBLE);
+    assert(nx_json_number(nx_json_get(json, "huge")) == 12345678901234567890.0);
+    assert(nx_json_get(json, "round")->type == NX_JSON_DOUBLE);
+    assert(nx_json_number(nx_json_get(json, "round")) == 1e21);
+    test_count += 4;
+    
+    // Doubles match strtod bit for bit, on the fast path and the fallback
+    char *doubles[] = {"3.14159", "-0.5", "1e10", "1E-7", "2.5e+3", "0.1", "0.3", "123456.789e-3",
+                       "1.7976931348623157e308", "4.9e-324", "2.2250738585072014e-308",
+                       "0.30000000000000004", "9007199254740993.0", "1234567890123456789.5", "-0.0"};
+    for (i = 0; i < (int)(sizeof(doubles) / sizeof(doubles[0])); i++) {
+        sprintf(text, "{\"v\":%s}", doubles[i]);
+        nx_json_reset();
+        json = nx_json_parse(text);
+        assert(json != NULL);
+        assert(nx_json_get(json, "v")->type == NX_JSON_DOUBLE);
+        assert(nx_json_number(nx_json_get(json, "v")) == strtod(doubles[i], NULL));
+        test_count += 3;
+    }
+    
+    // Numbers longer than the atof copy keep their leading digits and exponent
+    char *long_numbers[] = {"3.14159265358979323846264338327950288419716939937510582097494459230781640628620899",
+                            "-0.000000000000000000000000000000000000000000000000000000000000000000000123456789",
+                            "123456789012345678901234567890123456789012345678901234567890123456789012345.5",
+                            "1.0000000000000000000000000000000000000000000000000000000000000000000000001e-300",
+                            "0.00000000000000000000000000000000000000000000000000000000000000000000000000"};
+    for (i = 0; i < (int)(sizeof(long_numbers) / sizeof(long_numbers[0])); i++) {
+        sprintf(long_text, "{\"v\":%s}", long_numbers[i]);
+        nx_json_reset();
+        json = nx_json_parse(long_text);
+        assert(json != NULL);
+        assert(nx_json_get(json, "v")->type == NX_JSON_DOUBLE);
+        assert(nx_json_number(nx_json_get(json, "v")) == strtod(long_numbers[i], NULL));
+        test_count += 3;
+    }
+    
+    // Fast path cases with every mantissa length and power of ten
+    srand(8);
+    for (i = 0; i < 2000; i++) {
+        sprintf(text, "{\"v\":%d.%de%d}", rand() % 100000, rand(), rand() % 45 - 22);
+        nx_json_reset();
+        json = nx_json_parse(text);
+        assert(json != NULL);
+        assert(nx_json_number(nx_json_get(json, "v")) == strtod(strchr(text, ':') + 1, NULL));
+    }
+    test_count += 2000;
+    
+    // Malformed numbers are rejected
+    nx_json_reset();
+    assert(nx_json_parse("{\"v\":-}") == NULL);
+    assert(nx_json_parse("{\"v\":1.}") == NULL);
+    assert(nx_json_parse("{\"v\":1e}") == NULL);
+    assert(nx_json_parse("{\"v\":1e+}") == NULL);
+    assert(nx_json_parse("{\"v\":1-2}") == NULL);
+    test_count += 5;
+    
+    nx_json_reset();
+    printf("nx_json number parsing tests completed\n\n");
+}
+
+void test_nx_json_errors_and_stats() {
+    printf("Testing nx_json error codes and parse statistics...\n");
+    
+    struct nx_json_ctx ctx;
+    struct nx_json nodes[4];
+    char strings[16];
+    char message[NX_JSON_ERROR_SIZE];
+    nx_json_ctx_init(&ctx, NULL, 0, NULL, 0);
+    
+    // Statistics of a successful parse
+    char text[] = "  {\"a\":[1,{\"b\":\"xy\"}],\"c\":true}  ";
+    assert(nx_json_ctx_parse(&ctx, text) != NULL);
+    assert(ctx.error == NX_JSON_OK);
+    assert(ctx.stats.bytes == (int)strlen(text));
+    assert(ctx.stats.nodes == 6);
+    assert(ctx.stats.node_capacity == NX_JSON_NODE_CHUNK);
+    assert(ctx.stats.string_bytes == 9);  // "a", "b", "xy", "c" with terminators
+    assert(ctx.stats.string_capacity == NX_JSON_STRING_CHUNK);
+    assert(ctx.stats.max_depth == 3);
+    assert(ctx.stats.time_us >= 0);
+    test_count += 9;
+    
+    // Error codes point to the offending byte, the message is formatted on request
+    assert(nx_json_ctx_parse(&ctx, "{\"a\":1,\"b\" 2}") == NULL);
+    assert(ctx.error == NX_JSON_ERROR_EXPECTED_COLON);
+    assert(ctx.error_offset == 11);
+    assert(strcmp(nx_json_format_error(&ctx, message), "NXJSON ERROR: Expected ':' after key at byte 11") == 0);
+    assert(ctx.stats.bytes == 11);
+    assert(ctx.stats.nodes == 2);  // Usage up to the error, the partial document itself is dropped
+    test_count += 6;
+    
+    assert(nx_json_ctx_parse(&ctx, "[1]") == NULL);
+    assert(ctx.error == NX_JSON_ERROR_NOT_OBJECT && ctx.error_offset == 0);
+    assert(nx_json_ctx_parse(&ctx, "{\"a\":[1}") == NULL);
+    assert(ctx.error == NX_JSON_ERROR_MISMATCHED_BRACKET && ctx.error_offset == 7);
+    assert(nx_json_ctx_parse(&ctx, "{\"a\":\"open") == NULL);
+    assert(ctx.error == NX_JSON_ERROR_UNTERMINATED_STRING && ctx.error_offset == 5);
+    assert(nx_json_ctx_parse(&ctx, "{\"a\":1.}") == NULL);
+    assert(ctx.error == NX_JSON_ERROR_INVALID_NUMBER && ctx.error_offset == 5);
+    assert(nx_json_ctx_parse(&ctx, "{\"a\":1 2}") == NULL);
+    assert(ctx.error == NX_JSON_ERROR_EXPECTED_SEPARATOR && ctx.error_offset == 7);
+    assert(nx_json_ctx_parse(&ctx, "{\"a\":") == NULL);
+    assert(ctx.error == NX_JSON_ERROR_UNEXPECTED_END && ctx.error_offset == 5);
+    assert(nx_json_ctx_parse(&ctx, "{\"a\":x}") == NULL);
+    assert(ctx.error == NX_JSON_ERROR_UNEXPECTED_CHARACTER && ctx.error_offset == 5);
+    test_count += 14;
+    
+    // A successful parse clears the previous error
+    assert(nx_json_ctx_parse(&ctx, "{}") != NULL);
+    assert(ctx.error == NX_JSON_OK);
+    assert(ctx.stats.max_depth == 1);
+    test_count += 3;
+    nx_json_ctx_free(&ctx);
+    
+    // Fixed buffers report which one ran out and how much was used
+    nx_json_ctx_init(&ctx, nodes, 4, strings, sizeof(strings));
+    ctx.node_chunk = 0;
+    ctx.string_chunk = 0;
+    assert(nx_json_ctx_parse(&ctx, "{\"a\":1,\"b\":2,\"c\":3,\"d\":4}") == NULL);
+    assert(ctx.error == NX_JSON_ERROR_NODES_FULL && ctx.error_offset == 23);
+    assert(ctx.stats.nodes == 4 && ctx.stats.node_capacity == 4);
+    assert(ctx.stats.string_capacity == 16);
+    assert(nx_json_ctx_parse(&ctx, "{\"long key\":1,\"another key\":2}") == NULL);
+    assert(ctx.error == NX_JSON_ERROR_STRINGS_FULL && ctx.error_offset == 14);
+    assert(ctx.stats.string_bytes == 9);
+    test_count += 6;
+    nx_json_ctx_free(&ctx);
+    
+    // The streaming parser records the same codes at the stream offset
+    struct nx_json_stream stream;
+    nx_json_ctx_init(&ctx, NULL, 0, NULL, 0);
+    nx_json_stream_init(&stream, &ctx);
+    assert(nx_json_stream_feed(&stream, "{\"a\":[1,", 8) == 0);
+    assert(nx_json_stream_feed(&stream, "2}", 2) == -1);
+    assert(ctx.error == NX_JSON_ERROR_MISMATCHED_BRACKET && ctx.error_offset == 9);
+    nx_json_stream_init(&stream, &ctx);
+    assert(nx_json_stream_feed(&stream, "{\"a\":[1,2]}", 11) == 0);
+    assert(nx_json_stream_finish(&stream) != NULL);
+    assert(ctx.error == NX_JSON_OK && ctx.stats.nodes == 4 && ctx.stats.max_depth == 2 && ctx.stats.bytes == 11);
+    test_count += 6;
+    nx_json_ctx_free(&ctx);
+    
+    // nx_json_parse keeps its error in the default context
+    nx_json_reset();
+    assert(nx_json_parse("{\"a\" 1}") == NULL);
+    assert(nx_json_default()->error == NX_JSON_ERROR_EXPECTED_COLON);
+    assert(strcmp(nx_json_error_text(NX_JSON_ERROR_TOO_DEEP), "Maximum nesting depth exceeded") == 0);
+    test_count += 3;
+    nx_json_reset();
+    
+    printf("nx_json error code and statistics tests completed\n\n");
+}
+
 void test_nx_json_parse_error_handling() {
     printf("Testing nx_json_parse error handling...\n");
-    test_count += 2;
+    test_count += 5;
     
     // Test invalid JSON (missing closing brace)
     nx_json_reset();
@@ -137,6 +581,21 @@ void test_nx_json_parse_error_handling() {
     json = nx_json_parse("{\"value\":invalid}");
     assert(json == NULL);
     
+    // Test invalid JSON (mismatched brackets)
+    nx_json_reset();
+    json = nx_json_parse("{\"value\":[1, 2}");
+    assert(json == NULL);
+    
+    // Test invalid JSON (trailing comma in array)
+    nx_json_reset();
+    json = nx_json_parse("{\"value\":[1, ]}");
+    assert(json == NULL);
+    
+    // Test invalid JSON (unterminated nested object)
+    nx_json_reset();
+    json = nx_json_parse("{\"value\":{\"inner\":1");
+    assert(json == NULL);
+    
     printf("nx_json_parse error handling tests completed\n\n");
 }
 
@@ -147,6 +606,13 @@ int main() {
     test_nx_json_parse_simple();
     test_nx_json_parse_complex();
     test_nx_json_get();
+    test_nx_json_parse_nested();
+    test_nx_json_ctx();
+    test_nx_json_string_modes();
+    test_nx_json_index();
+    test_nx_json_scan();
+    test_nx_json_numbers();
+    test_nx_json_errors_and_stats();
     test_nx_json_parse_error_handling();
     
     printf("\nAll tests passed! (%d assertions)\n", test_count);
@@ -0,0 +1,107 @@
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "nx_json.h"
+
+// Lookup benchmark: nx_json_get and nx_json_item cost as containers grow,
+// with and without NX_JSON_INDEX. Prints one line per size.
+
+#define LOOKUPS 1000000
+
+double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Build {"o":{"2025-02-27 00:00:00":0,...},"a":[0,1,...]} with count keys and items
+char *build_document(int count) {
+    char *text = (char *)malloc(count * 48 + 64);
+    char *p = text;
+    int i;
+
+    p += sprintf(p, "{\"o\":{");
+    for (i = 0; i < count; i++) {
+        p += sprintf(p, "%s\"2025-02-%02d %02d:%02d:00\":%d", i > 0 ? "," : "", 1 + i / 96, (i / 4) % 24, (i % 4) * 15, i);
+    }
+    p += sprintf(p, "},\"a\":[");
+    for (i = 0; i < count; i++) {
+        p += sprintf(p, "%s%d", i > 0 ? "," : "", i);
+    }
+    sprintf(p, "]}");
+    return text;
+}
+
+// Average ns per nx_json_get, cycling through every key of the object
+double bench_get(struct nx_json *object, char **keys, int count) {
+    double start = now_ns();
+    double sum = 0;
+    int i;
+
+    for (i = 0; i < LOOKUPS; i++) {
+        sum += nx_json_number(nx_json_get(object, keys[i % count]));
+    }
+    if (sum < 0) printf("unexpected sum\n");
+    return (now_ns() - start) / LOOKUPS;
+}
+
+// Average ns per nx_json_item, cycling through every item of the array
+double bench_item(struct nx_json *array, int count) {
+    double start = now_ns();
+    double sum = 0;
+    int i;
+
+    for (i = 0; i < LOOKUPS; i++) {
+        sum += nx_json_number(nx_json_item(array, i % count));
+    }
+    if (sum < 0) printf("unexpected sum\n");
+    return (now_ns() - start) / LOOKUPS;
+}
+
+int main() {
+    int sizes[] = {2, 4, 8, 16, 32, 64, 128, 256, 500};
+    int size_count = sizeof(sizes) / sizeof(sizes[0]);
+    struct nx_json_ctx linear;
+    struct nx_json_ctx indexed;
+    int s;
+    int i;
+
+    nx_json_ctx_init(&linear, NULL, 0, NULL, 0);
+    nx_json_ctx_init(&indexed, NULL, 0, NULL, 0);
+    indexed.flags = NX_JSON_INDEX;
+
+    for (s = 0; s < size_count; s++) {
+        int count = sizes[s];
+        char *text = build_document(count);
+        struct nx_json *linear_json = nx_json_ctx_parse(&linear, text);
+        struct nx_json *indexed_json = nx_json_ctx_parse(&indexed, text);
+        struct nx_json *child;
+        char **keys = (char **)malloc(count * sizeof(char *));
+
+        if (linear_json == NULL || indexed_json == NULL) {
+            fprintf(stderr, "Failed to parse document with %d keys\n", count);
+            return 1;
+        }
+
+        i = 0;
+        for (child = nx_json_get(linear_json, "o")->u.children.first; child != NULL; child = child->next) {
+            keys[i++] = child->key;
+        }
+
+        printf("bench=lookup keys=%d get_linear_ns=%.1f get_indexed_ns=%.1f item_linear_ns=%.1f item_indexed_ns=%.1f\n",
+               count,
+               bench_get(nx_json_get(linear_json, "o"), keys, count),
+               bench_get(nx_json_get(indexed_json, "o"), keys, count),
+               bench_item(nx_json_get(linear_json, "a"), count),
+               bench_item(nx_json_get(indexed_json, "a"), count));
+
+        free(keys);
+        free(text);
+    }
+
+    nx_json_ctx_free(&linear);
+    nx_json_ctx_free(&indexed);
+    return 0;
+}
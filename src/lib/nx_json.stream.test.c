@@ -0,0 +1,297 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "nx_json.h"
+#include "forecast_solar.h"
+
+#define DUMP_SIZE 8192
+
+int test_count = 0;
+
+// Context holding the streamed documents, reused by every parse
+struct nx_json_ctx ctx;
+
+// Function to read the entire contents of a file into a string
+char* read_file(const char* filename) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        perror("Could not open file");
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *content = (char *)malloc(length + 1);
+    if (!content) {
+        perror("Could not allocate memory");
+        fclose(file);
+        return NULL;
+    }
+
+    size_t read_size = fread(content, 1, length, file);
+    content[read_size] = '\0';
+    fclose(file);
+
+    return content;
+}
+
+// Serialize a parsed tree so two parses can be compared after the node pool was reused
+void dump_json(struct nx_json *js, char *out) {
+    char value[64];
+    struct nx_json *child;
+
+    if (js->key != NULL) {
+        strcat(out, js->key);
+        strcat(out, "=");
+    }
+
+    switch (js->type) {
+        case NX_JSON_STRING:
+            strcat(out, "s:");
+            strcat(out, js->u.text_value);
+            break;
+        case NX_JSON_INTEGER:
+        case NX_JSON_DOUBLE:
+        case NX_JSON_BOOL:
+            snprintf(value, sizeof(value), "%d:%.17g", js->type, nx_json_number(js));
+            strcat(out, value);
+            break;
+        case NX_JSON_NULL:
+            strcat(out, "null");
+            break;
+        default:
+            snprintf(value, sizeof(value), "%d:%d(", js->type, js->u.children.length);
+            strcat(out, value);
+            for (child = js->u.children.first; child != NULL; child = child->next) {
+                dump_json(child, out);
+                strcat(out, ",");
+            }
+            strcat(out, ")");
+            break;
+    }
+}
+
+// Parse a document fed in the given chunks and dump the resulting tree
+int parse_chunks(char *text, int length, int chunk_size, char *out) {
+    struct nx_json_stream stream;
+    struct nx_json *root;
+    int i;
+
+    out[0] = '\0';
+    nx_json_stream_init(&stream, &ctx);
+    for (i = 0; i < length; i += chunk_size) {
+        int n = chunk_size;
+        if (i + n > length) n = length - i;
+        if (nx_json_stream_feed(&stream, text + i, n) != 0) return -1;
+    }
+    root = nx_json_stream_finish(&stream);
+    if (root == NULL) return -1;
+    dump_json(root, out);
+    return 0;
+}
+
+// Parse a document split into two chunks at the given offset and dump the resulting tree
+int parse_split(char *text, int length, int split, char *out) {
+    struct nx_json_stream stream;
+    struct nx_json *root;
+
+    out[0] = '\0';
+    nx_json_stream_init(&stream, &ctx);
+    if (nx_json_stream_feed(&stream, text, split) != 0) return -1;
+    if (nx_json_stream_feed(&stream, text + split, length - split) != 0) return -1;
+    root = nx_json_stream_finish(&stream);
+    if (root == NULL) return -1;
+    dump_json(root, out);
+    return 0;
+}
+
+// Every split offset and byte-by-byte feeding must yield the same tree as a single chunk
+void check_every_split(char *text) {
+    char reference[DUMP_SIZE];
+    char dump[DUMP_SIZE];
+    int length = strlen(text);
+    int split;
+
+    assert(parse_chunks(text, length, length, reference) == 0);
+
+    // The streaming parser builds the same tree as nx_json_parse
+    struct nx_json *json = nx_json_parse(text);
+    assert(json != NULL);
+    dump[0] = '\0';
+    dump_json(json, dump);
+    assert(strcmp(dump, reference) == 0);
+
+    for (split = 0; split <= length; split++) {
+        assert(parse_split(text, length, split, dump) == 0);
+        assert(strcmp(dump, reference) == 0);
+    }
+    assert(parse_chunks(text, length, 1, dump) == 0);
+    assert(strcmp(dump, reference) == 0);
+    assert(parse_chunks(text, length, 7, dump) == 0);
+    assert(strcmp(dump, reference) == 0);
+    test_count += 2 * length + 7;
+}
+
+void test_stream_forecast_mocks() {
+    printf("Testing nx_json_stream with forecast.solar mocks split at every offset...\n");
+
+    char *body = read_file(MOCK_RESPONSE_BODY_FILE);
+    char *oneline = read_file(MOCK_RESPONSE_BODY_ONELINE_FILE);
+    char *response = read_file(MOCK_RESPONSE_FILE);
+    assert(body != NULL && oneline != NULL && response != NULL);
+
+    check_every_split(body);
+    check_every_split(oneline);
+    check_every_split(skipHeaders(response));
+
+    // Values split across chunks and nested below the first level are reachable
+    struct nx_json_stream stream;
+    nx_json_stream_init(&stream, &ctx);
+    assert(nx_json_stream_feed(&stream, body, 40) == 0);
+    assert(nx_json_stream_feed(&stream, body + 40, strlen(body) - 40) == 0);
+    struct nx_json *json = nx_json_stream_finish(&stream);
+    assert(json != NULL);
+
+    struct nx_json *today = nx_json_get(nx_json_get(json, "result"), "2025-02-27");
+    assert(today != NULL);
+    assert(today->type == NX_JSON_INTEGER);
+    assert(nx_json_number(today) == 4674362.0);
+
+    struct nx_json *ratelimit = nx_json_get(nx_json_get(json, "message"), "ratelimit");
+    assert(ratelimit != NULL);
+    assert(ratelimit->type == NX_JSON_OBJECT);
+    assert(nx_json_number(nx_json_get(ratelimit, "remaining")) == 11.0);
+    test_count += 6;
+
+    nx_json_ctx_reset(&ctx);
+    free(body);
+    free(oneline);
+    free(response);
+    printf("nx_json_stream forecast.solar tests completed\n\n");
+}
+
+void test_stream_samples() {
+    printf("Testing nx_json_stream with JSON samples split at every offset...\n");
+
+    char *samples = read_file(MOCK_JSON_PATH);
+    assert(samples != NULL);
+
+    check_every_split(samples);
+
+    struct nx_json_stream stream;
+    nx_json_stream_init(&stream, &ctx);
+    assert(nx_json_stream_feed(&stream, samples, strlen(samples)) == 0);
+    struct nx_json *json = nx_json_stream_finish(&stream);
+    assert(json != NULL);
+
+    struct nx_json *simple_array = nx_json_get(json, "simple_array");
+    assert(simple_array != NULL);
+    assert(simple_array->u.children.length == 5);
+    assert(nx_json_number(nx_json_item(simple_array, 4)) == 5.0);
+
+    struct nx_json *second = nx_json_item(nx_json_get(json, "array_of_objects"), 1);
+    assert(second != NULL);
+    assert(strcmp(nx_json_get(second, "name")->u.text_value, "Object 2") == 0);
+
+    struct nx_json *nested = nx_json_get(nx_json_get(json, "simple_object"), "nested_object");
+    assert(strcmp(nx_json_get(nested, "nested_key")->u.text_value, "nested_value") == 0);
+
+    struct nx_json *float_value = nx_json_get(nx_json_get(json, "scalar_values"), "float");
+    assert(float_value->type == NX_JSON_DOUBLE);
+    assert(nx_json_number(float_value) == 3.14159);
+    test_count += 8;
+
+    nx_json_ctx_reset(&ctx);
+    free(samples);
+    printf("nx_json_stream sample tests completed\n\n");
+}
+
+void test_stream_escapes() {
+    printf("Testing nx_json_stream with escapes split across chunks...\n");
+
+    char text[] = "{\"a\\\"b\":\"x\\\\\",\"c\":[true,false,null,-1.5e3]}";
+    check_every_split(text);
+
+    struct nx_json_stream stream;
+    nx_json_stream_init(&stream, &ctx);
+    assert(nx_json_stream_feed(&stream, text, strlen(text)) == 0);
+    struct nx_json *json = nx_json_stream_finish(&stream);
+    assert(json != NULL);
+    assert(strcmp(nx_json_get(json, "a\\\"b")->u.text_value, "x\\\\") == 0);
+    assert(nx_json_number(nx_json_item(nx_json_get(json, "c"), 3)) == -1500.0);
+    test_count += 3;
+
+    nx_json_ctx_reset(&ctx);
+    printf("nx_json_stream escape tests completed\n\n");
+}
+
+void test_stream_small_blocks() {
+    printf("Testing nx_json_stream with tiny arena blocks...\n");
+
+    char *body = read_file(MOCK_RESPONSE_BODY_FILE);
+    char *samples = read_file(MOCK_JSON_PATH);
+    assert(body != NULL && samples != NULL);
+
+    // Strings split across chunks also move between arena blocks
+    nx_json_ctx_free(&ctx);
+    ctx.node_chunk = 2;
+    ctx.string_chunk = 4;
+    check_every_split(body);
+    check_every_split(samples);
+
+    nx_json_ctx_free(&ctx);
+    ctx.node_chunk = NX_JSON_NODE_CHUNK;
+    ctx.string_chunk = NX_JSON_STRING_CHUNK;
+    free(body);
+    free(samples);
+    printf("nx_json_stream tiny arena block tests completed\n\n");
+}
+
+void test_stream_error_handling() {
+    printf("Testing nx_json_stream error handling...\n");
+
+    struct nx_json_stream stream;
+    char dump[DUMP_SIZE];
+
+    // Truncated document
+    assert(parse_chunks("{\"name\":\"test\"", 14, 3, dump) == -1);
+
+    // Invalid keyword
+    assert(parse_chunks("{\"value\":invalid}", 17, 4, dump) == -1);
+    assert(parse_chunks("{\"value\":tru}", 13, 2, dump) == -1);
+
+    // Mismatched brackets
+    assert(parse_chunks("{\"value\":[1}", 12, 5, dump) == -1);
+
+    // Root must be an object
+    assert(parse_chunks("[1]", 3, 1, dump) == -1);
+
+    // Once failed, further chunks are rejected
+    nx_json_stream_init(&stream, &ctx);
+    assert(nx_json_stream_feed(&stream, "x", 1) == -1);
+    assert(nx_json_stream_feed(&stream, "{}", 2) == -1);
+    assert(nx_json_stream_finish(&stream) == NULL);
+    test_count += 8;
+
+    printf("nx_json_stream error handling tests completed\n\n");
+}
+
+int main() {
+    printf("Starting JSON stream tests...\n\n");
+
+    nx_json_ctx_init(&ctx, NULL, 0, NULL, 0);
+
+    test_stream_forecast_mocks();
+    test_stream_samples();
+    test_stream_escapes();
+    test_stream_small_blocks();
+    test_stream_error_handling();
+
+    nx_json_ctx_free(&ctx);
+    nx_json_reset();
+    printf("\nAll tests passed! (%d assertions)\n", test_count);
+    return 0;
+}
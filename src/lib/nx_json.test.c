@@ -58,12 +58,12 @@ void test_nx_json_parse() {
     struct nx_json *integer = nx_json_get(scalar_values, "integer");
     assert(integer != NULL);
     assert(integer->type == NX_JSON_INTEGER);
-    assert(integer->u.number_value == 42.0);
+    assert(nx_json_number(integer) == 42.0);
 
     struct nx_json *float_value = nx_json_get(scalar_values, "float");
     assert(float_value != NULL);
     assert(float_value->type == NX_JSON_DOUBLE);
-    assert(float_value->u.number_value == 3.14159);
+    assert(nx_json_number(float_value) == 3.14159);
 
     struct nx_json *string = nx_json_get(scalar_values, "string");
     assert(string != NULL);
@@ -73,12 +73,12 @@ void test_nx_json_parse() {
     struct nx_json *boolean_true = nx_json_get(scalar_values, "boolean_true");
     assert(boolean_true != NULL);
     assert(boolean_true->type == NX_JSON_BOOL);
-    assert(boolean_true->u.number_value == 1.0);
+    assert(nx_json_number(boolean_true) == 1.0);
 
     struct nx_json *boolean_false = nx_json_get(scalar_values, "boolean_false");
     assert(boolean_false != NULL);
     assert(boolean_false->type == NX_JSON_BOOL);
-    assert(boolean_false->u.number_value == 0.0);
+    assert(nx_json_number(boolean_false) == 0.0);
 
     struct nx_json *null_value = nx_json_get(scalar_values, "null_value");
     assert(null_value != NULL);
@@ -96,7 +96,54 @@ void test_nx_json_parse() {
     struct nx_json *value = nx_json_get(simple_object, "value");
     assert(value != NULL);
     assert(value->type == NX_JSON_INTEGER);
-    assert(value->u.number_value == 123.0);
+    assert(nx_json_number(value) == 123.0);
+
+    // Test object nested below the second level
+    struct nx_json *nested_object = nx_json_get(simple_object, "nested_object");
+    assert(nested_object != NULL);
+    assert(nested_object->type == NX_JSON_OBJECT);
+
+    struct nx_json *nested_key = nx_json_get(nested_object, "nested_key");
+    assert(nested_key != NULL);
+    assert(strcmp(nested_key->u.text_value, "nested_value") == 0);
+
+    // Test simple array
+    struct nx_json *simple_array = nx_json_get(json, "simple_array");
+    assert(simple_array != NULL);
+    assert(simple_array->type == NX_JSON_ARRAY);
+    assert(simple_array->u.children.length == 5);
+    for (int i = 0; i < 5; i++) {
+        struct nx_json *item = nx_json_item(simple_array, i);
+        assert(item != NULL);
+        assert(item->type == NX_JSON_INTEGER);
+        assert(nx_json_number(item) == i + 1);
+    }
+    assert(nx_json_item(simple_array, 5) == NULL);
+
+    // Test array of objects
+    struct nx_json *array_of_objects = nx_json_get(json, "array_of_objects");
+    assert(array_of_objects != NULL);
+    assert(array_of_objects->u.children.length == 2);
+
+    struct nx_json *object_2 = nx_json_item(array_of_objects, 1);
+    assert(object_2 != NULL);
+    assert(object_2->type == NX_JSON_OBJECT);
+    assert(nx_json_number(nx_json_get(object_2, "id")) == 2.0);
+    assert(strcmp(nx_json_get(object_2, "name")->u.text_value, "Object 2") == 0);
+
+    // Test mixed array
+    struct nx_json *mixed_array = nx_json_get(json, "mixed_array");
+    assert(mixed_array != NULL);
+    assert(mixed_array->u.children.length == 5);
+    assert(nx_json_item(mixed_array, 0)->type == NX_JSON_STRING);
+    assert(nx_json_item(mixed_array, 1)->type == NX_JSON_INTEGER);
+    assert(nx_json_item(mixed_array, 2)->type == NX_JSON_BOOL);
+    assert(nx_json_item(mixed_array, 3)->type == NX_JSON_NULL);
+
+    struct nx_json *mixed_object = nx_json_item(mixed_array, 4);
+    assert(mixed_object != NULL);
+    assert(mixed_object->type == NX_JSON_OBJECT);
+    assert(strcmp(nx_json_get(mixed_object, "key")->u.text_value, "value") == 0);
 
     // Clean up
     nx_json_reset();
@@ -0,0 +1,196 @@
+// Check if we're using a standard C compiler
+#ifndef PICO_C
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nx_json.h"
+#endif
+
+// Selective extraction: one forward pass over the input that fills the
+// requested paths and skips everything else, without nodes or string copies.
+
+// Start an empty path
+void nx_json_query_init(struct nx_json_query *query) {
+    query->depth = 0;
+    query->matched = 0;
+    query->found = 0;
+    query->type = NX_JSON_NULL;
+    query->number_value = 0;
+    query->int_value = 0;
+    query->text_value = NULL;
+    query->text_length = 0;
+}
+
+// Append an object key to the path, keys made of digits also match that array index
+void nx_json_query_key(struct nx_json_query *query, char *key) {
+    int i;
+    int index = 0;
+
+    if (query->depth >= NX_JSON_QUERY_MAX_DEPTH) return;
+
+    query->path[query->depth] = key;
+    query->path_length[query->depth] = strlen(key);
+
+    for (i = 0; key[i] != '\0'; i++) {
+        if (key[i] < '0' || key[i] > '9') {
+            index = -1;
+            break;
+        }
+        index = index * 10 + (key[i] - '0');
+    }
+    if (i == 0) {
+        index = -1;
+    }
+    query->index[query->depth] = index;
+    query->depth++;
+}
+
+// Does the element at level depth (key slice or array index) continue the query path
+int nx_json_query_matches(struct nx_json_query *query, int depth, char *key, int key_length, int index) {
+    if (query->found || query->matched != depth || query->depth <= depth) return 0;
+    if (key == NULL) {
+        return query->index[depth] == index;
+    }
+    return query->path_length[depth] == key_length && memcmp(query->path[depth], key, key_length) == 0;
+}
+
+// Store the scalar at p in the query, returns -1 if it is not a valid value
+int nx_json_query_store(struct nx_json_query *query, char *p, char *value_end) {
+    int length = value_end - p;
+
+    query->found = 1;
+    if (*p == '"') {
+        query->type = NX_JSON_STRING;
+        query->text_value = p + 1;
+        query->text_length = length - 2;
+    } else if (*p == 't' || *p == 'f') {
+        query->type = NX_JSON_BOOL;
+        if (*p == 't') {
+            query->number_value = 1;
+        } else {
+            query->number_value = 0;
+        }
+    } else if (*p == 'n') {
+        query->type = NX_JSON_NULL;
+    } else if (nx_json_scan_number(p, value_end, &query->type, &query->number_value, &query->int_value) != value_end) {
+        query->found = 0;
+        return -1;
+    }
+    return 0;
+}
+
+// Fill the queries from one forward pass over text. Subtrees no query descends
+// into are skipped by matching brackets and quotes only, and the pass stops once
+// every query is filled, so the input after the last filled value is not checked.
+// Returns the number of queries filled, or -1 if the input is malformed.
+int nx_json_extract(char *text, int length, struct nx_json_query *queries, int count) {
+    char *end = text + length;
+    char *p = text;
+    char *key;
+    char *value_end;
+    int key_length;
+    int index[NX_JSON_QUERY_MAX_DEPTH + 1];  // Next array index per open container
+    int is_array[NX_JSON_QUERY_MAX_DEPTH + 1];
+    int depth = 0;   // Open containers below the root
+    int expect = 0;  // 0 after an opening bracket, 1 after a comma, 2 after a value
+    int remaining = count;
+    int descend;
+    int i;
+
+    for (i = 0; i < count; i++) {
+        queries[i].matched = 0;
+        queries[i].found = 0;
+    }
+
+    p += nx_json_scan_space(p, end);
+    if (p >= end || *p != '{') return -1;
+    p++;
+    is_array[0] = 0;
+    index[0] = 0;
+
+    while (remaining > 0) {
+        p += nx_json_scan_space(p, end);
+        if (p >= end) return -1;
+
+        // Close the current container, right after opening it or after a value
+        if (*p == '}' || *p == ']') {
+            if (expect == 1 || (*p == ']') != is_array[depth]) return -1;
+            if (depth == 0) break;
+            for (i = 0; i < count; i++) {
+                if (queries[i].matched == depth) {
+                    queries[i].matched = depth - 1;
+                }
+            }
+            depth--;
+            p++;
+            expect = 2;
+            continue;
+        }
+
+        // A value is followed by a comma and the next member or item
+        if (expect == 2) {
+            if (*p != ',') return -1;
+            p++;
+            expect = 1;
+            continue;
+        }
+
+        // Key of an object member, or the position of an array item
+        key = NULL;
+        key_length = 0;
+        if (is_array[depth] == 0) {
+            if (*p != '"') return -1;
+            value_end = nx_json_scan_string_end(p, end);
+            if (value_end == NULL) return -1;
+            key = p + 1;
+            key_length = value_end - p - 2;
+            p = value_end + nx_json_scan_space(value_end, end);
+            if (p >= end || *p != ':') return -1;
+            p++;
+            p += nx_json_scan_space(p, end);
+            if (p >= end) return -1;
+        }
+
+        if ((*p == '{' || *p == '[') && depth < NX_JSON_QUERY_MAX_DEPTH) {
+            // Descend only if some query continues below this key
+            descend = 0;
+            for (i = 0; i < count; i++) {
+                if (nx_json_query_matches(&queries[i], depth, key, key_length, index[depth]) &&
+                    queries[i].depth > depth + 1) {
+                    queries[i].matched = depth + 1;
+                    descend = 1;
+                }
+            }
+            index[depth]++;
+            if (descend) {
+                depth++;
+                is_array[depth] = *p == '[';
+                index[depth] = 0;
+                p++;
+                expect = 0;
+                continue;
+            }
+        } else {
+            index[depth]++;
+        }
+
+        // An empty scalar means a missing value
+        value_end = nx_json_scan_value_end(p, end);
+        if (value_end == NULL || value_end == p) return -1;
+
+        if (*p != '{' && *p != '[') {
+            for (i = 0; i < count; i++) {
+                if (nx_json_query_matches(&queries[i], depth, key, key_length, index[depth] - 1) &&
+                    queries[i].depth == depth + 1) {
+                    if (nx_json_query_store(&queries[i], p, value_end) != 0) return -1;
+                    remaining--;
+                }
+            }
+        }
+
+        p = value_end;
+        expect = 2;
+    }
+
+    return count - remaining;
+}
@@ -0,0 +1,201 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "nx_json.h"
+
+int test_count = 0;
+
+// Function to read the entire contents of a file into a string
+char* read_file(const char* filename) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        perror("Could not open file");
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *content = (char *)malloc(length + 1);
+    if (!content) {
+        perror("Could not allocate memory");
+        fclose(file);
+        return NULL;
+    }
+
+    size_t read_size = fread(content, 1, length, file);
+    content[read_size] = '\0';
+    fclose(file);
+
+    return content;
+}
+
+// Set up a query for up to three keys, NULL ends the path early
+void set_query(struct nx_json_query *query, char *key1, char *key2, char *key3) {
+    nx_json_query_init(query);
+    nx_json_query_key(query, key1);
+    if (key2 != NULL) nx_json_query_key(query, key2);
+    if (key3 != NULL) nx_json_query_key(query, key3);
+}
+
+void test_extract_forecast() {
+    printf("Testing nx_json_extract with the forecast.solar mock...\n");
+
+    char *body = read_file(MOCK_RESPONSE_BODY_FILE);
+    assert(body != NULL);
+
+    struct nx_json_query queries[4];
+    set_query(&queries[0], "result", "2025-02-27", NULL);
+    set_query(&queries[1], "result", "2025-02-28", NULL);
+    set_query(&queries[2], "message", "ratelimit", "remaining");
+    set_query(&queries[3], "message", "info", "timezone");
+
+    assert(nx_json_extract(body, strlen(body), queries, 4) == 4);
+    assert(queries[0].type == NX_JSON_INTEGER);
+    assert(queries[0].number_value == 4674362.0);
+    assert(queries[0].int_value == 4674362);
+    assert(queries[1].number_value == 4774208.0);
+    assert(queries[2].number_value == 11.0);
+    assert(queries[3].type == NX_JSON_STRING);
+    assert(queries[3].text_length == 13);
+    assert(memcmp(queries[3].text_value, "Europe/Prague", 13) == 0);
+    test_count += 8;
+
+    // Missing keys stay unfilled, the others are still found
+    set_query(&queries[0], "result", "2025-03-01", NULL);
+    set_query(&queries[1], "message", "code", NULL);
+    assert(nx_json_extract(body, strlen(body), queries, 2) == 1);
+    assert(queries[0].found == 0);
+    assert(queries[1].found == 1);
+    assert(queries[1].number_value == 0.0);
+    test_count += 4;
+
+    // Values at the same paths as nx_json_parse
+    struct nx_json *json = nx_json_parse(body);
+    assert(json != NULL);
+    set_query(&queries[0], "message", "info", "latitude");
+    assert(nx_json_extract(body, strlen(body), queries, 1) == 1);
+    assert(queries[0].type == NX_JSON_DOUBLE);
+    assert(queries[0].number_value == nx_json_get(nx_json_get(nx_json_get(json, "message"), "info"), "latitude")->u.number_value);
+    test_count += 4;
+
+    nx_json_reset();
+    free(body);
+    printf("nx_json_extract forecast.solar tests completed\n\n");
+}
+
+void test_extract_samples() {
+    printf("Testing nx_json_extract with JSON samples...\n");
+
+    char *samples = read_file(MOCK_JSON_PATH);
+    assert(samples != NULL);
+
+    struct nx_json_query queries[6];
+    set_query(&queries[0], "simple_array", "4", NULL);
+    set_query(&queries[1], "array_of_objects", "1", "name");
+    set_query(&queries[2], "simple_object", "nested_object", "nested_key");
+    set_query(&queries[3], "scalar_values", "boolean_true", NULL);
+    set_query(&queries[4], "scalar_values", "null_value", NULL);
+    set_query(&queries[5], "mixed_array", "4", "key");
+
+    assert(nx_json_extract(samples, strlen(samples), queries, 6) == 6);
+    assert(queries[0].number_value == 5.0);
+    assert(queries[1].text_length == 8 && memcmp(queries[1].text_value, "Object 2", 8) == 0);
+    assert(queries[2].text_length == 12 && memcmp(queries[2].text_value, "nested_value", 12) == 0);
+    assert(queries[3].type == NX_JSON_BOOL && queries[3].number_value == 1.0);
+    assert(queries[4].type == NX_JSON_NULL);
+    assert(queries[5].text_length == 5 && memcmp(queries[5].text_value, "value", 5) == 0);
+    test_count += 7;
+
+    // Containers are not scalars and out of range items do not exist
+    set_query(&queries[0], "simple_object", NULL, NULL);
+    set_query(&queries[1], "simple_array", "5", NULL);
+    assert(nx_json_extract(samples, strlen(samples), queries, 2) == 0);
+    test_count += 1;
+
+    free(samples);
+    printf("nx_json_extract sample tests completed\n\n");
+}
+
+void test_extract_skipping() {
+    printf("Testing nx_json_extract subtree skipping and early stop...\n");
+
+    struct nx_json_query query;
+
+    // Brackets and quotes inside skipped strings do not confuse the skip
+    char text[] = "{\"a\":{\"x\":\"}]\\\"{[\",\"y\":[[1],{\"z\":\"]\"}]},\"b\":[{},[]],\"c\":-2.5e1}";
+    set_query(&query, "c", NULL, NULL);
+    assert(nx_json_extract(text, strlen(text), &query, 1) == 1);
+    assert(query.type == NX_JSON_DOUBLE);
+    assert(query.number_value == -25.0);
+    test_count += 3;
+
+    // A key nested under a different parent does not match
+    set_query(&query, "z", NULL, NULL);
+    assert(nx_json_extract(text, strlen(text), &query, 1) == 0);
+    test_count += 1;
+
+    // The pass stops once every query is filled, garbage after it is never read
+    char early[] = "{\"a\":1,\"b\":garbage";
+    set_query(&query, "a", NULL, NULL);
+    assert(nx_json_extract(early, strlen(early), &query, 1) == 1);
+    assert(query.number_value == 1.0);
+    test_count += 2;
+
+    // A number may end exactly at the end of the given length
+    char bounded[] = "{\"a\":1234";
+    set_query(&query, "a", NULL, NULL);
+    assert(nx_json_extract(bounded, 7, &query, 1) == 1);
+    assert(query.number_value == 12.0);
+    test_count += 2;
+
+    printf("nx_json_extract skipping tests completed\n\n");
+}
+
+void test_extract_error_handling() {
+    printf("Testing nx_json_extract error handling...\n");
+
+    struct nx_json_query query;
+    set_query(&query, "missing", NULL, NULL);
+
+    assert(nx_json_extract("", 0, &query, 1) == -1);
+    assert(nx_json_extract("[1]", 3, &query, 1) == -1);
+    assert(nx_json_extract("{\"a\":\"open", 10, &query, 1) == -1);
+    assert(nx_json_extract("{\"a\" 1}", 7, &query, 1) == -1);
+    assert(nx_json_extract("{\"a\":{\"b\":1}", 12, &query, 1) == -1);
+    assert(nx_json_extract("{a:1}", 5, &query, 1) == -1);
+    assert(nx_json_extract("{\"a\":1}", 7, &query, 1) == 0);
+    set_query(&query, "a", NULL, NULL);
+    assert(nx_json_extract("{\"a\":1.e5}", 10, &query, 1) == -1);
+    test_count += 8;
+
+    // Separators and closing brackets are checked up to the last filled value
+    set_query(&query, "missing", NULL, NULL);
+    assert(nx_json_extract("{\"a\":1 \"b\":2}", 13, &query, 1) == -1);
+    assert(nx_json_extract("{\"a\":1,}", 8, &query, 1) == -1);
+    assert(nx_json_extract("{\"a\":}", 6, &query, 1) == -1);
+    assert(nx_json_extract("{\"a\":1,,\"b\":2}", 14, &query, 1) == -1);
+    assert(nx_json_extract("{\"a\":1]", 7, &query, 1) == -1);
+    set_query(&query, "a", "5", NULL);
+    assert(nx_json_extract("{\"a\":[1},\"b\":2}", 15, &query, 1) == -1);
+    assert(nx_json_extract("{\"a\":[1,]}", 10, &query, 1) == -1);
+    assert(nx_json_extract("{\"a\":[,1]}", 10, &query, 1) == -1);
+    assert(nx_json_extract("{\"a\":[1,2] , \"b\":{}}", 20, &query, 1) == 0);
+    test_count += 9;
+
+    printf("nx_json_extract error handling tests completed\n\n");
+}
+
+int main() {
+    printf("Starting JSON query tests...\n\n");
+
+    test_extract_forecast();
+    test_extract_samples();
+    test_extract_skipping();
+    test_extract_error_handling();
+
+    printf("\nAll tests passed! (%d assertions)\n", test_count);
+    return 0;
+}
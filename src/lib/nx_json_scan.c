@@ -0,0 +1,242 @@
+// Check if we're using a standard C compiler
+#ifndef PICO_C
+#include <string.h>
+#include "nx_json.h"
+#endif
+
+// Scanning kernels shared by the parsers and the extractor. Host builds with
+// GCC or Clang define NX_JSON_SCAN_WIDE and take the space, quote and
+// structural kernels from nx_json_scan_wide.c, which is not bundled. The PicoC
+// bundle gets the plain byte loops below.
+
+#ifndef NX_JSON_SCAN_WIDE
+
+// Portable byte loops
+int nx_json_scan_space(char *p, char *end) {
+    int i = 0;
+    while (p + i < end && (p[i] == ' ' || p[i] == '\t' || p[i] == '\n' || p[i] == '\r')) {
+        i++;
+    }
+    return i;
+}
+
+char *nx_json_scan_quote(char *p, char *end) {
+    while (p < end && *p != '"' && *p != '\\') {
+        p++;
+    }
+    return p;
+}
+
+char *nx_json_scan_structural(char *p, char *end) {
+    while (p < end && *p != '"' && *p != '{' && *p != '}' && *p != '[' && *p != ']') {
+        p++;
+    }
+    return p;
+}
+
+#endif
+
+// Significant digits handed to atof, more than any double needs in practice
+#define NX_JSON_NUMBER_DIGITS 40
+
+// Parse the number at p in one pass, accumulating the digits into an integer
+// mantissa and a decimal exponent. Integers of up to NX_JSON_INT_DIGITS digits
+// are exact, other numbers become doubles. Doubles whose mantissa and power of
+// ten are both exact are correctly rounded by one multiply or divide, the rest
+// go through atof. Returns the end of the number, or NULL if it is malformed.
+char *nx_json_scan_number(char *p, char *end, enum nx_json_type *type, double *number, NX_JSON_INT *integer) {
+    char copy[NX_JSON_NUMBER_DIGITS + 24];
+    char *start = p;
+    NX_JSON_INT mantissa = 0;
+    int digits = 0;       // Significant digits in the mantissa
+    int exponent = 0;     // Power of ten applied to the mantissa
+    int exponent_value = 0;
+    int negative = 0;
+    int is_double = 0;
+    int exact = 1;        // No nonzero digit was dropped from the mantissa
+    double value;
+    double scale;
+    char *q;
+    int n;
+    int kept;            // Significant digits in the copy
+    char c;
+    int i;
+
+    if (p < end && *p == '-') {
+        negative = 1;
+        p++;
+    }
+    if (p >= end || *p < '0' || *p > '9') return NULL;
+    while (p < end && *p >= '0' && *p <= '9') {
+        if (digits < NX_JSON_INT_DIGITS) {
+            mantissa = mantissa * 10 + (*p - '0');
+            if (mantissa != 0) digits++;
+        } else {
+            exponent++;
+            if (*p != '0') exact = 0;
+        }
+        p++;
+    }
+
+    if (p < end && *p == '.') {
+        is_double = 1;
+        p++;
+        if (p >= end || *p < '0' || *p > '9') return NULL;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (digits < NX_JSON_INT_DIGITS) {
+                mantissa = mantissa * 10 + (*p - '0');
+                exponent--;
+                if (mantissa != 0) digits++;
+            } else if (*p != '0') {
+                exact = 0;
+            }
+            p++;
+        }
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        is_double = 1;
+        p++;
+        i = 1;
+        if (p < end && (*p == '+' || *p == '-')) {
+            if (*p == '-') i = -1;
+            p++;
+        }
+        if (p >= end || *p < '0' || *p > '9') return NULL;
+        while (p < end && *p >= '0' && *p <= '9') {
+            if (exponent_value < 100000) {
+                exponent_value = exponent_value * 10 + (*p - '0');
+            }
+            p++;
+        }
+        exponent_value = i * exponent_value;
+        exponent += exponent_value;
+    }
+
+    if (is_double == 0 && exact && exponent == 0) {
+        // Integer fast path, the usual case for forecast.solar Wh counts
+        if (negative) mantissa = -mantissa;
+        *type = NX_JSON_INTEGER;
+        *integer = mantissa;
+        *number = (double)mantissa;
+        return p;
+    }
+
+    *type = NX_JSON_DOUBLE;
+    *integer = 0;
+    if (exact && mantissa <= NX_JSON_EXACT_MANTISSA && exponent >= -22 && exponent <= 22) {
+        // Powers of ten up to 1e22 are exact, so a single rounding happens
+        value = (double)mantissa;
+        scale = 1;
+        for (i = 0; i < exponent || i < -exponent; i++) {
+            scale = scale * 10;
+        }
+        if (exponent < 0) {
+            value = value / scale;
+        } else {
+            value = value * scale;
+        }
+        if (negative) value = -value;
+        *number = value;
+        return p;
+    }
+
+    // Slow path, the input may end right after the number so atof gets a copy.
+    // The copy keeps the leading NX_JSON_NUMBER_DIGITS significant digits as
+    // "<digits>e<exponent>", further digits cannot change the double.
+    q = start;
+    n = 0;
+    kept = 0;
+    if (*q == '-') {
+        copy[n++] = '-';
+        q++;
+    }
+    while (q < p && *q >= '0' && *q <= '9') {
+        if (kept >= NX_JSON_NUMBER_DIGITS) {
+            exponent_value++;
+        } else if (kept > 0 || *q != '0') {
+            copy[n++] = *q;
+            kept++;
+        }
+        q++;
+    }
+    if (q < p && *q == '.') {
+        q++;
+        while (q < p && *q >= '0' && *q <= '9') {
+            if (kept < NX_JSON_NUMBER_DIGITS) {
+                if (kept > 0 || *q != '0') {
+                    copy[n++] = *q;
+                    kept++;
+                }
+                exponent_value--;
+            }
+            q++;
+        }
+    }
+    if (kept == 0) copy[n++] = '0';
+    copy[n++] = 'e';
+    if (exponent_value < 0) {
+        copy[n++] = '-';
+        exponent_value = -exponent_value;
+    }
+    q = copy + n;
+    do {
+        copy[n++] = (char)('0' + exponent_value % 10);
+        exponent_value = exponent_value / 10;
+    } while (exponent_value > 0);
+    copy[n] = '\0';
+    // Digits were written lowest first
+    for (i = 0; q + i < copy + n - 1 - i; i++) {
+        c = q[i];
+        q[i] = copy[n - 1 - i];
+        copy[n - 1 - i] = c;
+    }
+    *number = atof(copy);
+    return p;
+}
+
+// Pointer past the closing quote of the string at p, or NULL
+char *nx_json_scan_string_end(char *p, char *end) {
+    p = nx_json_scan_quote(p + 1, end);
+    while (p + 1 < end && *p == '\\') {
+        p = nx_json_scan_quote(p + 2, end);
+    }
+    if (p >= end || *p != '"') return NULL;
+    return p + 1;
+}
+
+// Pointer past the value at p, nested objects and arrays are skipped by bracket depth
+char *nx_json_scan_value_end(char *p, char *end) {
+    int depth = 0;
+
+    if (*p == '"') {
+        return nx_json_scan_string_end(p, end);
+    }
+
+    if (*p != '{' && *p != '[') {
+        // Scalar, runs until a delimiter
+        while (p < end && *p != ',' && *p != '}' && *p != ']' &&
+               *p != ' ' && *p != '\t' && *p != '\n' && *p != '\r') {
+            p++;
+        }
+        return p;
+    }
+
+    while (p < end) {
+        p = nx_json_scan_structural(p, end);
+        if (p >= end) break;
+        if (*p == '"') {
+            p = nx_json_scan_string_end(p, end);
+            if (p == NULL) return NULL;
+            continue;
+        }
+        if (*p == '{' || *p == '[') {
+            depth++;
+        } else if (*p == '}' || *p == ']') {
+            depth--;
+            if (depth == 0) return p + 1;
+        }
+        p++;
+    }
+    return NULL;
+}
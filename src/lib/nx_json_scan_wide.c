@@ -0,0 +1,156 @@
+#include <string.h>
+#include <stdint.h>
+#include "nx_json.h"
+
+// Wide scanning kernels for host builds, nx_json_scan.c has the byte loops the
+// PicoC bundle uses. CMake adds this file with NX_JSON_SCAN_WIDE for GCC and
+// Clang on little-endian targets: 16 bytes per step with SSE2, 8 bytes per step
+// with word arithmetic where SSE2 is missing.
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#ifdef __SSE2__
+
+// Number of whitespace bytes at p
+int nx_json_scan_space(char *p, char *end) {
+    char *s = p;
+    __m128i chunk;
+    int mask;
+
+    // Most runs are empty or a single separator, only go wide for indentation
+    if (s >= end || (*s != ' ' && *s != '\t' && *s != '\n' && *s != '\r')) return 0;
+    s++;
+    while (end - s >= 16) {
+        chunk = _mm_loadu_si128((__m128i *)s);
+        mask = _mm_movemask_epi8(_mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\t'))),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r')))));
+        if (mask != 0xFFFF) {
+            return s - p + __builtin_ctz(~mask);
+        }
+        s += 16;
+    }
+    while (s < end && (*s == ' ' || *s == '\t' || *s == '\n' || *s == '\r')) {
+        s++;
+    }
+    return s - p;
+}
+
+// First '"' or '\\' at or after p, end if there is none
+char *nx_json_scan_quote(char *p, char *end) {
+    __m128i chunk;
+    int mask;
+
+    while (end - p >= 16) {
+        chunk = _mm_loadu_si128((__m128i *)p);
+        mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')),
+                                              _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\'))));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+    while (p < end && *p != '"' && *p != '\\') {
+        p++;
+    }
+    return p;
+}
+
+// First '"', '{', '}', '[' or ']' at or after p, end if there is none.
+// Setting bit 5 folds '[' onto '{' and ']' onto '}'.
+char *nx_json_scan_structural(char *p, char *end) {
+    __m128i chunk;
+    __m128i folded;
+    int mask;
+
+    while (end - p >= 16) {
+        chunk = _mm_loadu_si128((__m128i *)p);
+        folded = _mm_or_si128(chunk, _mm_set1_epi8(0x20));
+        mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')),
+            _mm_or_si128(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')), _mm_cmpeq_epi8(folded, _mm_set1_epi8('}')))));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+    while (p < end && *p != '"' && *p != '{' && *p != '}' && *p != '[' && *p != ']') {
+        p++;
+    }
+    return p;
+}
+
+#else
+
+#define NX_JSON_SCAN_ONES 0x0101010101010101ULL
+#define NX_JSON_SCAN_LOW7 0x7F7F7F7F7F7F7F7FULL
+#define NX_JSON_SCAN_HIGH 0x8080808080808080ULL
+
+// High bit of each byte of word that equals c, exact for every byte
+uint64_t nx_json_scan_eq(uint64_t word, int c) {
+    uint64_t x = word ^ (NX_JSON_SCAN_ONES * (unsigned char)c);
+    return ~(((x & NX_JSON_SCAN_LOW7) + NX_JSON_SCAN_LOW7) | x) & NX_JSON_SCAN_HIGH;
+}
+
+int nx_json_scan_space(char *p, char *end) {
+    char *s = p;
+    uint64_t word;
+    uint64_t other;
+
+    if (s >= end || (*s != ' ' && *s != '\t' && *s != '\n' && *s != '\r')) return 0;
+    s++;
+    while (end - s >= 8) {
+        memcpy(&word, s, 8);
+        other = ~(nx_json_scan_eq(word, ' ') | nx_json_scan_eq(word, '\t') |
+                  nx_json_scan_eq(word, '\n') | nx_json_scan_eq(word, '\r')) & NX_JSON_SCAN_HIGH;
+        if (other != 0) {
+            return s - p + __builtin_ctzll(other) / 8;
+        }
+        s += 8;
+    }
+    while (s < end && (*s == ' ' || *s == '\t' || *s == '\n' || *s == '\r')) {
+        s++;
+    }
+    return s - p;
+}
+
+char *nx_json_scan_quote(char *p, char *end) {
+    uint64_t word;
+    uint64_t hit;
+
+    while (end - p >= 8) {
+        memcpy(&word, p, 8);
+        hit = nx_json_scan_eq(word, '"') | nx_json_scan_eq(word, '\\');
+        if (hit != 0) {
+            return p + __builtin_ctzll(hit) / 8;
+        }
+        p += 8;
+    }
+    while (p < end && *p != '"' && *p != '\\') {
+        p++;
+    }
+    return p;
+}
+
+char *nx_json_scan_structural(char *p, char *end) {
+    uint64_t word;
+    uint64_t folded;
+    uint64_t hit;
+
+    while (end - p >= 8) {
+        memcpy(&word, p, 8);
+        folded = word | (NX_JSON_SCAN_ONES * 0x20);
+        hit = nx_json_scan_eq(word, '"') | nx_json_scan_eq(folded, '{') | nx_json_scan_eq(folded, '}');
+        if (hit != 0) {
+            return p + __builtin_ctzll(hit) / 8;
+        }
+        p += 8;
+    }
+    while (p < end && *p != '"' && *p != '{' && *p != '}' && *p != '[' && *p != ']') {
+        p++;
+    }
+    return p;
+}
+
+#endif
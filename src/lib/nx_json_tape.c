@@ -0,0 +1,302 @@
+// Check if we're using a standard C compiler
+#ifndef PICO_C
+#include <stdlib.h>
+#include <string.h>
+#include "nx_json.h"
+#endif
+
+// Tape DOM: the document as one contiguous array of small entries instead of
+// pointer-linked nodes. Children follow their container, so the first child
+// is the next entry and the sibling after a container is found through the
+// end index the container records when it closes.
+
+// Prepare a tape, a caller buffer is used as is and never grows
+void nx_json_tape_init(struct nx_json_tape *tape, struct nx_json_tape_entry *entries, int capacity) {
+    tape->entries = NULL;
+    tape->capacity = 0;
+    tape->owned = 1;
+    if (entries != NULL && capacity > 0) {
+        tape->entries = entries;
+        tape->capacity = capacity;
+        tape->owned = 0;
+    }
+    tape->count = 0;
+    tape->input = NULL;
+    tape->error = NX_JSON_OK;
+    tape->error_offset = 0;
+}
+
+// Release entries allocated by the tape, a caller buffer is kept
+void nx_json_tape_free(struct nx_json_tape *tape) {
+    if (tape->owned && tape->entries != NULL) {
+        free(tape->entries);
+        tape->entries = NULL;
+        tape->capacity = 0;
+    }
+    tape->count = 0;
+}
+
+// Record the first error of a parse at p
+void nx_json_tape_fail(struct nx_json_tape *tape, enum nx_json_error error, char *p) {
+    if (tape->error != NX_JSON_OK) return;
+    tape->error = error;
+    tape->error_offset = p - tape->input;
+}
+
+// Append an entry, doubling owned entries when full. Entries may move, so
+// callers hold indexes rather than pointers across appends. Returns -1 when full.
+int nx_json_tape_append(struct nx_json_tape *tape, enum nx_json_type type, int key, int key_length) {
+    struct nx_json_tape_entry *entries;
+    struct nx_json_tape_entry *entry;
+    int capacity;
+
+    if (tape->count == tape->capacity) {
+        if (tape->owned == 0) return -1;
+        capacity = tape->capacity * 2;
+        if (capacity == 0) capacity = NX_JSON_TAPE_CHUNK;
+        entries = (struct nx_json_tape_entry *)realloc(tape->entries, capacity * sizeof(struct nx_json_tape_entry));
+        if (entries == NULL) return -1;
+        tape->entries = entries;
+        tape->capacity = capacity;
+    }
+
+    entry = &tape->entries[tape->count];
+    entry->type = type;
+    entry->key = key;
+    entry->key_length = key_length;
+    entry->length = 0;
+    entry->u.end = 0;
+    return tape->count++;
+}
+
+// Parse a value that is not a container into entry, returns the end of the value or NULL
+char *nx_json_tape_scalar(struct nx_json_tape *tape, struct nx_json_tape_entry *entry, char *p, char *end) {
+    char *value_end;
+    double number;
+    NX_JSON_INT integer;
+
+    if (*p == '"') {
+        value_end = nx_json_scan_string_end(p, end);
+        if (value_end == NULL) {
+            nx_json_tape_fail(tape, NX_JSON_ERROR_UNTERMINATED_STRING, p);
+            return NULL;
+        }
+        entry->type = NX_JSON_STRING;
+        entry->u.text = p + 1 - tape->input;
+        entry->length = value_end - p - 2;
+        return value_end;
+    }
+
+    if (*p == 't' || *p == 'f' || *p == 'n') {
+        if (end - p >= 4 && memcmp(p, "true", 4) == 0) {
+            entry->type = NX_JSON_BOOL;
+            entry->u.number_value = 1;
+            return p + 4;
+        }
+        if (end - p >= 5 && memcmp(p, "false", 5) == 0) {
+            entry->type = NX_JSON_BOOL;
+            entry->u.number_value = 0;
+            return p + 5;
+        }
+        if (end - p >= 4 && memcmp(p, "null", 4) == 0) {
+            entry->type = NX_JSON_NULL;
+            return p + 4;
+        }
+        nx_json_tape_fail(tape, NX_JSON_ERROR_UNEXPECTED_CHARACTER, p);
+        return NULL;
+    }
+
+    if (*p != '-' && (*p < '0' || *p > '9')) {
+        nx_json_tape_fail(tape, NX_JSON_ERROR_UNEXPECTED_CHARACTER, p);
+        return NULL;
+    }
+    value_end = nx_json_scan_number(p, end, &entry->type, &number, &integer);
+    if (value_end == NULL) {
+        nx_json_tape_fail(tape, NX_JSON_ERROR_INVALID_NUMBER, p);
+        return NULL;
+    }
+    if (entry->type == NX_JSON_INTEGER) {
+        entry->u.int_value = integer;
+    } else {
+        entry->u.number_value = number;
+    }
+    return value_end;
+}
+
+// Parse a document that does not need to be NUL-terminated onto the tape,
+// replacing what it held. Returns the root entry, or NULL with the error recorded.
+struct nx_json_tape_entry *nx_json_tape_parse(struct nx_json_tape *tape, char *text, int length) {
+    int stack[MAX_NESTING_DEPTH];  // Indexes of the open containers
+    int depth = 0;
+    int member = 1;      // A member or item is expected, after an opening bracket or a comma
+    struct nx_json_tape_entry *parent;
+    char *end = text + length;
+    char *p = text;
+    char *key_end;
+    int key;
+    int key_length;
+    int index;
+
+    tape->count = 0;
+    tape->input = text;
+    tape->error = NX_JSON_OK;
+    tape->error_offset = 0;
+    if (text == NULL) {
+        tape->error = NX_JSON_ERROR_UNEXPECTED_END;
+        return NULL;
+    }
+
+    p += nx_json_scan_space(p, end);
+    if (p >= end || *p != '{') {
+        nx_json_tape_fail(tape, NX_JSON_ERROR_NOT_OBJECT, p);
+        return NULL;
+    }
+    if (nx_json_tape_append(tape, NX_JSON_ROOT, -1, 0) < 0) {
+        nx_json_tape_fail(tape, NX_JSON_ERROR_NODES_FULL, p);
+        return NULL;
+    }
+    stack[depth++] = 0;
+    p++;
+
+    while (depth > 0) {
+        p += nx_json_scan_space(p, end);
+        if (p >= end) {
+            nx_json_tape_fail(tape, NX_JSON_ERROR_UNEXPECTED_END, p);
+            return NULL;
+        }
+        parent = &tape->entries[stack[depth - 1]];
+
+        // After a value a comma or the closing bracket follows, empty containers close right away
+        if (member == 0 || (parent->length == 0 && (*p == '}' || *p == ']'))) {
+            if (*p == ',' && member == 0) {
+                member = 1;
+                p++;
+            } else if ((*p == '}' && parent->type != NX_JSON_ARRAY) || (*p == ']' && parent->type == NX_JSON_ARRAY)) {
+                parent->u.end = tape->count;
+                depth--;
+                member = 0;
+                p++;
+            } else if (*p == '}' || *p == ']') {
+                nx_json_tape_fail(tape, NX_JSON_ERROR_MISMATCHED_BRACKET, p);
+                return NULL;
+            } else {
+                nx_json_tape_fail(tape, NX_JSON_ERROR_EXPECTED_SEPARATOR, p);
+                return NULL;
+            }
+            continue;
+        }
+
+        // Object members start with a key, array items do not
+        key = -1;
+        key_length = 0;
+        if (parent->type != NX_JSON_ARRAY) {
+            if (*p != '"') {
+                nx_json_tape_fail(tape, NX_JSON_ERROR_EXPECTED_KEY, p);
+                return NULL;
+            }
+            key_end = nx_json_scan_string_end(p, end);
+            if (key_end == NULL) {
+                nx_json_tape_fail(tape, NX_JSON_ERROR_UNTERMINATED_STRING, p);
+                return NULL;
+            }
+            key = p + 1 - text;
+            key_length = key_end - p - 2;
+            p = key_end + nx_json_scan_space(key_end, end);
+            if (p >= end || *p != ':') {
+                nx_json_tape_fail(tape, NX_JSON_ERROR_EXPECTED_COLON, p);
+                return NULL;
+            }
+            p++;
+            p += nx_json_scan_space(p, end);
+            if (p >= end) {
+                nx_json_tape_fail(tape, NX_JSON_ERROR_UNEXPECTED_END, p);
+                return NULL;
+            }
+        }
+
+        parent->length++;
+        index = nx_json_tape_append(tape, NX_JSON_NULL, key, key_length);
+        if (index < 0) {
+            nx_json_tape_fail(tape, NX_JSON_ERROR_NODES_FULL, p);
+            return NULL;
+        }
+
+        if (*p == '{' || *p == '[') {
+            if (depth >= MAX_NESTING_DEPTH) {
+                nx_json_tape_fail(tape, NX_JSON_ERROR_TOO_DEEP, p);
+                return NULL;
+            }
+            if (*p == '{') {
+                tape->entries[index].type = NX_JSON_OBJECT;
+            } else {
+                tape->entries[index].type = NX_JSON_ARRAY;
+            }
+            stack[depth++] = index;
+            member = 1;
+            p++;
+            continue;
+        }
+
+        p = nx_json_tape_scalar(tape, &tape->entries[index], p, end);
+        if (p == NULL) return NULL;
+        member = 0;
+    }
+
+    return &tape->entries[0];
+}
+
+// Entry after entry and its descendants, the next sibling if it has one
+struct nx_json_tape_entry *nx_json_tape_next(struct nx_json_tape *tape, struct nx_json_tape_entry *entry) {
+    if (entry->type == NX_JSON_OBJECT || entry->type == NX_JSON_ARRAY || entry->type == NX_JSON_ROOT) {
+        return &tape->entries[entry->u.end];
+    }
+    return entry + 1;
+}
+
+// Get a child entry by key from an object
+struct nx_json_tape_entry *nx_json_tape_get(struct nx_json_tape *tape, struct nx_json_tape_entry *json, char *key) {
+    struct nx_json_tape_entry *child;
+    int key_length;
+    int i;
+
+    if (json == NULL || key == NULL) return NULL;
+    if (json->type != NX_JSON_OBJECT && json->type != NX_JSON_ROOT) return NULL;
+
+    key_length = strlen(key);
+    child = json + 1;
+    for (i = 0; i < json->length; i++) {
+        if (child->key_length == key_length && memcmp(tape->input + child->key, key, key_length) == 0) {
+            return child;
+        }
+        child = nx_json_tape_next(tape, child);
+    }
+    return NULL;
+}
+
+// Get an item of an array by index
+struct nx_json_tape_entry *nx_json_tape_item(struct nx_json_tape *tape, struct nx_json_tape_entry *json, int idx) {
+    struct nx_json_tape_entry *child;
+    int i;
+
+    if (json == NULL || json->type != NX_JSON_ARRAY) return NULL;
+    if (idx < 0 || idx >= json->length) return NULL;
+
+    // Items without nested containers are one entry each and can be addressed directly
+    if (json->u.end - (json - tape->entries) - 1 == json->length) {
+        return json + 1 + idx;
+    }
+
+    child = json + 1;
+    for (i = 0; i < idx; i++) {
+        child = nx_json_tape_next(tape, child);
+    }
+    return child;
+}
+
+// Numeric value of an integer, double or bool entry, 0 for other types
+double nx_json_tape_number(struct nx_json_tape_entry *entry) {
+    if (entry == NULL) return 0;
+    if (entry->type == NX_JSON_INTEGER) return (double)entry->u.int_value;
+    if (entry->type == NX_JSON_DOUBLE || entry->type == NX_JSON_BOOL) return entry->u.number_value;
+    return 0;
+}
@@ -0,0 +1,239 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "nx_json.h"
+
+int test_count = 0;
+
+// Function to read the entire contents of a file into a string
+char* read_file(const char* filename) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        perror("Could not open file");
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *content = (char *)malloc(length + 1);
+    if (!content) {
+        perror("Could not allocate memory");
+        fclose(file);
+        return NULL;
+    }
+
+    size_t read_size = fread(content, 1, length, file);
+    content[read_size] = '\0';
+    fclose(file);
+
+    return content;
+}
+
+// Compare a tape subtree with the same subtree parsed by nx_json_parse in slice mode
+void compare_tree(struct nx_json_tape *tape, struct nx_json_tape_entry *entry, struct nx_json *node) {
+    struct nx_json_tape_entry *child;
+    struct nx_json *node_child;
+    int i;
+
+    assert(entry->type == node->type);
+    if (node->key != NULL) {
+        assert(entry->key_length == node->key_length);
+        assert(memcmp(tape->input + entry->key, node->key, node->key_length) == 0);
+    } else {
+        assert(entry->key == -1);
+    }
+    test_count += 2;
+
+    if (node->type == NX_JSON_STRING) {
+        assert(entry->length == node->text_length);
+        assert(memcmp(tape->input + entry->u.text, node->u.text_value, node->text_length) == 0);
+        test_count += 2;
+    } else if (node->type == NX_JSON_INTEGER) {
+        assert(entry->u.int_value == node->u.int_value);
+        test_count += 1;
+    } else if (node->type == NX_JSON_DOUBLE || node->type == NX_JSON_BOOL) {
+        assert(nx_json_tape_number(entry) == nx_json_number(node));
+        test_count += 1;
+    } else if (node->type != NX_JSON_NULL) {
+        assert(entry->length == node->u.children.length);
+        test_count += 1;
+        child = entry + 1;
+        node_child = node->u.children.first;
+        for (i = 0; i < entry->length; i++) {
+            compare_tree(tape, child, node_child);
+            child = nx_json_tape_next(tape, child);
+            node_child = node_child->next;
+        }
+        assert(child == &tape->entries[entry->u.end]);
+        test_count += 1;
+    }
+}
+
+void test_tape_matches_dom(char *path) {
+    printf("Testing the tape against nx_json_parse with %s...\n", path);
+
+    char *text = read_file(path);
+    assert(text != NULL);
+
+    struct nx_json_ctx ctx;
+    nx_json_ctx_init(&ctx, NULL, 0, NULL, 0);
+    ctx.flags = NX_JSON_SLICE;
+    struct nx_json *root = nx_json_ctx_parse(&ctx, text);
+    assert(root != NULL);
+
+    struct nx_json_tape tape;
+    nx_json_tape_init(&tape, NULL, 0);
+    assert(nx_json_tape_parse(&tape, text, strlen(text)) == &tape.entries[0]);
+    assert(tape.error == NX_JSON_OK);
+    assert(tape.count == ctx.stats.nodes);
+    test_count += 3;
+
+    compare_tree(&tape, &tape.entries[0], root);
+
+    nx_json_tape_free(&tape);
+    nx_json_ctx_free(&ctx);
+    free(text);
+    printf("Tape matches nx_json_parse\n\n");
+}
+
+void test_tape_lookups() {
+    printf("Testing nx_json_tape_get and nx_json_tape_item...\n");
+
+    char *text = read_file(MOCK_JSON_PATH);
+    assert(text != NULL);
+
+    struct nx_json_tape tape;
+    nx_json_tape_init(&tape, NULL, 0);
+    struct nx_json_tape_entry *root = nx_json_tape_parse(&tape, text, strlen(text));
+    assert(root != NULL);
+
+    struct nx_json_tape_entry *scalars = nx_json_tape_get(&tape, root, "scalar_values");
+    assert(scalars != NULL && scalars->type == NX_JSON_OBJECT);
+    assert(nx_json_tape_get(&tape, scalars, "integer")->u.int_value == 42);
+    assert(nx_json_tape_number(nx_json_tape_get(&tape, scalars, "float")) == 3.14159);
+    assert(nx_json_tape_number(nx_json_tape_get(&tape, scalars, "boolean_true")) == 1);
+    assert(nx_json_tape_get(&tape, scalars, "null_value")->type == NX_JSON_NULL);
+    assert(nx_json_tape_get(&tape, scalars, "missing") == NULL);
+    test_count += 6;
+
+    // Keys after skipped subtrees
+    assert(nx_json_tape_get(&tape, root, "mixed_array")->length == 5);
+    struct nx_json_tape_entry *nested = nx_json_tape_get(&tape, nx_json_tape_get(&tape, root, "simple_object"), "nested_object");
+    assert(nx_json_tape_get(&tape, nested, "nested_key")->length == 12);
+    test_count += 2;
+
+    // Flat arrays are addressed directly, arrays of containers are walked
+    struct nx_json_tape_entry *array = nx_json_tape_get(&tape, root, "simple_array");
+    assert(nx_json_tape_item(&tape, array, 0)->u.int_value == 1);
+    assert(nx_json_tape_item(&tape, array, 4)->u.int_value == 5);
+    assert(nx_json_tape_item(&tape, array, 5) == NULL);
+    assert(nx_json_tape_item(&tape, array, -1) == NULL);
+    struct nx_json_tape_entry *objects = nx_json_tape_get(&tape, root, "array_of_objects");
+    assert(nx_json_tape_get(&tape, nx_json_tape_item(&tape, objects, 1), "id")->u.int_value == 2);
+    struct nx_json_tape_entry *mixed = nx_json_tape_get(&tape, root, "mixed_array");
+    assert(nx_json_tape_get(&tape, nx_json_tape_item(&tape, mixed, 4), "key")->type == NX_JSON_STRING);
+    test_count += 6;
+
+    // Wrong types and NULL
+    assert(nx_json_tape_get(&tape, array, "0") == NULL);
+    assert(nx_json_tape_item(&tape, scalars, 0) == NULL);
+    assert(nx_json_tape_get(&tape, NULL, "a") == NULL);
+    assert(nx_json_tape_item(&tape, NULL, 0) == NULL);
+    test_count += 4;
+
+    nx_json_tape_free(&tape);
+    free(text);
+    printf("Tape lookup tests completed\n\n");
+}
+
+void test_tape_memory() {
+    printf("Testing tape memory use...\n");
+
+    // An entry is well under half of a node
+    assert(sizeof(struct nx_json_tape_entry) * 2 <= sizeof(struct nx_json));
+    test_count += 1;
+
+    // A caller buffer never grows, running out is an error
+    struct nx_json_tape_entry entries[4];
+    struct nx_json_tape tape;
+    nx_json_tape_init(&tape, entries, 4);
+    char fits[] = "{\"a\":[1,2]}";
+    assert(nx_json_tape_parse(&tape, fits, strlen(fits)) == &entries[0]);
+    assert(tape.count == 4);
+    char full[] = "{\"a\":[1,2,3]}";
+    assert(nx_json_tape_parse(&tape, full, strlen(full)) == NULL);
+    assert(tape.error == NX_JSON_ERROR_NODES_FULL);
+    assert(tape.error_offset == 10);
+    nx_json_tape_free(&tape);
+    assert(tape.entries == entries);
+    test_count += 6;
+
+    // Owned entries grow past the first chunk
+    char *big = (char *)malloc(NX_JSON_TAPE_CHUNK * 8 + 16);
+    char *p = big;
+    int i;
+    p += sprintf(p, "{\"a\":[");
+    for (i = 0; i < NX_JSON_TAPE_CHUNK * 2; i++) {
+        p += sprintf(p, "%d,", i);
+    }
+    sprintf(p - 1, "]}");
+    nx_json_tape_init(&tape, NULL, 0);
+    struct nx_json_tape_entry *root = nx_json_tape_parse(&tape, big, strlen(big));
+    assert(root != NULL);
+    assert(tape.count == NX_JSON_TAPE_CHUNK * 2 + 2);
+    assert(tape.capacity >= tape.count);
+    assert(nx_json_tape_item(&tape, nx_json_tape_get(&tape, root, "a"), NX_JSON_TAPE_CHUNK * 2 - 1)->u.int_value ==
+           NX_JSON_TAPE_CHUNK * 2 - 1);
+    test_count += 4;
+    nx_json_tape_free(&tape);
+    free(big);
+
+    printf("Tape memory tests completed\n\n");
+}
+
+void test_tape_errors() {
+    printf("Testing tape error handling...\n");
+
+    struct nx_json_tape tape;
+    nx_json_tape_init(&tape, NULL, 0);
+
+    assert(nx_json_tape_parse(&tape, NULL, 0) == NULL);
+    assert(nx_json_tape_parse(&tape, "[1]", 3) == NULL && tape.error == NX_JSON_ERROR_NOT_OBJECT);
+    assert(nx_json_tape_parse(&tape, "{\"a\":1", 6) == NULL && tape.error == NX_JSON_ERROR_UNEXPECTED_END);
+    assert(nx_json_tape_parse(&tape, "{\"a\" 1}", 7) == NULL && tape.error == NX_JSON_ERROR_EXPECTED_COLON);
+    assert(tape.error_offset == 5);
+    assert(nx_json_tape_parse(&tape, "{1:1}", 5) == NULL && tape.error == NX_JSON_ERROR_EXPECTED_KEY);
+    assert(nx_json_tape_parse(&tape, "{\"a\":[1}", 8) == NULL && tape.error == NX_JSON_ERROR_MISMATCHED_BRACKET);
+    assert(nx_json_tape_parse(&tape, "{\"a\":1 2}", 9) == NULL && tape.error == NX_JSON_ERROR_EXPECTED_SEPARATOR);
+    assert(nx_json_tape_parse(&tape, "{\"a\":[1,]}", 10) == NULL && tape.error == NX_JSON_ERROR_UNEXPECTED_CHARACTER);
+    assert(nx_json_tape_parse(&tape, "{\"a\":\"open}", 11) == NULL && tape.error == NX_JSON_ERROR_UNTERMINATED_STRING);
+    assert(nx_json_tape_parse(&tape, "{\"a\":-}", 7) == NULL && tape.error == NX_JSON_ERROR_INVALID_NUMBER);
+    assert(nx_json_tape_parse(&tape, "{\"a\":nul}", 9) == NULL && tape.error == NX_JSON_ERROR_UNEXPECTED_CHARACTER);
+    assert(nx_json_tape_parse(&tape, "{\"a\":[[[[[[[[[[1]]]]]]]]]]}", 27) == NULL && tape.error == NX_JSON_ERROR_TOO_DEEP);
+    test_count += 13;
+
+    // Empty containers and a good parse after errors
+    assert(nx_json_tape_parse(&tape, "{\"a\":{},\"b\":[]}", 15) != NULL);
+    assert(tape.count == 3 && tape.error == NX_JSON_OK);
+    assert(nx_json_tape_get(&tape, &tape.entries[0], "b")->type == NX_JSON_ARRAY);
+    test_count += 3;
+
+    nx_json_tape_free(&tape);
+    printf("Tape error handling tests completed\n\n");
+}
+
+int main() {
+    printf("Starting JSON tape tests...\n\n");
+
+    test_tape_matches_dom(MOCK_JSON_PATH);
+    test_tape_matches_dom(MOCK_RESPONSE_BODY_FILE);
+    test_tape_lookups();
+    test_tape_memory();
+    test_tape_errors();
+
+    printf("\nAll tests passed! (%d assertions)\n", test_count);
+    return 0;
+}
@@ -0,0 +1,136 @@
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "nx_json.h"
+
+// Formatting cost of the inverter state record of updateInverterState as JSON,
+// written with nx_json_writer and with one sprintf call. Prints one line per method:
+//
+//   bench=<writer|sprintf> records=<n> bytes=<n> ns_per_record=<f>
+
+#define RECORDS 1000000
+
+double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Inputs of one controller tick, varied per record so nothing is constant folded
+struct inverter_state {
+    double current_price;
+    double min_price;
+    double max_price;
+    double charge_threshold;
+    double discharge_threshold;
+    double soc_discharge_threshold;
+    char *mode;
+    double pv_today;
+    double pv_tomorrow;
+    double pv_threshold;
+    double price_threshold;
+    double soc;
+    int hour;
+    int battery_limit;
+    int grid_limit;
+    double soc_protection;
+    double soc_protection_user;
+    double pv_power;
+    int excess;
+};
+
+void fill_state(struct inverter_state *state, int i) {
+    state->current_price = 1.5 + (i % 100) * 0.013;
+    state->min_price = 0.82;
+    state->max_price = 4.731;
+    state->charge_threshold = 1.2;
+    state->discharge_threshold = 3.5;
+    state->soc_discharge_threshold = 60;
+    state->mode = "General";
+    state->pv_today = 4674.362 + i % 7;
+    state->pv_tomorrow = 4774.208;
+    state->pv_threshold = 10000;
+    state->price_threshold = 2.25;
+    state->soc = 50 + (i % 50) * 0.9;
+    state->hour = i % 24;
+    state->battery_limit = 10;
+    state->grid_limit = 0;
+    state->soc_protection = 20;
+    state->soc_protection_user = 15;
+    state->pv_power = 3120.5 + i % 1000;
+    state->excess = i & 1;
+}
+
+int write_record(char *buffer, int size, struct inverter_state *state) {
+    struct nx_json_writer writer;
+
+    nx_json_writer_init(&writer, buffer, size);
+    nx_json_write_object(&writer, NULL);
+    nx_json_write_double(&writer, "currentSpotPrice", state->current_price, 3);
+    nx_json_write_double(&writer, "minSpotPrice", state->min_price, 3);
+    nx_json_write_double(&writer, "maxSpotPrice", state->max_price, 3);
+    nx_json_write_double(&writer, "chargeThreshold", state->charge_threshold, 3);
+    nx_json_write_double(&writer, "dischargeThreshold", state->discharge_threshold, 3);
+    nx_json_write_double(&writer, "socDischargeToGridThreshold", state->soc_discharge_threshold, 1);
+    nx_json_write_string(&writer, "currentInverterMode", state->mode);
+    nx_json_write_double(&writer, "predictedPVToday", state->pv_today, 3);
+    nx_json_write_double(&writer, "predictedPVTomorrow", state->pv_tomorrow, 3);
+    nx_json_write_double(&writer, "pvProductionThreshold", state->pv_threshold, 1);
+    nx_json_write_double(&writer, "spotPriceThreshold", state->price_threshold, 3);
+    nx_json_write_double(&writer, "soc", state->soc, 1);
+    nx_json_write_int(&writer, "hour", state->hour);
+    nx_json_write_int(&writer, "batteryPowerLimit", state->battery_limit);
+    nx_json_write_int(&writer, "gridInjectionPowerLimit", state->grid_limit);
+    nx_json_write_double(&writer, "onGridSOCProtection", state->soc_protection, 1);
+    nx_json_write_double(&writer, "onGridSOCProtectionUserSetting", state->soc_protection_user, 1);
+    nx_json_write_double(&writer, "pvPowerNow", state->pv_power, 1);
+    nx_json_write_bool(&writer, "excessEnergyAvailable", state->excess);
+    nx_json_write_end(&writer);
+    return writer.length;
+}
+
+int sprintf_record(char *buffer, struct inverter_state *state) {
+    return sprintf(buffer,
+                   "{\"currentSpotPrice\":%.3f,\"minSpotPrice\":%.3f,\"maxSpotPrice\":%.3f,\"chargeThreshold\":%.3f,"
+                   "\"dischargeThreshold\":%.3f,\"socDischargeToGridThreshold\":%.1f,\"currentInverterMode\":\"%s\","
+                   "\"predictedPVToday\":%.3f,\"predictedPVTomorrow\":%.3f,\"pvProductionThreshold\":%.1f,"
+                   "\"spotPriceThreshold\":%.3f,\"soc\":%.1f,\"hour\":%d,\"batteryPowerLimit\":%d,"
+                   "\"gridInjectionPowerLimit\":%d,\"onGridSOCProtection\":%.1f,\"onGridSOCProtectionUserSetting\":%.1f,"
+                   "\"pvPowerNow\":%.1f,\"excessEnergyAvailable\":%s}",
+                   state->current_price, state->min_price, state->max_price, state->charge_threshold,
+                   state->discharge_threshold, state->soc_discharge_threshold, state->mode,
+                   state->pv_today, state->pv_tomorrow, state->pv_threshold,
+                   state->price_threshold, state->soc, state->hour, state->battery_limit,
+                   state->grid_limit, state->soc_protection, state->soc_protection_user,
+                   state->pv_power, state->excess ? "true" : "false");
+}
+
+int main() {
+    struct inverter_state state;
+    char buffer[1024];
+    double start;
+    double elapsed;
+    long bytes;
+    int method;
+    int i;
+
+    for (method = 0; method < 2; method++) {
+        bytes = 0;
+        start = now_ns();
+        for (i = 0; i < RECORDS; i++) {
+            fill_state(&state, i);
+            if (method == 0) {
+                bytes += write_record(buffer, sizeof(buffer), &state);
+            } else {
+                bytes += sprintf_record(buffer, &state);
+            }
+        }
+        elapsed = now_ns() - start;
+
+        printf("bench=%s records=%d bytes=%ld ns_per_record=%.1f\n",
+               method == 0 ? "writer" : "sprintf", RECORDS, bytes / RECORDS, elapsed / RECORDS);
+    }
+    return 0;
+}
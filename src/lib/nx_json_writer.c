@@ -0,0 +1,269 @@
+// Check if we're using a standard C compiler
+#ifndef PICO_C
+#include <stdio.h>
+#include <string.h>
+#include "nx_json.h"
+#endif
+
+// JSON writer into a fixed caller buffer. Numbers are formatted by hand, only
+// doubles beyond the exact integer range fall back to sprintf. Output goes out
+// in runs with one bounds check each rather than byte by byte.
+
+// Start writing into buffer, which holds size bytes including the NUL
+void nx_json_writer_init(struct nx_json_writer *writer, char *buffer, int size) {
+    writer->buffer = buffer;
+    writer->size = size;
+    writer->length = 0;
+    writer->overflow = 0;
+    writer->full = 0;
+    writer->depth = 0;
+    writer->count[0] = 0;
+    writer->mark_length = 0;
+    writer->mark_depth = 0;
+    writer->mark_count = 0;
+    if (size > 0) buffer[0] = '\0';
+}
+
+// Remember the current position, e.g. before a record that may not fit
+void nx_json_writer_mark(struct nx_json_writer *writer) {
+    writer->mark_length = writer->length;
+    writer->mark_depth = writer->depth;
+    writer->mark_count = writer->count[writer->depth];
+}
+
+// Drop everything written since the last mark and clear the overflow
+void nx_json_writer_rollback(struct nx_json_writer *writer) {
+    writer->length = writer->mark_length;
+    writer->depth = writer->mark_depth;
+    writer->count[writer->depth] = writer->mark_count;
+    writer->overflow = 0;
+    writer->full = 0;
+    if (writer->size > 0) writer->buffer[writer->length] = '\0';
+}
+
+// Append one byte if it fits before the reserved closing brackets and the NUL
+void nx_json_put(struct nx_json_writer *writer, char c) {
+    if (writer->length + writer->depth + 2 > writer->size) {
+        writer->full = 1;
+        return;
+    }
+    writer->buffer[writer->length++] = c;
+}
+
+// Append length bytes with one bounds check
+void nx_json_put_text(struct nx_json_writer *writer, char *text, int length) {
+    if (writer->length + length + writer->depth + 1 > writer->size) {
+        writer->full = 1;
+        return;
+    }
+    memcpy(writer->buffer + writer->length, text, length);
+    writer->length += length;
+}
+
+// Append value >= 0 in decimal, padded with zeros to min_digits. Digits are
+// produced backwards into a local buffer and appended at once.
+void nx_json_put_digits(struct nx_json_writer *writer, NX_JSON_INT value, int min_digits) {
+    char digits[24];
+    int start = 24;
+
+    while (value > 0 || 24 - start < min_digits || start == 24) {
+        digits[--start] = '0' + (int)(value % 10);
+        value = value / 10;
+    }
+    nx_json_put_text(writer, digits + start, 24 - start);
+}
+
+// Append text as the contents of a JSON string, runs without escapes are copied whole
+void nx_json_put_escaped(struct nx_json_writer *writer, char *text) {
+    char *hex = "0123456789abcdef";
+    char escape[6];
+    char *run = text;
+    int c;
+
+    while (writer->full == 0) {
+        c = (unsigned char)*text;
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            text++;
+            continue;
+        }
+        if (text > run) nx_json_put_text(writer, run, text - run);
+        if (c == '\0') return;
+
+        escape[0] = '\\';
+        escape[1] = c;
+        if (c == '\n') escape[1] = 'n';
+        if (c == '\r') escape[1] = 'r';
+        if (c == '\t') escape[1] = 't';
+        if (c < 0x20 && escape[1] == c) {
+            escape[1] = 'u';
+            escape[2] = '0';
+            escape[3] = '0';
+            escape[4] = hex[c >> 4];
+            escape[5] = hex[c & 15];
+            nx_json_put_text(writer, escape, 6);
+        } else {
+            nx_json_put_text(writer, escape, 2);
+        }
+        text++;
+        run = text;
+    }
+}
+
+// Separator and key in front of a value, returns -1 if the key is misplaced
+int nx_json_write_key(struct nx_json_writer *writer, char *key) {
+    int in_object = writer->depth > 0 && writer->closer[writer->depth] == '}';
+
+    if (in_object && key == NULL) return -1;
+    if (in_object == 0 && key != NULL) return -1;
+
+    if (writer->count[writer->depth] > 0) {
+        if (writer->depth == 0) {
+            nx_json_put(writer, '\n');
+        } else {
+            nx_json_put(writer, ',');
+        }
+    }
+    if (key != NULL) {
+        nx_json_put(writer, '"');
+        nx_json_put_escaped(writer, key);
+        nx_json_put_text(writer, "\":", 2);
+    }
+    return 0;
+}
+
+// Finish an append started at length/depth, dropping it whole if it did not fit
+int nx_json_write_done(struct nx_json_writer *writer, int length, int depth) {
+    if (writer->full) {
+        writer->length = length;
+        writer->depth = depth;
+        writer->full = 0;
+        writer->overflow = 1;
+        if (writer->size > 0) writer->buffer[length] = '\0';
+        return -1;
+    }
+    writer->count[depth]++;
+    writer->buffer[writer->length] = '\0';
+    return 0;
+}
+
+// Open an object or array, its closing bracket is reserved right away
+int nx_json_write_open(struct nx_json_writer *writer, char *key, char open, char close) {
+    int length = writer->length;
+    int depth = writer->depth;
+
+    if (depth >= MAX_NESTING_DEPTH) return -1;
+    if (nx_json_write_key(writer, key) != 0) return -1;
+    writer->depth++;
+    writer->closer[writer->depth] = close;
+    writer->count[writer->depth] = 0;
+    nx_json_put(writer, open);
+    return nx_json_write_done(writer, length, depth);
+}
+
+int nx_json_write_object(struct nx_json_writer *writer, char *key) {
+    return nx_json_write_open(writer, key, '{', '}');
+}
+
+int nx_json_write_array(struct nx_json_writer *writer, char *key) {
+    return nx_json_write_open(writer, key, '[', ']');
+}
+
+// Close the innermost object or array, this always fits
+int nx_json_write_end(struct nx_json_writer *writer) {
+    if (writer->depth == 0) return -1;
+    writer->buffer[writer->length++] = writer->closer[writer->depth];
+    writer->buffer[writer->length] = '\0';
+    writer->depth--;
+    return 0;
+}
+
+int nx_json_write_string(struct nx_json_writer *writer, char *key, char *text) {
+    int length = writer->length;
+
+    if (text == NULL) return nx_json_write_null(writer, key);
+    if (nx_json_write_key(writer, key) != 0) return -1;
+    nx_json_put(writer, '"');
+    nx_json_put_escaped(writer, text);
+    nx_json_put(writer, '"');
+    return nx_json_write_done(writer, length, writer->depth);
+}
+
+int nx_json_write_int(struct nx_json_writer *writer, char *key, NX_JSON_INT value) {
+    int length = writer->length;
+
+    if (nx_json_write_key(writer, key) != 0) return -1;
+    if (value < 0) {
+        nx_json_put(writer, '-');
+        value = -value;
+    }
+    nx_json_put_digits(writer, value, 1);
+    return nx_json_write_done(writer, length, writer->depth);
+}
+
+// Write value rounded to at most decimals fraction digits, trailing zeros are
+// dropped. NaN and infinity have no JSON form and are written as null.
+int nx_json_write_double(struct nx_json_writer *writer, char *key, double value, int decimals) {
+    char text[64];
+    int length = writer->length;
+    NX_JSON_INT scale = 1;
+    NX_JSON_INT scaled;
+    NX_JSON_INT fraction;
+    double rounded;
+    int i;
+
+    if (value != value || value - value != 0) return nx_json_write_null(writer, key);
+    if (decimals < 0) decimals = 0;
+    if (decimals > NX_JSON_WRITE_MAX_DECIMALS) decimals = NX_JSON_WRITE_MAX_DECIMALS;
+    if (nx_json_write_key(writer, key) != 0) return -1;
+
+    if (value < 0) {
+        rounded = -value;
+    } else {
+        rounded = value;
+    }
+    for (i = 0; i < decimals; i++) {
+        scale = scale * 10;
+    }
+    rounded = rounded * scale + 0.5;
+
+    if (rounded >= (double)NX_JSON_EXACT_MANTISSA) {
+        // Too large to format exactly by hand, rare enough for sprintf
+        sprintf(text, "%e", value);
+        nx_json_put_text(writer, text, strlen(text));
+        return nx_json_write_done(writer, length, writer->depth);
+    }
+
+    scaled = (NX_JSON_INT)rounded;
+    if (value < 0 && scaled != 0) {
+        nx_json_put(writer, '-');
+    }
+    nx_json_put_digits(writer, scaled / scale, 1);
+    fraction = scaled % scale;
+    if (fraction != 0) {
+        while (fraction % 10 == 0) {
+            fraction = fraction / 10;
+            decimals--;
+        }
+        nx_json_put(writer, '.');
+        nx_json_put_digits(writer, fraction, decimals);
+    }
+    return nx_json_write_done(writer, length, writer->depth);
+}
+
+int nx_json_write_bool(struct nx_json_writer *writer, char *key, int value) {
+    char *text = "false";
+    int length = writer->length;
+
+    if (value) text = "true";
+    if (nx_json_write_key(writer, key) != 0) return -1;
+    nx_json_put_text(writer, text, strlen(text));
+    return nx_json_write_done(writer, length, writer->depth);
+}
+
+int nx_json_write_null(struct nx_json_writer *writer, char *key) {
+    int length = writer->length;
+
+    if (nx_json_write_key(writer, key) != 0) return -1;
+    nx_json_put_text(writer, "null", 4);
+    return nx_json_write_done(writer, length, writer->depth);
+}
@@ -0,0 +1,199 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "nx_json.h"
+
+int test_count = 0;
+
+void test_write_document() {
+    printf("Testing nx_json writer output...\n");
+
+    char buffer[256];
+    struct nx_json_writer writer;
+    nx_json_writer_init(&writer, buffer, sizeof(buffer));
+
+    assert(nx_json_write_object(&writer, NULL) == 0);
+    assert(nx_json_write_string(&writer, "mode", "Grid injection \"enabled\"") == 0);
+    assert(nx_json_write_int(&writer, "limit", -10) == 0);
+    assert(nx_json_write_double(&writer, "soc", 87.25, 3) == 0);
+    assert(nx_json_write_bool(&writer, "excess", 1) == 0);
+    assert(nx_json_write_null(&writer, "price") == 0);
+    assert(nx_json_write_array(&writer, "hours") == 0);
+    assert(nx_json_write_int(&writer, NULL, 0) == 0);
+    assert(nx_json_write_double(&writer, NULL, 1.5, 2) == 0);
+    assert(nx_json_write_object(&writer, NULL) == 0);
+    assert(nx_json_write_end(&writer) == 0);
+    assert(nx_json_write_end(&writer) == 0);
+    assert(nx_json_write_end(&writer) == 0);
+    test_count += 13;
+
+    assert(strcmp(buffer, "{\"mode\":\"Grid injection \\\"enabled\\\"\",\"limit\":-10,\"soc\":87.25,"
+                          "\"excess\":true,\"price\":null,\"hours\":[0,1.5,{}]}") == 0);
+    assert(writer.length == (int)strlen(buffer));
+    assert(writer.overflow == 0);
+    test_count += 3;
+
+    // The output parses back to the same values
+    struct nx_json *json = nx_json_parse(buffer);
+    assert(json != NULL);
+    assert(strcmp(nx_json_get(json, "mode")->u.text_value, "Grid injection \\\"enabled\\\"") == 0);
+    assert(nx_json_get(json, "limit")->u.int_value == -10);
+    assert(nx_json_number(nx_json_get(json, "soc")) == 87.25);
+    assert(nx_json_number(nx_json_item(nx_json_get(json, "hours"), 1)) == 1.5);
+    test_count += 5;
+    nx_json_reset();
+
+    // Misplaced keys and unbalanced ends are refused without writing
+    assert(nx_json_write_end(&writer) == -1);
+    assert(nx_json_write_int(&writer, "top", 1) == -1);
+    assert(nx_json_write_object(&writer, NULL) == 0);
+    assert(nx_json_write_int(&writer, NULL, 1) == -1);
+    assert(nx_json_write_array(&writer, "a") == 0);
+    assert(nx_json_write_int(&writer, "b", 1) == -1);
+    test_count += 6;
+
+    printf("Writer output tests completed\n\n");
+}
+
+void test_write_numbers() {
+    printf("Testing nx_json writer number formatting...\n");
+
+    char buffer[256];
+    struct nx_json_writer writer;
+    nx_json_writer_init(&writer, buffer, sizeof(buffer));
+
+    nx_json_write_array(&writer, NULL);
+    nx_json_write_double(&writer, NULL, 4674.362, 3);
+    nx_json_write_double(&writer, NULL, 0.1 + 0.2, 9);
+    nx_json_write_double(&writer, NULL, 2.0, 3);
+    nx_json_write_double(&writer, NULL, 0.05, 2);
+    nx_json_write_double(&writer, NULL, 0.005, 3);
+    nx_json_write_double(&writer, NULL, -0.0001, 3);
+    nx_json_write_double(&writer, NULL, -12.3456, 2);
+    nx_json_write_double(&writer, NULL, 1.23456789012, 20);
+    nx_json_write_double(&writer, NULL, 7.5, -1);
+    nx_json_write_int(&writer, NULL, 4774208);
+    nx_json_write_int(&writer, NULL, 0);
+    nx_json_write_end(&writer);
+    assert(strcmp(buffer, "[4674.362,0.3,2,0.05,0.005,0,-12.35,1.23456789,8,4774208,0]") == 0);
+    test_count += 1;
+
+    // Values without a JSON number form
+    nx_json_writer_init(&writer, buffer, sizeof(buffer));
+    nx_json_write_array(&writer, NULL);
+    nx_json_write_double(&writer, NULL, 0.0 / 0.0, 2);
+    nx_json_write_double(&writer, NULL, 1.0 / 0.0, 2);
+    nx_json_write_double(&writer, NULL, 1e300, 2);
+    nx_json_write_end(&writer);
+    assert(strcmp(buffer, "[null,null,1.000000e+300]") == 0);
+    test_count += 1;
+
+    // Every written number parses back within the rounding
+    int i;
+    double value;
+    for (i = 0; i < 1000; i++) {
+        value = (i * 7919 % 100000) / 7.0 - 5000;
+        nx_json_writer_init(&writer, buffer, sizeof(buffer));
+        nx_json_write_object(&writer, NULL);
+        nx_json_write_double(&writer, "v", value, 4);
+        nx_json_write_end(&writer);
+        struct nx_json *json = nx_json_parse(buffer);
+        assert(json != NULL);
+        assert(nx_json_number(nx_json_get(json, "v")) - value < 0.00005);
+        assert(value - nx_json_number(nx_json_get(json, "v")) <= 0.00005);
+        test_count += 3;
+    }
+    nx_json_reset();
+
+    printf("Writer number formatting tests completed\n\n");
+}
+
+void test_write_overflow() {
+    printf("Testing nx_json writer overflow handling...\n");
+
+    char buffer[16];
+    struct nx_json_writer writer;
+    nx_json_writer_init(&writer, buffer, sizeof(buffer));
+
+    // A value that does not fit is dropped whole, the brackets can still be closed
+    assert(nx_json_write_object(&writer, NULL) == 0);
+    assert(nx_json_write_int(&writer, "a", 1) == 0);
+    assert(nx_json_write_string(&writer, "b", "too long to fit") == -1);
+    assert(writer.overflow == 1);
+    assert(strcmp(buffer, "{\"a\":1") == 0);
+    assert(nx_json_write_int(&writer, "c", 22) == 0);
+    assert(nx_json_write_array(&writer, "d") == -1);
+    assert(nx_json_write_end(&writer) == 0);
+    assert(nx_json_write_end(&writer) == -1);
+    assert(strcmp(buffer, "{\"a\":1,\"c\":22}") == 0);
+    test_count += 10;
+
+    // The buffer is never overrun and the text stays valid JSON
+    assert(writer.length == (int)strlen(buffer));
+    assert(writer.length < (int)sizeof(buffer));
+    assert(nx_json_parse(buffer) != NULL);
+    test_count += 3;
+    nx_json_reset();
+
+    printf("Writer overflow tests completed\n\n");
+}
+
+void test_write_records() {
+    printf("Testing nx_json writer incremental records...\n");
+
+    char buffer[64];
+    struct nx_json_writer writer;
+    nx_json_writer_init(&writer, buffer, sizeof(buffer));
+
+    // Records append one per line until one does not fit, which is then rolled back whole
+    int written = 0;
+    int i;
+    for (i = 0; i < 10; i++) {
+        nx_json_writer_mark(&writer);
+        nx_json_write_object(&writer, NULL);
+        nx_json_write_int(&writer, "tick", i);
+        nx_json_write_double(&writer, "soc", 50 + i * 0.5, 1);
+        nx_json_write_end(&writer);
+        if (writer.overflow) {
+            nx_json_writer_rollback(&writer);
+            break;
+        }
+        written++;
+    }
+    assert(written == 3);
+    assert(strcmp(buffer, "{\"tick\":0,\"soc\":50}\n{\"tick\":1,\"soc\":50.5}\n{\"tick\":2,\"soc\":51}") == 0);
+    assert(writer.overflow == 0);
+    assert(writer.depth == 0);
+    test_count += 4;
+
+    // After sending, the next batch starts in the same buffer
+    nx_json_writer_init(&writer, buffer, sizeof(buffer));
+    nx_json_write_object(&writer, NULL);
+    nx_json_write_int(&writer, "tick", 3);
+    nx_json_write_end(&writer);
+    assert(strcmp(buffer, "{\"tick\":3}") == 0);
+    test_count += 1;
+
+    // Control characters in strings are escaped
+    nx_json_writer_init(&writer, buffer, sizeof(buffer));
+    nx_json_write_array(&writer, NULL);
+    nx_json_write_string(&writer, NULL, "a\nb\tc\\\x01");
+    nx_json_write_end(&writer);
+    assert(strcmp(buffer, "[\"a\\nb\\tc\\\\\\u0001\"]") == 0);
+    test_count += 1;
+
+    printf("Writer incremental record tests completed\n\n");
+}
+
+int main() {
+    printf("Starting JSON writer tests...\n\n");
+
+    test_write_document();
+    test_write_numbers();
+    test_write_overflow();
+    test_write_records();
+
+    printf("\nAll tests passed! (%d assertions)\n", test_count);
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include "plant_model.h"
+#include <string.h>
+
+// Heat capacity of water in kWh per liter and kelvin
+#define WATER_KWH_PER_LITER_K (4.186 / 3600)
+
+// Temperature of the cold water refilling the tank
+#define COLD_WATER_C 10
+
+void plant_config_init(struct plant_config *config) {
+    config->capacity_kwh = 15;
+    config->power_kw = 5;
+    config->efficiency = 0.95f;
+    config->initial_soc = 50;
+    config->load_kw = 1.5f;
+    config->import_fee = 0;
+    config->tank_liters = 200;
+    config->heater_kw = 2.5f;
+    config->tank_loss_w_per_k = 2;
+    config->room_c = 20;
+    config->draw_kw = 0.25f;
+    config->tank_cold_c = 50;
+    config->tank_warm_c = 55;
+    config->initial_tank_c = 55;
+}
+
+void plant_state_init(struct plant_config *config, struct plant_state *state) {
+    memset(state, 0, sizeof(*state));
+    state->stored_kwh = config->capacity_kwh * config->initial_soc / 100;
+    state->tank_c = config->initial_tank_c;
+    state->tank_cold = state->tank_c < config->tank_cold_c;
+}
+
+float plant_soc(struct plant_config *config, struct plant_state *state) {
+    return (float)(state->stored_kwh * 100 / config->capacity_kwh);
+}
+
+double plant_cycles(struct plant_config *config, struct plant_state *state) {
+    return state->throughput_kwh / (2 * config->capacity_kwh);
+}
+
+double plant_step_inverter(struct plant_config *config, struct plant_state *state, struct InverterDecision *decision,
+                           double pv_kw, double load_kw, double price, double hours) {
+    double capacity = config->capacity_kwh;
+    double efficiency = config->efficiency;
+    double limit = config->power_kw * decision->batteryChargeDischargePowerLimit / 100.0;
+    double battery;
+    double floor;
+    double grid;
+
+    // Battery power, positive while charging
+    if (decision->batteryMode == BATTERY_CHARGE_MODE) {
+        battery = limit;
+    } else if (decision->batteryMode == BATTERY_DISCHARGE_MODE) {
+        battery = -limit;
+    } else {
+        battery = pv_kw - load_kw;
+        if (battery > config->power_kw) battery = config->power_kw;
+        if (battery < -config->power_kw) battery = -config->power_kw;
+    }
+
+    // The inverter stops at a full battery and at the on-grid end SOC protection
+    floor = capacity * decision->onGridEndSOCProtection / 100;
+    if (battery > 0 && battery * efficiency * hours > capacity - state->stored_kwh) {
+        battery = (capacity - state->stored_kwh) / (efficiency * hours);
+    }
+    if (battery < 0 && -battery * hours / efficiency > state->stored_kwh - floor) {
+        battery = state->stored_kwh > floor ? -(state->stored_kwh - floor) * efficiency / hours : 0;
+    }
+
+    // Surplus PV is curtailed without grid injection
+    grid = load_kw - pv_kw + battery;
+    if (grid < 0 && decision->gridInjectionPowerLimit == GRID_INJECTION_POWER_LIMIT_OFF) grid = 0;
+
+    if (grid > 0) {
+        state->import_kwh += grid * hours;
+        state->cost += grid * hours * (price + config->import_fee);
+    } else {
+        state->export_kwh -= grid * hours;
+        state->cost += grid * hours * price;
+    }
+    if (battery > 0) {
+        state->stored_kwh += battery * efficiency * hours;
+        state->throughput_kwh += battery * hours;
+    } else {
+        state->stored_kwh += battery / efficiency * hours;
+        state->throughput_kwh -= battery * hours;
+    }
+    state->battery_kw = battery;
+    state->grid_kw = grid;
+    return grid;
+}
+
+void plant_step_tank(struct plant_config *config, struct plant_state *state, int heating, double hours) {
+    double heat_kw = -config->tank_loss_w_per_k * (state->tank_c - config->room_c) / 1000 - config->draw_kw;
+
+    if (heating) {
+        heat_kw += config->heater_kw;
+        state->heater_kwh += config->heater_kw * hours;
+    }
+    if (state->tank_cold) state->cold_hours += hours;
+
+    state->tank_c += heat_kw * hours / (config->tank_liters * WATER_KWH_PER_LITER_K);
+    if (state->tank_c < COLD_WATER_C) state->tank_c = COLD_WATER_C;
+
+    // Cold below one temperature until heated to the other
+    if (state->tank_c < config->tank_cold_c) state->tank_cold = 1;
+    if (state->tank_c >= config->tank_warm_c) state->tank_cold = 0;
+}
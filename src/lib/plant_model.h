@@ -0,0 +1,73 @@
+#ifndef PLANT_MODEL_H
+#define PLANT_MODEL_H
+
+#include "inverter_state.h"
+
+// Fixed-step model of the house behind the grid meter, for backtests and
+// closed-loop simulations of the controllers: a battery on the hybrid inverter,
+// PV, the house load and the water tank with its heater. The inverter follows
+// the decision of the inverter state manager (inverter_state.h):
+//
+//   charging from grid   the battery charges at the decision's power limit in % of
+//                        the battery power, surplus PV is curtailed
+//   discharging to grid  the battery discharges at the power limit, the rest is exported
+//   morning push         the battery idles, all surplus PV is exported
+//   general mode         the battery covers the house and takes surplus PV,
+//                        what is left is exported only if grid injection is enabled
+//
+// and never discharges below the on-grid end SOC protection. The tank loses
+// heat to the room and to hot water use, and reports cold below one temperature
+// until it is heated to another, like the thermostat input of the controller.
+
+struct plant_config {
+    float capacity_kwh;         // Of the battery
+    float power_kw;             // Battery charge and discharge limit
+    float efficiency;           // Of charging and of discharging each
+    float initial_soc;          // In %
+    float load_kw;              // House load without the heater, when no trace gives it
+    float import_fee;           // Distribution fee per imported kWh on top of the spot price
+    float tank_liters;
+    float heater_kw;
+    float tank_loss_w_per_k;    // Heat loss to the room
+    float room_c;
+    float draw_kw;              // Mean hot water use
+    float tank_cold_c;          // Cold below this temperature
+    float tank_warm_c;          // until heated to this one
+    float initial_tank_c;
+};
+
+struct plant_state {
+    double stored_kwh;          // In the battery
+    double tank_c;
+    int tank_cold;
+    double grid_kw;             // Of the last step, positive for import
+    double battery_kw;          // Of the last step, positive while charging
+    double import_kwh;
+    double export_kwh;
+    double cost;                // Imports minus exports at the spot price
+    double throughput_kwh;      // Into and out of the battery
+    double heater_kwh;
+    double cold_hours;          // While the tank was cold
+};
+
+// Function to set a 15 kWh battery of 5 kW with 95 % efficiency each way, 1.5 kW of
+// load and a 200 l tank with a 2.5 kW heater kept between 50 and 55 °C
+void plant_config_init(struct plant_config *config);
+
+void plant_state_init(struct plant_config *config, struct plant_state *state);
+
+// State of charge in %
+float plant_soc(struct plant_config *config, struct plant_state *state);
+
+// Full battery cycles so far, throughput over twice the capacity
+double plant_cycles(struct plant_config *config, struct plant_state *state);
+
+// Function to step the battery and the grid meter by hours with the inverter
+// following decision. load_kw includes the heater. Returns the grid power.
+double plant_step_inverter(struct plant_config *config, struct plant_state *state, struct InverterDecision *decision,
+                           double pv_kw, double load_kw, double price, double hours);
+
+// Function to step the tank temperature by hours, heating while the heater runs
+void plant_step_tank(struct plant_config *config, struct plant_state *state, int heating, double hours);
+
+#endif // PLANT_MODEL_H
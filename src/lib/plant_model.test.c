@@ -0,0 +1,112 @@
+#include "plant_model.h"
+#include <stdio.h>
+#include <math.h>
+#include <assert.h>
+
+// 200 l of water in kWh per kelvin
+#define TANK_KWH_PER_K (200 * 4.186 / 3600)
+
+int near(double value, double expected) {
+    return fabs(value - expected) < 1e-4;
+}
+
+void init_decision(struct InverterDecision* decision, int batteryMode, int limit, int injection, float protection) {
+    decision->mode = INVERTER_ECONOMIC_MODE;
+    decision->batteryMode = batteryMode;
+    decision->batteryChargeDischargePowerLimit = limit;
+    decision->gridInjectionPowerLimit = injection;
+    decision->onGridEndSOCProtection = protection;
+}
+
+void test_battery() {
+    printf("Testing the battery and the grid meter...\n");
+
+    struct plant_config config;
+    struct plant_state state;
+    struct InverterDecision decision;
+
+    plant_config_init(&config);
+    plant_state_init(&config, &state);
+    assert(near(state.stored_kwh, 7.5));
+    assert(plant_soc(&config, &state) == 50);
+
+    init_decision(&decision, BATTERY_CHARGE_MODE, BATTERY_POWER_LIMIT_CHARGE_MAX, GRID_INJECTION_POWER_LIMIT_OFF, 50);
+    assert(near(plant_step_inverter(&config, &state, &decision, 0, 1, 2, 1), 2.5));
+    assert(near(state.battery_kw, 1.5));
+    assert(near(state.stored_kwh, 7.5 + 1.5 * 0.95));
+    assert(near(state.import_kwh, 2.5) && near(state.cost, 5));
+    printf("✓ Charging from grid draws the power limit through the meter\n");
+
+    init_decision(&decision, BATTERY_DISCHARGE_MODE, BATTERY_POWER_LIMIT_DISCHARGE_MAX, GRID_INJECTION_POWER_LIMIT_MAX, 20);
+    assert(near(plant_step_inverter(&config, &state, &decision, 1, 1, 4, 0.5), -4));
+    assert(near(state.export_kwh, 2) && near(state.cost, 5 - 8));
+    assert(near(state.stored_kwh, 7.5 + 1.5 * 0.95 - 2 / 0.95));
+    assert(near(plant_cycles(&config, &state), (1.5 + 2) / 30));
+    printf("✓ Discharging to grid exports the power limit, losses come from the battery\n");
+
+    // A lossless battery at the protection covers nothing
+    config.efficiency = 1;
+    config.initial_soc = 20;
+    plant_state_init(&config, &state);
+    init_decision(&decision, BATTERY_NO_MODE, BATTERY_POWER_LIMIT_OFF, GRID_INJECTION_POWER_LIMIT_OFF, 20);
+    assert(near(plant_step_inverter(&config, &state, &decision, 0, 2, 1, 1), 2));
+    assert(state.battery_kw == 0);
+
+    // A full one curtails surplus PV without grid injection
+    config.initial_soc = 100;
+    plant_state_init(&config, &state);
+    assert(plant_step_inverter(&config, &state, &decision, 6, 1, 1, 1) == 0);
+    assert(state.export_kwh == 0 && state.battery_kw == 0);
+    decision.gridInjectionPowerLimit = GRID_INJECTION_POWER_LIMIT_MAX;
+    assert(near(plant_step_inverter(&config, &state, &decision, 6, 1, 1, 1), -5));
+    printf("✓ The battery stops at the protection and when full\n");
+}
+
+void test_tank() {
+    printf("\nTesting the water tank...\n");
+
+    struct plant_config config;
+    struct plant_state state;
+
+    plant_config_init(&config);
+    config.tank_loss_w_per_k = 0;
+    config.draw_kw = 0;
+    config.initial_tank_c = 40;
+    plant_state_init(&config, &state);
+    assert(state.tank_cold == 1);
+
+    plant_step_tank(&config, &state, 1, 1);
+    assert(near(state.tank_c, 40 + 2.5 / TANK_KWH_PER_K));
+    assert(near(state.heater_kwh, 2.5));
+    assert(near(state.cold_hours, 1));
+    assert(state.tank_cold == 1);
+    plant_step_tank(&config, &state, 1, 0.5);
+    assert(state.tank_c > 55 && state.tank_cold == 0);
+    printf("✓ The heater warms the water by its heat capacity\n");
+
+    config.tank_loss_w_per_k = 2;
+    config.draw_kw = 0.25f;
+    state.tank_c = 52;
+    plant_step_tank(&config, &state, 0, 1);
+    assert(near(state.tank_c, 52 - (0.002 * 32 + 0.25) / TANK_KWH_PER_K));
+    assert(state.tank_cold == 0);
+    plant_step_tank(&config, &state, 0, 1);
+    assert(state.tank_c < 50 && state.tank_cold == 1);
+    plant_step_tank(&config, &state, 1, 0.25);
+    assert(state.tank_c < 55 && state.tank_cold == 1);
+    printf("✓ Losses cool it, it stays cold until heated to the warm temperature\n");
+
+    plant_step_tank(&config, &state, 0, 1000);
+    assert(state.tank_c == 10);
+    printf("✓ Not below the cold water\n");
+}
+
+int main() {
+    printf("Running plant_model tests...\n\n");
+
+    test_battery();
+    test_tank();
+
+    printf("\nAll tests passed! ✓\n");
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include "plant_sim.h"
+
+void plant_sim_config_init(struct plant_sim_config *config) {
+    config->step_seconds = 1;
+    config->control_seconds = 1;
+    config->very_low_price = 1;
+    config->priority_charging = 0;
+}
+
+void plant_controllers_init(struct plant_sim_config *sim, struct InverterSettings *settings,
+                            struct plant_controllers *controllers) {
+    controllers->inverter.currentInverterMode = INVERTER_GENERAL_MODE;
+    controllers->inverter.onGridEndSOCProtection = settings->onGridEndSOCProtectionUserSetting;
+    controllers->tank.priorityChargingEnabled = sim->priority_charging;
+    controllers->heating.heating = 0;
+}
+
+void plant_control(struct plant_config *plant, struct InverterSettings *settings, struct plant_state *state,
+                   struct plant_controllers *controllers) {
+    struct InverterInputs *inverter = &controllers->inverter;
+    struct InverterDecision *decision = &controllers->decision;
+
+    inverter->soc = plant_soc(plant, state);
+    decideInverterState(settings, inverter, decision);
+    inverter->currentInverterMode = decision->mode;
+    inverter->onGridEndSOCProtection = decision->onGridEndSOCProtection;
+
+    controllers->tank.temperatureBelowTreshold = state->tank_cold;
+    controllers->tank.excessEnergyAvailable = decision->excessEnergyAvailable;
+    decideWaterTankHeating(&controllers->tank, &controllers->heating);
+}
+
+long plant_simulate(struct plant_sim_config *sim, struct backtest_series *series, struct plant_config *plant,
+                    struct InverterSettings *settings, struct plant_state *state, FILE *log) {
+    struct plant_controllers controllers;
+    struct InverterInputs *inverter = &controllers.inverter;
+    struct WaterTankInputs *tank = &controllers.tank;
+    double hours;
+    double load;
+    long substeps;
+    long control;
+    long tick = 0;
+    long i;
+    long k;
+
+    if (sim->step_seconds <= 0 || series->step_seconds % sim->step_seconds != 0 ||
+        sim->control_seconds < sim->step_seconds || sim->control_seconds % sim->step_seconds != 0) {
+        return -1;
+    }
+    substeps = series->step_seconds / sim->step_seconds;
+    control = sim->control_seconds / sim->step_seconds;
+    hours = sim->step_seconds / 3600.0;
+
+    plant_state_init(plant, state);
+    plant_controllers_init(sim, settings, &controllers);
+
+    for (i = 0; i < series->steps; i++) {
+        inverter->currentSpotPrice = series->price[i];
+        inverter->maxSpotPrice = series->max_price[i];
+        inverter->predictedPVToday = series->pv_today[i];
+        inverter->hour = series->hour[i];
+        tank->spotPriceIsVeryLow = series->price[i] < sim->very_low_price;
+        tank->predictedPVToday = series->pv_today[i];
+        tank->predictedPVTomorrow = series->pv_tomorrow != NULL ? series->pv_tomorrow[i] : 0;
+        tank->pvPowerNow = series->pv[i];
+        tank->hour = series->hour[i];
+        load = series->load != NULL ? series->load[i] : plant->load_kw;
+
+        for (k = 0; k < substeps; k++) {
+            // The outputs of the controllers hold until their next run
+            if (tick % control == 0) plant_control(plant, settings, state, &controllers);
+            tick++;
+
+            plant_step_inverter(plant, state, &controllers.decision, series->pv[i],
+                                load + controllers.heating.heating * plant->heater_kw,
+                                series->price[i], hours);
+            plant_step_tank(plant, state, controllers.heating.heating, hours);
+        }
+
+        if (log != NULL) {
+            fprintf(log, "%lld,%.2f,%.2f,%d,%d,%.3f,%.3f,%d\n", series->start + (i + 1) * series->step_seconds,
+                    plant_soc(plant, state), state->tank_c, controllers.decision.mode, controllers.decision.batteryMode,
+                    state->battery_kw, state->grid_kw, controllers.heating.heating);
+        }
+    }
+    return tick * sim->step_seconds;
+}
@@ -0,0 +1,56 @@
+#ifndef PLANT_SIM_H
+#define PLANT_SIM_H
+
+#include "inverter_backtest.h"
+#include "water_tank_state.h"
+
+// Closed-loop simulation of the inverter state manager and the water tank
+// heating controller on the plant of plant_model.h. The trace gives what the
+// controllers do not change, resampled into a backtest_series: spot prices, PV
+// power and predictions, and the house load. The rest comes from the plant:
+// the SOC and the on-grid end SOC protection for the inverter, whether the tank
+// is cold for the water tank, whose heater adds to the load, and the inverter's
+// excess energy flag goes to the water tank as it is wired on the Miniserver.
+//
+// The plant steps at a fixed step, a second by default, holding the values of
+// each series step, and the controllers run every control period like the
+// loops of the scripts.
+
+struct plant_sim_config {
+    int step_seconds;           // Of the plant, dividing the series step
+    int control_seconds;        // Between controller runs, a multiple of the plant step
+    float very_low_price;       // Spot price the water tank sees as very low below
+    int priority_charging;      // Input 7 of the water tank controller
+};
+
+// What the controllers of one house keep between their runs: their inputs,
+// which the simulation sets from the series and the plant, and their decisions
+struct plant_controllers {
+    struct InverterInputs inverter;
+    struct InverterDecision decision;
+    struct WaterTankInputs tank;
+    struct WaterTankDecision heating;
+};
+
+// Function to set plant steps and controller runs of 1 s, prices below 1 very low
+void plant_sim_config_init(struct plant_sim_config *config);
+
+// Function to start the controllers with the inverter in general mode and the heater off
+void plant_controllers_init(struct plant_sim_config *sim, struct InverterSettings *settings,
+                            struct plant_controllers *controllers);
+
+// Function to run the controllers on the plant state, feeding the decision of
+// the inverter back to its inputs and its excess energy to the water tank
+void plant_control(struct plant_config *plant, struct InverterSettings *settings, struct plant_state *state,
+                   struct plant_controllers *controllers);
+
+// Function to simulate the series from the initial plant state. log gets a CSV
+// row at the end of every series step, NULL for none:
+//
+//   time,soc,tank_c,mode,battery_mode,battery_kw,grid_kw,heating
+//
+// Returns the simulated seconds, -1 if the steps do not divide each other.
+long plant_simulate(struct plant_sim_config *sim, struct backtest_series *series, struct plant_config *plant,
+                    struct InverterSettings *settings, struct plant_state *state, FILE *log);
+
+#endif // PLANT_SIM_H
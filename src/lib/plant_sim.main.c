@@ -0,0 +1,168 @@
+#define _POSIX_C_SOURCE 199309L
+#include <time.h>
+#include "plant_sim.h"
+
+// Run the inverter state manager and the water tank heating controller in the
+// loop with the plant over a trace (see plant_sim.h):
+//
+//   plant_sim --trace <file> [--map <column>=<target>]... [--set <name>=<value>]...
+//             [--series-step <s>] [--step <s>] [--control <s>] [--very-low <price>] [--priority]
+//             [--capacity <kWh>] [--power <kW>] [--efficiency <f>] [--soc <%>] [--load <kW>]
+//             [--import-fee <price>] [--tank <l>] [--heater <kW>] [--draw <kW>]
+//             [--tank-cold <°C>] [--tank-warm <°C>] [--log <file>]
+//
+// The columns are wired and the inverter thresholds named as for inverter_sweep.
+// The trace is resampled into series steps of 60 s, the plant steps every
+// second within them. Two lines report the run:
+//
+//   plant cost=<f> import_kwh=<f> export_kwh=<f> cycles=<f> heater_kwh=<f> cold_hours=<f> soc=<f> tank_c=<f>
+//   sim steps=<n> simulated_s=<n> load_ms=<f> wall_ms=<f> simulated_s_per_s=<f>
+
+double wall_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+int usage() {
+    fprintf(stderr,
+            "Usage: plant_sim --trace <file> [--map <column>=<target>]... [--set <name>=<value>]...\n"
+            "                 [--series-step <s>] [--step <s>] [--control <s>] [--very-low <price>] [--priority]\n"
+            "                 [--capacity <kWh>] [--power <kW>] [--efficiency <f>] [--soc <%%>] [--load <kW>]\n"
+            "                 [--import-fee <price>] [--tank <l>] [--heater <kW>] [--draw <kW>]\n"
+            "                 [--tank-cold <C>] [--tank-warm <C>] [--log <file>]\n");
+    return 1;
+}
+
+// Function to split <name>=<value> into name, NULL if it does not fit
+char *split_option(char *text, char *name, int size) {
+    char *value = strchr(text, '=');
+
+    if (value == NULL || value - text >= size) return NULL;
+    memcpy(name, text, value - text);
+    name[value - text] = '\0';
+    return value + 1;
+}
+
+int main(int argc, char **argv) {
+    struct plant_sim_config sim;
+    struct plant_config plant;
+    struct InverterSettings settings;
+    struct backtest_series series;
+    struct plant_state state;
+    struct trace trace;
+    char name[LOXONE_IO_NAME];
+    char *path = NULL;
+    char *maps[TRACE_MAX_COLUMNS];
+    int map_count = 0;
+    int series_step = 60;
+    char *log_path = NULL;
+    FILE *log = NULL;
+    double load_ms;
+    double started;
+    long simulated;
+    char *value;
+    int status;
+    int i;
+
+    loxone_reset(0);
+    plant_sim_config_init(&sim);
+    plant_config_init(&plant);
+    backtest_settings_init(&settings);
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            path = argv[++i];
+        } else if (strcmp(argv[i], "--map") == 0 && i + 1 < argc && map_count < TRACE_MAX_COLUMNS) {
+            maps[map_count++] = argv[++i];
+        } else if (strcmp(argv[i], "--set") == 0 && i + 1 < argc) {
+            value = split_option(argv[++i], name, sizeof(name));
+            if (value == NULL || backtest_parameter(name) < 0) return usage();
+            backtest_set_parameter(&settings, backtest_parameter(name), (float)atof(value));
+        } else if (strcmp(argv[i], "--series-step") == 0 && i + 1 < argc) {
+            series_step = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--step") == 0 && i + 1 < argc) {
+            sim.step_seconds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--control") == 0 && i + 1 < argc) {
+            sim.control_seconds = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--very-low") == 0 && i + 1 < argc) {
+            sim.very_low_price = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--priority") == 0) {
+            sim.priority_charging = 1;
+        } else if (strcmp(argv[i], "--capacity") == 0 && i + 1 < argc) {
+            plant.capacity_kwh = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--power") == 0 && i + 1 < argc) {
+            plant.power_kw = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--efficiency") == 0 && i + 1 < argc) {
+            plant.efficiency = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--soc") == 0 && i + 1 < argc) {
+            plant.initial_soc = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--load") == 0 && i + 1 < argc) {
+            plant.load_kw = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--import-fee") == 0 && i + 1 < argc) {
+            plant.import_fee = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--tank") == 0 && i + 1 < argc) {
+            plant.tank_liters = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--heater") == 0 && i + 1 < argc) {
+            plant.heater_kw = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--draw") == 0 && i + 1 < argc) {
+            plant.draw_kw = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--tank-cold") == 0 && i + 1 < argc) {
+            plant.tank_cold_c = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--tank-warm") == 0 && i + 1 < argc) {
+            plant.tank_warm_c = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--log") == 0 && i + 1 < argc) {
+            log_path = argv[++i];
+        } else {
+            return usage();
+        }
+    }
+    if (path == NULL || series_step <= 0 || plant.capacity_kwh <= 0 || plant.efficiency <= 0 || plant.tank_liters <= 0) {
+        return usage();
+    }
+
+    started = wall_ms();
+    if (trace_open(&trace, path) != 0) {
+        fprintf(stderr, "%s: %s\n", path, trace.error);
+        return 1;
+    }
+    for (i = 0; i < map_count; i++) {
+        value = split_option(maps[i], name, sizeof(name));
+        if (value == NULL) return usage();
+        if (trace_map(&trace, name, value) != 0) {
+            fprintf(stderr, "--map %s: %s\n", maps[i], trace.error);
+            return 1;
+        }
+    }
+    status = backtest_load(&series, &trace, series_step);
+    trace_close(&trace);
+    if (status != 0) {
+        fprintf(stderr, "%s: %s\n", path, trace.error);
+        return 1;
+    }
+    load_ms = wall_ms() - started;
+
+    if (log_path != NULL) {
+        log = fopen(log_path, "w");
+        if (log == NULL) {
+            fprintf(stderr, "%s: can not write the log\n", log_path);
+            return 1;
+        }
+        fprintf(log, "time,soc,tank_c,mode,battery_mode,battery_kw,grid_kw,heating\n");
+    }
+    started = wall_ms();
+    simulated = plant_simulate(&sim, &series, &plant, &settings, &state, log);
+    started = wall_ms() - started;
+    if (log != NULL) fclose(log);
+    backtest_free(&series);
+    if (simulated < 0) {
+        fprintf(stderr, "the plant step must divide the series step and the control period\n");
+        return 1;
+    }
+
+    printf("plant cost=%.2f import_kwh=%.1f export_kwh=%.1f cycles=%.2f heater_kwh=%.1f cold_hours=%.1f soc=%.1f tank_c=%.1f\n",
+           state.cost, state.import_kwh, state.export_kwh, plant_cycles(&plant, &state), state.heater_kwh,
+           state.cold_hours, plant_soc(&plant, &state), state.tank_c);
+    printf("sim steps=%ld simulated_s=%ld load_ms=%.0f wall_ms=%.0f simulated_s_per_s=%.0f\n",
+           simulated / sim.step_seconds, simulated, load_ms, started, simulated * 1000.0 / (started > 0 ? started : 1e-3));
+    return 0;
+}
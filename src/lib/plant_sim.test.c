@@ -0,0 +1,176 @@
+#include "plant_sim.h"
+#include <assert.h>
+
+// An hour of minute steps
+#define STEPS 60
+
+// 2025-02-27 12:00 CET
+#define T0 1740654000LL
+
+int near(double value, double expected, double tolerance) {
+    return fabs(value - expected) < tolerance;
+}
+
+struct minutes {
+    float price[STEPS];
+    float max_price[STEPS];
+    float pv_today[STEPS];
+    float pv[STEPS];
+    unsigned char hour[STEPS];
+};
+
+// A cloudy noon at one price
+void init_series(struct backtest_series* series, struct minutes* minutes, float price) {
+    int i;
+
+    for (i = 0; i < STEPS; i++) {
+        minutes->price[i] = price;
+        minutes->max_price[i] = 5;
+        minutes->pv_today[i] = 10;
+        minutes->pv[i] = 0;
+        minutes->hour[i] = 12;
+    }
+    memset(series, 0, sizeof(*series));
+    series->steps = STEPS;
+    series->step_seconds = 60;
+    series->start = T0;
+    series->price = minutes->price;
+    series->max_price = minutes->max_price;
+    series->pv_today = minutes->pv_today;
+    series->pv = minutes->pv;
+    series->hour = minutes->hour;
+}
+
+void test_battery() {
+    printf("Testing the inverter in the loop...\n");
+
+    struct plant_sim_config sim;
+    struct plant_config plant;
+    struct InverterSettings settings;
+    struct backtest_series series;
+    struct plant_state state;
+    struct minutes minutes;
+
+    plant_sim_config_init(&sim);
+    plant_config_init(&plant);
+    backtest_settings_init(&settings);
+    init_series(&series, &minutes, 0.5f);
+
+    // An hour of grid charging at 30 % of 5 kW, the tank stays warm
+    assert(plant_simulate(&sim, &series, &plant, &settings, &state, NULL) == 3600);
+    assert(near(state.stored_kwh, 7.5 + 1.5 * 0.95, 1e-6));
+    assert(near(state.import_kwh, 1.5 + 1.5, 1e-6));
+    assert(state.heater_kwh == 0 && state.tank_cold == 0);
+    printf("✓ Grid charging raises the SOC the inverter sees\n");
+
+    // Near the day's max the battery discharges to grid until the SOC threshold
+    plant.initial_soc = 90;
+    plant.load_kw = 0;
+    init_series(&series, &minutes, 4.8f);
+    plant_simulate(&sim, &series, &plant, &settings, &state, NULL);
+    assert(near(plant_soc(&plant, &state), 80, 0.01));
+    assert(near(state.export_kwh, 1.5 * 0.95, 0.01));
+    assert(state.import_kwh == 0);
+    printf("✓ Discharging to grid stops at the SOC threshold\n");
+}
+
+void test_water_tank() {
+    printf("\nTesting the water tank in the loop...\n");
+
+    struct plant_sim_config sim;
+    struct plant_config plant;
+    struct InverterSettings settings;
+    struct backtest_series series;
+    struct plant_state state;
+    struct minutes minutes;
+
+    plant_sim_config_init(&sim);
+    plant_config_init(&plant);
+    backtest_settings_init(&settings);
+
+    // A cold tank at a very low price heats until warm, with the heater on the meter
+    plant.initial_tank_c = 48;
+    init_series(&series, &minutes, 0.5f);
+    plant_simulate(&sim, &series, &plant, &settings, &state, NULL);
+    assert(state.tank_cold == 0 && state.tank_c > 54);
+    assert(state.heater_kwh > 1.5 && state.heater_kwh < 2.5);
+    assert(near(state.cold_hours * 2.5, state.heater_kwh, 1e-3));
+    assert(near(state.import_kwh, 3 + state.heater_kwh, 1e-6));
+    printf("✓ A cold tank is heated to the warm temperature at a very low price\n");
+
+    // Not at a normal price, unless priority charging is enabled
+    init_series(&series, &minutes, 2);
+    plant_simulate(&sim, &series, &plant, &settings, &state, NULL);
+    assert(state.heater_kwh == 0 && state.tank_cold == 1);
+    sim.priority_charging = 1;
+    plant_simulate(&sim, &series, &plant, &settings, &state, NULL);
+    assert(state.heater_kwh > 1.5 && state.tank_cold == 0);
+    printf("✓ At a normal price only priority charging heats\n");
+
+    // Discharging to grid leaves no excess energy for the tank, 3 kWh take 43 minutes
+    plant.initial_soc = 100;
+    plant.load_kw = 0;
+    init_series(&series, &minutes, 4.8f);
+    plant_simulate(&sim, &series, &plant, &settings, &state, NULL);
+    assert(near(state.heater_kwh, (1 - 3 * 0.95 / 4) * 2.5, 0.01));
+    printf("✓ The tank waits while the inverter discharges to grid\n");
+}
+
+void test_steps() {
+    printf("\nTesting steps and control periods...\n");
+
+    struct plant_sim_config sim;
+    struct plant_config plant;
+    struct InverterSettings settings;
+    struct backtest_series series;
+    struct plant_state state;
+    struct plant_state coarse;
+    struct minutes minutes;
+    FILE* log;
+    char line[128];
+
+    plant_sim_config_init(&sim);
+    plant_config_init(&plant);
+    backtest_settings_init(&settings);
+    plant.initial_soc = 90;
+    plant.load_kw = 0;
+    init_series(&series, &minutes, 4.8f);
+    plant_simulate(&sim, &series, &plant, &settings, &state, NULL);
+
+    // Controllers every minute overshoot the SOC threshold by up to a minute of discharging
+    sim.control_seconds = 60;
+    plant_simulate(&sim, &series, &plant, &settings, &coarse, NULL);
+    assert(plant_soc(&plant, &coarse) < plant_soc(&plant, &state));
+    assert(plant_soc(&plant, &coarse) > 80 - 4 / 0.95 / 60 / 15 * 100);
+    sim.step_seconds = 60;
+    assert(plant_simulate(&sim, &series, &plant, &settings, &coarse, NULL) == 3600);
+    printf("✓ Controllers hold their decisions over the control period\n");
+
+    sim.step_seconds = 7;
+    assert(plant_simulate(&sim, &series, &plant, &settings, &coarse, NULL) == -1);
+    sim.step_seconds = 20;
+    sim.control_seconds = 30;
+    assert(plant_simulate(&sim, &series, &plant, &settings, &coarse, NULL) == -1);
+    printf("✓ Steps must divide each other\n");
+
+    plant_sim_config_init(&sim);
+    log = tmpfile();
+    assert(log != NULL);
+    plant_simulate(&sim, &series, &plant, &settings, &state, log);
+    rewind(log);
+    assert(fgets(line, sizeof(line), log) != NULL);
+    assert(strcmp(line, "1740654060,89.53,54.98,258,2,-4.000,-4.000,0\n") == 0);
+    fclose(log);
+    printf("✓ The log has a row per series step\n");
+}
+
+int main() {
+    printf("Running plant_sim tests...\n\n");
+
+    test_battery();
+    test_water_tank();
+    test_steps();
+
+    printf("\nAll tests passed! ✓\n");
+    return 0;
+}
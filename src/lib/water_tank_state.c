@@ -0,0 +1,28 @@
+// Check if we're using a standard C compiler
+#ifndef PICO_C
+#include "water_tank_state.h"
+#endif
+
+// Function to decide whether to heat the water tank
+void decideWaterTankHeating(struct WaterTankInputs* inputs, struct WaterTankDecision* decision) {
+    int sufficientPVPowerNow = inputs->pvPowerNow > PV_POWER_THRESHOLD_IN_KW;
+    int sufficientPVProductionToday = inputs->predictedPVToday > PV_LOW_PRODUCTION_THRESHOLD_IN_KW;
+
+    decision->sufficientPVProductionTomorrow = inputs->predictedPVTomorrow > PV_LOW_PRODUCTION_THRESHOLD_IN_KW;
+
+    // TODO: use better algorithm to determine that the hour is during the day (sunrise to sunset)
+    if(inputs->hour >= 6 && inputs->hour < 21) {
+        // During the day
+        decision->isDayMode = 1;
+        decision->canCharge =
+            (!sufficientPVProductionToday && inputs->spotPriceIsVeryLow) ||
+            (sufficientPVPowerNow && inputs->spotPriceIsVeryLow);
+    } else {
+        // During the night
+        decision->isDayMode = 0;
+        decision->canCharge = !decision->sufficientPVProductionTomorrow && inputs->spotPriceIsVeryLow;
+    }
+
+    // Only charge the water tank when excess energy is available (to avoid using grid power when prioritizing grid export)
+    decision->heating = (inputs->priorityChargingEnabled || decision->canCharge) && inputs->temperatureBelowTreshold && inputs->excessEnergyAvailable;
+}
@@ -0,0 +1,36 @@
+#ifndef WATER_TANK_STATE_H
+#define WATER_TANK_STATE_H
+
+// Decision core of water-tank-heating-controller: whether the heater runs for
+// the tank temperature, spot price, PV and the inverter's excess energy. It
+// keeps no state between calls, so the plant simulation can step it in the
+// loop with the inverter (see plant_sim.h).
+
+// This is exactly the power the water heater consumes when heating on
+#define PV_POWER_THRESHOLD_IN_KW 2.5
+
+// This is the minimum power the PV should produce to charge the water tank and supply the house during the day
+#define PV_LOW_PRODUCTION_THRESHOLD_IN_KW 20
+
+struct WaterTankInputs {
+    int temperatureBelowTreshold;
+    int spotPriceIsVeryLow;
+    float predictedPVToday;
+    float predictedPVTomorrow;
+    int excessEnergyAvailable;                 // From the inverter state manager
+    int priorityChargingEnabled;               // Charges whenever the temperature is below treshold
+    float pvPowerNow;                          // In kW
+    int hour;                                  // Local
+};
+
+struct WaterTankDecision {
+    int heating;
+    int isDayMode;
+    int canCharge;
+    int sufficientPVProductionTomorrow;
+};
+
+// Function to decide whether to heat the water tank
+void decideWaterTankHeating(struct WaterTankInputs* inputs, struct WaterTankDecision* decision);
+
+#endif // WATER_TANK_STATE_H
@@ -0,0 +1,82 @@
+#include "water_tank_state.h"
+#include <stdio.h>
+#include <assert.h>
+
+// A cold tank at noon with excess energy, a very low price and a cloudy forecast
+void init_inputs(struct WaterTankInputs* inputs) {
+    inputs->temperatureBelowTreshold = 1;
+    inputs->spotPriceIsVeryLow = 1;
+    inputs->predictedPVToday = 10;
+    inputs->predictedPVTomorrow = 10;
+    inputs->excessEnergyAvailable = 1;
+    inputs->priorityChargingEnabled = 0;
+    inputs->pvPowerNow = 0;
+    inputs->hour = 12;
+}
+
+void test_day() {
+    printf("Testing heating during the day...\n");
+
+    struct WaterTankInputs inputs;
+    struct WaterTankDecision decision;
+
+    init_inputs(&inputs);
+    decideWaterTankHeating(&inputs, &decision);
+    assert(decision.isDayMode == 1);
+    assert(decision.heating == 1);
+    printf("✓ A cloudy day heats at a very low price\n");
+
+    inputs.predictedPVToday = 30;
+    decideWaterTankHeating(&inputs, &decision);
+    assert(decision.heating == 0);
+    inputs.pvPowerNow = 3;
+    decideWaterTankHeating(&inputs, &decision);
+    assert(decision.heating == 1);
+    printf("✓ A sunny day waits for PV power above the heater's\n");
+
+    inputs.spotPriceIsVeryLow = 0;
+    decideWaterTankHeating(&inputs, &decision);
+    assert(decision.canCharge == 0 && decision.heating == 0);
+    inputs.priorityChargingEnabled = 1;
+    decideWaterTankHeating(&inputs, &decision);
+    assert(decision.heating == 1);
+    printf("✓ Priority charging heats at any price\n");
+
+    inputs.excessEnergyAvailable = 0;
+    decideWaterTankHeating(&inputs, &decision);
+    assert(decision.heating == 0);
+    inputs.excessEnergyAvailable = 1;
+    inputs.temperatureBelowTreshold = 0;
+    decideWaterTankHeating(&inputs, &decision);
+    assert(decision.heating == 0);
+    printf("✓ Only a cold tank is heated, and only with excess energy\n");
+}
+
+void test_night() {
+    printf("\nTesting heating at night...\n");
+
+    struct WaterTankInputs inputs;
+    struct WaterTankDecision decision;
+
+    init_inputs(&inputs);
+    inputs.hour = 21;
+    decideWaterTankHeating(&inputs, &decision);
+    assert(decision.isDayMode == 0);
+    assert(decision.heating == 1);
+
+    inputs.predictedPVTomorrow = 25;
+    decideWaterTankHeating(&inputs, &decision);
+    assert(decision.sufficientPVProductionTomorrow == 1);
+    assert(decision.heating == 0);
+    printf("✓ Nights heat unless tomorrow is sunny\n");
+}
+
+int main() {
+    printf("Running water_tank_state tests...\n\n");
+
+    test_day();
+    test_night();
+
+    printf("\nAll tests passed! ✓\n");
+    return 0;
+}
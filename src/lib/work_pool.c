@@ -0,0 +1,158 @@
+#define _POSIX_C_SOURCE 200112L
+#include "work_pool.h"
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+
+// Tasks next..end-1 are left in a worker's range
+struct work_range {
+    pthread_mutex_t lock;
+    long next;
+    long end;
+};
+
+struct work_pool {
+    int workers;
+    struct work_range ranges[WORK_POOL_MAX_WORKERS];
+    work_pool_task run;
+    void *context;
+    pthread_mutex_t stats_lock;
+    struct work_pool_stats *stats;
+};
+
+struct work_worker {
+    struct work_pool *pool;
+    int index;
+};
+
+int work_pool_cores(void) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores < 1) return 1;
+    if (cores > WORK_POOL_MAX_WORKERS) return WORK_POOL_MAX_WORKERS;
+    return (int)cores;
+}
+
+// Take the next task of a range, -1 if it is empty
+long work_take(struct work_range *range) {
+    long task = -1;
+
+    pthread_mutex_lock(&range->lock);
+    if (range->next < range->end) task = range->next++;
+    pthread_mutex_unlock(&range->lock);
+    return task;
+}
+
+// Move the back half of the largest other range into the worker's own, 0 if all are empty
+int work_steal(struct work_pool *pool, int self) {
+    struct work_range *victim;
+    long largest = 0;
+    long left;
+    long half;
+    int chosen = -1;
+    int i;
+
+    // The victim may be robbed by someone else before it is locked again below
+    for (i = 0; i < pool->workers; i++) {
+        if (i == self) continue;
+        pthread_mutex_lock(&pool->ranges[i].lock);
+        left = pool->ranges[i].end - pool->ranges[i].next;
+        pthread_mutex_unlock(&pool->ranges[i].lock);
+        if (left > largest) {
+            largest = left;
+            chosen = i;
+        }
+    }
+    if (chosen < 0) return 0;
+
+    victim = &pool->ranges[chosen];
+    pthread_mutex_lock(&victim->lock);
+    left = victim->end - victim->next;
+    if (left <= 0) {
+        pthread_mutex_unlock(&victim->lock);
+        return 1;   // Lost the race, look again
+    }
+    half = (left + 1) / 2;
+    victim->end -= half;
+    pthread_mutex_lock(&pool->ranges[self].lock);
+    pool->ranges[self].next = victim->end;
+    pool->ranges[self].end = victim->end + half;
+    pthread_mutex_unlock(&pool->ranges[self].lock);
+    pthread_mutex_unlock(&victim->lock);
+    return 2;
+}
+
+void *work_worker_main(void *argument) {
+    struct work_worker *worker = (struct work_worker *)argument;
+    struct work_pool *pool = worker->pool;
+    long steals = 0;
+    long done = 0;
+    long task;
+    int stolen;
+
+    for (;;) {
+        task = work_take(&pool->ranges[worker->index]);
+        if (task >= 0) {
+            pool->run(pool->context, task, worker->index);
+            done++;
+            continue;
+        }
+        stolen = work_steal(pool, worker->index);
+        if (stolen == 0) break;
+        if (stolen == 2) steals++;
+    }
+    if (pool->stats != NULL) {
+        pthread_mutex_lock(&pool->stats_lock);
+        pool->stats->steals += steals;
+        pool->stats->tasks[worker->index] = done;
+        pthread_mutex_unlock(&pool->stats_lock);
+    }
+    return NULL;
+}
+
+int work_pool_run(int workers, long tasks, work_pool_task run, void *context, struct work_pool_stats *stats) {
+    static struct work_pool pool;   // Large, one run at a time
+    pthread_t threads[WORK_POOL_MAX_WORKERS];
+    struct work_worker args[WORK_POOL_MAX_WORKERS];
+    int started;
+    int status = 0;
+    int i;
+
+    if (workers < 1) workers = 1;
+    if (workers > WORK_POOL_MAX_WORKERS) workers = WORK_POOL_MAX_WORKERS;
+    if (stats != NULL) {
+        memset(stats, 0, sizeof(*stats));
+        stats->workers = workers;
+    }
+    if (workers == 1) {
+        for (i = 0; i < tasks; i++) run(context, i, 0);
+        if (stats != NULL) stats->tasks[0] = tasks;
+        return 0;
+    }
+
+    pool.workers = workers;
+    pool.run = run;
+    pool.context = context;
+    pool.stats = stats;
+    pthread_mutex_init(&pool.stats_lock, NULL);
+    for (i = 0; i < workers; i++) {
+        pthread_mutex_init(&pool.ranges[i].lock, NULL);
+        pool.ranges[i].next = tasks * i / workers;
+        pool.ranges[i].end = tasks * (i + 1) / workers;
+    }
+
+    for (started = 0; started < workers; started++) {
+        args[started].pool = &pool;
+        args[started].index = started;
+        if (pthread_create(&threads[started], NULL, work_worker_main, &args[started]) != 0) {
+            status = -1;
+            break;
+        }
+    }
+    // Workers that started also run the ranges of those that did not
+    for (i = 0; i < started; i++) pthread_join(threads[i], NULL);
+    if (started == 0) status = -1;
+
+    for (i = 0; i < workers; i++) pthread_mutex_destroy(&pool.ranges[i].lock);
+    pthread_mutex_destroy(&pool.stats_lock);
+    return status;
+}
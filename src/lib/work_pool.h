@@ -0,0 +1,27 @@
+#ifndef WORK_POOL_H
+#define WORK_POOL_H
+
+// Work-stealing pool for host tools. Tasks are numbered 0..tasks-1 and split
+// into one contiguous range per worker. A worker takes tasks from the front of
+// its range and, once it is empty, steals the back half of the largest range
+// left, so uneven tasks still keep every core busy without a shared queue.
+
+#define WORK_POOL_MAX_WORKERS 256
+
+// Runs one task, worker is 0..workers-1 for per-worker scratch space
+typedef void (*work_pool_task)(void *context, long task, int worker);
+
+struct work_pool_stats {
+    int workers;
+    long steals;
+    long tasks[WORK_POOL_MAX_WORKERS];   // Run by each worker
+};
+
+// Number of online cores, at least 1
+int work_pool_cores(void);
+
+// Function to run all tasks on workers threads and wait for them, 0 on success.
+// With one worker the tasks run in order on the calling thread. stats may be NULL.
+int work_pool_run(int workers, long tasks, work_pool_task run, void *context, struct work_pool_stats *stats);
+
+#endif // WORK_POOL_H
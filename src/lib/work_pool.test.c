@@ -0,0 +1,89 @@
+#include "work_pool.h"
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include <sched.h>
+
+#define TASKS 10000
+
+struct counts {
+    pthread_mutex_t lock;
+    int runs[TASKS];
+    int workers[TASKS];
+    long done;
+    int block;      // Task 0 waits for all the others
+};
+
+void count_task(void *context, long task, int worker) {
+    struct counts *counts = (struct counts *)context;
+    long done;
+
+    pthread_mutex_lock(&counts->lock);
+    counts->runs[task]++;
+    counts->workers[task] = worker;
+    counts->done++;
+    pthread_mutex_unlock(&counts->lock);
+
+    // The rest of the first worker's range can only run if the others steal it
+    while (task == 0 && counts->block) {
+        pthread_mutex_lock(&counts->lock);
+        done = counts->done;
+        pthread_mutex_unlock(&counts->lock);
+        if (done == TASKS) break;
+        sched_yield();
+    }
+}
+
+void run(int workers, int block, struct work_pool_stats *stats) {
+    static struct counts counts;
+    long total = 0;
+    int i;
+
+    memset(&counts, 0, sizeof(counts));
+    pthread_mutex_init(&counts.lock, NULL);
+    counts.block = block;
+    assert(work_pool_run(workers, TASKS, count_task, &counts, stats) == 0);
+    assert(stats->workers == workers);
+    for (i = 0; i < TASKS; i++) {
+        assert(counts.runs[i] == 1);
+        assert(counts.workers[i] >= 0 && counts.workers[i] < workers);
+    }
+    for (i = 0; i < workers; i++) total += stats->tasks[i];
+    assert(total == TASKS);
+    pthread_mutex_destroy(&counts.lock);
+}
+
+void test_pool() {
+    printf("Testing the work-stealing pool...\n");
+
+    struct work_pool_stats stats;
+
+    run(1, 0, &stats);
+    assert(stats.steals == 0);
+    printf("✓ One worker runs every task on the calling thread\n");
+
+    run(4, 0, &stats);
+    printf("✓ Four workers run every task once\n");
+
+    run(4, 1, &stats);
+    assert(stats.steals > 0);
+    assert(stats.tasks[0] == 1);
+    printf("✓ Idle workers steal the range of a busy one\n");
+
+    assert(work_pool_run(3, 0, count_task, NULL, &stats) == 0);
+    assert(stats.steals == 0);
+    printf("✓ No tasks, no steals\n");
+
+    assert(work_pool_cores() >= 1);
+    printf("✓ At least one core\n");
+}
+
+int main() {
+    printf("Running work_pool tests...\n\n");
+
+    test_pool();
+
+    printf("\nAll tests passed! ✓\n");
+    return 0;
+}
@@ -13,27 +13,19 @@
  Text Output 1 - Debug information
 */
 
-#define SECONDS_IN_A_MINUTE 60
-#define SOC_HYSTERESIS_MARGIN 2.0 // Hysteresis margin for SOC to avoid frequent switching charging on/off
 #define ONE_SECOND_SLEEP 1000 // Sleep for 1s in the main loop
 
+// The readings and the charging state are kept in an EvEcoState of
+// ev_eco_state.h, which the bundle puts in front of this script
+
 float userConfigEcoPower;
 float userConfigSocTreshold;
 float currentSolarPowerProduction;
 float batterySoc;
-float solarPowerReadings[SECONDS_IN_A_MINUTE];
-int solarPowerReadingsIndex = 0;
-float averagePower;
-float highSOCPower; // Power to charge the car when SOC is above threshold
-int carCharging = 0; // Flag to track if car charging is on
-int loopIndex;
+struct EvEcoState state;
 char debugOutput[2048];
-float ecoPower = 0.0;
 
-// Initialize the readings array
-for (loopIndex = 0; loopIndex < SECONDS_IN_A_MINUTE; loopIndex++) {
-    solarPowerReadings[loopIndex] = 0.0;
-}
+initEvEcoState(&state);
 
 while (TRUE) {
     userConfigEcoPower = getinput(0);
@@ -41,41 +33,9 @@ while (TRUE) {
     batterySoc = getinput(2);
     userConfigSocTreshold = getinput(3);
 
-    solarPowerReadings[solarPowerReadingsIndex] = currentSolarPowerProduction;
-    solarPowerReadingsIndex = (solarPowerReadingsIndex + 1) % SECONDS_IN_A_MINUTE;
-
-    if (solarPowerReadingsIndex == 0) {  // Every minute
-        float sum = 0.0;
-        for (loopIndex = 0; loopIndex < SECONDS_IN_A_MINUTE; loopIndex++) {
-            sum += solarPowerReadings[loopIndex];
-        }
-        averagePower = sum / SECONDS_IN_A_MINUTE;
-
-        // Choose the higher of the two values as the power to charge the car in case SOC is above threshold
-        if(averagePower > userConfigEcoPower) {
-            highSOCPower = averagePower;
-        } else {
-            highSOCPower = userConfigEcoPower;
-        }
-
-        if (carCharging) {
-            // If car is already charging, use lower SOC threshold (threshold - SOC_HYSTERESIS_MARGIN)
-            if (batterySoc >= userConfigSocTreshold - SOC_HYSTERESIS_MARGIN) {
-                ecoPower = highSOCPower;
-            } else {
-                ecoPower = 0;
-                carCharging = 0;
-            }
-        } else {
-            // If car is not charging, use higher SOC threshold
-            if (batterySoc >= userConfigSocTreshold) {
-                ecoPower = highSOCPower;
-                carCharging = 1;
-            }
-        }
-
-        setoutput(0, ecoPower);
-        setoutput(1, carCharging);
+    if (updateEvEcoState(&state, userConfigEcoPower, currentSolarPowerProduction, batterySoc, userConfigSocTreshold)) {  // Every minute
+        setoutput(0, state.ecoPower);
+        setoutput(1, state.carCharging);
     }
 
      sprintf(debugOutput,
@@ -84,10 +44,10 @@ while (TRUE) {
              currentSolarPowerProduction,
              batterySoc,
              userConfigSocTreshold,
-             highSOCPower,
-             averagePower,
-             carCharging,
-             ecoPower);
+             state.highSOCPower,
+             state.averagePower,
+             state.carCharging,
+             state.ecoPower);
 
      setoutputtext(0, debugOutput);
 
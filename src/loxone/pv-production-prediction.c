@@ -1,10 +1,11 @@
 /* 
 Loxone programming block for fetching PV production predictions from Forecast.solar API and updating the virtual inputs.
 
-The script should not bet triggered more than once a day to avoid unnecessary API calls and stay within the free tier limits.
+Refreshes are scheduled by forecast_schedule: every 30 minutes in the morning and every 3 hours otherwise, within
+the request quota the API reports. Trigger events ask for an early refresh, bursts of them make one request per plane.
 
 Inputs:
-- Input 1: Trigger event to fetch the data
+- Input 1: Trigger event to refresh the data
 
 Outputs:
 - Output 1: PV production prediction for today
@@ -14,16 +15,12 @@ Outputs:
 // Define all required constants
 #define SERVER_ADDRESS "api.forecast.solar"
 
-// Panel configuration
+// Location of the PV array
 #define LATITUDE "50.6920036"
 #define LONGITUDE "15.2203556"
-#define SLOPE "45"
-#define EAST_AZIMUTH "-63"
-#define EAST_KWP "5500"
-#define WEST_AZIMUTH "113"
-#define WEST_KWP "4500"
+#define PLANE_COUNT 2  // Entries of the planes table below
 
-// API endpoint path format (same for both orientations)
+// API endpoint path format (same for all planes)
 #define URL_PATH_FORMAT "/estimate/watthours/day/%s/%s/%s/%s/%s?time=%s"
 
 // Output indexes
@@ -34,6 +31,19 @@ Outputs:
 #define VI_PV_PRODUCTION_TODAY "VI9"
 #define VI_PV_PRODUCTION_TOMORROW "VI10"
 
+// Fetch settings, all planes are requested at once
+#define SERVER_PORT 80
+#define FETCH_BUFFER_SIZE 0     // Bodies are parsed as they arrive, none is kept
+#define FETCH_TIMEOUT_S 15      // Seconds after which a plane without a complete response counts as failed
+#define FETCH_POLL_MS 50        // Wait per socket read
+
+// Forecast cache, published at startup and refetched only when it is stale
+#define CACHE_PATH "/user/common/pv-forecast.bin"
+#define CACHE_TTL (6 * 60 * 60)  // Seconds
+
+// Least seconds between refreshes asked for by trigger events
+#define TRIGGER_INTERVAL (10 * 60)
+
 // Define debug output indexes
 #define DEBUG_OUTPUT_RESPONSE 0
 #define DEBUG_OUTPUT_URL 1
@@ -41,18 +51,71 @@ Outputs:
 
 int nEvents;
 char debug[1024];
-char urlEast[512];  // Buffer for east panels API URL
-char urlWest[512];  // Buffer for west panels API URL
-char* responseEast;
-char* responseWest;
-int initialFetchDone = 0;
+char* paths[PLANE_COUNT];  // API paths, one per plane
+struct ForecastFetch fetch;
+struct ForecastSchedule schedule;
+struct ForecastRateLimit rateLimit;
+struct HttpReader* http;
+unsigned int currentTime;
+int failedPlanes;
+int today;
+int i;
+
+// Panel planes, one entry per roof orientation
+struct PanelPlane planes[PLANE_COUNT];
+planes[0].name = "East";
+planes[0].slope = "45";
+planes[0].azimuth = "-63";
+planes[0].kwp = "5500";
+planes[1].name = "West";
+planes[1].slope = "45";
+planes[1].azimuth = "113";
+planes[1].kwp = "4500";
+for (i = 0; i < PLANE_COUNT; i++) {
+    paths[i] = malloc(512);
+}
+
+// Production of all planes together
+struct DailyProduction production;
+struct ForecastCache cache;
+
+// Publish the cached forecast of a previous run right away, and count it as a refresh while it is fresh.
+// After midnight yesterday's forecast for tomorrow is today's, and tomorrow waits for the fetch.
+initForecastSchedule(&schedule, PLANE_COUNT, TRIGGER_INTERVAL);
+if (loadForecastCache(&cache, CACHE_PATH) == 0 && cache.planeCount == PLANE_COUNT) {
+    unsigned int startTime = getcurrenttime();
+    int cachedValues;
+    int fresh = 0;
+    today = forecastSolarDay(getyear(startTime, 1), getmonth(startTime, 1), getday(startTime, 1));
+    cachedValues = forecastCacheProduction(&cache, today, &production);
+    if (cachedValues > 0) {
+        setoutput(OUTPUT_PV_PRODUCTION_TODAY, production.today / 1000.0);
+        setio(VI_PV_PRODUCTION_TODAY, production.today / 1000.0);
+    }
+    if (cachedValues > 1) {
+        setoutput(OUTPUT_PV_PRODUCTION_TOMORROW, production.tomorrow / 1000.0);
+        setio(VI_PV_PRODUCTION_TOMORROW, production.tomorrow / 1000.0);
+    }
+
+    if (forecastCacheFresh(&cache, startTime, today, PLANE_COUNT, CACHE_TTL)) {
+        restoreForecastSchedule(&schedule, cache.fetchedAt, cache.day);
+        fresh = 1;
+    }
+    sprintf(debug, "Cached production today: %f, tomorrow: %f, values: %d, fresh: %d", production.today / 1000.0,
+        production.tomorrow / 1000.0, cachedValues, fresh);
+    setoutputtext(DEBUG_OUTPUT_DEBUG, debug);
+}
 
 while (TRUE) {
     nEvents = getinputevent();
-    if ((nEvents & 0xFF) || !initialFetchDone) {
+    if (nEvents & 0xFF) {
+        triggerForecastSchedule(&schedule);
+    }
+    currentTime = getcurrenttime();
+    today = forecastSolarDay(getyear(currentTime, 1), getmonth(currentTime, 1), getday(currentTime, 1));
+    if (forecastScheduleDue(&schedule, currentTime, today, gethour(currentTime, 1))) {
         // Get current date in YYYY-MM-DD format using Loxone time functions
         char todayDate[11], tomorrowDate[11];
-        unsigned int currentTime = getcurrenttime();
         unsigned int tomorrowTime = currentTime + (24 * 60 * 60); // Add 24 hours in seconds
         
         // Format today's date (using local time)
@@ -67,68 +130,73 @@ while (TRUE) {
             getmonth(tomorrowTime, 1),
             getday(tomorrowTime, 1));
 
-       // Format URLs for both panel orientations
-        sprintf(urlEast, URL_PATH_FORMAT, LATITUDE, LONGITUDE, SLOPE, EAST_AZIMUTH, EAST_KWP, tomorrowDate);
-        sprintf(urlWest, URL_PATH_FORMAT, LATITUDE, LONGITUDE, SLOPE, WEST_AZIMUTH, WEST_KWP, tomorrowDate);
-        
-        // Log URLs
-        sprintf(debug, "East URL: %s\nWest URL: %s", urlEast, urlWest);
-        setoutputtext(DEBUG_OUTPUT_URL, debug);
-
-        // Fetch and process east panels data
-        struct DailyProduction eastProduction;
-        char* jsonBody;
-        responseEast = httpget(SERVER_ADDRESS, urlEast);
-        if (responseEast != NULL) {
-            // Log response (show body only)
-            jsonBody = skipHeaders(responseEast);
-            sprintf(debug, "East response: %s", jsonBody);
-            setoutputtext(DEBUG_OUTPUT_RESPONSE, debug);
-            
-            // Parse east production values
-            eastProduction = parseDailyProduction(jsonBody, todayDate, tomorrowDate);
-
-            // Free the east response
-            free(responseEast);
-        } else {
-            sprintf(debug, "Failed to fetch east panel data");
-            setoutputtext(DEBUG_OUTPUT_DEBUG, debug);
+        // Request every plane at once, then read the responses as they arrive
+        for (i = 0; i < PLANE_COUNT; i++) {
+            sprintf(paths[i], URL_PATH_FORMAT, LATITUDE, LONGITUDE, planes[i].slope, planes[i].azimuth, planes[i].kwp, tomorrowDate);
+            sprintf(debug, "%s URL: %s", planes[i].name, paths[i]);
+            setoutputtext(DEBUG_OUTPUT_URL, debug);
+        }
+        startForecastRefresh(&schedule, currentTime, today);
+        startForecastFetch(&fetch, SERVER_ADDRESS, SERVER_PORT, paths, PLANE_COUNT, FETCH_BUFFER_SIZE, FETCH_TIMEOUT_S, currentTime);
+        parseForecastFetch(&fetch, todayDate, tomorrowDate);
+        while (pollForecastFetch(&fetch, FETCH_POLL_MS, getcurrenttime()) > 0) {
         }
 
-        // Fetch and process west panels data
-        struct DailyProduction westProduction;
-        responseWest = httpget(SERVER_ADDRESS, urlWest);
-        if (responseWest != NULL) {
-            // Log response (show body only)
-            jsonBody = skipHeaders(responseWest);
-            sprintf(debug, "West response: %s", jsonBody);
-            setoutputtext(DEBUG_OUTPUT_RESPONSE, debug);    
-            
-            // Parse west production values
-            westProduction = parseDailyProduction(jsonBody, todayDate, tomorrowDate);
-
-            // Free the west response
-            free(responseWest);
-        } else {
-            sprintf(debug, "Failed to fetch east panel data");
-            setoutputtext(DEBUG_OUTPUT_DEBUG, debug);
+        // Add the production of each plane to the total, and keep it per plane for the cache
+        initForecastCache(&cache, currentTime, today, PLANE_COUNT);
+        failedPlanes = 0;
+        for (i = 0; i < PLANE_COUNT; i++) {
+            // The quota from the headers, also of failed requests, then from the body
+            http = &fetch.requests[i].http;
+            updateForecastSchedule(&schedule, currentTime, http->rateLimit, http->ratePeriod, http->rateRemaining, http->retryAfter);
+
+            if (fetch.requests[i].state != FORECAST_FETCH_DONE) {
+                sprintf(debug, "Failed to fetch %s panel data: %s (status %d)", planes[i].name,
+                    forecastFetchStateText(fetch.requests[i].state), fetch.requests[i].http.status);
+                setoutputtext(DEBUG_OUTPUT_DEBUG, debug);
+                failedPlanes++;
+                continue;
+            }
+
+            // The body was parsed as it arrived
+            if (parsedForecastRateLimit(&fetch.requests[i].parser, &rateLimit) == 0) {
+                updateForecastSchedule(&schedule, currentTime, rateLimit.limit, rateLimit.period, rateLimit.remaining, -1);
+            }
+            if (addParsedProduction(&cache.planes[i], &fetch.requests[i].parser) < 0) {
+                sprintf(debug, "Failed to parse %s panel data", planes[i].name);
+                setoutputtext(DEBUG_OUTPUT_DEBUG, debug);
+                failedPlanes++;
+                continue;
+            }
+
+            // Log the values read from the response, the body is not kept
+            sprintf(debug, "%s response: today %f, tomorrow %f, requests left %d", planes[i].name,
+                cache.planes[i].today / 1000.0, cache.planes[i].tomorrow / 1000.0, rateLimit.remaining);
+            setoutputtext(DEBUG_OUTPUT_RESPONSE, debug);
         }
-            
+        closeForecastFetch(&fetch);
+        production = forecastCacheTotal(&cache);
+
         // Calculate total production (convert to kWh)
-        float totalToday = (eastProduction.today + westProduction.today) / 1000.0;
-        float totalTomorrow = (eastProduction.tomorrow + westProduction.tomorrow) / 1000.0;
+        float totalToday = production.today / 1000.0;
+        float totalTomorrow = production.tomorrow / 1000.0;
 
-        sprintf(debug, "Total production today: %f, tomorrow: %f", totalToday, totalTomorrow);
+        sprintf(debug, "Total production today: %f, tomorrow: %f, failed planes: %d, requests left: %d", totalToday, totalTomorrow,
+            failedPlanes, schedule.remaining);
         setoutputtext(DEBUG_OUTPUT_DEBUG, debug);
 
-        // Update outputs and virtual inputs
-        setoutput(OUTPUT_PV_PRODUCTION_TODAY, totalToday);
-        setio(VI_PV_PRODUCTION_TODAY, totalToday);
-        
-        setoutput(OUTPUT_PV_PRODUCTION_TOMORROW, totalTomorrow);
-        setio(VI_PV_PRODUCTION_TOMORROW, totalTomorrow);
-        
-        initialFetchDone = 1;
+        // Update outputs and virtual inputs only with every plane counted, a partial sum would understate production
+        if (failedPlanes == 0) {
+            if (saveForecastCache(&cache, CACHE_PATH) < 0) {
+                setoutputtext(DEBUG_OUTPUT_DEBUG, "Failed to write the forecast cache");
+            }
+
+            setoutput(OUTPUT_PV_PRODUCTION_TODAY, totalToday);
+            setio(VI_PV_PRODUCTION_TODAY, totalToday);
+            
+            setoutput(OUTPUT_PV_PRODUCTION_TOMORROW, totalTomorrow);
+            setio(VI_PV_PRODUCTION_TOMORROW, totalTomorrow);
+        }
     }
     sleep(1000);
 }
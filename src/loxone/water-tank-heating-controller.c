@@ -34,11 +34,8 @@
 // Virtual input connection addresses
 #define VI_PV_POWER_NOW "AMQ125"
 
-// This is exactly the power the water heater consumes when heating on
-#define PV_POWER_THRESHOLD_IN_KW 2.5
-
-// This is the minimum power the PV should produce to charge the water tank and supply the house during the day
-#define PV_LOW_PRODUCTION_THRESHOLD_IN_KW 20
+// The PV thresholds of the decision are defined by water_tank_state.h,
+// which the bundle puts in front of this script
 
 // Define constants for inverter modes
 #define INVERTER_GENERAL_MODE 257
@@ -50,50 +47,37 @@
 void controlHeating() {
 
     char inputs[1024];
-    int temperatureBelowTreshold = getinput(INPUT_WATER_TANK_TEMPERATURE_BELOW_TRESHOLD) == 1;
-    int spotPriceIsVeryLow = getinput(INPUT_SPOT_PRICE_VLOW) == 1;
-    float predictedPVToday = getinput(INPUT_PREDICTED_PV_TODAY);
+    struct WaterTankInputs state;
+    struct WaterTankDecision decision;
     float predictedPVTomorrow = getinput(INPUT_PREDICTED_PV_TOMORROW);
     int inverterMode = getinput(INPUT_INVERTER_MODE);
-    int excessEnergyAvailable = getinput(INPUT_INVERTER_EXCESS_ENERGY_AVAILABLE) == 1;
-    int priorityChargingEnabled = getinput(INPUT_PRIORITY_CHARGING_ENABLED) == 1;
-    float pwPowerNow = getio(VI_PV_POWER_NOW);
-    int hourNow = gethour(getcurrenttime(), 1);
-    int canCharge = 0;
-    int sufficientPVPowerNow = pwPowerNow > PV_POWER_THRESHOLD_IN_KW;
-    int sufficientPVProductionToday = predictedPVToday > PV_LOW_PRODUCTION_THRESHOLD_IN_KW;
-    int sufficientPVProductionTomorrow = predictedPVTomorrow > PV_LOW_PRODUCTION_THRESHOLD_IN_KW;
-    int isDayMode = 0;
-    
-    // TODO: use better algorithm to determine that the hour is during the day (sunrise to sunset)
-    if(hourNow >= 6 && hourNow < 21) {
-        // During the day
-        isDayMode = 1;
-        canCharge = 
-            (!sufficientPVProductionToday && spotPriceIsVeryLow) ||
-            (sufficientPVPowerNow && spotPriceIsVeryLow);
-    } else {
-        // During the night
-        isDayMode = 0;
-        canCharge = !sufficientPVProductionTomorrow && spotPriceIsVeryLow;
-    }
-
-    // Only charge the water tank when excess energy is available (to avoid using grid power when prioritizing grid export)
-    setoutput(OUTPUT_HEATING_ON_OFF, (priorityChargingEnabled || canCharge) && temperatureBelowTreshold && excessEnergyAvailable);
+
+    state.temperatureBelowTreshold = getinput(INPUT_WATER_TANK_TEMPERATURE_BELOW_TRESHOLD) == 1;
+    state.spotPriceIsVeryLow = getinput(INPUT_SPOT_PRICE_VLOW) == 1;
+    state.predictedPVToday = getinput(INPUT_PREDICTED_PV_TODAY);
+    state.predictedPVTomorrow = predictedPVTomorrow;
+    state.excessEnergyAvailable = getinput(INPUT_INVERTER_EXCESS_ENERGY_AVAILABLE) == 1;
+    state.priorityChargingEnabled = getinput(INPUT_PRIORITY_CHARGING_ENABLED) == 1;
+    state.pvPowerNow = getio(VI_PV_POWER_NOW);
+    state.hour = gethour(getcurrenttime(), 1);
+
+    // Decide whether to heat, only with excess energy available
+    decideWaterTankHeating(&state, &decision);
+    setoutput(OUTPUT_HEATING_ON_OFF, decision.heating);
 
     sprintf(inputs,
             "Inputs:\n - Water tank temperature below treshold: %d\n - Spot price is very low: %d\n - Predicted PV production for tomorrow: %f\n - Predicted PV production for today: %f\n - Current PV production: %f\n - Current hour: %d\n - Is day mode: %d\n - Predicted PV tomorrow value: %f\n - Sufficient PV production tomorrow: %d\n - Can charge: %d\n - Excess energy available: %d",
-            temperatureBelowTreshold,
-            spotPriceIsVeryLow,
+            state.temperatureBelowTreshold,
+            state.spotPriceIsVeryLow,
             predictedPVTomorrow,
-            predictedPVToday,
-            pwPowerNow,
-            hourNow,
-            isDayMode,
+            state.predictedPVToday,
+            state.pvPowerNow,
+            state.hour,
+            decision.isDayMode,
             predictedPVTomorrow,
-            sufficientPVProductionTomorrow,
-            canCharge,
-            excessEnergyAvailable);
+            decision.sufficientPVProductionTomorrow,
+            decision.canCharge,
+            state.excessEnergyAvailable);
 
     // Set text output for debug inputs
     setoutputtext(TEXT_OUTPUT_DEBUG, inputs);
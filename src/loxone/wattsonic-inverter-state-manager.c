@@ -33,25 +33,8 @@ Wattsonic inverter G3 Modbus registers documentation:
 https://smarthome.exposed/wattsonic-hybrid-inverter-gen3-modbus-rtu-protocol
 */
 
-// Define constants for inverter modes
-#define INVERTER_GENERAL_MODE 257
-#define INVERTER_ECONOMIC_MODE 258
-#define INVERTER_UPS_MODE 259
-
-// Define battery modes
-#define BATTERY_NO_MODE 0
-#define BATTERY_CHARGE_MODE 1
-#define BATTERY_DISCHARGE_MODE 2
-
-// Constants for inverter state
-#define MORNING_HOURS_TILL 12
-#define MORNING_HOURS_FROM 5
-#define BATTERY_POWER_LIMIT_DISCHARGE_MAX 80
-// 30% power limit is recommended by the technician
-#define BATTERY_POWER_LIMIT_CHARGE_MAX 30
-#define BATTERY_POWER_LIMIT_OFF 0
-#define GRID_INJECTION_POWER_LIMIT_MAX 80
-#define GRID_INJECTION_POWER_LIMIT_OFF 0
+// Inverter modes, battery modes and limits are defined by inverter_state.h,
+// which the bundle puts in front of this script
 
 // Constants for output indexes
 #define OUTPUT_MODE 0
@@ -102,136 +85,79 @@ char* mapInverterMode(float mode) {
     }
 }
 
+// Thresholds of the decision, the morning hours are set once
+struct InverterSettings settings;
+
 // Function to determine the correct inverter state
 void updateInverterState() {
-
-    float currentSpotPrice = getinput(INPUT_CURRENT_SPOT_PRICE);
+    struct InverterInputs state;
+    struct InverterDecision decision;
     float minSpotPrice = getinput(INPUT_MIN_SPOT_PRICE);
-    float maxSpotPrice = getinput(INPUT_MAX_SPOT_PRICE);
-    float chargeSpotPriceThreshold = getinput(INPUT_CHARGE_THRESHOLD);
-    float dischargeSpotPriceThreshold = getinput(INPUT_DISCHARGE_THRESHOLD);
-    float socDischargeToGridTreshold = getinput(INPUT_SOC_DISCHARGE_TO_GRID_THRESHOLD);
-    float currentInverterMode = getinput(INPUT_CURRENT_INVERTER_MODE);
-    float predictedPVToday = getinput(INPUT_PREDICTED_PV_TODAY);
     float predictedPVTommorrow = getinput(INPUT_PREDICTED_PV_TOMORROW);
-    float pvProductionThreshold = getinput(INPUT_PV_PRODUCTION_THRESHOLD);
-    float spotPriceTreshold = getinput(INPUT_SPOT_PRICE_THRESHOLD);
-    float soc = getinput(INPUT_SOC);
-    float onGridEndSOCProtection = getinput(INPUT_ONGRID_SOC_PROTECTION);
-    float onGridEndSOCProtectionUserSetting = getio(VI_ONGRID_SOC_PROTECTION_USER_SETTING);
     float pvPowerNow = getio(VI_PV_POWER_NOW);
-    
-    float newMode = currentInverterMode;
-    int batteryMode = BATTERY_NO_MODE;
-    int batteryChargeDischargePowerLimit = BATTERY_POWER_LIMIT_OFF;
-    int gridInjectionPowerLimit = GRID_INJECTION_POWER_LIMIT_OFF;
-    int hourNow = gethour(getcurrenttime(), 1);
-    char inverterState[512];
     char inputs[1024];
-    int excessEnergyAvailable = 0;
 
-    // Determine the inverter mode and battery operation
+    settings.chargeSpotPriceThreshold = getinput(INPUT_CHARGE_THRESHOLD);
+    settings.dischargeSpotPriceThreshold = getinput(INPUT_DISCHARGE_THRESHOLD);
+    settings.socDischargeToGridThreshold = getinput(INPUT_SOC_DISCHARGE_TO_GRID_THRESHOLD);
+    settings.pvProductionThreshold = getinput(INPUT_PV_PRODUCTION_THRESHOLD);
+    settings.spotPriceThreshold = getinput(INPUT_SPOT_PRICE_THRESHOLD);
+    settings.onGridEndSOCProtectionUserSetting = getio(VI_ONGRID_SOC_PROTECTION_USER_SETTING);
+
+    state.currentSpotPrice = getinput(INPUT_CURRENT_SPOT_PRICE);
+    state.maxSpotPrice = getinput(INPUT_MAX_SPOT_PRICE);
+    state.currentInverterMode = getinput(INPUT_CURRENT_INVERTER_MODE);
+    state.predictedPVToday = getinput(INPUT_PREDICTED_PV_TODAY);
+    state.soc = getinput(INPUT_SOC);
+    state.onGridEndSOCProtection = getinput(INPUT_ONGRID_SOC_PROTECTION);
+    state.hour = gethour(getcurrenttime(), 1);
 
-    if (currentSpotPrice < chargeSpotPriceThreshold) {
-        newMode = INVERTER_ECONOMIC_MODE;
-        batteryMode = BATTERY_CHARGE_MODE; // Charge from grid
-        batteryChargeDischargePowerLimit = BATTERY_POWER_LIMIT_CHARGE_MAX; // Limit battery charging power to max allowed value
-        gridInjectionPowerLimit = GRID_INJECTION_POWER_LIMIT_OFF; // Do not inject power to grid
-        onGridEndSOCProtection = soc; // Set on-grid end SOC protection to current SOC, to avoid charging with full power, which is not good for the battery life-expectancy
-        
-        // Excess energy is available during very low spot prices (grid charging)
-        excessEnergyAvailable = 1;
-        
-        sprintf(inverterState, "Charging from grid");
-    } else if (fabs(maxSpotPrice - currentSpotPrice) <= 0.5 && // Spot price is close to max
-               currentSpotPrice >= dischargeSpotPriceThreshold && // Spot price is above discharge threshold
-               soc > socDischargeToGridTreshold) { // SOC is above the push to grid threshold
-        newMode = INVERTER_ECONOMIC_MODE;
-        batteryMode = BATTERY_DISCHARGE_MODE; // Discharge to grid
-        batteryChargeDischargePowerLimit = BATTERY_POWER_LIMIT_DISCHARGE_MAX; // Limit discharging power to max allowed value
-        gridInjectionPowerLimit = GRID_INJECTION_POWER_LIMIT_MAX; // Allow maximum allowed power to be injected to grid
-        onGridEndSOCProtection = onGridEndSOCProtectionUserSetting; // Set on-grid end SOC protection to user setting
-        
-        // No excess energy during discharging to grid (prioritize grid export)
-        excessEnergyAvailable = 0;
-        
-        sprintf(inverterState, "Discharging to grid");
-    } else if (currentSpotPrice > spotPriceTreshold && 
-               predictedPVToday > pvProductionThreshold &&
-               ((currentInverterMode != INVERTER_ECONOMIC_MODE && soc > onGridEndSOCProtectionUserSetting + 5) || // SOC is above the SOC protection threshold, with a hysteresis of 5%
-                (currentInverterMode == INVERTER_ECONOMIC_MODE && soc > onGridEndSOCProtectionUserSetting)) &&
-               hourNow > MORNING_HOURS_FROM && hourNow < MORNING_HOURS_TILL) { //only in morning hours
-        newMode = INVERTER_ECONOMIC_MODE;
-        batteryMode = BATTERY_DISCHARGE_MODE;
-        if(soc > onGridEndSOCProtection) {
-            onGridEndSOCProtection = soc; // Set on-grid end SOC protection to current SOC to prevent battery from discharging to the grid
-        }
-        batteryChargeDischargePowerLimit = BATTERY_POWER_LIMIT_OFF; // Switch off battery discharging by setting limit to 0
-        gridInjectionPowerLimit = GRID_INJECTION_POWER_LIMIT_MAX; // Allow maximum allowed power to be injected to grid
-        
-        // No excess energy during morning push to grid (prioritize grid export)
-        excessEnergyAvailable = 0;
-        
-        sprintf(inverterState, "Morning push to grid");
-    } else {
-        newMode = INVERTER_GENERAL_MODE;
-        onGridEndSOCProtection = onGridEndSOCProtectionUserSetting; // Set on-grid end SOC protection to user setting
-        
-        // Excess energy is available when the inverter is in general mode
-        excessEnergyAvailable = 1;
-
-        // Fix for battery full + low spot price scenario
-        // Always enable grid injection when battery is nearly full to prevent PV throttling
-        if(currentSpotPrice > spotPriceTreshold) {
-            gridInjectionPowerLimit = GRID_INJECTION_POWER_LIMIT_MAX; // Allow maximum allowed power to be injected to grid
-            sprintf(inverterState, "Grid injection enabled");
-        } else {
-            gridInjectionPowerLimit = GRID_INJECTION_POWER_LIMIT_OFF; // Do not inject power to grid
-            sprintf(inverterState, "Grid injection disabled");
-        }
-    }
+    // Determine the inverter mode and battery operation
+    decideInverterState(&settings, &state, &decision);
 
-    setoutput(OUTPUT_MODE, newMode);
-    setoutput(OUTPUT_BATTERY_MODE, batteryMode);
+    setoutput(OUTPUT_MODE, decision.mode);
+    setoutput(OUTPUT_BATTERY_MODE, decision.batteryMode);
     setoutput(OUTPUT_PERIOD_ENABLED, 1); // Period 1 is enabled
     setoutput(OUTPUT_BATTERY_CHARGE_BY, 1); // Battery charges by PV+Grid
-    setoutput(OUTPUT_BATTERY_CHARGE_DISCHARGE_LIMIT, batteryChargeDischargePowerLimit * 10); // FIXME: This does not work, the limit is not applied
-    setoutput(OUTPUT_GRID_INJECTION_LIMIT, gridInjectionPowerLimit * 10); // Set grid injection power limit based on current spot price
-    setoutput(OUTPUT_ONGRID_SOC_PROTECTION, onGridEndSOCProtection); // Set on-grid end SOC protection
-    setoutput(OUTPUT_INVERTER_EXCESS_ENERGY_AVAILABLE, excessEnergyAvailable); // Set excess energy available flag
+    setoutput(OUTPUT_BATTERY_CHARGE_DISCHARGE_LIMIT, decision.batteryChargeDischargePowerLimit * 10); // FIXME: This does not work, the limit is not applied
+    setoutput(OUTPUT_GRID_INJECTION_LIMIT, decision.gridInjectionPowerLimit * 10); // Set grid injection power limit based on current spot price
+    setoutput(OUTPUT_ONGRID_SOC_PROTECTION, decision.onGridEndSOCProtection); // Set on-grid end SOC protection
+    setoutput(OUTPUT_INVERTER_EXCESS_ENERGY_AVAILABLE, decision.excessEnergyAvailable); // Set excess energy available flag
 
     // Set text output for inverter mode
-    setoutputtext(TEXT_OUTPUT_MODE, mapInverterMode(newMode));
+    setoutputtext(TEXT_OUTPUT_MODE, mapInverterMode(decision.mode));
 
     // Set text output for inverter state
-    setoutputtext(TEXT_OUTPUT_INVERTER_STATE, inverterState);
+    setoutputtext(TEXT_OUTPUT_INVERTER_STATE, decision.state);
 
     sprintf(inputs,
             "Current spot price: %f\nMin spot price today: %f\nMax spot price today: %f\nCharge threshold: %f\nDischarge threshold: %f\nSOC discharge to grid threshold: %f\nCurrent inverter mode: %s\nPredicted PV today: %f\nPredicted PV tomorrow: %f\nPV production prediction threshold to discharge to grid or postpone morning production: %f\nSpot price threshold to push to grid: %f\nSOC: %f\nHour: %f\nBattery charge/discharge power limit: %d kW\nGrid injection power limit: %d kW\nOn-grid end SOC protection: %f\nOn-grid end SOC protection user setting: %f\nPV power now: %f W\nExcess energy available: %d",
-            currentSpotPrice,
+            state.currentSpotPrice,
             minSpotPrice,
-            maxSpotPrice,
-            chargeSpotPriceThreshold,
-            dischargeSpotPriceThreshold,
-            socDischargeToGridTreshold,
-            mapInverterMode(currentInverterMode),
-            predictedPVToday, 
+            state.maxSpotPrice,
+            settings.chargeSpotPriceThreshold,
+            settings.dischargeSpotPriceThreshold,
+            settings.socDischargeToGridThreshold,
+            mapInverterMode(state.currentInverterMode),
+            state.predictedPVToday,
             predictedPVTommorrow,
-            pvProductionThreshold,
-            spotPriceTreshold,
-            soc,
-            hourNow,
-            batteryChargeDischargePowerLimit,
-            gridInjectionPowerLimit,
-            onGridEndSOCProtection,
-            onGridEndSOCProtectionUserSetting,
+            settings.pvProductionThreshold,
+            settings.spotPriceThreshold,
+            state.soc,
+            state.hour,
+            decision.batteryChargeDischargePowerLimit,
+            decision.gridInjectionPowerLimit,
+            decision.onGridEndSOCProtection,
+            settings.onGridEndSOCProtectionUserSetting,
             pvPowerNow,
-            excessEnergyAvailable);
+            decision.excessEnergyAvailable);
 
     // Set text output for debug inputs
     setoutputtext(TEXT_OUTPUT_DEBUG_INPUTS, inputs);
 }
 
+initInverterSettings(&settings);
+
 // Main loop
 while(TRUE) {
     updateInverterState();